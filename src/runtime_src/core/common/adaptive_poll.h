@@ -0,0 +1,130 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef core_common_adaptive_poll_h_
+#define core_common_adaptive_poll_h_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace xrt_core {
+
+/**
+ * Hybrid polling policy for command completion.
+ *
+ * Blocking in exec_wait costs an interrupt and a thread wake-up, which
+ * dominates the completion latency of short commands.  This policy
+ * busy polls command state for a short window before the caller falls
+ * back to blocking.  The window adapts to a moving average of recently
+ * observed command durations: when commands are short the window covers
+ * them, when commands are longer than the max window polling is skipped
+ * altogether since it would only burn CPU.
+ *
+ * Durations are recorded by the thread waiting for completion, the
+ * policy itself is safe to share between threads.
+ */
+class adaptive_poll
+{
+  using clock = std::chrono::steady_clock;
+
+  std::atomic<unsigned long> m_max_window_ns;
+  std::atomic<unsigned long> m_average_ns {0};
+
+  static unsigned long
+  now_ns()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now().time_since_epoch()).count();
+  }
+
+public:
+  /**
+   * @max_window_us: upper bound of poll window in microseconds, zero
+   *   disables polling
+   */
+  explicit
+  adaptive_poll(unsigned int max_window_us)
+    : m_max_window_ns(max_window_us*1000ul)
+  {}
+
+  void
+  set_max_window(unsigned int us)
+  {
+    m_max_window_ns = us*1000ul;
+  }
+
+  unsigned int
+  get_max_window() const
+  {
+    return m_max_window_ns/1000;
+  }
+
+  /**
+   * Record the observed duration of a command
+   */
+  void
+  record(unsigned long duration_ns)
+  {
+    // Exponential moving average with weight 1/8 for new samples
+    auto avg = m_average_ns.load(std::memory_order_relaxed);
+    avg = avg ? avg - avg/8 + duration_ns/8 : duration_ns;
+    m_average_ns.store(avg,std::memory_order_relaxed);
+  }
+
+  /**
+   * @return current poll window in nanoseconds
+   */
+  unsigned long
+  window() const
+  {
+    auto max = m_max_window_ns.load(std::memory_order_relaxed);
+    auto avg = m_average_ns.load(std::memory_order_relaxed);
+    if (!avg)
+      return max;
+    if (avg > max)
+      return 0;
+    return std::min(max,2*avg);
+  }
+
+  /**
+   * Poll until predicate is satisfied or poll window expires
+   *
+   * @done: predicate returning true when polling is satisfied
+   * Return: true if predicate was satisfied, false if caller should block
+   */
+  template <typename Predicate>
+  bool
+  poll(Predicate&& done) const
+  {
+    auto w = window();
+    if (!w)
+      return done();
+
+    auto deadline = now_ns() + w;
+    do {
+      if (done())
+        return true;
+      std::this_thread::yield();
+    } while (now_ns() < deadline);
+
+    return done();
+  }
+};
+
+} // xrt_core
+
+#endif
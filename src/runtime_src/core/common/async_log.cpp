@@ -0,0 +1,163 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "async_log.h"
+
+namespace {
+
+// Max bytes of records written to the stream at a time
+constexpr size_t batch_size = 64*1024;
+
+}
+
+namespace xrt_core {
+
+async_log::
+async_log(std::ostream& out, size_t queue_size, unsigned int flush_interval_ms)
+  : m_out(out)
+  , m_queue(queue_size)
+  , m_flush_interval(flush_interval_ms)
+{
+  m_thread = std::thread([this] { run(); });
+}
+
+async_log::
+~async_log()
+{
+  stop();
+}
+
+bool
+async_log::
+write(std::string&& record, bool urgent)
+{
+  ++m_writers;
+  if (m_stop.load()) {
+    --m_writers;
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_out.write(record.data(),record.size());
+    m_out.flush();
+    return true;
+  }
+
+  bool queued = m_queue.push(std::move(record));
+  if (!queued)
+    ++m_dropped;
+  else if (urgent)
+    m_urgent.store(true);
+
+  // Pairs with the writer announcing itself before it checks the queue
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (m_waiting.load()) {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_cond.notify_one();
+  }
+  --m_writers;
+  return queued;
+}
+
+void
+async_log::
+stop()
+{
+  if (m_stop.exchange(true))
+    return;
+
+  // Records of writers that saw m_stop clear must be queued before the
+  // writer thread is told to drain and exit
+  while (m_writers.load())
+    std::this_thread::yield();
+
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_exit.store(true);
+    m_cond.notify_one();
+  }
+  m_thread.join();
+}
+
+void
+async_log::
+wait(bool dirty, std::chrono::steady_clock::time_point last_flush)
+{
+  std::unique_lock<std::mutex> lk(m_mutex);
+  m_waiting.store(true);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (m_queue.empty() && !m_exit.load() && !m_urgent.load()) {
+    if (dirty)
+      m_cond.wait_until(lk,last_flush + m_flush_interval);
+    else
+      m_cond.wait_for(lk,m_flush_interval);
+  }
+  m_waiting.store(false);
+}
+
+void
+async_log::
+run()
+{
+  std::string batch;
+  std::string record;
+  batch.reserve(batch_size + 1024);
+  auto last_flush = std::chrono::steady_clock::now();
+  bool dirty = false;
+
+  for (;;) {
+    // Both read before draining so that the drain covers all records
+    // queued before the flags were raised
+    bool exit = m_exit.load();
+    bool urgent = m_urgent.exchange(false);
+
+    bool popped = false;
+    while (batch.size() < batch_size && m_queue.pop(record)) {
+      batch += record;
+      popped = true;
+    }
+
+    auto dropped = m_dropped.load();
+    if (dropped != m_reported) {
+      batch += "[XRT] " + std::to_string(dropped - m_reported) + " log records dropped\n";
+      m_reported = dropped;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (!batch.empty())
+      dirty = true;
+    bool flush = dirty && (exit || urgent || now - last_flush >= m_flush_interval);
+    if (!batch.empty() || flush) {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      m_out.write(batch.data(),batch.size());
+      if (flush) {
+        m_out.flush();
+        last_flush = now;
+        dirty = false;
+      }
+    }
+    batch.clear();
+
+    if (!m_queue.empty()) {
+      // more records, or one that is claimed but not yet published
+      if (!popped)
+        std::this_thread::yield();
+      continue;
+    }
+    if (exit)
+      break;
+    wait(dirty,last_flush);
+  }
+}
+
+} // xrt_core
@@ -0,0 +1,117 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef core_common_async_log_h_
+#define core_common_async_log_h_
+
+#include "mpsc_queue.h"
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <string>
+#include <ostream>
+#include <cstdint>
+
+namespace xrt_core {
+
+/**
+ * Asynchronous writer of preformatted log records.
+ *
+ * Callers push complete records (including the line terminator) into a
+ * bounded lock-free queue and return immediately.  A background thread
+ * drains the queue, writes records in batches, and flushes the stream
+ * once a flush interval has passed since the last flush, or right away
+ * after an urgent record.
+ *
+ * When the queue is full, records are dropped rather than blocking the
+ * caller.  Dropped records are counted and the count is reported in the
+ * log stream itself.
+ *
+ * After stop(), which drains all queued records, records are written
+ * and flushed synchronously.
+ */
+class async_log
+{
+public:
+  /**
+   * @out: stream to write records to, must outlive this object
+   * @queue_size: max number of queued records
+   * @flush_interval_ms: max time written records are held unflushed
+   */
+  async_log(std::ostream& out, size_t queue_size, unsigned int flush_interval_ms);
+  ~async_log();
+
+  async_log(const async_log&) = delete;
+  async_log& operator=(const async_log&) = delete;
+
+  /**
+   * Queue a record for writing
+   *
+   * @record: complete record, moved from only if queued
+   * @urgent: wake the writer and flush as soon as the record is written
+   * @return
+   *   true if queued or written, false if dropped
+   */
+  bool
+  write(std::string&& record, bool urgent=false);
+
+  /**
+   * Drain queued records, flush, and stop the writer thread
+   */
+  void
+  stop();
+
+  /**
+   * @return
+   *   number of records dropped since construction
+   */
+  uint64_t
+  dropped() const
+  {
+    return m_dropped.load();
+  }
+
+private:
+  void
+  run();
+
+  void
+  wait(bool dirty, std::chrono::steady_clock::time_point last_flush);
+
+  std::ostream& m_out;
+  mpsc_queue<std::string> m_queue;
+  const std::chrono::milliseconds m_flush_interval;
+
+  std::atomic<uint64_t> m_dropped {0};
+  uint64_t m_reported = 0;             // writer thread only
+
+  std::atomic<unsigned int> m_writers {0};  // threads inside write()
+  std::atomic<bool> m_urgent {false};
+  std::atomic<bool> m_waiting {false};
+  std::atomic<bool> m_stop {false};     // no more records are queued
+  std::atomic<bool> m_exit {false};     // writer drains and exits
+
+  std::mutex m_mutex;
+  std::condition_variable m_cond;
+  std::thread m_thread;
+};
+
+} // xrt_core
+
+#endif
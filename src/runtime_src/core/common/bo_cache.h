@@ -17,9 +17,9 @@
 #ifndef core_common_bo_cache_h_
 #define core_common_bo_cache_h_
 
-#include <vector>
+#include "cmd_bo_pool.h"
+
 #include <utility>
-#include <mutex>
 #ifndef _WIN32
 #include <sys/mman.h>
 #endif
@@ -30,12 +30,20 @@
 namespace xrt_core {
 
 // Create a cache of CMD BO objects -- for now only used for M2M -- to reduce
-// the overhead of BO life cycle management.
+// the overhead of BO life cycle management.  The cache is a lock-free
+// cmd_bo_pool of mapped exec BOs, BOs are mapped once and recycled.
 class bo_cache {
-  // Helper typedef for std::pair. Note the elements are const so that the
-  // pair is immutable. The clients should not change the contents of cmd_bo.
+  // Helper struct for a mapped exec BO.  The slot identifies the pool entry
+  // the BO belongs to.  The clients should not change the contents of cmd_bo.
   template <typename CommandType>
-  using cmd_bo = std::pair<const unsigned int, CommandType *const>;
+  struct cmd_bo
+  {
+    unsigned int first;
+    CommandType* second;
+    size_t slot;
+  };
+
+  using pool_type = cmd_bo_pool<std::pair<unsigned int, void*>>;
 
   // We are really allocating a page size as that is what xocl/zocl do. Note on
   // POWER9 pagesize maybe more than 4K, xocl would upsize the allocation to the
@@ -44,71 +52,42 @@ class bo_cache {
   xclDeviceHandle mDevice;
   // Maximum number of BOs that can be cached in the pool. Value of 0 indicates
   // caching should be disabled.
-  const unsigned int mCacheMaxSize;
-  std::vector<cmd_bo<void>> mCmdBOCache;
-  std::mutex mCacheMutex;
+  pool_type mCmdBOCache;
 
 public:
  bo_cache(xclDeviceHandle handle, unsigned int max_size)
-   : mDevice(handle), mCacheMaxSize(max_size)
+   : mDevice(handle)
+   , mCmdBOCache(max_size, [this](pool_type::buffer_type& bo) { destroy(bo); })
   {}
 
-  ~bo_cache()
-  {
-    std::lock_guard<std::mutex> lock(mCacheMutex);
-    for (auto& bo : mCmdBOCache)
-      destroy(bo);
-  }
-
   template<typename T>
   cmd_bo<T>
   alloc()
   {
-    auto bo = alloc_impl();
-    return std::make_pair(bo.first, static_cast<T *>(bo.second));
+    auto e = mCmdBOCache.acquire([this] { return alloc_impl(); });
+    return {e.bo.first, static_cast<T *>(e.bo.second), e.slot};
   }
 
   template<typename T>
   void
   release(cmd_bo<T>& bo)
   {
-    release_impl(std::make_pair(bo.first, static_cast<void *>(bo.second)));
+    pool_type::entry e;
+    e.bo = std::make_pair(bo.first, static_cast<void *>(bo.second));
+    e.slot = bo.slot;
+    mCmdBOCache.release(e);
   }
 
 private:
-  cmd_bo<void>
+  pool_type::buffer_type
   alloc_impl()
   {
-    if (mCacheMaxSize) {
-      // If caching is enabled first look up in the BO cache
-      std::lock_guard<std::mutex> lock(mCacheMutex);
-      if (!mCmdBOCache.empty()) {
-        auto bo = mCmdBOCache.back();
-        mCmdBOCache.pop_back();
-        return bo;
-      }
-    }
-
     auto execHandle = xclAllocBO(mDevice, mBOSize, 0, XCL_BO_FLAGS_EXECBUF);
     return std::make_pair(execHandle, xclMapBO(mDevice, execHandle, true));
   }
 
   void
-  release_impl(const cmd_bo<void> &bo)
-  {
-    if (mCacheMaxSize) {
-      // If caching is enabled and BO cache is not fully populated add this the cache
-      std::lock_guard<std::mutex> lock(mCacheMutex);
-      if (mCmdBOCache.size() < mCacheMaxSize) {
-        mCmdBOCache.push_back(bo);
-        return;
-      }
-    }
-    destroy(bo);
-  }
-  
-  void
-  destroy(const cmd_bo<void> &bo)
+  destroy(const pool_type::buffer_type& bo)
   {
     (void)munmap(bo.second, mBOSize);
     xclFreeBO(mDevice, bo.first);
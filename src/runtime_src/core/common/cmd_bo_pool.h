@@ -0,0 +1,232 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef core_common_cmd_bo_pool_h_
+#define core_common_cmd_bo_pool_h_
+
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <cstddef>
+
+namespace xrt_core {
+
+/**
+ * Lock-free pool of mapped command buffer objects.
+ *
+ * The pool has a fixed number of slots.  A slot is either empty, holds
+ * an idle buffer object, or holds a buffer object that is in use.
+ * Buffer objects are allocated (and mapped) once when a slot is first
+ * populated and are then recycled without being remapped.  Slot state
+ * transitions are atomic, so acquire and release never lock.
+ *
+ * Each thread remembers the slot it last used and starts its search
+ * there, which in the common case of a thread recycling its own
+ * command buffer finds an idle slot on first probe and keeps threads
+ * from contending on the same slots.
+ *
+ * When all slots are in use, acquire allocates an overflow buffer object
+ * that is destroyed on release.  A pool with zero capacity disables
+ * caching entirely.
+ *
+ * @BufferType: the pooled buffer object, must be default constructible
+ *  and copyable.  Copies of an acquired buffer object are owned by
+ *  the pool and must not outlive the pool.
+ */
+template <typename BufferType>
+class cmd_bo_pool
+{
+public:
+  using buffer_type = BufferType;
+  using destroy_type = std::function<void(buffer_type&)>;
+
+  static constexpr size_t npos = ~size_t(0);
+
+  /**
+   * An acquired buffer object and the slot it belongs to
+   */
+  struct entry
+  {
+    buffer_type bo {};
+    size_t slot = npos;
+  };
+
+private:
+  enum : int { empty = 0, idle = 1, busy = 2 };
+
+  struct slot_type
+  {
+    std::atomic<int> state {empty};
+    buffer_type bo {};
+  };
+
+  size_t m_capacity;
+  std::unique_ptr<slot_type[]> m_slots;
+  destroy_type m_destroy;
+
+  static size_t&
+  hint()
+  {
+    static thread_local size_t value = std::hash<std::thread::id>()(std::this_thread::get_id());
+    return value;
+  }
+
+  void
+  destroy(buffer_type& bo)
+  {
+    if (m_destroy)
+      m_destroy(bo);
+    bo = buffer_type{};
+  }
+
+  bool
+  try_claim(size_t idx, int from)
+  {
+    return m_slots[idx].state.compare_exchange_strong(from,busy,std::memory_order_acquire);
+  }
+
+  template <typename AllocFn>
+  void
+  populate(size_t idx, AllocFn&& alloc)
+  {
+    try {
+      m_slots[idx].bo = alloc();
+    }
+    catch (...) {
+      m_slots[idx].state.store(empty,std::memory_order_release);
+      throw;
+    }
+  }
+
+public:
+  /**
+   * @capacity: max number of buffer objects retained by pool
+   * @destroy: function to free a buffer object, can be empty if
+   *   buffer_type manages its own lifetime
+   */
+  explicit
+  cmd_bo_pool(size_t capacity, destroy_type destroy = nullptr)
+    : m_capacity(capacity)
+    , m_slots(capacity ? new slot_type[capacity] : nullptr)
+    , m_destroy(std::move(destroy))
+  {}
+
+  ~cmd_bo_pool()
+  {
+    purge();
+  }
+
+  cmd_bo_pool(const cmd_bo_pool&) = delete;
+  cmd_bo_pool& operator=(const cmd_bo_pool&) = delete;
+
+  size_t
+  capacity() const
+  {
+    return m_capacity;
+  }
+
+  /**
+   * Acquire a buffer object from the pool
+   *
+   * @alloc: callable returning a new buffer_type, used if no idle
+   *   buffer object is available.
+   * Return: entry with buffer object, must be released to this pool
+   */
+  template <typename AllocFn>
+  entry
+  acquire(AllocFn&& alloc)
+  {
+    if (!m_capacity)
+      return {alloc(),npos};
+
+    auto start = hint();
+
+    // Idle slot, probing from this thread's last slot
+    for (size_t i=0; i<m_capacity; ++i) {
+      auto idx = (start + i) % m_capacity;
+      if (try_claim(idx,idle)) {
+        hint() = idx;
+        return {m_slots[idx].bo,idx};
+      }
+    }
+
+    // Populate an empty slot
+    for (size_t i=0; i<m_capacity; ++i) {
+      auto idx = (start + i) % m_capacity;
+      if (try_claim(idx,empty)) {
+        populate(idx,alloc);
+        hint() = idx;
+        return {m_slots[idx].bo,idx};
+      }
+    }
+
+    // All slots in use
+    return {alloc(),npos};
+  }
+
+  /**
+   * Release a buffer object previously acquired from this pool
+   */
+  void
+  release(entry& e)
+  {
+    if (e.slot == npos) {
+      destroy(e.bo);
+      return;
+    }
+
+    hint() = e.slot;
+    m_slots[e.slot].state.store(idle,std::memory_order_release);
+    e.bo = buffer_type{};
+    e.slot = npos;
+  }
+
+  /**
+   * Populate up to @count empty slots with idle buffer objects
+   */
+  template <typename AllocFn>
+  void
+  prealloc(size_t count, AllocFn&& alloc)
+  {
+    for (size_t idx=0; idx<m_capacity && count; ++idx) {
+      if (!try_claim(idx,empty))
+        continue;
+      populate(idx,alloc);
+      m_slots[idx].state.store(idle,std::memory_order_release);
+      --count;
+    }
+  }
+
+  /**
+   * Free all idle buffer objects.  Buffer objects in use are
+   * not affected.
+   */
+  void
+  purge()
+  {
+    for (size_t idx=0; idx<m_capacity; ++idx) {
+      if (!try_claim(idx,idle))
+        continue;
+      destroy(m_slots[idx].bo);
+      m_slots[idx].state.store(empty,std::memory_order_release);
+    }
+  }
+};
+
+} // xrt_core
+
+#endif
@@ -22,6 +22,14 @@
 #include <boost/filesystem/operations.hpp>
 #include <iostream>
 #include <cstdlib>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <csignal>
 
 #ifdef __GNUC__
 # include <linux/limits.h>
@@ -102,10 +110,64 @@ get_ini_path()
   return full_path;
 }
 
+/*
+ * Reload the ini file when it changes or on SIGHUP, as selected by
+ * Runtime.ini_reload.  The file is checked once per interval.
+ */
+static std::atomic<int> s_sighup {0}; // lock free, safe in a handler
+
+static void
+on_sighup(int)
+{
+  s_sighup = 1;
+}
+
+struct file_stamp
+{
+  time_t sec = 0;
+  long nsec = 0;
+  off_t size = -1;
+
+  bool
+  operator!=(const file_stamp& rhs) const
+  {
+    return sec != rhs.sec || nsec != rhs.nsec || size != rhs.size;
+  }
+};
+
+static file_stamp
+get_file_stamp(const std::string& path)
+{
+  file_stamp stamp;
+#ifdef __GNUC__
+  struct stat st;
+  if (!path.empty() && ::stat(path.c_str(),&st) == 0) {
+    stamp.sec = st.st_mtim.tv_sec;
+    stamp.nsec = st.st_mtim.tv_nsec;
+    stamp.size = st.st_size;
+  }
+#endif
+  return stamp;
+}
+
 struct tree
 {
-  boost::property_tree::ptree m_tree;
+  // Every tree read is kept, get_ptree_value() hands out references
+  // into them.  Reloads are rare, so this stays small.
+  std::vector<std::unique_ptr<boost::property_tree::ptree>> m_trees;
+  const boost::property_tree::ptree* m_tree = nullptr;
   const boost::property_tree::ptree null_tree;
+  std::string m_path;
+  std::mutex m_mutex;
+  std::atomic<uint64_t> m_reloads {0};
+
+  // ini file watcher
+  std::mutex m_watch_mutex;
+  std::condition_variable m_watch_cond;
+  std::thread m_watch_thread;
+  bool m_watch_stop = false;
+  struct sigaction m_old_action;
+  bool m_sighup = false;
 
   void
   setenv()
@@ -114,36 +176,156 @@ struct tree
       ::setenv("XCL_MULTIPROCESS_MODE","1",1);
   }
 
-  void
-  read(const std::string& path)
+  // Read path and make it the current tree if it differs
+  bool
+  read(const std::string& path, const char* what)
   {
+    std::unique_ptr<boost::property_tree::ptree> pt(new boost::property_tree::ptree);
     try {
-      read_ini(path,m_tree);
-
-      // inform which .ini was read
-      xrt_core::message::send(xrt_core::message::severity_level::XRT_INFO, "XRT", std::string("Read ") + path);
+      read_ini(path,*pt);
     }
     catch (const std::exception& ex) {
       xrt_core::message::send(xrt_core::message::severity_level::XRT_WARNING, "XRT", ex.what());
+      return false;
+    }
+
+    bool changed = false;
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      m_path = path;
+      if (*pt != *m_tree) {
+        m_tree = pt.get();
+        m_trees.push_back(std::move(pt));
+        ++m_reloads;
+        changed = true;
+      }
+    }
+
+    // inform which .ini was read
+    xrt_core::message::send(xrt_core::message::severity_level::XRT_INFO, "XRT", std::string(what) + path);
+    return changed;
+  }
+
+  bool
+  reload(const std::string& path)
+  {
+    std::string file = path;
+    if (file.empty()) {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      file = m_path;
+    }
+    if (file.empty())
+      file = get_ini_path();
+    if (file.empty())
+      return false;
+    return read(file,"Reloaded ");
+  }
+
+  std::string
+  path()
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return m_path;
+  }
+
+  void
+  watch_run(bool watch_file, std::chrono::milliseconds interval)
+  {
+    auto stamp = get_file_stamp(path());
+    std::unique_lock<std::mutex> lk(m_watch_mutex);
+    while (!m_watch_cond.wait_for(lk,interval,[this] { return m_watch_stop; })) {
+      lk.unlock();
+      bool signaled = s_sighup.exchange(0);
+      if (signaled)
+        reload("");
+      if (watch_file) {
+        auto now = get_file_stamp(path());
+        if (now != stamp && !signaled)
+          reload("");
+        stamp = now;
+      }
+      lk.lock();
+    }
+  }
+
+  void
+  watch_stop()
+  {
+    {
+      std::lock_guard<std::mutex> lk(m_watch_mutex);
+      m_watch_stop = true;
+    }
+    m_watch_cond.notify_all();
+    if (m_watch_thread.joinable())
+      m_watch_thread.join();
+    m_watch_stop = false;
+
+    if (m_sighup) {
+      ::sigaction(SIGHUP,&m_old_action,nullptr);
+      m_sighup = false;
+    }
+  }
+
+  void
+  watch(const std::string& mode, unsigned int interval_ms)
+  {
+    watch_stop();
+    if (mode == "off")
+      return;
+    if (mode != "watch" && mode != "signal") {
+      xrt_core::message::send(xrt_core::message::severity_level::XRT_WARNING, "XRT",
+                              "Unknown ini_reload '" + mode + "', ini file is not reloaded");
+      return;
+    }
+
+    if (mode == "signal") {
+      // Don't take SIGHUP from an application handling it
+      struct sigaction action = {};
+      action.sa_handler = on_sighup;
+      sigemptyset(&action.sa_mask);
+      action.sa_flags = SA_RESTART;
+      struct sigaction old_action;
+      if (::sigaction(SIGHUP,nullptr,&old_action) == 0
+          && old_action.sa_handler != SIG_DFL && old_action.sa_handler != SIG_IGN
+          && old_action.sa_handler != on_sighup) {
+        xrt_core::message::send(xrt_core::message::severity_level::XRT_WARNING, "XRT",
+                                "SIGHUP is handled by the application, ini file is not reloaded");
+        return;
+      }
+      m_old_action = old_action;
+      m_sighup = (::sigaction(SIGHUP,&action,nullptr) == 0);
     }
+
+    m_watch_thread = std::thread([this,mode,interval_ms] {
+      watch_run(mode == "watch",std::chrono::milliseconds(interval_ms));
+    });
   }
 
   tree()
   {
+    m_trees.emplace_back(new boost::property_tree::ptree);
+    m_tree = m_trees.back().get();
+
     auto ini_path = get_ini_path();
     if (!ini_path.empty())
-      read(ini_path);
+      read(ini_path,"Read ");
 
     // set env vars to expose sdaccel.ini (or default) to hal layer
     setenv();
 
+    watch(xrt_core::config::get_ini_reload(),1000);
     return;
   }
 
+  ~tree()
+  {
+    watch_stop();
+  }
+
   void
   reread(const std::string& fnm)
   {
-    read(fnm);
+    read(fnm,"Read ");
   }
 };
 
@@ -167,13 +349,18 @@ get_bool_value(const char* key, bool default_value)
   if (auto env = get_env_value(key))
     return is_true(env);
 
-  return s_tree.m_tree.get<bool>(key,default_value);
+  std::lock_guard<std::mutex> lk(s_tree.m_mutex);
+  return s_tree.m_tree->get<bool>(key,default_value);
 }
 
 std::string
 get_string_value(const char* key, const std::string& default_value)
 {
-  std::string val = s_tree.m_tree.get<std::string>(key,default_value);
+  std::string val;
+  {
+    std::lock_guard<std::mutex> lk(s_tree.m_mutex);
+    val = s_tree.m_tree->get<std::string>(key,default_value);
+  }
   // Although INI file entries are not supposed to have quotes around strings
   // but we want to be cautious
   if (!val.empty() && (val.front() == '"') && (val.back() == '"')) {
@@ -186,15 +373,28 @@ get_string_value(const char* key, const std::string& default_value)
 unsigned int
 get_uint_value(const char* key, unsigned int default_value)
 {
-  return s_tree.m_tree.get<unsigned int>(key,default_value);
+  std::lock_guard<std::mutex> lk(s_tree.m_mutex);
+  return s_tree.m_tree->get<unsigned int>(key,default_value);
+}
+
+uint64_t
+get_reload_count()
+{
+  return s_tree.m_reloads.load(std::memory_order_acquire);
 }
 
+void
+watch(const std::string& mode, unsigned int interval_ms)
+{
+  s_tree.watch(mode,interval_ms);
+}
 
 const boost::property_tree::ptree&
 get_ptree_value(const char* key)
 {
-  boost::property_tree::ptree::const_assoc_iterator i = s_tree.m_tree.find(key);
-  return (i != s_tree.m_tree.not_found()) ? i->second : s_tree.null_tree;
+  std::lock_guard<std::mutex> lk(s_tree.m_mutex);
+  boost::property_tree::ptree::const_assoc_iterator i = s_tree.m_tree->find(key);
+  return (i != s_tree.m_tree->not_found()) ? i->second : s_tree.null_tree;
 }
 
 std::ostream&
@@ -203,7 +403,8 @@ debug(std::ostream& ostr, const std::string& ini)
   if (!ini.empty())
     s_tree.reread(ini);
 
-  for(auto& section : s_tree.m_tree) {
+  std::lock_guard<std::mutex> lk(s_tree.m_mutex);
+  for(auto& section : *s_tree.m_tree) {
     ostr << "[" << section.first << "]\n";
     for (auto& key:section.second) {
       ostr << key.first << " = " << key.second.get_value<std::string>() << std::endl;
@@ -214,4 +415,10 @@ debug(std::ostream& ostr, const std::string& ini)
 
 } // detail
 
+bool
+reload(const std::string& path)
+{
+  return s_tree.reload(path);
+}
+
 }}
@@ -19,6 +19,9 @@
 
 #include <string>
 #include <iosfwd>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
 
 #include <boost/property_tree/ptree_fwd.hpp>
 
@@ -52,6 +55,10 @@ namespace xrt_core { namespace config {
  * else.  E.g. xdp::config, xocl::config, etc all sharing the same
  * data read at start up.
  *
+ * A few values that tune performance or logging are reloadable, they
+ * are read again when the ini file has been reloaded, see reload().
+ * All other values keep what was read the first time.
+ *
  * For a unit test live example see xrt/test/util/tconfig.cpp
  */
 
@@ -69,8 +76,59 @@ unsigned int                       get_uint_value(const char*, unsigned int);
 const boost::property_tree::ptree& get_ptree_value(const char*);
 std::ostream& debug(std::ostream&, const std::string& ini="");
 
+/* Number of times the ini file was reloaded with changed content */
+uint64_t get_reload_count();
+/* Start (or stop with "off") watching the ini file, used by tests */
+void watch(const std::string& mode, unsigned int interval_ms);
+
+/**
+ * Cached value that is read again after the ini file is reloaded.
+ * A reader sees either the old or the new value, never a torn one.
+ *
+ * The value is refreshed by one thread at a time and stored before
+ * the reload count it was read at, so a reader that sees the current
+ * count also sees a value at least that new.  A refresh racing with
+ * another reload stores the older count and is redone on next access.
+ */
+template <typename T>
+class reloadable
+{
+  std::atomic<T> m_value {T()};
+  std::atomic<uint64_t> m_count {~uint64_t(0)};
+  std::mutex m_mutex;
+public:
+  template <typename Read>
+  T
+  get(Read read)
+  {
+    if (m_count.load(std::memory_order_acquire) != get_reload_count()) {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      auto count = get_reload_count();
+      if (m_count.load(std::memory_order_relaxed) != count) {
+        m_value.store(read(),std::memory_order_relaxed);
+        m_count.store(count,std::memory_order_release);
+      }
+    }
+    return m_value.load(std::memory_order_relaxed);
+  }
+};
+
 }
 
+/**
+ * Read the ini file again, path defaults to the file read at start.
+ * Returns true if the content changed, in which case reloadable
+ * values pick up the new settings the next time they are accessed.
+ *
+ * The ini file is also reloaded automatically according to
+ * Runtime.ini_reload:
+ *   off    - never (default)
+ *   watch  - when the file is modified, checked once per second
+ *   signal - when the process receives SIGHUP
+ */
+bool
+reload(const std::string& path="");
+
 /**
  * Public API.  Cached accessors.
  *
@@ -149,6 +207,38 @@ get_timeline_trace()
   return value;
 }
 
+/**
+ * Write the timeline trace through a buffered writer whose I/O is done
+ * by a thread of its own, instead of on the thread logging events.
+ */
+inline bool
+get_timeline_trace_stream()
+{
+  static bool value = get_timeline_trace() && detail::get_bool_value("Debug.timeline_trace_stream",false);
+  return value;
+}
+
+/**
+ * Size in MB after which the streamed timeline trace continues in a
+ * new file.  Zero writes one file.
+ */
+inline unsigned int
+get_timeline_trace_file_size()
+{
+  static unsigned int value = detail::get_uint_value("Debug.timeline_trace_file_size",0);
+  return value;
+}
+
+/**
+ * Compression of the streamed timeline trace, "off" or "gzip".
+ */
+inline std::string
+get_timeline_trace_compress()
+{
+  static std::string value = detail::get_string_value("Debug.timeline_trace_compress","off");
+  return value;
+}
+
 inline std::string
 get_trace_buffer_size()
 {
@@ -163,6 +253,29 @@ get_profile_api()
   return value;
 }
 
+/**
+ * Interval in seconds at which profile summaries of the run so far
+ * are written while the application runs.  Zero writes the summary
+ * at the end only.
+ */
+inline unsigned int
+get_profile_summary_interval()
+{
+  static unsigned int value = (!get_profile()) ? 0 : detail::get_uint_value("Debug.profile_summary_interval",0);
+  return value;
+}
+
+/**
+ * Number of periodic profile summaries kept on disk, older ones
+ * are removed.
+ */
+inline unsigned int
+get_profile_summary_files()
+{
+  static unsigned int value = detail::get_uint_value("Debug.profile_summary_files",10);
+  return value;
+}
+
 inline bool
 get_api_checks()
 {
@@ -177,24 +290,90 @@ get_logging()
   return value;
 }
 
+/**
+ * Reloadable
+ */
 inline unsigned int
 get_verbosity()
 {
-  static unsigned int value = detail::get_uint_value("Runtime.verbosity",4);
+  static detail::reloadable<unsigned int> value;
+  return value.get([] { return detail::get_uint_value("Runtime.verbosity",4); });
+}
+
+/**
+ * Max number of records queued by the asynchronous logger
+ * (runtime_log=async:console or runtime_log=async:<file>) before
+ * further records are dropped and counted.
+ */
+inline unsigned int
+get_log_queue_size()
+{
+  static unsigned int value = detail::get_uint_value("Runtime.runtime_log_queue_size",8192);
   return value;
 }
 
+/**
+ * Max time in milliseconds the asynchronous logger holds written
+ * records before flushing them.
+ */
 inline unsigned int
-get_dma_threads()
+get_log_flush_interval()
+{
+  static unsigned int value = detail::get_uint_value("Runtime.runtime_log_flush_ms",100);
+  return value;
+}
+
+/**
+ * Max number of threads used to open devices and to load a program
+ * on multiple devices concurrently.  One loads devices serially.
+ */
+inline unsigned int
+get_device_load_threads()
+{
+  static unsigned int value = detail::get_uint_value("Runtime.device_load_threads",8);
+  return value;
+}
+
+/**
+ * Chunk size in KB of buffer copies through host memory.  Larger
+ * copies are pipelined in chunks over the DMA worker threads.  Zero
+ * copies the full size at once.
+ */
+inline size_t
+get_host_copy_chunk_size()
 {
-  static unsigned int value = detail::get_uint_value("Runtime.dma_channels",0);
+  static size_t value = static_cast<size_t>(detail::get_uint_value("Runtime.host_copy_chunk_kb",4096)) * 1024;
   return value;
 }
 
+/**
+ * Reloadable, a device grows its DMA workers to a larger count on
+ * next use but keeps them when the count is lowered.
+ */
+inline unsigned int
+get_dma_threads()
+{
+  static detail::reloadable<unsigned int> value;
+  return value.get([] { return detail::get_uint_value("Runtime.dma_channels",0); });
+}
+
+/**
+ * Reloadable
+ */
 inline unsigned int
 get_polling_throttle()
 {
-  static unsigned int value = detail::get_uint_value("Runtime.polling_throttle",0);
+  static detail::reloadable<unsigned int> value;
+  return value.get([] { return detail::get_uint_value("Runtime.polling_throttle",0); });
+}
+
+/**
+ * When to reload the ini file, see reload()
+ */
+inline std::string
+get_ini_reload()
+{
+  static std::string value = detail::get_string_value("Runtime.ini_reload","off");
   return value;
 }
 
@@ -240,13 +419,13 @@ get_ert()
   return value;
 }
 /**
- * Poll for command completion
+ * Poll for command completion.  Reloadable
  */
 inline bool
 get_ert_polling()
 {
-  static bool value = detail::get_bool_value("Runtime.ert_polling",false);
-  return value;
+  static detail::reloadable<bool> value;
+  return value.get([] { return detail::get_bool_value("Runtime.ert_polling",false); });
 }
 
 
@@ -334,6 +513,76 @@ get_cmdbo_cache()
   return value;
 }
 
+/**
+ * Enable sub-allocation of small buffer objects from per memory bank
+ * slabs.  Buffers smaller than or equal to bo_pool_max_size are carved
+ * out of slabs of bo_pool_slab_size bytes.  Note that a pooled buffer
+ * shares its underlying buffer object with other pooled buffers, so
+ * exporting a pooled buffer (xclGetMemObjectFd) exports the entire slab.
+ */
+inline bool
+get_bo_pool()
+{
+  static bool value = detail::get_bool_value("Runtime.bo_pool",false);
+  return value;
+}
+
+inline unsigned int
+get_bo_pool_slab_size()
+{
+  static unsigned int value = detail::get_uint_value("Runtime.bo_pool_slab_size",0x400000);
+  return value;
+}
+
+inline unsigned int
+get_bo_pool_max_size()
+{
+  static unsigned int value = detail::get_uint_value("Runtime.bo_pool_max_size",0x10000);
+  return value;
+}
+
+/**
+ * Size of per device pool of mapped exec buffers used by xrt::command,
+ * and number of exec buffers preallocated when an xclbin is loaded.
+ */
+inline unsigned int
+get_exec_bo_pool_size()
+{
+  static unsigned int value = detail::get_uint_value("Runtime.exec_bo_pool_size",128);
+  return value;
+}
+
+inline unsigned int
+get_exec_bo_pool_prealloc()
+{
+  static unsigned int value = detail::get_uint_value("Runtime.exec_bo_pool_prealloc",16);
+  return value;
+}
+
+/**
+ * Max time in microseconds to busy poll for command completion before
+ * blocking in exec_wait.  The actual poll window adapts to recently
+ * observed command durations, see core/common/adaptive_poll.h.  Zero
+ * disables polling.
+ */
+inline unsigned int
+get_poll_window()
+{
+  static unsigned int value = detail::get_uint_value("Runtime.poll_window_us",50);
+  return value;
+}
+
+/**
+ * Cache compact xclbin meta data per xclbin uuid so that repeated
+ * program creation with the same xclbin skips xml parsing.
+ */
+inline bool
+get_xclbin_metadata_cache()
+{
+  static bool value = detail::get_bool_value("Runtime.xclbin_metadata_cache",true);
+  return value;
+}
+
 inline std::string
 get_hw_em_driver()
 {
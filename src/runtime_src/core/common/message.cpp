@@ -18,14 +18,21 @@
 #include "t_time.h"
 #include "version.h"
 #include "config_reader.h"
+#include "async_log.h"
 
 #include <unistd.h>
 #include <syslog.h>
 #include <map>
 #include <fstream>
 #include <iostream>
+#include <sstream>
+#include <memory>
+#include <mutex>
 #include <thread>
 #include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
 #include <sys/types.h>
 #ifdef __GNUC__
 # include <linux/limits.h>
@@ -46,6 +53,54 @@ get_exe_path()
 #endif
 }
 
+// Timestamp in the format of xrt_core::timestamp(), formatted at most
+// once per second per thread and without the non reentrant ctime
+static const std::string&
+cached_timestamp()
+{
+  thread_local std::time_t last = 0;
+  thread_local std::string stamp;
+  auto t = std::time(nullptr);
+  if (t != last) {
+    struct tm tm;
+    char buf[64];
+    localtime_r(&t, &tm);
+    std::strftime(buf, sizeof(buf), "[%a %b %e %H:%M:%S %Y]", &tm);
+    stamp = buf;
+    last = t;
+  }
+  return stamp;
+}
+
+static const std::string&
+thread_id()
+{
+  thread_local std::string id;
+  if (id.empty()) {
+    std::ostringstream ostr;
+    ostr << std::this_thread::get_id();
+    id = ostr.str();
+  }
+  return id;
+}
+
+static void
+print_header(std::ostream& ostr)
+{
+  ostr << "XRT build version: " << xrt_build_version << std::endl;
+  ostr << "Build hash: " << xrt_build_version_hash << std::endl;
+  ostr << "Build date: " << xrt_build_version_date << std::endl;
+  ostr << "Git branch: " << xrt_build_version_branch<< std::endl;
+  ostr << xrt_core::timestamp() << std::endl;
+  ostr << "PID: " << getpid() << std::endl;
+  ostr << "UID: " << getuid() << std::endl;
+  //hostname
+  char hostname[HOST_NAME_MAX];
+  gethostname(hostname, HOST_NAME_MAX);
+  ostr << "HOST: " <<  hostname << std::endl;
+  ostr << "EXE: " <<get_exe_path() << std::endl;
+}
+
 using severity_level = xrt_core::message::severity_level;
 
 //--
@@ -118,6 +173,34 @@ public:
   virtual void send(severity_level l, const char* tag, const char* msg) override;
 private:
   std::ofstream handle;
+  std::mutex mutex;
+  std::map<severity_level, const char*> severityMap = {
+    { severity_level::XRT_EMERGENCY, "EMERGENCY: "},
+    { severity_level::XRT_ALERT,     "ALERT: "},
+    { severity_level::XRT_CRITICAL,  "CRITICAL: "},
+    { severity_level::XRT_ERROR,     "ERROR: "},
+    { severity_level::XRT_WARNING,   "WARNING: "},
+    { severity_level::XRT_NOTICE,    "NOTICE: "},
+    { severity_level::XRT_INFO,      "INFO: "},
+    { severity_level::XRT_DEBUG,     "DEBUG: "}
+  };
+};
+
+//--
+// Console or file logging through xrt_core::async_log, the caller only
+// formats the record and queues it
+class async_dispatch : public message_dispatch
+{
+public:
+  explicit
+  async_dispatch(const std::string& sink);
+  virtual ~async_dispatch();
+  virtual void send(severity_level l, const char* tag, const char* msg) override;
+  void stop();
+private:
+  bool console;
+  std::ofstream handle;
+  std::unique_ptr<xrt_core::async_log> logger;
   std::map<severity_level, const char*> severityMap = {
     { severity_level::XRT_EMERGENCY, "EMERGENCY: "},
     { severity_level::XRT_ALERT,     "ALERT: "},
@@ -130,6 +213,24 @@ private:
   };
 };
 
+// The dispatcher lives until exit, queued records are drained then
+static async_dispatch* async_dispatcher = nullptr;
+
+static void
+stop_async_dispatch()
+{
+  if (async_dispatcher)
+    async_dispatcher->stop();
+}
+
+static std::string
+unquote(const std::string& choice)
+{
+  if (choice.size() >= 2 && choice.front() == '"' && choice.back() == '"')
+    return choice.substr(1, choice.size()-2);
+  return choice;
+}
+
 //-------
 message_dispatch*
 message_dispatch::
@@ -141,6 +242,14 @@ make_dispatcher(const std::string& choice)
     return new console_dispatch;
   else if(choice == "syslog")
     return new syslog_dispatch;
+  else if(unquote(choice).compare(0, 6, "async:") == 0) {
+    auto sink = unquote(unquote(choice).substr(6));
+    if (sink == "null" || sink == "syslog")
+      return make_dispatcher(sink);
+    async_dispatcher = new async_dispatch(sink);
+    std::atexit(stop_async_dispatch);
+    return async_dispatcher;
+  }
   else {
     if(choice.front() == '"'){
       std::string file = choice;
@@ -178,18 +287,7 @@ file_dispatch::
 file_dispatch(const std::string &file)
 {
   handle.open(file.c_str());
-  handle << "XRT build version: " << xrt_build_version << std::endl;
-  handle << "Build hash: " << xrt_build_version_hash << std::endl;
-  handle << "Build date: " << xrt_build_version_date << std::endl;
-  handle << "Git branch: " << xrt_build_version_branch<< std::endl;
-  handle << xrt_core::timestamp() << std::endl;
-  handle << "PID: " << getpid() << std::endl;
-  handle << "UID: " << getuid() << std::endl;
-  //hostname
-  char hostname[HOST_NAME_MAX];
-  gethostname(hostname, HOST_NAME_MAX);
-  handle << "HOST: " <<  hostname << std::endl;
-  handle << "EXE: " <<get_exe_path() << std::endl;
+  print_header(handle);
 }
 
 file_dispatch::~file_dispatch() {
@@ -200,6 +298,7 @@ void
 file_dispatch::
 send(severity_level l, const char* tag, const char* msg)
 {
+  std::lock_guard<std::mutex> lk(mutex);
   handle << xrt_core::timestamp() <<" [" << tag << "] Tid: "
          << std::this_thread::get_id() << ", " << " " << severityMap[l]
          << msg << std::endl;
@@ -209,18 +308,7 @@ send(severity_level l, const char* tag, const char* msg)
 console_dispatch::
 console_dispatch()
 {
-  std::cout << "XRT build version: " << xrt_build_version << std::endl;
-  std::cout << "Build hash: " << xrt_build_version_hash << std::endl;
-  std::cout << "Build date: " << xrt_build_version_date << std::endl;
-  std::cout << "Git branch: " << xrt_build_version_branch<< std::endl;
-  std::cout << "PID: " << getpid() << std::endl;
-  std::cout << "UID: " << getuid() << std::endl;
-  std::cout << xrt_core::timestamp() << std::endl;
-  //hostname
-  char hostname[HOST_NAME_MAX];
-  gethostname(hostname, HOST_NAME_MAX);
-  std::cout << "HOST: " <<  hostname << std::endl;
-  std::cout << "EXE: " <<get_exe_path() << std::endl;
+  print_header(std::cout);
 }
 
 void
@@ -231,6 +319,51 @@ send(severity_level l, const char* tag, const char* msg)
             << msg << std::endl;
 }
 
+//async ops
+async_dispatch::
+async_dispatch(const std::string& sink)
+  : console(sink.empty() || sink == "console")
+{
+  std::ostream* out = &std::cout;
+  if (!console) {
+    handle.open(sink.c_str());
+    out = &handle;
+  }
+  print_header(*out);
+  logger.reset(new xrt_core::async_log(*out, xrt_core::config::get_log_queue_size(),
+                                       xrt_core::config::get_log_flush_interval()));
+}
+
+async_dispatch::
+~async_dispatch()
+{
+  logger.reset();
+}
+
+void
+async_dispatch::
+stop()
+{
+  logger->stop();
+}
+
+void
+async_dispatch::
+send(severity_level l, const char* tag, const char* msg)
+{
+  std::string record;
+  record.reserve(128 + std::strlen(msg));
+  if (console) {
+    record.append("[").append(tag).append("] ");
+  }
+  else {
+    record.append(cached_timestamp()).append(" [").append(tag).append("] Tid: ")
+          .append(thread_id()).append(",  ");
+  }
+  record.append(severityMap[l]).append(msg).append("\n");
+  logger->write(std::move(record), l <= severity_level::XRT_ERROR);
+}
+
 } //end unnamed namespace
 
 namespace xrt_core { namespace message {
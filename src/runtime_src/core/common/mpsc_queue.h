@@ -0,0 +1,162 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef core_common_mpsc_queue_h_
+#define core_common_mpsc_queue_h_
+
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <cstddef>
+
+namespace xrt_core {
+
+/**
+ * Bounded lock-free multiple producer single consumer queue.
+ *
+ * Each cell carries a sequence number that tells producers and the
+ * consumer whether the cell is free for the current lap of the
+ * position counters.  Producers claim a cell by advancing the shared
+ * enqueue position with compare-and-swap and then publish the cell by
+ * storing its sequence number with release semantics, so a producer
+ * never waits on another producer beyond retrying its claim.  The
+ * consumer owns the dequeue position.
+ *
+ * push fails instead of blocking when the queue is full, leaving it to
+ * the caller to drop or retry.
+ *
+ * @ValueType: queued value, must be default constructible and movable
+ */
+template <typename ValueType>
+class mpsc_queue
+{
+  static constexpr size_t cache_line = 64;
+
+  static size_t
+  round_pow2(size_t value)
+  {
+    size_t pow2 = 1;
+    while (pow2 < value)
+      pow2 <<= 1;
+    return pow2;
+  }
+
+  struct cell_type
+  {
+    std::atomic<size_t> sequence;
+    ValueType value;
+  };
+
+  const size_t m_capacity;   // power of two
+  const size_t m_mask;
+  std::unique_ptr<cell_type[]> m_cells;
+
+  char m_pad0[cache_line];
+  std::atomic<size_t> m_enqueue {0};
+  char m_pad1[cache_line];
+  size_t m_dequeue = 0;
+  char m_pad2[cache_line];
+
+public:
+  /**
+   * @min_capacity: minimum number of values the queue can hold, the
+   *   capacity is rounded up to a power of two
+   */
+  explicit
+  mpsc_queue(size_t min_capacity)
+    : m_capacity(round_pow2(std::max<size_t>(min_capacity,2)))
+    , m_mask(m_capacity-1)
+    , m_cells(new cell_type[m_capacity])
+  {
+    for (size_t i=0; i<m_capacity; ++i)
+      m_cells[i].sequence.store(i,std::memory_order_relaxed);
+  }
+
+  mpsc_queue(const mpsc_queue&) = delete;
+  mpsc_queue& operator=(const mpsc_queue&) = delete;
+
+  size_t
+  capacity() const
+  {
+    return m_capacity;
+  }
+
+  /**
+   * Enqueue a value, safe to call from any number of threads
+   *
+   * @return
+   *   true if queued, false if the queue is full in which case
+   *   @value is left untouched
+   */
+  bool
+  push(ValueType&& value)
+  {
+    auto pos = m_enqueue.load(std::memory_order_relaxed);
+    for (;;) {
+      auto& cell = m_cells[pos & m_mask];
+      auto seq = cell.sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+      if (diff == 0) {
+        if (m_enqueue.compare_exchange_weak(pos,pos+1,std::memory_order_relaxed)) {
+          cell.value = std::move(value);
+          cell.sequence.store(pos+1,std::memory_order_release);
+          return true;
+        }
+      }
+      else if (diff < 0) {
+        return false;   // full, consumer has not freed this cell yet
+      }
+      else {
+        pos = m_enqueue.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /**
+   * Dequeue a value, must be called from one thread only
+   *
+   * @return
+   *   true if a value was moved into @value, false if the queue is
+   *   empty or the next value is still being published
+   */
+  bool
+  pop(ValueType& value)
+  {
+    auto& cell = m_cells[m_dequeue & m_mask];
+    auto seq = cell.sequence.load(std::memory_order_acquire);
+    if (seq != m_dequeue+1)
+      return false;
+    value = std::move(cell.value);
+    cell.sequence.store(m_dequeue+m_capacity,std::memory_order_release);
+    ++m_dequeue;
+    return true;
+  }
+
+  /**
+   * Must be called from the consumer thread.  A value that is claimed
+   * but not yet published makes the queue non-empty even though pop
+   * fails.
+   */
+  bool
+  empty() const
+  {
+    return m_enqueue.load(std::memory_order_acquire) == m_dequeue;
+  }
+};
+
+} // xrt_core
+
+#endif
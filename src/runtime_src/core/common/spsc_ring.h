@@ -0,0 +1,351 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef core_common_spsc_ring_h_
+#define core_common_spsc_ring_h_
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <memory>
+#include <algorithm>
+#include <cstring>
+#include <cstddef>
+
+namespace xrt_core {
+
+/**
+ * Lock-free single producer single consumer ring of fixed size packets.
+ *
+ * The ring holds exactly the number of packets it is created with.
+ * The producer owns the head index and the consumer owns the tail
+ * index.  Indices are free running packet counts that are masked into
+ * a buffer of the next power-of-two number of packets, they are
+ * observed with acquire semantics and published with sequentially
+ * consistent stores, which also order them with respect to the waiter
+ * flags below.  Producer and consumer state live on separate cache
+ * lines, and each side caches the last observed index of the other
+ * side so that the shared index is read only when the cached value
+ * does not allow the requested transfer.
+ *
+ * Bulk read and write transfer many packets with at most two copies.
+ *
+ * Blocking read and write spin for a bounded number of iterations and
+ * then wait on a condition variable.  The opposite side signals only
+ * when a waiter has announced itself, so the fast path never locks.
+ *
+ * Exactly one thread may write and exactly one thread may read at any
+ * given time.  Callers with multiple producers or consumers must
+ * serialize each side.
+ */
+class spsc_ring
+{
+  static constexpr size_t cache_line = 64;
+
+  static size_t
+  round_pow2(size_t value)
+  {
+    size_t pow2 = 1;
+    while (pow2 < value)
+      pow2 <<= 1;
+    return pow2;
+  }
+
+  const size_t m_packet_size;
+  const size_t m_capacity;   // number of packets the ring holds
+  const size_t m_slots;      // number of packets in buffer, power of two
+  const size_t m_mask;
+  const unsigned int m_spin;
+  std::unique_ptr<char[]> m_buffer;
+
+  char m_pad0[cache_line];
+
+  // producer
+  std::atomic<size_t> m_head {0};
+  size_t m_tail_cache = 0;
+  char m_pad1[cache_line];
+
+  // consumer
+  std::atomic<size_t> m_tail {0};
+  size_t m_head_cache = 0;
+  char m_pad2[cache_line];
+
+  // waiters, touched only on the slow path
+  std::atomic<bool> m_reader_waiting {false};
+  std::atomic<bool> m_writer_waiting {false};
+  std::mutex m_mutex;
+  std::condition_variable m_cond;
+
+  char*
+  slot_ptr(size_t idx) const
+  {
+    return m_buffer.get() + (idx & m_mask)*m_packet_size;
+  }
+
+  // Copy count packets between ring starting at idx and dst or src,
+  // wrapping at end of buffer
+  void
+  copy_in(size_t idx, const char* src, size_t count)
+  {
+    auto first = std::min(count,m_slots - (idx & m_mask));
+    std::memcpy(slot_ptr(idx),src,first*m_packet_size);
+    if (count > first)
+      std::memcpy(m_buffer.get(),src+first*m_packet_size,(count-first)*m_packet_size);
+  }
+
+  void
+  copy_out(size_t idx, char* dst, size_t count) const
+  {
+    auto first = std::min(count,m_slots - (idx & m_mask));
+    std::memcpy(dst,slot_ptr(idx),first*m_packet_size);
+    if (count > first)
+      std::memcpy(dst+first*m_packet_size,m_buffer.get(),(count-first)*m_packet_size);
+  }
+
+  void
+  signal(std::atomic<bool>& waiting)
+  {
+    if (!waiting.load())
+      return;
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_cond.notify_all();
+  }
+
+  // Spin and then wait until ready() is true.  The waiting flag is
+  // raised before ready() is re-checked, which pairs with the
+  // opposite side publishing its index before checking the flag.
+  template <typename Ready>
+  void
+  wait(std::atomic<bool>& waiting, Ready&& ready)
+  {
+    for (unsigned int i=0; i<m_spin; ++i)
+      if (ready())
+        return;
+
+    std::unique_lock<std::mutex> lk(m_mutex);
+    waiting.store(true);
+    while (!ready())
+      m_cond.wait_for(lk,std::chrono::milliseconds(1));
+    waiting.store(false);
+  }
+
+  // Packets that can be written, refreshing the cached tail only if
+  // the cached value has less space than wanted
+  size_t
+  writable(size_t head, size_t want)
+  {
+    auto space = m_capacity - (head - m_tail_cache);
+    if (space < want) {
+      m_tail_cache = m_tail.load(std::memory_order_acquire);
+      space = m_capacity - (head - m_tail_cache);
+    }
+    return space;
+  }
+
+  size_t
+  readable(size_t tail, size_t want)
+  {
+    auto avail = m_head_cache - tail;
+    if (avail < want) {
+      m_head_cache = m_head.load(std::memory_order_acquire);
+      avail = m_head_cache - tail;
+    }
+    return avail;
+  }
+
+public:
+  /**
+   * @packet_size: size in bytes of each packet
+   * @packets: number of packets the ring can hold
+   * @spin: number of polls before a blocking call waits
+   */
+  spsc_ring(size_t packet_size, size_t packets, unsigned int spin = 4096)
+    : m_packet_size(packet_size)
+    , m_capacity(std::max<size_t>(packets,1))
+    , m_slots(round_pow2(m_capacity))
+    , m_mask(m_slots-1)
+    , m_spin(spin)
+    , m_buffer(new char[m_slots*packet_size])
+  {}
+
+  spsc_ring(const spsc_ring&) = delete;
+  spsc_ring& operator=(const spsc_ring&) = delete;
+
+  size_t
+  packet_size() const
+  {
+    return m_packet_size;
+  }
+
+  size_t
+  capacity() const
+  {
+    return m_capacity;
+  }
+
+  /**
+   * Approximate number of packets in the ring
+   */
+  size_t
+  size() const
+  {
+    return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+  }
+
+  /**
+   * Write up to @count packets from @src without blocking (producer)
+   *
+   * Return: number of packets written
+   */
+  size_t
+  try_write(const void* src, size_t count)
+  {
+    auto head = m_head.load(std::memory_order_relaxed);
+    auto n = std::min(count,writable(head,count));
+    if (!n)
+      return 0;
+    copy_in(head,static_cast<const char*>(src),n);
+    m_head.store(head+n,std::memory_order_seq_cst);
+    signal(m_reader_waiting);
+    return n;
+  }
+
+  /**
+   * Read up to @count packets into @dst without blocking (consumer)
+   *
+   * Return: number of packets read
+   */
+  size_t
+  try_read(void* dst, size_t count)
+  {
+    auto tail = m_tail.load(std::memory_order_relaxed);
+    auto n = std::min(count,readable(tail,count));
+    if (!n)
+      return 0;
+    copy_out(tail,static_cast<char*>(dst),n);
+    m_tail.store(tail+n,std::memory_order_seq_cst);
+    signal(m_writer_waiting);
+    return n;
+  }
+
+  /**
+   * Copy the next packet into @dst without consuming it (consumer)
+   *
+   * Return: true if a packet was available
+   */
+  bool
+  try_peek(void* dst)
+  {
+    auto tail = m_tail.load(std::memory_order_relaxed);
+    if (!readable(tail,1))
+      return false;
+    copy_out(tail,static_cast<char*>(dst),1);
+    return true;
+  }
+
+  /**
+   * Write @count packets from @src, block while ring is full
+   */
+  void
+  write(const void* src, size_t count)
+  {
+    auto data = static_cast<const char*>(src);
+    while (count) {
+      auto n = try_write(data,count);
+      if (!n) {
+        wait(m_writer_waiting,[this] {
+            return m_tail.load() != m_head.load(std::memory_order_relaxed) - m_capacity;
+          });
+        continue;
+      }
+      data += n*m_packet_size;
+      count -= n;
+    }
+  }
+
+  /**
+   * Read @count packets into @dst, block while ring is empty
+   */
+  void
+  read(void* dst, size_t count)
+  {
+    auto data = static_cast<char*>(dst);
+    while (count) {
+      auto n = try_read(data,count);
+      if (!n) {
+        wait(m_reader_waiting,[this] {
+            return m_head.load() != m_tail.load(std::memory_order_relaxed);
+          });
+        continue;
+      }
+      data += n*m_packet_size;
+      count -= n;
+    }
+  }
+
+  /**
+   * Low level access for callers that reserve ranges of packets and
+   * commit them later.  Indices are free running packet counts.
+   */
+  size_t
+  write_index() const
+  {
+    return m_head.load(std::memory_order_relaxed);
+  }
+
+  size_t
+  read_index() const
+  {
+    return m_tail.load(std::memory_order_relaxed);
+  }
+
+  size_t
+  readable_index() const
+  {
+    return m_head.load(std::memory_order_acquire);
+  }
+
+  size_t
+  writable_index() const
+  {
+    return m_tail.load(std::memory_order_acquire) + m_capacity;
+  }
+
+  void*
+  slot(size_t idx)
+  {
+    return slot_ptr(idx);
+  }
+
+  void
+  commit_write(size_t idx)
+  {
+    m_head.store(idx,std::memory_order_seq_cst);
+    signal(m_reader_waiting);
+  }
+
+  void
+  commit_read(size_t idx)
+  {
+    m_tail.store(idx,std::memory_order_seq_cst);
+    signal(m_writer_waiting);
+  }
+};
+
+} // xrt_core
+
+#endif
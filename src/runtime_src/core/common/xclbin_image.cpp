@@ -0,0 +1,251 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "xclbin_image.h"
+
+#include <map>
+#include <mutex>
+#include <array>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <cerrno>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#ifdef __GNUC__
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
+namespace {
+
+// Validate that data is an xclbin2 of at least header specified length
+static void
+validate(const char* data, size_t size)
+{
+  if (size < sizeof(axlf) || std::strncmp(data,"xclbin2",7))
+    throw std::runtime_error("not an xclbin2 image");
+  auto top = reinterpret_cast<const axlf*>(data);
+  if (size < top->m_header.m_length)
+    throw std::runtime_error("xclbin image length mismatch");
+}
+
+}
+
+namespace xrt_core {
+
+namespace {
+
+// Images are registered by uuid, with length and timestamp guarding
+// against stale or hand edited images reusing a uuid
+struct image_key
+{
+  std::array<unsigned char,sizeof(xuid_t)> uuid;
+  uint64_t length;
+  uint64_t timestamp;
+
+  explicit
+  image_key(const axlf* top)
+    : length(top->m_header.m_length), timestamp(top->m_header.m_timeStamp)
+  {
+    std::memcpy(uuid.data(),&top->m_header.uuid,uuid.size());
+  }
+
+  bool
+  null() const
+  {
+    return std::all_of(uuid.begin(),uuid.end(),[](unsigned char c) { return c==0; });
+  }
+
+  bool
+  operator<(const image_key& rhs) const
+  {
+    if (uuid != rhs.uuid)
+      return uuid < rhs.uuid;
+    if (length != rhs.length)
+      return length < rhs.length;
+    return timestamp < rhs.timestamp;
+  }
+};
+
+using registry_type = std::map<image_key,std::weak_ptr<const xclbin_image>>;
+
+static std::mutex s_mutex;
+
+// Constructed on first use and intentionally leaked so images
+// released during static destruction can still unregister
+static registry_type&
+get_registry()
+{
+  static auto registry = new registry_type;
+  return *registry;
+}
+
+} // namespace
+
+std::shared_ptr<const xclbin_image>
+xclbin_image::
+lookup(const char* data, size_t size)
+{
+  validate(data,size);
+  image_key k(reinterpret_cast<const axlf*>(data));
+  if (k.null())
+    return nullptr;
+
+  std::lock_guard<std::mutex> lk(s_mutex);
+  auto& registry = get_registry();
+  auto itr = registry.find(k);
+  return itr != registry.end() ? itr->second.lock() : nullptr;
+}
+
+std::shared_ptr<const xclbin_image>
+xclbin_image::
+share(std::unique_ptr<xclbin_image>&& image)
+{
+  image_key k(image->get_axlf());
+  if (k.null())
+    return std::shared_ptr<const xclbin_image>(image.release());
+
+  // Unregister on release, unless the registry entry has already
+  // been replaced by another image with the same key
+  auto deleter = [k](const xclbin_image* img) {
+    {
+      std::lock_guard<std::mutex> lk(s_mutex);
+      auto& registry = get_registry();
+      auto itr = registry.find(k);
+      if (itr != registry.end() && itr->second.expired())
+        registry.erase(itr);
+    }
+    delete img;
+  };
+
+  std::lock_guard<std::mutex> lk(s_mutex);
+  auto& registry = get_registry();
+  auto& entry = registry[k];
+  if (auto existing = entry.lock())
+    return existing;  // lost race, image is destroyed on return
+
+  std::shared_ptr<const xclbin_image> shared(image.release(),deleter);
+  entry = shared;
+  return shared;
+}
+
+std::shared_ptr<const xclbin_image>
+xclbin_image::
+open(const std::string& path)
+{
+#ifdef __GNUC__
+  auto fd = ::open(path.c_str(),O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("cannot open xclbin '" + path + "': " + std::strerror(errno));
+
+  struct stat st;
+  if (::fstat(fd,&st) || st.st_size < static_cast<off_t>(sizeof(axlf))) {
+    ::close(fd);
+    throw std::runtime_error("bad xclbin file '" + path + "'");
+  }
+
+  auto addr = ::mmap(nullptr,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+  ::close(fd);
+  if (addr == MAP_FAILED)
+    throw std::runtime_error("cannot map xclbin '" + path + "': " + std::strerror(errno));
+
+  std::unique_ptr<xclbin_image> image(new xclbin_image);
+  image->m_data = static_cast<const char*>(addr);
+  image->m_size = st.st_size;
+  image->m_mapped = true;
+
+  validate(image->m_data,image->m_size);
+
+  // Prefer an already registered image, dropping this mapping
+  if (auto existing = lookup(image->m_data,image->m_size))
+    return existing;
+
+  return share(std::move(image));
+#else
+  // No mmap, read the file into a private buffer
+  std::ifstream istr(path,std::ios::binary);
+  if (!istr)
+    throw std::runtime_error("cannot open xclbin '" + path + "'");
+  std::vector<char> data((std::istreambuf_iterator<char>(istr)),std::istreambuf_iterator<char>());
+  validate(data.data(),data.size());
+  return create(std::move(data));
+#endif
+}
+
+std::shared_ptr<const xclbin_image>
+xclbin_image::
+create(const char* data, size_t size)
+{
+  if (auto existing = lookup(data,size))
+    return existing;
+
+  return create(std::vector<char>(data,data+size));
+}
+
+std::shared_ptr<const xclbin_image>
+xclbin_image::
+create(std::vector<char>&& data)
+{
+  if (auto existing = lookup(data.data(),data.size()))
+    return existing;
+
+  std::unique_ptr<xclbin_image> image(new xclbin_image);
+  image->m_buffer = std::move(data);
+  image->m_data = image->m_buffer.data();
+  image->m_size = image->m_buffer.size();
+  return share(std::move(image));
+}
+
+xclbin_image::
+~xclbin_image()
+{
+#ifdef __GNUC__
+  if (m_mapped)
+    ::munmap(const_cast<char*>(m_data),m_size);
+#endif
+}
+
+xclbin_image::data_range
+xclbin_image::
+section(axlf_section_kind kind) const
+{
+  if (auto header = ::xclbin::get_axlf_section(get_axlf(),kind)) {
+    // offset and size come from the file, compare without overflow
+    auto offset = header->m_sectionOffset;
+    auto size = header->m_sectionSize;
+    if (offset > m_size || size > m_size - offset)
+      throw std::runtime_error("xclbin section " + std::to_string(kind)
+                               + " exceeds image size");
+    auto begin = m_data + offset;
+    return std::make_pair(begin,begin+size);
+  }
+  return std::make_pair(nullptr,nullptr);
+}
+
+size_t
+xclbin_image::
+registered()
+{
+  std::lock_guard<std::mutex> lk(s_mutex);
+  return get_registry().size();
+}
+
+} // xrt_core
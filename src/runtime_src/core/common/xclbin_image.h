@@ -0,0 +1,132 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef core_common_xclbin_image_h_
+#define core_common_xclbin_image_h_
+
+#include "xclbin.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <utility>
+
+namespace xrt_core {
+
+/**
+ * Shared, immutable xclbin image.
+ *
+ * An xclbin image is the raw bytes of an xclbin, either memory mapped
+ * from a file or held in one heap buffer.  Images are reference
+ * counted and registered by xclbin UUID while alive, so all devices,
+ * programs, and sessions that use the same xclbin share one copy.
+ * Section lookups return views into the image, no section data is
+ * copied.
+ *
+ * Images of legacy xclbins without a UUID are not shared.
+ */
+class xclbin_image
+{
+public:
+  using data_range = std::pair<const char*, const char*>;
+
+  /**
+   * Memory map an xclbin file
+   *
+   * Throws if file cannot be mapped or is not an xclbin.
+   */
+  static std::shared_ptr<const xclbin_image>
+  open(const std::string& path);
+
+  /**
+   * Share the image of an xclbin in memory
+   *
+   * The data is copied only if no image with same UUID is registered,
+   * caller retains ownership of @data.
+   */
+  static std::shared_ptr<const xclbin_image>
+  create(const char* data, size_t size);
+
+  /**
+   * Share the image of an xclbin in memory, taking ownership of @data
+   */
+  static std::shared_ptr<const xclbin_image>
+  create(std::vector<char>&& data);
+
+  ~xclbin_image();
+
+  xclbin_image(const xclbin_image&) = delete;
+  xclbin_image& operator=(const xclbin_image&) = delete;
+
+  const char*
+  data() const
+  {
+    return m_data;
+  }
+
+  size_t
+  size() const
+  {
+    return m_size;
+  }
+
+  const axlf*
+  get_axlf() const
+  {
+    return reinterpret_cast<const axlf*>(m_data);
+  }
+
+  /**
+   * @return true if image is memory mapped from a file
+   */
+  bool
+  is_mapped() const
+  {
+    return m_mapped;
+  }
+
+  /**
+   * View of section data, or {nullptr,nullptr} if section is absent
+   *
+   * Throws if the section extends past the end of the image.
+   */
+  data_range
+  section(axlf_section_kind kind) const;
+
+  /**
+   * Number of images currently registered
+   */
+  static size_t
+  registered();
+
+private:
+  const char* m_data = nullptr;
+  size_t m_size = 0;
+  bool m_mapped = false;
+  std::vector<char> m_buffer;   // backing store if not mapped
+
+  xclbin_image() {}
+
+  static std::shared_ptr<const xclbin_image>
+  share(std::unique_ptr<xclbin_image>&& image);
+
+  static std::shared_ptr<const xclbin_image>
+  lookup(const char* data, size_t size);
+};
+
+} // xrt_core
+
+#endif
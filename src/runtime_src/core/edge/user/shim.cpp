@@ -804,7 +804,7 @@ inline int ZYNQShim::xclLog(xrtLogMsgLevel level, const char* tag,
 int ZYNQShim::xclLogMsg(xrtLogMsgLevel level, const char* tag,
     const char* format, va_list args)
 {
-  static auto verbosity = xrt_core::config::get_verbosity();
+  auto verbosity = xrt_core::config::get_verbosity();
   if (level <= verbosity) {
     va_list args_bak;
     // vsnprintf will mutate va_list so back it up
@@ -1462,7 +1462,7 @@ int xclCuName2Index(xclDeviceHandle handle, const char *name, uint32_t *indexp)
 int xclLogMsg(xclDeviceHandle handle, xrtLogMsgLevel level, const char* tag,
               const char* format, ...)
 {
-    static auto verbosity = xrt_core::config::get_verbosity();
+    auto verbosity = xrt_core::config::get_verbosity();
     if (level <= verbosity) {
         va_list args;
         va_start(args, format);
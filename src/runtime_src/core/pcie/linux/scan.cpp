@@ -24,6 +24,7 @@
 #include <fstream>
 #include <dirent.h>
 #include <cstring>
+#include <cstdlib>
 #include <unistd.h>
 #include <algorithm>
 #include <mutex>
@@ -39,7 +40,57 @@
 
 #define RENDER_NM       "renderD"
 
-static const std::string sysfs_root = "/sys/bus/pci/devices/";
+// Roots of PCIE sysfs tree and device nodes, see pcidev::set_roots()
+struct roots {
+    std::mutex lock;
+    std::string sysfs;
+    std::string devfs;
+
+    roots()
+    {
+        const char *sysfs_env = std::getenv("XRT_SYSFS_ROOT");
+        const char *devfs_env = std::getenv("XRT_DEVFS_ROOT");
+        set(sysfs_env ? sysfs_env : "/sys/bus/pci/devices",
+            devfs_env ? devfs_env : "/dev");
+    }
+
+    void set(const std::string& sysfs_root, const std::string& devfs_root)
+    {
+        std::lock_guard<std::mutex> l(lock);
+        sysfs = sysfs_root;
+        if (sysfs.empty() || sysfs.back() != '/')
+            sysfs += '/';
+        devfs = devfs_root;
+        if (!devfs.empty() && devfs.back() == '/')
+            devfs.pop_back();
+    }
+};
+
+static roots& get_roots()
+{
+    static roots r;
+    return r;
+}
+
+std::string pcidev::get_sysfs_root()
+{
+    auto& r = get_roots();
+    std::lock_guard<std::mutex> l(r.lock);
+    return r.sysfs;
+}
+
+std::string pcidev::get_devfs_root()
+{
+    auto& r = get_roots();
+    std::lock_guard<std::mutex> l(r.lock);
+    return r.devfs;
+}
+
+void pcidev::set_roots(const std::string& sysfs_root,
+    const std::string& devfs_root)
+{
+    get_roots().set(sysfs_root, devfs_root);
+}
 
 static std::string get_name(const std::string& dir, const std::string& subdir)
 {
@@ -88,13 +139,58 @@ static int get_subdev_dir_name(const std::string& dir,
     return ret;
 }
 
+// Subdevice directories are looked up once and cached, a lookup scans
+// the whole PF directory and reads the name entry of each child
+int pcidev::pci_device::get_subdev_dir(const std::string& subdev,
+    std::string& subdir)
+{
+    subdir = "";
+    if (subdev.empty())
+        return 0;
+
+    {
+        std::lock_guard<std::mutex> l(subdev_lock);
+        auto it = subdev_dirs.find(subdev);
+        if (it != subdev_dirs.end()) {
+            subdir = it->second;
+            return 0;
+        }
+    }
+
+    int ret = get_subdev_dir_name(get_sysfs_root() + sysfs_name, subdev, subdir);
+    if (ret == 0) {
+        std::lock_guard<std::mutex> l(subdev_lock);
+        subdev_dirs[subdev] = subdir;
+    }
+    return ret;
+}
+
+// Drop cached subdevice directory if it is gone, e.g. the subdevice
+// was recreated with another instance by xclbin download
+bool pcidev::pci_device::forget_stale_subdev_dir(const std::string& subdev)
+{
+    std::lock_guard<std::mutex> l(subdev_lock);
+    auto it = subdev_dirs.find(subdev);
+    if (it == subdev_dirs.end())
+        return false;
+
+    struct stat buf;
+    if (stat((get_sysfs_root() + sysfs_name + "/" + it->second).c_str(), &buf) == 0)
+        return false;
+
+    subdev_dirs.erase(it);
+    return true;
+}
+
 std::string pcidev::pci_device::get_sysfs_path(const std::string& subdev,
     const std::string& entry)
 {
     std::string subdir;
-    if (get_subdev_dir_name(sysfs_root + sysfs_name, subdev, subdir) != 0)
+    if (get_subdev_dir(subdev, subdir) != 0)
         return "";
 
+    const std::string sysfs_root = get_sysfs_root();
+
     std::string path = sysfs_root;
     path += sysfs_name;
     path += "/";
@@ -135,10 +231,12 @@ std::fstream pcidev::pci_device::sysfs_open(const std::string& subdev,
     if (path.empty()) {
         std::stringstream ss;
         ss << "Failed to find subdirectory for " << subdev
-            << " under " << sysfs_root + sysfs_name << std::endl;
+            << " under " << get_sysfs_root() + sysfs_name << std::endl;
         err = ss.str();
     } else {
         fs = sysfs_open_path(path, err, write, binary);
+        if (!fs.is_open() && forget_stale_subdev_dir(subdev))
+            return sysfs_open(subdev, entry, err, write, binary);
     }
 
     return fs;
@@ -205,32 +303,25 @@ void pcidev::pci_device::sysfs_get(
         sv.push_back(line);
 }
 
-void pcidev::pci_device::sysfs_get(
-    const std::string& subdev, const std::string& entry,
-    std::string& err_msg, std::vector<uint64_t>& iv)
+// Convert lines read from sysfs entry at path to integers
+static void lines_to_uint64(const std::string& path,
+    const std::vector<std::string>& sv, std::string& err_msg,
+    std::vector<uint64_t>& iv)
 {
     uint64_t n;
-    std::vector<std::string> sv;
-
-    iv.clear();
-
-    sysfs_get(subdev, entry, err_msg, sv);
-    if (!err_msg.empty())
-        return;
-
     char *end;
     for (auto& s : sv) {
         std::stringstream ss;
 
         if (s.empty()) {
-            ss << "Reading " << get_sysfs_path(subdev, entry) << ", ";
+            ss << "Reading " << path << ", ";
             ss << "can't convert empty string to integer" << std::endl;
             err_msg = ss.str();
             break;
         }
         n = std::strtoull(s.c_str(), &end, 0);
         if (*end != '\0') {
-            ss << "Reading " << get_sysfs_path(subdev, entry) << ", ";
+            ss << "Reading " << path << ", ";
             ss << "failed to convert string to integer: " << s << std::endl;
             err_msg = ss.str();
             break;
@@ -239,6 +330,21 @@ void pcidev::pci_device::sysfs_get(
     }
 }
 
+void pcidev::pci_device::sysfs_get(
+    const std::string& subdev, const std::string& entry,
+    std::string& err_msg, std::vector<uint64_t>& iv)
+{
+    std::vector<std::string> sv;
+
+    iv.clear();
+
+    sysfs_get(subdev, entry, err_msg, sv);
+    if (!err_msg.empty())
+        return;
+
+    lines_to_uint64(get_sysfs_path(subdev, entry), sv, err_msg, iv);
+}
+
 void pcidev::pci_device::sysfs_get(
     const std::string& subdev, const std::string& entry,
     std::string& err_msg, std::string& s)
@@ -267,7 +373,8 @@ void pcidev::pci_device::sysfs_get(
 
 static std::string get_devfs_path(bool is_mgmt, uint32_t instance)
 {
-    std::string prefixStr = is_mgmt ? "/dev/xclmgmt" : "/dev/dri/" RENDER_NM;
+    std::string prefixStr = pcidev::get_devfs_root();
+    prefixStr += is_mgmt ? "/xclmgmt" : "/dri/" RENDER_NM;
     std::string instStr = std::to_string(instance);
 
     return prefixStr + instStr;
@@ -282,7 +389,7 @@ int pcidev::pci_device::open(const std::string& subdev, int flag)
     }
 
     // Open subdevice node
-    std::string file("/dev/xfpga/");
+    std::string file = get_devfs_root() + "/xfpga/";
     file += subdev;
     file += is_mgmt ? ".m" : ".u";
     file += std::to_string((domain<<16) + (bus<<8) + (dev<<3) + func);
@@ -337,7 +444,7 @@ static bool devfs_exists(bool is_mgmt, uint32_t instance)
 
 pcidev::pci_device::pci_device(const std::string& sysfs) : sysfs_name(sysfs)
 {
-    const std::string dir = sysfs_root + sysfs;
+    const std::string dir = get_sysfs_root() + sysfs;
     std::string err;
     std::vector<pci_device> mgmt_devices;
     std::vector<pci_device> user_devices;
@@ -593,7 +700,10 @@ void pci_device_scanner::pci_device_scanner::rescan_nolock()
 
     user_list.clear();
     mgmt_list.clear();
+    num_user_ready = 0;
+    num_mgmt_ready = 0;
 
+    const std::string sysfs_root = pcidev::get_sysfs_root();
     dir = opendir(sysfs_root.c_str());
     if(!dir) {
         std::cout << "Cannot open " << sysfs_root << std::endl;
@@ -640,6 +750,161 @@ std::shared_ptr<pcidev::pci_device> pcidev::get_dev(unsigned index, bool user)
     return pci_device_scanner::get_scanner()->get_dev(index, user);
 }
 
+pcidev::sysfs_snapshot::sysfs_snapshot(std::shared_ptr<pci_device> d)
+    : dev(std::move(d))
+{
+}
+
+pcidev::sysfs_snapshot::~sysfs_snapshot()
+{
+    for (auto& a : attrs) {
+        if (a.second.fd >= 0)
+            ::close(a.second.fd);
+    }
+}
+
+// Read entry from offset 0 of its fd, sysfs regenerates the content on
+// every such read.  The fd is opened on first use and reopened once if
+// it went stale.
+void pcidev::sysfs_snapshot::read(const key& k, attr& a)
+{
+    for (int attempt = 0; attempt < 2; attempt++) {
+        if (a.fd < 0) {
+            a.path = dev->get_sysfs_path(k.first, k.second);
+            if (a.path.empty()) {
+                std::stringstream ss;
+                ss << "Failed to find subdirectory for " << k.first
+                    << " under " << get_sysfs_root() + dev->sysfs_name
+                    << std::endl;
+                a.err = ss.str();
+                a.data.clear();
+                return;
+            }
+            a.fd = ::open(a.path.c_str(), O_RDONLY);
+            if (a.fd < 0) {
+                if (attempt == 0 && dev->forget_stale_subdev_dir(k.first))
+                    continue;
+                std::stringstream ss;
+                ss << "Failed to open " << a.path << " for reading: "
+                    << strerror(errno) << std::endl;
+                a.err = ss.str();
+                a.data.clear();
+                return;
+            }
+        }
+
+        a.data.clear();
+        char buf[4096];
+        off_t off = 0;
+        ssize_t n;
+        while ((n = ::pread(a.fd, buf, sizeof(buf), off)) > 0) {
+            a.data.append(buf, n);
+            off += n;
+        }
+        if (n == 0) {
+            a.err.clear();
+            return;
+        }
+
+        std::stringstream ss;
+        ss << "Failed to read " << a.path << ": " << strerror(errno)
+            << std::endl;
+        a.err = ss.str();
+        a.data.clear();
+        ::close(a.fd);
+        a.fd = -1;
+    }
+}
+
+const pcidev::sysfs_snapshot::attr& pcidev::sysfs_snapshot::lookup(
+    const std::string& subdev, const std::string& entry)
+{
+    auto k = key(subdev, entry);
+    auto it = attrs.find(k);
+    if (it != attrs.end())
+        return it->second;
+
+    auto& a = attrs[k];
+    read(k, a);
+    return a;
+}
+
+void pcidev::sysfs_snapshot::refresh()
+{
+    std::lock_guard<std::mutex> l(lock);
+    for (auto& a : attrs)
+        read(a.first, a.second);
+}
+
+void pcidev::sysfs_snapshot::get(
+    const std::string& subdev, const std::string& entry,
+    std::string& err_msg, std::vector<char>& buf)
+{
+    std::lock_guard<std::mutex> l(lock);
+    auto& a = lookup(subdev, entry);
+    err_msg = a.err;
+    buf.insert(std::end(buf), a.data.begin(), a.data.end());
+}
+
+void pcidev::sysfs_snapshot::get(
+    const std::string& subdev, const std::string& entry,
+    std::string& err_msg, std::vector<std::string>& sv)
+{
+    std::lock_guard<std::mutex> l(lock);
+    auto& a = lookup(subdev, entry);
+    err_msg = a.err;
+    sv.clear();
+    if (!err_msg.empty())
+        return;
+
+    std::istringstream is(a.data);
+    std::string line;
+    while (std::getline(is, line))
+        sv.push_back(line);
+}
+
+void pcidev::sysfs_snapshot::get(
+    const std::string& subdev, const std::string& entry,
+    std::string& err_msg, std::vector<uint64_t>& iv)
+{
+    std::vector<std::string> sv;
+
+    iv.clear();
+
+    get(subdev, entry, err_msg, sv);
+    if (!err_msg.empty())
+        return;
+
+    std::lock_guard<std::mutex> l(lock);
+    lines_to_uint64(lookup(subdev, entry).path, sv, err_msg, iv);
+}
+
+void pcidev::sysfs_snapshot::get(
+    const std::string& subdev, const std::string& entry,
+    std::string& err_msg, std::string& s)
+{
+    std::vector<std::string> sv;
+
+    get(subdev, entry, err_msg, sv);
+    if (!sv.empty())
+        s = sv[0];
+    else
+        s = ""; // default value
+}
+
+void pcidev::sysfs_snapshot::get(
+    const std::string& subdev, const std::string& entry,
+    std::string& err_msg, bool& b)
+{
+    std::vector<uint64_t> iv;
+
+    get(subdev, entry, err_msg, iv);
+    if (!iv.empty())
+        b = (iv[0] == 1);
+    else
+        b = false; // default value
+}
+
 std::ostream& operator<<(std::ostream& stream,
     const std::shared_ptr<pcidev::pci_device>& dev)
 {
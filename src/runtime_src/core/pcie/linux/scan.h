@@ -19,6 +19,7 @@
 
 #include <string>
 #include <vector>
+#include <map>
 #include <memory>
 #include <sys/mman.h>
 #include <sys/ioctl.h>
@@ -46,7 +47,7 @@ public:
     uint16_t dev =              INVALID_ID;
     uint16_t func =             INVALID_ID;
     uint32_t instance =         INVALID_ID;
-    std::string sysfs_name =    ""; // dir name under /sys/bus/pci/devices
+    std::string sysfs_name =    ""; // dir name under sysfs root
     int user_bar =              0;  // BAR mapped in by tools, default is BAR0
     size_t user_bar_size =      0;
     bool is_mgmt =              false;
@@ -82,6 +83,7 @@ public:
         std::string& err_msg, const std::vector<char>& buf);
     std::string get_sysfs_path(const std::string& subdev,
         const std::string& entry);
+    bool forget_stale_subdev_dir(const std::string& subdev);
 
     int pcieBarRead(uint64_t offset, void *buf, uint64_t len);
     int pcieBarWrite(uint64_t offset, const void *buf, uint64_t len);
@@ -98,11 +100,85 @@ private:
         const std::string& entry, std::string& err,
         bool write = false, bool binary = false);
     int map_usr_bar(void);
+    int get_subdev_dir(const std::string& subdev, std::string& subdir);
 
     std::mutex lock;
     char *user_bar_map = reinterpret_cast<char *>(MAP_FAILED);
+
+    std::mutex subdev_lock;
+    std::map<std::string, std::string> subdev_dirs; // subdev -> dir name
 };
 
+// Values of sysfs entries of one PCIE function, read in one pass.
+//
+// An entry is read when first asked for and is then remembered.
+// refresh() re-reads all remembered entries through file descriptors
+// kept open across refreshes, so tools polling many entries (xbutil
+// query, dump, top) neither resolve paths nor open files again.  The
+// get() overloads mirror pci_device::sysfs_get() and return the values
+// of the last read.
+class sysfs_snapshot {
+public:
+    sysfs_snapshot(std::shared_ptr<pci_device> dev);
+    ~sysfs_snapshot();
+
+    sysfs_snapshot(const sysfs_snapshot&) = delete;
+    sysfs_snapshot& operator=(const sysfs_snapshot&) = delete;
+
+    void refresh();
+
+    void get(const std::string& subdev, const std::string& entry,
+        std::string& err_msg, std::vector<std::string>& sv);
+    void get(const std::string& subdev, const std::string& entry,
+        std::string& err_msg, std::vector<uint64_t>& iv);
+    void get(const std::string& subdev, const std::string& entry,
+        std::string& err_msg, std::string& s);
+    void get(const std::string& subdev, const std::string& entry,
+        std::string& err_msg, bool& b);
+    void get(const std::string& subdev, const std::string& entry,
+        std::string& err_msg, std::vector<char>& buf);
+    template <typename T>
+    void get(const std::string& subdev, const std::string& entry,
+        std::string& err_msg, T& i) {
+        std::vector<uint64_t> iv;
+
+        get(subdev, entry, err_msg, iv);
+        if (!iv.empty())
+            i = static_cast<T>(iv[0]);
+        else
+            i = static_cast<T>(-1); // default value
+    }
+
+    const std::shared_ptr<pci_device>& device() const {
+        return dev;
+    }
+
+private:
+    using key = std::pair<std::string, std::string>; // subdev, entry
+    struct attr {
+        int fd = -1;
+        std::string path;
+        std::string data;
+        std::string err;
+    };
+
+    void read(const key& k, attr& a);
+    const attr& lookup(const std::string& subdev, const std::string& entry);
+
+    std::shared_ptr<pci_device> dev;
+    std::map<key, attr> attrs;
+    std::mutex lock;
+};
+
+// Roots of the PCIE sysfs device tree and of the device nodes.  They
+// default to /sys/bus/pci/devices and /dev, and can be pointed at a fake
+// tree with XRT_SYSFS_ROOT and XRT_DEVFS_ROOT or with set_roots(), e.g.
+// to exercise scan and query code without hardware.  Call rescan() after
+// changing the roots.
+std::string get_sysfs_root();
+std::string get_devfs_root();
+void set_roots(const std::string& sysfs_root, const std::string& devfs_root);
+
 void rescan(void);
 size_t get_dev_total(bool user = true);
 size_t get_dev_ready(bool user = true);
@@ -250,7 +250,7 @@ shim::~shim()
  */
 int shim::xclLogMsg(xrtLogMsgLevel level, const char* tag, const char* format, va_list args)
 {
-    static auto verbosity = xrt_core::config::get_verbosity();
+    auto verbosity = xrt_core::config::get_verbosity();
     if (level <= verbosity) {
         va_list args_bak;
         // vsnprintf will mutate va_list so back it up
@@ -1606,7 +1606,7 @@ int xclLoadXclBin(xclDeviceHandle handle, const xclBin *buffer)
 
 int xclLogMsg(xclDeviceHandle handle, xrtLogMsgLevel level, const char* tag, const char* format, ...)
 {
-    static auto verbosity = xrt_core::config::get_verbosity();
+    auto verbosity = xrt_core::config::get_verbosity();
     if (level <= verbosity) {
         va_list args;
         va_start(args, format);
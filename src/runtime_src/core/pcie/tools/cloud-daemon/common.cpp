@@ -22,6 +22,7 @@
 #include <sys/socket.h>
 #include <sys/select.h>
 #include <sys/time.h>
+#include <poll.h>
 #include <syslog.h>
 #include <unistd.h>
 #include <strings.h>
@@ -115,6 +116,14 @@ bool sendMsg(const pcieFunc& dev, int fd, sw_msg *swmsg)
 
     while (cur < total) {
         ssize_t ret = write(fd, buf + cur, total - cur);
+        if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // Non-blocking socket is full, wait for room.
+            struct pollfd pfd = { fd, POLLOUT, 0 };
+            if (poll(&pfd, 1, -1) > 0)
+                continue;
+        }
+        if (ret < 0 && errno == EINTR)
+            continue;
         if (ret <= 0)
             break;
         cur += ret;
@@ -196,7 +205,7 @@ std::unique_ptr<sw_msg> getRemoteMsg(const pcieFunc& dev, int remotefd)
     if (msgsz == 0)
         return nullptr;
 
-    if (msgsz > 1024 * 1024 * 1024)
+    if (msgsz > maxMsgSize)
         return nullptr;
 
     std::unique_ptr<sw_msg> swmsg = std::make_unique<sw_msg>(msgsz);
@@ -212,10 +221,12 @@ std::unique_ptr<sw_msg> getRemoteMsg(const pcieFunc& dev, int remotefd)
 /*
  *  passing the msg directly or the processed msg by the callback 
  *  to local mailbox or the peer side
+ *  msg.data is left holding one of the msgs, so its buffer can be reused
  */
 int handleMsg(const pcieFunc& dev, queue_msg &msg)
 {
     int pass;
+    int ret = -EINVAL;
     std::unique_ptr<sw_msg> swmsg = std::move(msg.data);
     std::unique_ptr<sw_msg> swmsgProcessed;
     if (!msg.cb) {
@@ -234,11 +245,14 @@ int handleMsg(const pcieFunc& dev, queue_msg &msg)
     }
 
     if (pass == FOR_LOCAL && sendMsg(dev, msg.localFd, swmsgProcessed.get()))
-        return 0;
-    if (pass == FOR_REMOTE && sendMsg(dev, msg.remoteFd, swmsgProcessed.get()))
-        return 0;
-    // Error occured
-    return -EINVAL;
+        ret = 0;
+    else if (pass == FOR_REMOTE && sendMsg(dev, msg.remoteFd, swmsgProcessed.get()))
+        ret = 0;
+    else if (pass == FOR_NONE)
+        ret = 0;
+
+    msg.data = swmsg ? std::move(swmsg) : std::move(swmsgProcessed);
+    return ret;
 }
 
 void Common::preStart()
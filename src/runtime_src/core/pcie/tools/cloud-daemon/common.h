@@ -30,11 +30,15 @@
 // Callback function for processing SW channel msg. The original msg
 // is passed in. The output would be a new msg ready to pass to either
 // local mailbox or remote socket for further handling. The return value
-// will indicate where to pass.
+// will indicate where to pass, FOR_NONE if the msg is consumed.
 using msgHandler = int(*)(const pcieFunc& dev, std::unique_ptr<sw_msg>&,
     std::unique_ptr<sw_msg>&);
 #define FOR_REMOTE 0
 #define FOR_LOCAL  1
+#define FOR_NONE   2
+
+// Largest msg taken from a socket or the mailbox.
+const size_t maxMsgSize = 1024 * 1024 * 1024;
 
 enum MSG_TYPE {
     LOCAL_MSG = 0,
@@ -22,6 +22,7 @@
 #include <stdlib.h>
 #include <signal.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <syslog.h>
 #include <netdb.h>
 #include <arpa/inet.h>
@@ -39,11 +40,15 @@
 #include <cstdlib>
 #include <cstring>
 #include <functional>
+#include <algorithm>
+#include <map>
 #include <dlfcn.h>
 
 #include "pciefunc.h"
 #include "sw_msg.h"
 #include "common.h"
+#include "reactor.h"
+#include "xclbin_xfer.h"
 #include "mpd_plugin.h"
 
 static bool quit = false;
@@ -57,12 +62,29 @@ static int localMsgHandler(const pcieFunc& dev,
     std::unique_ptr<sw_msg>& orig,
     std::unique_ptr<sw_msg>& processed);
 static int mb_notify(const pcieFunc &dev, int &fd, bool online);
-void mpd_getMsg(size_t index,
-    std::shared_ptr<Msgq> &msgq,
-    std::shared_ptr<std::atomic<bool>> &is_handling);
-void mpd_handleMsg(size_t index,
-    std::shared_ptr<Msgq> &msgq,
-    std::shared_ptr<std::atomic<bool>> &is_handling);
+static int xferLocalHandler(const pcieFunc& dev,
+    std::unique_ptr<sw_msg>& orig,
+    std::unique_ptr<sw_msg>& processed);
+static int xferRemoteHandler(const pcieFunc& dev,
+    std::unique_ptr<sw_msg>& orig,
+    std::unique_ptr<sw_msg>& processed);
+
+// Streamed xclbin transfers to msd, one per board.
+static std::map<int, std::unique_ptr<xferSender>> senders;
+
+struct mpdBoard {
+    mpdBoard(size_t index) : dev(index)
+    {
+    }
+
+    pcieFunc dev;
+    int mbxfd = -1;
+    int msdfd = -1;
+    bool online = false;
+    bool plugin = false;
+    // Bumped on every msd connection change to ignore stale errors.
+    uint64_t gen = 0;
+};
 
 class Mpd : public Common
 {
@@ -79,12 +101,18 @@ public:
     void start();
     void run();
     void stop();
-    init_fn plugin_init;
-    fini_fn plugin_fini;
-    std::vector<std::thread> threads_getMsg;
-    std::vector<std::thread> threads_handleMsg;
+    init_fn plugin_init = nullptr;
+    fini_fn plugin_fini = nullptr;
 
 private:
+    xferSender::hooks senderHooks(mpdBoard& b);
+    void setupBoard(mpdBoard& b);
+    void attachMsd(mpdBoard& b, int msdfd);
+    void msdDown(mpdBoard& b, uint64_t gen);
+    void boardDown(mpdBoard& b);
+    std::vector<std::unique_ptr<mpdBoard>> boards;
+    std::unique_ptr<msgReactor> reactor;
+    size_t active = 0;
 };
 
 void Mpd::start()
@@ -105,32 +133,45 @@ void Mpd::start()
 void Mpd::run()
 {
     /*
-     * Fire up 2 threads for each board - one is to get msg and the other is to
-     * handle msg. The reason is, in some cases, handle msg may take a relative
-     * long time, eg. downloading a large xclbin, and in this case, one thead
-     * implementation makes the next mailbox msg not read out promptly and ends
-     * up a tx timeout
+     * One reactor thread reads msgs from the mailbox and msd socket of all
+     * boards, and a few worker threads handle them. The reason is, in some
+     * cases, handle msg may take a relative long time, eg. downloading a large
+     * xclbin, and in this case, handling msg on the reading thread makes the
+     * next mailbox msg not read out promptly and ends up a tx timeout
      */
-    if (total == 0)
+    if (total == 0) {
         syslog(LOG_INFO, "no device found");
+        return;
+    }
+
+    /*
+     * Nothing waits on msd in the workers, a xclbin streamed to msd is
+     * written as msd ACKs and the socket takes it, so a few workers are
+     * enough for any number of boards.
+     */
+    reactor = std::make_unique<msgReactor>(std::min<size_t>(total, 4));
+    active = total;
     for (size_t i = 0; i < total; i++) {
-        std::shared_ptr<Msgq> msgq= std::make_shared<Msgq>();
-        std::shared_ptr<std::atomic<bool>> is_handling =
-            std::make_shared<std::atomic<bool>>(true);
-        auto t0 = std::bind(&mpd_getMsg, i, msgq, is_handling);
-        threads_getMsg.emplace_back(t0);
-        auto t1 = std::bind(&mpd_handleMsg, i, msgq, is_handling);
-        threads_handleMsg.emplace_back(t1);
+        boards.emplace_back(std::make_unique<mpdBoard>(i));
+        mpdBoard *b = boards.back().get();
+        senders[i] = std::make_unique<xferSender>(b->dev, senderHooks(*b));
+        reactor->post(i, [this, b]() { setupBoard(*b); });
     }
+
+    reactor->run(quit, 3);
+
+    // Let boards being set up come online, so they are notified offline.
+    reactor->drain();
+    for (auto& b : boards)
+        boardDown(*b);
 }
 
 void Mpd::stop()
 {
-    // Wait for all threads to finish before quit.
-    for (auto& t : threads_handleMsg)
-        t.join();
-    for (auto& t : threads_getMsg)
-        t.join();
+    // Wait for all queued msgs and offline notifications before quit.
+    reactor.reset();
+    boards.clear();
+    senders.clear();
 
     if (plugin_fini)
         (*plugin_fini)(plugin_cbs.mpc_cookie);
@@ -425,18 +466,82 @@ static int mb_notify(const pcieFunc &dev, int &fd, bool online)
     return handleMsg(dev, msg);    
 }
 
-// Client of MPD getting msg. Will quit on any error from either local mailbox or socket fd.
-// No retry is ever conducted.
-void mpd_getMsg(size_t index,
-       std::shared_ptr<Msgq> &msgq,
-       std::shared_ptr<std::atomic<bool>> &is_handling)
+/*
+ * Local mailbox msg handler used when msd supports streamed transfer. All
+ * msgs for msd are queued on the sender of the board, which streams large
+ * xclbin download requests in chunks and passes other msgs on as is. The
+ * response is sent back by msd as usual.
+ */
+static int xferLocalHandler(const pcieFunc& dev, std::unique_ptr<sw_msg>& orig,
+    std::unique_ptr<sw_msg>&)
 {
-    int msdfd = -1, mbxfd = -1;
-    int ret = 0;
-    std::string ip;
-    msgHandler cb = nullptr;
+    senders.at(dev.getIndex())->send(std::move(orig));
+    return FOR_NONE;
+}
 
-    pcieFunc dev(index);
+/*
+ * Remote msg handler used when msd supports streamed transfer. ACKs are
+ * for the sender, other msgs are passed on to mailbox as is.
+ */
+static int xferRemoteHandler(const pcieFunc& dev, std::unique_ptr<sw_msg>& orig,
+    std::unique_ptr<sw_msg>& processed)
+{
+    if (isXferMsg(*orig)) {
+        auto hdr = reinterpret_cast<xfer_hdr *>(orig->payloadData());
+        if (hdr->op == XFER_ACK)
+            senders.at(dev.getIndex())->ack(*hdr);
+        return FOR_NONE;
+    }
+
+    processed = std::move(orig);
+    return FOR_LOCAL;
+}
+
+/*
+ * The sender of a board is driven on the socket strand of the board, where
+ * ACKs from msd are handled as well.
+ */
+xferSender::hooks Mpd::senderHooks(mpdBoard& b)
+{
+    size_t i = b.dev.getIndex();
+    xferSender::hooks cbs;
+
+    cbs.waitWritable = [this, i](int fd) {
+        reactor->defer([this, i, fd]() {
+            (void) reactor->watchWritable(fd, [this, i]() {
+                reactor->post(total + i, [i]() { senders.at(i)->writable(); });
+            });
+        });
+    };
+    cbs.wakeAfter = [this, i](int secs) {
+        reactor->deferAfter(secs, [this, i]() {
+            reactor->post(total + i, [i]() { senders.at(i)->expire(); });
+        });
+    };
+    // msd is gone, fail the request instead of letting it time out.
+    cbs.failed = [this, &b, i](sw_msg& msg, int err) {
+        auto sc = reinterpret_cast<sw_chan *>(msg.data());
+        if (!(sc->flags & MB_REQ_FLAG_REQUEST))
+            return;
+        uint64_t id = msg.id();
+        reactor->post(i, [&b, id, err]() {
+            sw_msg resp(&err, sizeof(err), id, MB_REQ_FLAG_RESPONSE);
+            (void) sendMsg(b.dev, b.mbxfd, &resp);
+        });
+    };
+    return cbs;
+}
+
+/*
+ * Connect the board to msd, runs on a worker thread. The mailbox and socket
+ * fds are added to the reactor on the reactor thread.
+ * Will quit on any error, no retry is ever conducted.
+ */
+void Mpd::setupBoard(mpdBoard& b)
+{
+    pcieFunc& dev = b.dev;
+    int msdfd = -1;
+    std::string ip;
 
     /*
      * If there is user plugin, then we assume the users either don't want to
@@ -444,41 +549,38 @@ void mpd_getMsg(size_t index,
      * want to use the software mailbox at all. In this case, we interpret the
      * mailbox msg and process the msg with the hook function the plugin provides.
      */
+    bool failed = false;
     if (plugin_cbs.get_remote_msd_fd) {
-        ret = (*plugin_cbs.get_remote_msd_fd)(dev.getIndex(), msdfd);
+        int ret = (*plugin_cbs.get_remote_msd_fd)(dev.getIndex(), msdfd);
         if (ret) {
             syslog(LOG_ERR, "failed to get remote fd in plugin");
-            quit = true;
-            return;
+            failed = true;
         }
-        cb = localMsgHandler;
-    } else {
-        if (!dev.loadConf()) {
-            quit = true;
-            return;
-        }
-
+        // Plugins handling mailbox msgs themselves hand out no fd.
+        b.plugin = true;
+    } else if (dev.loadConf()) {
         ip = getIP(dev.getHost());
         if (ip.empty()) {
             dev.log(LOG_ERR, "Can't find out IP from host: %s", dev.getHost());
-            quit = true;
-            return;
-        }
-
-        dev.log(LOG_INFO, "peer msd ip=%s, port=%d, id=0x%x",
-            ip.c_str(), dev.getPort(), dev.getId());
-
-        if ((msdfd = connectMsd(dev, ip, dev.getPort(), dev.getId())) < 0) {
-            quit = true;
-            return;
+        } else {
+            dev.log(LOG_INFO, "peer msd ip=%s, port=%d, id=0x%x",
+                ip.c_str(), dev.getPort(), dev.getId());
+            msdfd = connectMsd(dev, ip, dev.getPort(), dev.getId());
         }
     }
 
-    mbxfd = dev.getMailbox();
+    if (!b.plugin && msdfd < 0)
+        failed = true;
+    int mbxfd = failed ? -1 : dev.getMailbox();
     if (mbxfd == -1) {
+        if (msdfd >= 0)
+            close(msdfd);
         quit = true;
+        reactor->defer([this]() { reactor->stop(); });
         return;
     }
+    if (msdfd >= 0)
+        (void) fcntl(msdfd, F_SETFL, fcntl(msdfd, F_GETFL) | O_NONBLOCK);
 
     /*
      * notify mailbox driver the daemon is ready.
@@ -488,99 +590,133 @@ void mpd_getMsg(size_t index,
      */
     mb_notify(dev, mbxfd, true);
 
-    struct queue_msg msg = {
-        .localFd = mbxfd,
-        .remoteFd = msdfd,
-        .cb = cb,
-        .data = nullptr,
-    };
-
-    int retfd[2];
-    for ( ;; ) {
-        retfd[0] = retfd[1] = -100;
-        ret = waitForMsg(dev, mbxfd, msdfd, 3, retfd);
-
-        if (quit)
-            break;
-        if (!(*is_handling)) //handleMsg thread exits
-            break;
-
-        if (ret < 0) {
-            if (ret == -EAGAIN)
-                continue;
-            else
-                break;
-        }
-
-        bool broken = false;
-        for (int i = 0; i < 2; i++) {
-            if (retfd[i] == mbxfd) {
-                msg.type = LOCAL_MSG;
-                msg.data = std::move(getLocalMsg(dev, mbxfd));
-            } else if (retfd[i] == msdfd) {
-                msg.type = REMOTE_MSG;
-                msg.data = std::move(getRemoteMsg(dev, msdfd));
-            } else
-                continue;
+    reactor->defer([this, &b, mbxfd, msdfd]() {
+        b.mbxfd = mbxfd;
+        b.online = true;
+        attachMsd(b, msdfd);
+    });
+}
 
-            if (msg.data == nullptr) {
-                broken = true;
-                break;
-            }
-            
-            std::lock_guard<std::mutex> lck(msgq->mtx);
-            msgq->q.push(std::move(msg));
-            (msgq->cv).notify_all();
-        }
+/*
+ * Serve the board with a new msd socket, runs on the reactor thread.
+ * Mailbox msgs are handled under the board index and socket msgs under
+ * total + index, where the sender of the board picks up ACKs from msd.
+ * A plugin may have no msd socket at all, then only the mailbox is served.
+ */
+void Mpd::attachMsd(mpdBoard& b, int msdfd)
+{
+    msgHandler lcb = nullptr;
+    msgHandler rcb = nullptr;
+    if (b.plugin) {
+        lcb = localMsgHandler;
+    } else if (b.dev.getXfer() >= XFER_VERSION) {
+        lcb = xferLocalHandler;
+        rcb = xferRemoteHandler;
+    }
 
-        if (broken)
-            break;
+    size_t i = b.dev.getIndex();
+    uint64_t gen = ++b.gen;
+    b.msdfd = msdfd;
+    msgRoute local = { LOCAL_MSG, b.mbxfd, msdfd, lcb };
+    msgRoute remote = { REMOTE_MSG, b.mbxfd, msdfd, rcb };
+    auto down = [this, &b](int) { boardDown(b); };
+    auto lost = [this, &b, gen](int) { msdDown(b, gen); };
+    if (reactor->addMsgFd(i, b.dev, b.mbxfd, true, local, down) != 0) {
+        boardDown(b);
+        return;
+    }
+    if (msdfd < 0)
+        return;
+    if (reactor->addMsgFd(total + i, b.dev, msdfd, false, remote, lost) != 0) {
+        boardDown(b);
+        return;
     }
+    senders.at(i)->connected(msdfd);
+}
 
-    msg.type = ILLEGAL_MSG;
-    std::lock_guard<std::mutex> lck(msgq->mtx);
-    msgq->q.push(std::move(msg));
-    (msgq->cv).notify_all();
+/*
+ * Socket to msd is broken, eg. msd restarted. Reconnect and resume serving
+ * the board, a xclbin transfer cut off in the middle is resumed as well.
+ * Runs on the reactor thread.
+ */
+void Mpd::msdDown(mpdBoard& b, uint64_t gen)
+{
+    if (!b.online || gen != b.gen)
+        return;
+    if (b.plugin) {
+        boardDown(b);
+        return;
+    }
 
-    //notify mailbox driver the daemon is offline 
-    mb_notify(dev, mbxfd, false);
+    size_t i = b.dev.getIndex();
+    int oldfd = b.msdfd;
+    reactor->removeFd(b.mbxfd);
+    reactor->removeFd(oldfd);
+    senders.at(i)->connected(-1);
+    b.msdfd = -1;
+    b.gen++;
 
-    if (msdfd > 0)     
-        close(msdfd);
-    dev.log(LOG_INFO, "mpd_getMsg thread %d exit!!", index);
-}
+    /*
+     * Fail pending writes right away, but don't close the fd before msgs
+     * already queued on the board are handled, so the fd number is not
+     * reused under a sender.
+     */
+    (void) shutdown(oldfd, SHUT_RDWR);
+    reactor->post(i, [oldfd]() { close(oldfd); });
+
+    reactor->post(total + i, [this, &b]() {
+        int msdfd = -1;
+        for (int retry = 0; retry < 10 && !quit && msdfd < 0; retry++) {
+            if (retry)
+                std::this_thread::sleep_for(std::chrono::seconds(1));
+            // msd may come back with a new port or id
+            if (!b.dev.loadConf())
+                continue;
+            std::string ip = getIP(b.dev.getHost());
+            if (!ip.empty())
+                msdfd = connectMsd(b.dev, ip, b.dev.getPort(), b.dev.getId());
+        }
+        if (msdfd >= 0)
+            (void) fcntl(msdfd, F_SETFL, fcntl(msdfd, F_GETFL) | O_NONBLOCK);
 
-// Client of MPD handling msg. Will quit on any error from either local mailbox or socket fd.
-// No retry is ever conducted.
-void mpd_handleMsg(size_t index,
-       std::shared_ptr<Msgq> &msgq,
-       std::shared_ptr<std::atomic<bool>> &is_handling)
-{
-    pcieFunc dev(index);
-    *is_handling = true;
-    std::unique_lock<std::mutex> lck(msgq->mtx, std::defer_lock);
-    for ( ;; ) {
-        lck.lock();
-        while (msgq->q.empty()) {
-            (msgq->cv).wait_for(lck, std::chrono::seconds(3));
-            if (quit) {
-                *is_handling = false;
-                dev.log(LOG_INFO, "mpd_handleMsg thread %d exit!!", index);
+        reactor->defer([this, &b, msdfd]() {
+            if (msdfd >= 0 && b.online) {
+                b.dev.log(LOG_INFO, "reconnected to msd");
+                attachMsd(b, msdfd);
                 return;
             }
-        }
-
-        struct queue_msg msg = std::move(msgq->q.front());
-        msgq->q.pop();
-        lck.unlock();
-        if (msg.type == ILLEGAL_MSG) //getMsg thread exits
-            break;
-        if (handleMsg(dev, msg) != 0)
-            break;
-    }
+            if (msdfd >= 0)
+                close(msdfd);
+            boardDown(b);
+        });
+    });
+}
 
-    *is_handling = false;
-    dev.log(LOG_INFO, "mpd_handleMsg thread %d exit!!", index);
+/*
+ * Stop serving the board on any error from either local mailbox or socket
+ * fd, runs on the reactor thread. The board is gone for good.
+ */
+void Mpd::boardDown(mpdBoard& b)
+{
+    if (!b.online)
+        return;
+    b.online = false;
+    reactor->removeFd(b.mbxfd);
+    if (b.msdfd >= 0)
+        reactor->removeFd(b.msdfd);
+    senders.at(b.dev.getIndex())->connected(-1);
+
+    // After msgs already read are handled, notify mailbox driver the
+    // daemon is offline
+    reactor->post(b.dev.getIndex(), [&b]() {
+        mb_notify(b.dev, b.mbxfd, false);
+        if (b.msdfd >= 0)
+            close(b.msdfd);
+        b.dev.log(LOG_INFO, "mpd board %d exit!!", b.dev.getIndex());
+    });
+
+    if (--active == 0)
+        reactor->stop();
 }
 
 /*
@@ -20,21 +20,26 @@
 
 #include <stdio.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <syslog.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 
 #include <fstream>
 #include <vector>
+#include <map>
 #include <thread>
 #include <cstdlib>
 #include <csignal>
 #include <cstring>
+#include <algorithm>
 #include <dlfcn.h>
 
 #include "pciefunc.h"
 #include "sw_msg.h"
 #include "common.h"
+#include "reactor.h"
+#include "xclbin_xfer.h"
 #include "msd_plugin.h"
 #include "xclbin.h"
 #include "core/pcie/driver/linux/include/mgmt-ioctl.h"
@@ -47,15 +52,28 @@ static uint64_t chanSwitch = (1UL<<MAILBOX_REQ_TEST_READY) |
                       (1UL<<MAILBOX_REQ_LOAD_XCLBIN);
 static struct msd_plugin_callbacks plugin_cbs;
 static const std::string plugin_path("/opt/xilinx/xrt/lib/libmsd_plugin.so");
+// Streamed xclbin transfers from mpd, one per board.
+static std::map<int, std::unique_ptr<xferReceiver>> receivers;
 
 static std::string getHost();
 static void createSocket(const pcieFunc& dev, int& sockfd, uint16_t& port);
 static int verifyMpd(const pcieFunc& dev, int mpdfd, int id);
 static int connectMpd(const pcieFunc& dev, int sockfd, int id, int& mpdfd);
-void msd_thread(size_t index, std::string host);
 int remoteMsgHandler(const pcieFunc& dev, std::unique_ptr<sw_msg>& orig,
     std::unique_ptr<sw_msg>& processed);
 
+struct msdBoard {
+    msdBoard(size_t index) : dev(index, false)
+    {
+    }
+
+    pcieFunc dev;
+    int mbxfd = -1;
+    int sockfd = -1;
+    int mpdfd = -1;
+    bool online = false;
+};
+
 class Msd : public Common
 {
 public:
@@ -71,14 +89,20 @@ public:
     void start();
     void run();
     void stop();
-    init_fn plugin_init;
-    fini_fn plugin_fini;
-    std::vector<std::thread> threads;
+    init_fn plugin_init = nullptr;
+    fini_fn plugin_fini = nullptr;
 
 private:
+    void setupBoard(msdBoard& b, const std::string& host);
+    void acceptMpd(msdBoard& b);
+    void mpdConnected(msdBoard& b, int mpdfd);
+    void mpdDown(msdBoard& b);
+    void boardDown(msdBoard& b);
+    std::vector<std::unique_ptr<msdBoard>> boards;
+    std::unique_ptr<msgReactor> reactor;
+    size_t active = 0;
 };
 
-
 void Msd::start()
 {
     if (plugin_handle != nullptr) {
@@ -103,18 +127,34 @@ void Msd::run()
         return;
     }
 
-    // Fire one thread for each board.
-    if (total == 0)
+    // Serve all boards from one reactor thread.
+    if (total == 0) {
         syslog(LOG_INFO, "no device found");
-    for (size_t i = 0; i < total; i++)
-        threads.emplace_back(msd_thread, i, host);
+        return;
+    }
+
+    reactor = std::make_unique<msgReactor>(std::min<size_t>(total, 4));
+    active = total;
+    for (size_t i = 0; i < total; i++) {
+        boards.emplace_back(std::make_unique<msdBoard>(i));
+        receivers[i] = std::make_unique<xferReceiver>();
+        msdBoard *b = boards.back().get();
+        reactor->post(i, [this, b, host]() { setupBoard(*b, host); });
+    }
+
+    reactor->run(quit, 3);
+
+    reactor->drain();
+    for (auto& b : boards)
+        boardDown(*b);
 }
 
 void Msd::stop()
 {
-    // Wait for all threads to finish before quit.
-    for (auto& t : threads)
-        t.join();
+    // Wait for all queued msgs and config restore before quit.
+    reactor.reset();
+    boards.clear();
+    receivers.clear();
 
     if (plugin_fini)
         (*plugin_fini)(plugin_cbs.mpc_cookie);
@@ -261,9 +301,44 @@ int download_xclbin(const pcieFunc& dev, char *xclbin)
     return ret;
 }
 
+/*
+ * Streamed xclbin download request from mpd. Once all of it is staged and
+ * verified, the xclbin is downloaded from the staged copy.
+ */
+static int xferMsgHandler(const pcieFunc& dev, std::unique_ptr<sw_msg>& orig,
+    std::unique_ptr<sw_msg>& processed)
+{
+    std::unique_ptr<xferStage> done;
+    int pass = receivers.at(dev.getIndex())->recv(dev, *orig, processed, done);
+    if (!done)
+        return pass;
+
+    int ret = -EINVAL;
+    char *payload = done->map();
+    mailbox_req *req = reinterpret_cast<mailbox_req *>(payload);
+    if (payload == nullptr) {
+        dev.log(LOG_ERR, "failed to map staged xclbin: %m");
+        ret = -ENOMEM;
+    } else if (done->size < sizeof(mailbox_req) + sizeof(axlf) ||
+        req->req != MAILBOX_REQ_LOAD_XCLBIN ||
+        reinterpret_cast<axlf *>(req->data)->m_header.m_length >
+        done->size - sizeof(mailbox_req)) {
+        dev.log(LOG_ERR, "peer request dropped, wrong size");
+    } else {
+        ret = download_xclbin(dev, req->data);
+        dev.log(LOG_INFO, "xclbin download, ret=%d", ret);
+    }
+    processed = std::make_unique<sw_msg>(&ret, sizeof(ret), done->xid,
+        MB_REQ_FLAG_RESPONSE);
+    return FOR_REMOTE;
+}
+
 int remoteMsgHandler(const pcieFunc& dev, std::unique_ptr<sw_msg>& orig,
     std::unique_ptr<sw_msg>& processed)
 {
+    if (isXferMsg(*orig))
+        return xferMsgHandler(dev, orig, processed);
+
     int pass = FOR_LOCAL;
     mailbox_req *req = reinterpret_cast<mailbox_req *>(orig->payloadData());
     if (orig->payloadSize() < sizeof(mailbox_req)) {
@@ -301,90 +376,122 @@ int remoteMsgHandler(const pcieFunc& dev, std::unique_ptr<sw_msg>& orig,
     return pass;
 }
 
-// Server serving MPD. Any error from socket fd, re-accept, don't quit.
-// Will quit on any error from local mailbox fd.
-void msd_thread(size_t index, std::string host)
+/*
+ * Open mailbox and socket for the board and wait for mpd to connect, runs
+ * on a worker thread.
+ */
+void Msd::setupBoard(msdBoard& b, const std::string& host)
 {
-    uint16_t port;
-    int sockfd = -1, mpdfd = -1, mbxfd = -1;
-    int retfd[2];
-    int ret;
-    struct queue_msg msg = {0};
-
-    pcieFunc dev(index, false);
-
-    mbxfd = dev.getMailbox();
-    if (mbxfd == -1)
-        goto done;
-
-    // Create socket and obtain port.
-    port = dev.getPort();
-    createSocket(dev, sockfd, port);
-    if (sockfd < 0 || port == 0)
-        goto done;
+    pcieFunc& dev = b.dev;
+    uint16_t port = 0;
+    int sockfd = -1;
+
+    int mbxfd = dev.getMailbox();
+    if (mbxfd != -1) {
+        // Create socket and obtain port.
+        port = dev.getPort();
+        createSocket(dev, sockfd, port);
+    }
 
     // Update config, if the existing one is not the same.
-    (void) dev.loadConf();
-    if (host != dev.getHost() || port != dev.getPort() ||
-        chanSwitch != dev.getSwitch()) {
-        if (dev.updateConf(host, port, chanSwitch) != 0)
-            goto done;
+    bool ok = (sockfd >= 0 && port != 0);
+    if (ok) {
+        (void) dev.loadConf();
+        if (host != dev.getHost() || port != dev.getPort() ||
+            chanSwitch != dev.getSwitch() || dev.getXfer() != XFER_VERSION)
+            ok = (dev.updateConf(host, port, chanSwitch, XFER_VERSION) == 0);
     }
 
-    while (!quit) {
-        // Connect to mpd.
-        if (mpdfd == -1) {
-            ret = connectMpd(dev, sockfd, dev.getId(), mpdfd);
-            if (ret == -EWOULDBLOCK) {
-                sleep(1);
-                mpdfd = -1;
-                continue; // MPD is not ready yet, retry.
-            } else if (ret != 0) {
-                break;
-            }
-        }
+    reactor->defer([this, &b, mbxfd, sockfd, ok]() {
+        b.mbxfd = mbxfd;
+        b.sockfd = sockfd;
+        b.online = true;
+        if (!ok || reactor->addFd(sockfd, [this, &b](uint32_t) {
+                acceptMpd(b);
+            }) != 0)
+            boardDown(b);
+    });
+}
 
-        retfd[0] = retfd[1] = -100;
-        // Waiting for msg to show up, interval is 3 seconds.
-        ret = waitForMsg(dev, mbxfd, mpdfd, 3, retfd);
-        if (ret < 0) {
-            if (ret == -EAGAIN) // MPD has been quiet, retry.
-                continue;
+/*
+ * Connection from mpd is pending on the listening socket. Verifying mpd
+ * needs a blocking read, so it is done on a worker thread.
+ */
+void Msd::acceptMpd(msdBoard& b)
+{
+    reactor->removeFd(b.sockfd);
+    reactor->post(b.dev.getIndex(), [this, &b]() {
+        int mpdfd = -1;
+        int ret = connectMpd(b.dev, b.sockfd, b.dev.getId(), mpdfd);
+        reactor->defer([this, &b, ret, mpdfd]() {
+            if (!b.online) {
+                if (mpdfd >= 0)
+                    close(mpdfd);
+                return;
+            }
+            if (ret == 0)
+                mpdConnected(b, mpdfd);
+            else if (ret == -EWOULDBLOCK || ret == -EINVAL) // retry
+                reactor->addFd(b.sockfd, [this, &b](uint32_t) {
+                    acceptMpd(b);
+                });
             else
-                break;
-        }
+                boardDown(b);
+        });
+    });
+}
 
-        msg.localFd = mbxfd;
-        msg.remoteFd = mpdfd;
-
-        // Process msg.
-        for (int i = 0; i < 2; i++) {
-            if (retfd[i] == mbxfd) {
-                msg.type = LOCAL_MSG;
-                msg.data = std::move(getLocalMsg(dev, mbxfd));
-            } else if (retfd[i] == mpdfd) {
-                msg.type = REMOTE_MSG;
-                msg.data = std::move(getRemoteMsg(dev, mpdfd));
-                msg.cb = remoteMsgHandler;
-            } else
-                continue;
-            if (msg.data == nullptr)
-                goto done;
-            ret = handleMsg(dev, msg);
-            if (ret == -EAGAIN) { // Socket connection was lost, retry
-                close(mpdfd);
-                mpdfd = -1;
-                continue;
-            } else if (ret != 0) {
-                goto done;
-            }
-        }
-    }
+void Msd::mpdConnected(msdBoard& b, int mpdfd)
+{
+    (void) fcntl(mpdfd, F_SETFL, fcntl(mpdfd, F_GETFL) | O_NONBLOCK);
+    b.mpdfd = mpdfd;
+
+    size_t i = b.dev.getIndex();
+    msgRoute local = { LOCAL_MSG, b.mbxfd, mpdfd, nullptr };
+    msgRoute remote = { REMOTE_MSG, b.mbxfd, mpdfd, remoteMsgHandler };
+    auto mbxErr = [this, &b](int) { boardDown(b); };
+    auto mpdErr = [this, &b](int) { mpdDown(b); };
+    if (reactor->addMsgFd(i, b.dev, b.mbxfd, true, local, mbxErr) != 0 ||
+        reactor->addMsgFd(i, b.dev, mpdfd, false, remote, mpdErr) != 0)
+        boardDown(b);
+}
+
+// Any error from socket fd, re-accept, don't quit.
+void Msd::mpdDown(msdBoard& b)
+{
+    if (!b.online || b.mpdfd < 0)
+        return;
+    reactor->removeFd(b.mbxfd);
+    reactor->removeFd(b.mpdfd);
+
+    int mpdfd = b.mpdfd;
+    b.mpdfd = -1;
+    reactor->post(b.dev.getIndex(), [mpdfd]() { close(mpdfd); });
+
+    if (reactor->addFd(b.sockfd, [this, &b](uint32_t) { acceptMpd(b); }) != 0)
+        boardDown(b);
+}
 
-done:
-    dev.updateConf("", 0, 0); // Restore default config.
-    close(mpdfd);
-    close(sockfd);
+// Will quit on any error from local mailbox fd or msg handling.
+void Msd::boardDown(msdBoard& b)
+{
+    if (!b.online)
+        return;
+    b.online = false;
+    reactor->removeFd(b.mbxfd);
+    reactor->removeFd(b.mpdfd);
+    reactor->removeFd(b.sockfd);
+
+    reactor->post(b.dev.getIndex(), [&b]() {
+        b.dev.updateConf("", 0, 0); // Restore default config.
+        if (b.mpdfd >= 0)
+            close(b.mpdfd);
+        if (b.sockfd >= 0)
+            close(b.sockfd);
+    });
+
+    if (--active == 0)
+        reactor->stop();
 }
 
 /*
@@ -55,6 +55,12 @@ uint64_t pcieFunc::getSwitch()
     return chanSwitch;
 }
 
+int pcieFunc::getXfer()
+{
+    std::lock_guard<std::mutex> l(lock);
+    return xferVersion;
+}
+
 int pcieFunc::getIndex() const
 {
     return index;
@@ -76,6 +82,7 @@ void pcieFunc::clearConf()
     port = 0;
     devId = 0;
     chanSwitch = 0;
+    xferVersion = 0;
 }
 
 bool pcieFunc::loadConf()
@@ -114,6 +121,8 @@ bool pcieFunc::loadConf()
             port = stoi(value, nullptr, 0);
         else if (key.compare("id") == 0)
             devId = stoi(value, nullptr, 0);
+        else if (key.compare("xfer") == 0)
+            xferVersion = stoi(value, nullptr, 0);
         else // ignore unknown key, but don't fail
             log(LOG_WARNING, "unknown config key %s", key.c_str());
     }
@@ -157,7 +166,8 @@ pcieFunc::~pcieFunc()
     mbxfd = -1;
 }
 
-int pcieFunc::updateConf(std::string hostname, uint16_t hostport, uint64_t swch)
+int pcieFunc::updateConf(std::string hostname, uint16_t hostport, uint64_t swch,
+    int xfer)
 {
     std::lock_guard<std::mutex> l(lock);
     std::string config;
@@ -169,6 +179,9 @@ int pcieFunc::updateConf(std::string hostname, uint16_t hostport, uint64_t swch)
     std::stringstream ss;
     ss << std::hex << id;
     config += "id=0x" + ss.str();
+    // Streamed xclbin transfer supported by msd, see xclbin_xfer.h
+    if (xfer)
+        config += "\nxfer=" + std::to_string(xfer);
     dev->sysfs_put("", "config_mailbox_comm_id", err, config);
     if (!err.empty()) {
         log(LOG_ERR, "failed to push config: %s", err.c_str());
@@ -186,6 +199,7 @@ int pcieFunc::updateConf(std::string hostname, uint16_t hostport, uint64_t swch)
     port = hostport;
     devId = id;
     chanSwitch = swch;
+    xferVersion = xfer;
     log(LOG_INFO, "pushed switch: 0x%llx, config: %s", swch, config.c_str());
     return 0;
 }
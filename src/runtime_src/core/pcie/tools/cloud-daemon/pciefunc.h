@@ -34,13 +34,15 @@ public:
     int getId();
     int getMailbox();
     uint64_t getSwitch();
+    int getXfer();
     int getIndex() const;
     std::shared_ptr<pcidev::pci_device> getDev() const;
 
     // Load config from device's sysfs nodes
     bool loadConf();
     // Write config to device's sysfs nodes
-    int updateConf(std::string host, uint16_t port, uint64_t swch);
+    int updateConf(std::string host, uint16_t port, uint64_t swch,
+        int xfer = 0);
 
     // prefix syslog msg with dev specific bdf
     void log(int priority, const char *format, ...) const;
@@ -50,6 +52,7 @@ private:
     uint16_t port = 0;
     uint64_t chanSwitch = 0;
     int devId = 0;
+    int xferVersion = 0;
     int mbxfd = -1;
     std::shared_ptr<pcidev::pci_device> dev;
     size_t index;
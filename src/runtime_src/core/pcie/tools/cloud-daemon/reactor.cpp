@@ -0,0 +1,453 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * In this file, we provide the epoll based event loop for all daemons.
+ */
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <syslog.h>
+#include <unistd.h>
+#include <errno.h>
+#include <algorithm>
+
+#include "reactor.h"
+
+// Mailbox read buffer, big enough for all but xclbin download msgs.
+static const size_t mailboxBufSize = 64 * 1024;
+// Don't hold on to buffers of large msgs for reuse.
+static const size_t maxSpareSize = 1024 * 1024;
+
+msgReader::msgReader(int fd, bool mailbox) : fd(fd), mailbox(mailbox)
+{
+}
+
+int msgReader::getFd() const
+{
+    return fd;
+}
+
+std::unique_ptr<std::vector<char>> msgReader::getBuffer()
+{
+    std::lock_guard<std::mutex> l(spareLock);
+    if (spare)
+        return std::move(spare);
+    return std::make_unique<std::vector<char>>();
+}
+
+void msgReader::recycle(std::unique_ptr<sw_msg> msg)
+{
+    if (!msg)
+        return;
+    auto b = msg->release();
+    if (!b || b->capacity() > maxSpareSize)
+        return;
+    std::lock_guard<std::mutex> l(spareLock);
+    if (!spare || spare->capacity() < b->capacity())
+        spare = std::move(b);
+}
+
+int msgReader::readMailbox(const pcieFunc& dev, std::unique_ptr<sw_msg>& msg)
+{
+    auto b = getBuffer();
+    if (b->size() < mailboxBufSize)
+        b->resize(mailboxBufSize);
+
+    ssize_t ret = read(fd, b->data(), b->size());
+    if (ret < 0 && errno == EMSGSIZE) {
+        // Driver filled out the real msg size, retry with a bigger buffer.
+        size_t sz = reinterpret_cast<sw_chan *>(b->data())->sz;
+        if (sz > maxMsgSize) {
+            dev.log(LOG_ERR, "mailbox msg too big: %lu bytes", sz);
+            return -EINVAL;
+        }
+        b->resize(sizeof(sw_chan) + sz);
+        ret = read(fd, b->data(), b->size());
+    }
+    if (ret < 0) {
+        int err = errno;
+        if (err == EAGAIN || err == EINTR)
+            return 0;
+        dev.log(LOG_ERR, "can't read sw_chan from mailbox, %m");
+        return -err;
+    }
+    if (ret == 0) // msg was taken by someone else
+        return 0;
+
+    b->resize(ret);
+    msg = std::make_unique<sw_msg>(std::move(b));
+    if (!msg->valid()) {
+        dev.log(LOG_ERR, "read %d bytes of invalid msg from mailbox fd %d",
+            ret, fd);
+        return -EINVAL;
+    }
+    return 1;
+}
+
+int msgReader::readSocket(const pcieFunc& dev, std::unique_ptr<sw_msg>& msg)
+{
+    if (!buf) {
+        buf = getBuffer();
+        buf->resize(sizeof(sw_chan));
+        cur = 0;
+    }
+
+    for ( ;; ) {
+        ssize_t ret = read(fd, buf->data() + cur, buf->size() - cur);
+        if (ret == 0) {
+            dev.log(LOG_INFO, "peer closed fd %d", fd);
+            return -EPIPE;
+        }
+        if (ret < 0) {
+            int err = errno;
+            if (err == EINTR)
+                continue;
+            if (err == EAGAIN || err == EWOULDBLOCK)
+                return 0;
+            dev.log(LOG_ERR, "can't read sw_chan from socket, %m");
+            return -err;
+        }
+
+        cur += ret;
+        if (cur < buf->size())
+            continue;
+
+        // Header is complete, make room for the payload.
+        if (cur == sizeof(sw_chan)) {
+            size_t sz = reinterpret_cast<sw_chan *>(buf->data())->sz;
+            if (sz > maxMsgSize) {
+                dev.log(LOG_ERR, "socket msg too big: %lu bytes", sz);
+                return -EINVAL;
+            }
+            if (sz) {
+                buf->resize(sizeof(sw_chan) + sz);
+                continue;
+            }
+        }
+        break;
+    }
+
+    msg = std::make_unique<sw_msg>(std::move(buf));
+    cur = 0;
+    return 1;
+}
+
+int msgReader::readMsg(const pcieFunc& dev, std::unique_ptr<sw_msg>& msg)
+{
+    return mailbox ? readMailbox(dev, msg) : readSocket(dev, msg);
+}
+
+msgReactor::msgReactor(size_t workers)
+{
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0)
+        syslog(LOG_ERR, "failed to create epoll fd: %m");
+
+    evfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (evfd < 0) {
+        syslog(LOG_ERR, "failed to create event fd: %m");
+    } else {
+        struct epoll_event ev = { 0 };
+        ev.events = EPOLLIN;
+        ev.data.fd = evfd;
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, evfd, &ev) != 0)
+            syslog(LOG_ERR, "failed to add event fd: %m");
+    }
+
+    if (workers == 0)
+        workers = 1;
+    for (size_t i = 0; i < workers; i++)
+        threads.emplace_back(&msgReactor::worker, this);
+}
+
+msgReactor::~msgReactor()
+{
+    // Workers finish all posted work before exiting.
+    {
+        std::lock_guard<std::mutex> l(lock);
+        exiting = true;
+    }
+    cv.notify_all();
+    for (auto& t : threads)
+        t.join();
+
+    if (evfd >= 0)
+        close(evfd);
+    if (epfd >= 0)
+        close(epfd);
+}
+
+int msgReactor::addFd(int fd, fdHandler handler)
+{
+    struct epoll_event ev = { 0 };
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        int err = errno;
+        syslog(LOG_ERR, "failed to add fd %d to epoll: %m", fd);
+        return -err;
+    }
+    handlers[fd] = std::move(handler);
+    return 0;
+}
+
+/*
+ * Read msgs from fd and pass them to handleMsg() on the worker threads.
+ * onError is expected to remove fd from the reactor.
+ */
+int msgReactor::addMsgFd(size_t key, const pcieFunc& dev, int fd,
+    bool mailbox, const msgRoute& route, errHandler onError)
+{
+    auto reader = std::make_shared<msgReader>(fd, mailbox);
+
+    return addFd(fd, [this, key, &dev, reader, route, onError](uint32_t) {
+        std::unique_ptr<sw_msg> swmsg;
+        int ret = reader->readMsg(dev, swmsg);
+        if (ret == 0)
+            return;
+        if (ret < 0) {
+            onError(ret);
+            return;
+        }
+
+        // std::function must be copyable, so the msg is shared
+        auto data = std::make_shared<std::unique_ptr<sw_msg>>(
+            std::move(swmsg));
+        post(key, [this, &dev, reader, route, onError, data]() {
+            struct queue_msg msg;
+            msg.localFd = route.localFd;
+            msg.remoteFd = route.remoteFd;
+            msg.cb = route.cb;
+            msg.type = route.type;
+            msg.data = std::move(*data);
+
+            int ret = handleMsg(dev, msg);
+            reader->recycle(std::move(msg.data));
+            if (ret != 0)
+                defer([onError, ret]() { onError(ret); });
+        });
+    });
+}
+
+void msgReactor::removeFd(int fd)
+{
+    writers.erase(fd);
+    if (handlers.erase(fd) == 0)
+        return;
+    (void) epoll_ctl(epfd, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+int msgReactor::watchWritable(int fd, std::function<void()> fn)
+{
+    if (handlers.find(fd) == handlers.end())
+        return -ENOENT;
+
+    struct epoll_event ev = { 0 };
+    ev.events = EPOLLIN | EPOLLOUT;
+    ev.data.fd = fd;
+    if (epoll_ctl(epfd, EPOLL_CTL_MOD, fd, &ev) != 0) {
+        int err = errno;
+        syslog(LOG_ERR, "failed to watch fd %d for write: %m", fd);
+        return -err;
+    }
+    writers[fd] = std::move(fn);
+    return 0;
+}
+
+size_t msgReactor::fdCount() const
+{
+    return handlers.size();
+}
+
+void msgReactor::post(size_t key, std::function<void()> work)
+{
+    std::lock_guard<std::mutex> l(lock);
+    auto& s = strands[key];
+    s.work.push_back(std::move(work));
+    if (s.busy)
+        return;
+    s.busy = true;
+    ready.push_back(key);
+    cv.notify_one();
+}
+
+void msgReactor::worker()
+{
+    std::unique_lock<std::mutex> l(lock);
+    for ( ;; ) {
+        cv.wait(l, [this] { return exiting || !ready.empty(); });
+        if (ready.empty())
+            return;
+
+        size_t key = ready.front();
+        ready.pop_front();
+        auto& s = strands[key];
+        auto work = std::move(s.work.front());
+        s.work.pop_front();
+
+        running++;
+        l.unlock();
+        work();
+        l.lock();
+        running--;
+
+        // Let other keys go first before running the next work of this key.
+        if (s.work.empty())
+            s.busy = false;
+        else
+            ready.push_back(key);
+        if (ready.empty() && running == 0)
+            idle.notify_all();
+    }
+}
+
+void msgReactor::defer(std::function<void()> fn)
+{
+    {
+        std::lock_guard<std::mutex> l(lock);
+        deferred.push_back(std::move(fn));
+    }
+    wakeup();
+}
+
+void msgReactor::deferAfter(long secs, std::function<void()> fn)
+{
+    {
+        std::lock_guard<std::mutex> l(lock);
+        timers.emplace(std::chrono::steady_clock::now() +
+            std::chrono::seconds(secs), std::move(fn));
+    }
+    // Let epoll_wait() pick up the new timeout.
+    wakeup();
+}
+
+void msgReactor::wakeup()
+{
+    uint64_t one = 1;
+    if (write(evfd, &one, sizeof(one)) != sizeof(one) && errno != EAGAIN)
+        syslog(LOG_ERR, "failed to wake up reactor: %m");
+}
+
+void msgReactor::runDeferred()
+{
+    uint64_t cnt;
+    (void) read(evfd, &cnt, sizeof(cnt));
+
+    std::vector<std::function<void()>> fns;
+    {
+        std::lock_guard<std::mutex> l(lock);
+        fns.swap(deferred);
+    }
+    for (auto& fn : fns)
+        fn();
+}
+
+void msgReactor::runTimers()
+{
+    std::vector<std::function<void()>> fns;
+    {
+        std::lock_guard<std::mutex> l(lock);
+        auto now = std::chrono::steady_clock::now();
+        auto end = timers.upper_bound(now);
+        for (auto it = timers.begin(); it != end; ++it)
+            fns.push_back(std::move(it->second));
+        timers.erase(timers.begin(), end);
+    }
+    for (auto& fn : fns)
+        fn();
+}
+
+// Milliseconds to wait for events, until the first timer is due.
+int msgReactor::nextTimeout(long interval)
+{
+    long ms = interval * 1000;
+    std::lock_guard<std::mutex> l(lock);
+    if (!timers.empty()) {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+            timers.begin()->first - std::chrono::steady_clock::now()).count();
+        // Round up, so the timer is due when epoll_wait() returns.
+        ms = std::max(std::min<long>(ms, left + 1), 0L);
+    }
+    return ms;
+}
+
+void msgReactor::stop()
+{
+    stopped = true;
+}
+
+void msgReactor::drain()
+{
+    for ( ;; ) {
+        {
+            std::unique_lock<std::mutex> l(lock);
+            idle.wait(l, [this] { return ready.empty() && running == 0; });
+            if (deferred.empty())
+                return;
+        }
+        runDeferred();
+    }
+}
+
+void msgReactor::run(const bool& quit, long interval)
+{
+    const int maxEvents = 64;
+    struct epoll_event events[maxEvents];
+
+    stopped = false;
+    while (!quit && !stopped) {
+        int n = epoll_wait(epfd, events, maxEvents, nextTimeout(interval));
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            syslog(LOG_ERR, "failed to epoll_wait: %m");
+            break;
+        }
+
+        for (int i = 0; i < n && !stopped; i++) {
+            int fd = events[i].data.fd;
+            uint32_t ev = events[i].events;
+            if (fd == evfd) {
+                runDeferred();
+                continue;
+            }
+
+            // Writer is called once, stop watching for write first.
+            auto w = writers.find(fd);
+            if (w != writers.end() && (ev & (EPOLLOUT | EPOLLERR | EPOLLHUP))) {
+                auto fn = std::move(w->second);
+                writers.erase(w);
+                struct epoll_event in = { 0 };
+                in.events = EPOLLIN;
+                in.data.fd = fd;
+                (void) epoll_ctl(epfd, EPOLL_CTL_MOD, fd, &in);
+                fn();
+            }
+            if (ev == EPOLLOUT)
+                continue;
+
+            // Handler may have been removed by an earlier one in this batch.
+            auto it = handlers.find(fd);
+            if (it == handlers.end())
+                continue;
+            auto handler = it->second;
+            handler(ev);
+        }
+        if (!stopped)
+            runTimers();
+    }
+}
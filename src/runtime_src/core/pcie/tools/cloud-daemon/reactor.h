@@ -0,0 +1,164 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Declaring an epoll based event loop serving the mailbox and socket fds of
+ * all boards from one thread.
+ */
+
+#ifndef REACTOR_H
+#define REACTOR_H
+
+#include <map>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include "common.h"
+
+/*
+ * Reader of framed sw channel msgs from one fd.
+ *
+ * A socket fd is expected to be non-blocking. The sw_chan header and the
+ * payload are read into the msg buffer as they arrive, a partial msg is
+ * kept until the fd is readable again. The payload size is taken from the
+ * header, so no MSG_PEEK is needed.
+ *
+ * A mailbox fd hands out one whole msg per read. The read is done into a
+ * buffer big enough for most msgs, only a bigger msg costs a second read
+ * after the driver fails the first one with EMSGSIZE and fills in the size.
+ *
+ * Buffers of handled msgs can be given back by recycle() and are reused
+ * for the next msg read.
+ */
+class msgReader {
+public:
+    msgReader(int fd, bool mailbox);
+
+    // Returns 1 when msg holds a complete msg, 0 if more data is needed
+    // and negative errno on error. A closed peer is reported as -EPIPE.
+    int readMsg(const pcieFunc& dev, std::unique_ptr<sw_msg>& msg);
+    // May be called from any thread.
+    void recycle(std::unique_ptr<sw_msg> msg);
+    int getFd() const;
+
+private:
+    int readMailbox(const pcieFunc& dev, std::unique_ptr<sw_msg>& msg);
+    int readSocket(const pcieFunc& dev, std::unique_ptr<sw_msg>& msg);
+    std::unique_ptr<std::vector<char>> getBuffer();
+
+    int fd;
+    bool mailbox;
+    std::unique_ptr<std::vector<char>> buf; // msg being read from socket
+    size_t cur = 0;
+    std::mutex spareLock;
+    std::unique_ptr<std::vector<char>> spare;
+};
+
+/*
+ * Where msgs read from one fd are passed on, see handleMsg().
+ */
+struct msgRoute {
+    enum MSG_TYPE type;
+    int localFd;
+    int remoteFd;
+    msgHandler cb;
+};
+
+/*
+ * Event loop multiplexing the fds of all boards with epoll.
+ *
+ * Fd handlers run on the thread calling run(). Msgs read from fds added by
+ * addMsgFd() are passed to handleMsg() on a small pool of worker threads,
+ * so a msg that takes long to handle, eg. downloading a large xclbin, does
+ * not hold up reading the mailbox of any board. Work posted under the same
+ * key, which is the board index for msgs, runs one at a time in the order
+ * it was posted.
+ */
+class msgReactor {
+public:
+    // Called on the reactor thread with the ready epoll events.
+    using fdHandler = std::function<void(uint32_t events)>;
+    // Called on the reactor thread when reading or handling a msg failed.
+    using errHandler = std::function<void(int err)>;
+
+    msgReactor(size_t workers);
+    ~msgReactor();
+
+    // Fd management, to be called before run() or on the reactor thread.
+    int addFd(int fd, fdHandler handler);
+    int addMsgFd(size_t key, const pcieFunc& dev, int fd, bool mailbox,
+        const msgRoute& route, errHandler onError);
+    void removeFd(int fd);
+    size_t fdCount() const;
+    // Call fn once on the reactor thread when fd is writable, fd must have
+    // been added. Also to be called on the reactor thread.
+    int watchWritable(int fd, std::function<void()> fn);
+
+    // Run work on a worker thread, one at a time per key.
+    void post(size_t key, std::function<void()> work);
+    // Run fn on the reactor thread, may be called from any thread.
+    void defer(std::function<void()> fn);
+    // Run fn on the reactor thread in secs seconds, may be called from any
+    // thread. Timers still pending when run() returns are dropped.
+    void deferAfter(long secs, std::function<void()> fn);
+
+    // Dispatch events until quit is set or stop() is called. The quit
+    // flag is checked at least every interval seconds.
+    void run(const bool& quit, long interval);
+    void stop();
+    // Wait for all posted work and run deferred fns after run() returned.
+    void drain();
+
+private:
+    struct strand {
+        std::deque<std::function<void()>> work;
+        bool busy = false;
+    };
+
+    void worker();
+    void wakeup();
+    void runDeferred();
+    void runTimers();
+    int nextTimeout(long interval);
+
+    int epfd = -1;
+    int evfd = -1;
+    bool stopped = false;
+    std::map<int, fdHandler> handlers;
+    std::map<int, std::function<void()>> writers;
+
+    std::mutex lock;
+    std::condition_variable cv;
+    std::condition_variable idle;
+    size_t running = 0;
+    std::map<size_t, strand> strands;
+    std::deque<size_t> ready;
+    std::vector<std::function<void()>> deferred;
+    std::multimap<std::chrono::steady_clock::time_point,
+        std::function<void()>> timers;
+    bool exiting = false;
+    std::vector<std::thread> threads;
+
+    msgReactor(const msgReactor&) = delete;
+    msgReactor& operator=(const msgReactor&) = delete;
+};
+
+#endif // REACTOR_H
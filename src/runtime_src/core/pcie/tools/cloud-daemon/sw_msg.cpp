@@ -40,6 +40,16 @@ sw_msg::sw_msg(size_t len)
     sc->sz = len;
 }
 
+sw_msg::sw_msg(std::unique_ptr<std::vector<char>> msgbuf) :
+    buf(std::move(msgbuf))
+{
+}
+
+std::unique_ptr<std::vector<char>> sw_msg::release()
+{
+    return std::move(buf);
+}
+
 size_t sw_msg::size()
 {
     return buf->size();
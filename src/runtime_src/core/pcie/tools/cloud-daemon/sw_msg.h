@@ -28,8 +28,13 @@ public:
     sw_msg(const void *payload, size_t len, uint64_t id, uint64_t flags);
     // Init a buffer ready to receive data.
     sw_msg(size_t len);
+    // Take over a buffer holding a msg read from a fd.
+    explicit sw_msg(std::unique_ptr<std::vector<char>> msgbuf);
     ~sw_msg();
 
+    // Give up the buffer, so it can be reused for another msg.
+    std::unique_ptr<std::vector<char>> release();
+
     size_t size();
     char *data();
     bool valid();
@@ -0,0 +1,498 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * In this file, we provide streamed transfer of xclbin download requests
+ * between mpd and msd.
+ */
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <syslog.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <cstddef>
+#include <cstring>
+#include <cstdlib>
+#include <chrono>
+#include <algorithm>
+
+#include "xclbin_xfer.h"
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+
+static const uint64_t fnvPrime = 0x100000001b3ULL;
+
+uint64_t xferHash(const char *data, size_t len, uint64_t hash)
+{
+    size_t i = 0;
+
+    for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+        uint64_t w;
+        std::memcpy(&w, data + i, sizeof(w));
+        hash = (hash ^ w) * fnvPrime;
+    }
+    for (; i < len; i++)
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * fnvPrime;
+    return hash;
+}
+
+bool isXferMsg(sw_msg& msg)
+{
+    auto sc = reinterpret_cast<sw_chan *>(msg.data());
+    return (sc->flags & XFER_MSG_FLAG) && msg.payloadSize() >= sizeof(xfer_hdr);
+}
+
+bool isXclbinReq(sw_msg& msg)
+{
+    auto sc = reinterpret_cast<sw_chan *>(msg.data());
+    if (!(sc->flags & MB_REQ_FLAG_REQUEST) ||
+        msg.payloadSize() < sizeof(mailbox_req))
+        return false;
+    auto req = reinterpret_cast<mailbox_req *>(msg.payloadData());
+    return req->req == MAILBOX_REQ_LOAD_XCLBIN;
+}
+
+// Frames written in one go before other boards get a turn.
+static const int maxBurst = 16;
+
+xferSender::xferSender(const pcieFunc& dev, const hooks& cbs, size_t chunk,
+    int timeout) : dev(dev), cbs(cbs), timeout(timeout)
+{
+    // Chunks must keep word alignment for incremental hashing at msd.
+    this->chunk = std::max<size_t>(chunk & ~(sizeof(uint64_t) - 1),
+        sizeof(uint64_t));
+    std::memset(pad, 0, sizeof(pad));
+    frame = msghdr();
+}
+
+void xferSender::send(std::unique_ptr<sw_msg> msg)
+{
+    pending p;
+    p.stream = isXclbinReq(*msg) && msg->payloadSize() > chunk;
+    // Hash the payload before taking the lock.
+    p.hash = p.stream ? xferHash(msg->payloadData(), msg->payloadSize()) : 0;
+    p.msg = std::move(msg);
+
+    std::lock_guard<std::mutex> l(lock);
+    queue.push_back(std::move(p));
+    pump();
+}
+
+void xferSender::ack(const xfer_hdr& hdr)
+{
+    std::lock_guard<std::mutex> l(lock);
+    if (!cur.msg || phase != PHASE_ACK || hdr.xid != cur.msg->id() ||
+        hdr.session != session)
+        return;
+
+    uint64_t size = cur.msg->payloadSize();
+    offset = hdr.offset;
+    if (offset > size || (offset % chunk && offset != size)) {
+        dev.log(LOG_ERR, "bad xclbin transfer ack offset %llu", offset);
+        offset = 0;
+    }
+    if (offset)
+        dev.log(LOG_INFO, "resuming xclbin transfer at %llu bytes", offset);
+    phase = PHASE_DATA;
+    progress = std::chrono::steady_clock::now();
+    pump();
+}
+
+void xferSender::writable()
+{
+    std::lock_guard<std::mutex> l(lock);
+    pump();
+}
+
+void xferSender::connected(int fd)
+{
+    std::lock_guard<std::mutex> l(lock);
+    sockfd = fd;
+    broken = false;
+    // Whatever was written of the frame is lost with the old socket.
+    frame.msg_iovlen = 0;
+    partial = false;
+    if (cur.msg && cur.stream)
+        phase = PHASE_BEGIN;
+    progress = std::chrono::steady_clock::now();
+    pump();
+}
+
+void xferSender::expire()
+{
+    std::lock_guard<std::mutex> l(lock);
+    armed = false;
+    if (!cur.msg)
+        return;
+
+    auto idle = std::chrono::steady_clock::now() - progress;
+    if (idle < std::chrono::seconds(timeout)) {
+        armTimer();
+        return;
+    }
+
+    dev.log(LOG_ERR, "msd is unreachable, msg 0x%llx dropped", cur.msg->id());
+    cbs.failed(*cur.msg, -ETIMEDOUT);
+    if (partial && sockfd >= 0) {
+        // Rest of the frame can't be skipped, start over on a new socket.
+        (void) shutdown(sockfd, SHUT_RDWR);
+        broken = true;
+    }
+    frame.msg_iovlen = 0;
+    partial = false;
+    finish();
+    pump();
+}
+
+bool xferSender::idle()
+{
+    std::lock_guard<std::mutex> l(lock);
+    return !cur.msg && queue.empty();
+}
+
+void xferSender::armTimer()
+{
+    if (cur.msg && !armed) {
+        auto left = std::chrono::seconds(timeout) -
+            (std::chrono::steady_clock::now() - progress);
+        int secs = std::chrono::duration_cast<std::chrono::seconds>(left).count();
+        armed = true;
+        cbs.wakeAfter(std::max(secs, 0) + 1);
+    }
+}
+
+void xferSender::finish()
+{
+    cur = pending();
+    phase = PHASE_MSG;
+}
+
+/*
+ * Write frames until the socket is full or there is nothing to write. The
+ * lock is held.
+ */
+void xferSender::pump()
+{
+    for (int n = 0; sockfd >= 0 && !broken; ) {
+        if (frame.msg_iovlen == 0) {
+            if (n++ == maxBurst) {
+                // Socket is still writable, come back after others.
+                cbs.waitWritable(sockfd);
+                break;
+            }
+            if (!nextFrame())
+                break;
+        }
+
+        int ret = flush();
+        if (ret == -EAGAIN) {
+            cbs.waitWritable(sockfd);
+            break;
+        }
+        if (ret) {
+            // Reactor finds the socket broken as well and reconnects.
+            dev.log(LOG_WARNING, "msg to msd cut off: %d, waiting for msd",
+                ret);
+            broken = true;
+            break;
+        }
+        frameDone();
+    }
+    armTimer();
+}
+
+/*
+ * Set up the next frame to write. Returns false if there is none for now.
+ */
+bool xferSender::nextFrame()
+{
+    if (!cur.msg) {
+        if (queue.empty())
+            return false;
+        cur = std::move(queue.front());
+        queue.pop_front();
+        phase = cur.stream ? PHASE_BEGIN : PHASE_MSG;
+        progress = std::chrono::steady_clock::now();
+    }
+
+    sw_msg& msg = *cur.msg;
+    uint64_t size = msg.payloadSize();
+    switch (phase) {
+    case PHASE_MSG:
+        iov[0] = { msg.data(), msg.size() };
+        frame.msg_iov = iov;
+        frame.msg_iovlen = 1;
+        break;
+    case PHASE_BEGIN:
+        setFrame({ XFER_BEGIN, ++session, msg.id(), 0, size, cur.hash },
+            nullptr, 0);
+        break;
+    case PHASE_ACK:
+        return false;
+    case PHASE_DATA:
+        if (offset < size) {
+            size_t len = std::min<uint64_t>(chunk, size - offset);
+            setFrame({ XFER_DATA, session, msg.id(), offset, 0, 0 },
+                msg.payloadData() + offset, len);
+            break;
+        }
+        phase = PHASE_END;
+        // fall through
+    case PHASE_END:
+        setFrame({ XFER_END, session, msg.id(), size, 0, 0 }, nullptr, 0);
+        break;
+    }
+    return true;
+}
+
+/*
+ * Move on after the frame is written.
+ */
+void xferSender::frameDone()
+{
+    switch (phase) {
+    case PHASE_MSG:
+        finish();
+        break;
+    case PHASE_BEGIN:
+        phase = PHASE_ACK;
+        break;
+    case PHASE_DATA:
+        offset += sc.sz - sizeof(xfer_hdr);
+        break;
+    case PHASE_END:
+        dev.log(LOG_INFO, "sent xclbin transfer of %llu bytes",
+            cur.msg->payloadSize());
+        finish();
+        break;
+    default:
+        break;
+    }
+}
+
+/*
+ * A transfer msg made of hdr and len bytes at data, written straight from
+ * where the bytes are.
+ */
+void xferSender::setFrame(const xfer_hdr& h, const char *data, size_t len)
+{
+    sc = sw_chan();
+    sc.sz = sizeof(h) + len;
+    sc.flags = XFER_MSG_FLAG;
+    sc.id = h.xid;
+    hdr = h;
+
+    iov[0] = { &sc, offsetof(sw_chan, data) };
+    iov[1] = { &hdr, sizeof(hdr) };
+    iov[2] = { const_cast<char *>(data), len };
+    iov[3] = { pad, sizeof(pad) };
+    frame.msg_iov = iov;
+    frame.msg_iovlen = 4;
+}
+
+/*
+ * Write what is left of the frame. Returns 0 once all of it is written,
+ * -EAGAIN if the socket is full, or negative errno.
+ */
+int xferSender::flush()
+{
+    while (frame.msg_iovlen) {
+        ssize_t ret = sendmsg(sockfd, &frame, MSG_NOSIGNAL);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return -EAGAIN;
+            return -errno;
+        }
+        partial = true;
+        progress = std::chrono::steady_clock::now();
+
+        // Skip what is written.
+        while (frame.msg_iovlen &&
+            static_cast<size_t>(ret) >= frame.msg_iov->iov_len) {
+            ret -= frame.msg_iov->iov_len;
+            frame.msg_iov++;
+            frame.msg_iovlen--;
+        }
+        if (frame.msg_iovlen) {
+            frame.msg_iov->iov_base =
+                static_cast<char *>(frame.msg_iov->iov_base) + ret;
+            frame.msg_iov->iov_len -= ret;
+        }
+    }
+    partial = false;
+    return 0;
+}
+
+xferStage::xferStage(uint64_t xid, uint64_t size, uint64_t hash) :
+    xid(xid), size(size), hash(hash)
+{
+#ifdef SYS_memfd_create
+    fd = syscall(SYS_memfd_create, "xclbin", MFD_CLOEXEC);
+#endif
+    if (fd < 0) {
+        char path[] = "/tmp/xclbin.XXXXXX";
+        fd = mkstemp(path);
+        if (fd >= 0)
+            unlink(path);
+    }
+    if (fd >= 0 && ftruncate(fd, size) != 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+xferStage::~xferStage()
+{
+    if (addr)
+        munmap(addr, size);
+    if (fd >= 0)
+        close(fd);
+}
+
+bool xferStage::valid() const
+{
+    return fd >= 0;
+}
+
+bool xferStage::matches(const xfer_hdr& hdr) const
+{
+    return xid == hdr.xid && size == hdr.size && hash == hdr.hash;
+}
+
+int xferStage::write(const char *buf, size_t len)
+{
+    size_t cur = 0;
+
+    while (cur < len) {
+        ssize_t ret = pwrite(fd, buf + cur, len - cur, received + cur);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0)
+            return ret < 0 ? -errno : -EIO;
+        cur += ret;
+    }
+    receivedHash = xferHash(buf, len, receivedHash);
+    received += len;
+    return 0;
+}
+
+char *xferStage::map()
+{
+    if (addr == nullptr && size) {
+        // Private mapping, handed out as writable without copying pages
+        addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED)
+            addr = nullptr;
+    }
+    return static_cast<char *>(addr);
+}
+
+static std::unique_ptr<sw_msg> xferResponse(int ret, uint64_t xid)
+{
+    return std::make_unique<sw_msg>(&ret, sizeof(ret), xid,
+        MB_REQ_FLAG_RESPONSE);
+}
+
+int xferReceiver::recv(const pcieFunc& dev, sw_msg& msg,
+    std::unique_ptr<sw_msg>& reply, std::unique_ptr<xferStage>& done)
+{
+    if (!isXferMsg(msg)) {
+        dev.log(LOG_ERR, "bad xclbin transfer msg");
+        return -EINVAL;
+    }
+
+    std::lock_guard<std::mutex> l(lock);
+    auto hdr = reinterpret_cast<xfer_hdr *>(msg.payloadData());
+    const char *data = msg.payloadData() + sizeof(xfer_hdr);
+    size_t len = msg.payloadSize() - sizeof(xfer_hdr);
+
+    switch (hdr->op) {
+    case XFER_BEGIN: {
+        if (stage && stage->matches(*hdr)) {
+            dev.log(LOG_INFO, "resuming xclbin transfer at %llu bytes",
+                stage->received);
+        } else {
+            // Same limit as a msg sent as is, nothing to stage if empty.
+            if (hdr->size == 0 || hdr->size > maxMsgSize) {
+                dev.log(LOG_ERR, "bad xclbin transfer size %llu", hdr->size);
+                stage.reset();
+                reply = xferResponse(-EINVAL, hdr->xid);
+                return FOR_REMOTE;
+            }
+            stage = std::make_unique<xferStage>(hdr->xid, hdr->size, hdr->hash);
+            if (!stage->valid()) {
+                dev.log(LOG_ERR, "failed to stage xclbin transfer: %m");
+                stage.reset();
+                reply = xferResponse(-ENOMEM, hdr->xid);
+                return FOR_REMOTE;
+            }
+        }
+        stage->session = hdr->session;
+        xfer_hdr ack = { XFER_ACK, hdr->session, hdr->xid, stage->received,
+            0, 0 };
+        reply = std::make_unique<sw_msg>(&ack, sizeof(ack), hdr->xid,
+            XFER_MSG_FLAG);
+        return FOR_REMOTE;
+    }
+    case XFER_DATA:
+        // Out of sequence chunk is dropped, END will tell.
+        if (!stage || stage->xid != hdr->xid ||
+            stage->session != hdr->session ||
+            hdr->offset != stage->received ||
+            stage->received + len > stage->size) {
+            dev.log(LOG_WARNING, "xclbin transfer chunk at %llu dropped",
+                hdr->offset);
+            return FOR_NONE;
+        }
+        if (stage->write(data, len) != 0) {
+            dev.log(LOG_ERR, "failed to stage xclbin chunk: %m");
+            stage.reset();
+        }
+        return FOR_NONE;
+    case XFER_END: {
+        if (!stage || stage->xid != hdr->xid) {
+            dev.log(LOG_ERR, "xclbin transfer ended without data");
+            reply = xferResponse(-EIO, hdr->xid);
+            return FOR_REMOTE;
+        }
+        if (stage->session != hdr->session) {
+            dev.log(LOG_WARNING, "stale xclbin transfer end dropped");
+            return FOR_NONE;
+        }
+        std::unique_ptr<xferStage> s = std::move(stage);
+        if (s->received != s->size || s->receivedHash != s->hash) {
+            dev.log(LOG_ERR, "xclbin transfer corrupted, %llu of %llu bytes",
+                s->received, s->size);
+            reply = xferResponse(-EIO, hdr->xid);
+            return FOR_REMOTE;
+        }
+        done = std::move(s);
+        return FOR_NONE;
+    }
+    default:
+        dev.log(LOG_ERR, "bad xclbin transfer op %d", hdr->op);
+        return -EINVAL;
+    }
+}
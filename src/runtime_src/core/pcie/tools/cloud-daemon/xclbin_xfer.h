@@ -0,0 +1,219 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Declaring streamed transfer of xclbin download requests from mpd to msd.
+ *
+ * Instead of one sw_msg holding the whole request, mpd sends
+ *   BEGIN  - xid, size and hash of the request payload
+ *   DATA   - one chunk of the payload at offset, in order
+ *   END    - all chunks are sent
+ * msd answers BEGIN with ACK carrying the number of bytes it already has,
+ * which is 0 unless the same transfer was cut off by a socket reset, in
+ * which case mpd resumes from there after reconnecting. Chunks still in
+ * flight on the old socket are told apart by the session in the header.
+ * Chunks are staged in a memfd at msd, which is mapped and handed to the
+ * download ioctl once size and hash are verified at END. The answer to the
+ * request is the same response msg as without streaming.
+ *
+ * Transfer msgs are marked by XFER_MSG_FLAG in sw_chan flags and never make
+ * it to the mailbox. msd advertises support with "xfer=1" in the mailbox
+ * comm config, mpd only streams to a msd which does.
+ */
+
+#ifndef XCLBIN_XFER_H
+#define XCLBIN_XFER_H
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <deque>
+#include <chrono>
+#include <functional>
+#include "common.h"
+
+#define XFER_MSG_FLAG   (1ULL << 63)
+#define XFER_VERSION    1
+
+enum xfer_op {
+    XFER_BEGIN = 1,
+    XFER_DATA,
+    XFER_END,
+    XFER_ACK,
+};
+
+struct xfer_hdr {
+    uint32_t op;
+    uint32_t session;   // BEGIN count of the sender, older chunks are dropped
+    uint64_t xid;       // id of the mailbox request
+    uint64_t offset;    // DATA: chunk offset, ACK: bytes received
+    uint64_t size;      // BEGIN: payload size
+    uint64_t hash;      // BEGIN: payload hash
+};
+
+// Chunk size keeping msgs under the size reactor buffers are reused for.
+const size_t xferChunkSize = 1024 * 1024 - sizeof(sw_chan) - sizeof(xfer_hdr);
+
+// 64 bit FNV-1a over 8 byte words, tail bytes one by one.
+const uint64_t xferHashInit = 0xcbf29ce484222325ULL;
+uint64_t xferHash(const char *data, size_t len, uint64_t hash = xferHashInit);
+
+bool isXferMsg(sw_msg& msg);
+// Whether msg is a xclbin download request worth streaming.
+bool isXclbinReq(sw_msg& msg);
+
+/*
+ * mpd side, one per board. All msgs from the board to a msd supporting
+ * streamed transfer go through the sender, so no msg gets in the middle of
+ * a transfer msg written in pieces.
+ *
+ * Nothing blocks. Msgs are written until the socket is full, then writing
+ * resumes when the socket is writable again, and chunks of a transfer are
+ * only written after msd ACKs its BEGIN. Calls may come from any thread.
+ */
+class xferSender {
+public:
+    /*
+     * Called back with the sender locked, so none of them may call into
+     * the sender directly.
+     */
+    struct hooks {
+        // Call writable() once fd can take more data.
+        std::function<void(int fd)> waitWritable;
+        // Call expire() in secs seconds.
+        std::function<void(int secs)> wakeAfter;
+        // msg is dropped, msd stayed unreachable for timeout seconds.
+        std::function<void(sw_msg& msg, int err)> failed;
+    };
+
+    xferSender(const pcieFunc& dev, const hooks& cbs,
+        size_t chunk = xferChunkSize, int timeout = 30);
+
+    // Queue msg for msd. A xclbin download request bigger than a chunk is
+    // streamed, any other msg is written as is.
+    void send(std::unique_ptr<sw_msg> msg);
+    // ACK received from msd.
+    void ack(const xfer_hdr& hdr);
+    // Socket to msd is writable.
+    void writable();
+    // Socket to msd is up, or gone if fd is -1. Msg cut off by a socket
+    // reset is sent again, a transfer is resumed from where msd is.
+    void connected(int fd);
+    // Drop the msg being sent if msd made no progress for timeout seconds.
+    void expire();
+    // Whether all queued msgs are written.
+    bool idle();
+
+private:
+    enum xferPhase {
+        PHASE_MSG,      // writing a msg as is
+        PHASE_BEGIN,    // writing BEGIN
+        PHASE_ACK,      // waiting for ACK of BEGIN
+        PHASE_DATA,     // writing chunks
+        PHASE_END,      // writing END
+    };
+    struct pending {
+        std::unique_ptr<sw_msg> msg;
+        bool stream = false;
+        uint64_t hash = 0;
+    };
+
+    void pump();
+    bool nextFrame();
+    void frameDone();
+    void setFrame(const xfer_hdr& hdr, const char *data, size_t len);
+    int flush();
+    void finish();
+    void armTimer();
+
+    const pcieFunc& dev;
+    hooks cbs;
+    size_t chunk;
+    int timeout;
+    std::mutex lock;
+    int sockfd = -1;
+    bool broken = false;    // socket failed, wait for connected()
+    bool armed = false;
+    std::chrono::steady_clock::time_point progress;
+
+    std::deque<pending> queue;
+    pending cur;            // msg being sent, if any
+    xferPhase phase = PHASE_MSG;
+    uint64_t offset = 0;
+    uint32_t session = 0;
+
+    // Frame being written, frame.msg_iov is what is left of it.
+    sw_chan sc;
+    xfer_hdr hdr;
+    char pad[sizeof(sw_chan) - offsetof(sw_chan, data)];
+    struct iovec iov[4];
+    struct msghdr frame;
+    bool partial = false;
+
+    xferSender(const xferSender&) = delete;
+    xferSender& operator=(const xferSender&) = delete;
+};
+
+/*
+ * Request payload staged in a memfd, mapped for the download ioctl.
+ */
+class xferStage {
+public:
+    xferStage(uint64_t xid, uint64_t size, uint64_t hash);
+    ~xferStage();
+
+    bool valid() const;
+    bool matches(const xfer_hdr& hdr) const;
+    int write(const char *buf, size_t len);
+    // Map the staged payload after all of it is received and verified.
+    char *map();
+
+    uint64_t xid;
+    uint64_t size;
+    uint64_t hash;
+    uint64_t received = 0;
+    uint64_t receivedHash = xferHashInit;
+    uint32_t session = 0;
+
+private:
+    int fd = -1;
+    void *addr = nullptr;
+
+    xferStage(const xferStage&) = delete;
+    xferStage& operator=(const xferStage&) = delete;
+};
+
+/*
+ * msd side, one per board. Kept across mpd reconnects so a transfer can be
+ * resumed.
+ */
+class xferReceiver {
+public:
+    // Handle a transfer msg from mpd. reply is set to a msg for mpd, if
+    // any. When a transfer is complete and verified, done is set to its
+    // stage. Returns FOR_REMOTE if there is a reply, FOR_NONE if not, or
+    // negative errno if the msg is bad.
+    int recv(const pcieFunc& dev, sw_msg& msg, std::unique_ptr<sw_msg>& reply,
+        std::unique_ptr<xferStage>& done);
+
+private:
+    std::mutex lock;
+    std::unique_ptr<xferStage> stage;
+};
+
+#endif // XCLBIN_XFER_H
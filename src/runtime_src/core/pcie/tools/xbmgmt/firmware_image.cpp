@@ -19,16 +19,23 @@
 #include <climits>
 #include <iomanip>
 #include <memory>
+#include <map>
 #include <regex>
+#include <set>
 #include <sstream>
 #include <unistd.h>
 #include <dirent.h>
 #include <stdint.h>
+#include <sys/stat.h>
 #include "boost/filesystem.hpp"
+#include "boost/property_tree/ptree.hpp"
+#include "boost/property_tree/json_parser.hpp"
 #include "firmware_image.h"
 #include "xclbin.h"
 
 #define hex_digit "([0-9a-fA-F]+)"
+// bump when the layout of firmware index entries changes
+#define FIRMWARE_INDEX_VERSION 1
 
 using namespace boost::filesystem;
 /*
@@ -350,24 +357,197 @@ bool DSAInfo::matchId(DSAInfo& dsa)
     return false;
 }
 
+/*
+ * Persistent index of DSA info parsed from installed firmware files.
+ * Entries are keyed by file path and only valid as long as the size and
+ * modification time of the file are unchanged.
+ */
+class firmwareIndex
+{
+public:
+    firmwareIndex(const std::string& indexFile) : mIndexFile(indexFile)
+    {
+        load();
+    }
+
+    // DSA info of file, parse() is only called if the index has none or
+    // the file changed since it was indexed
+    template <typename Parse>
+    DSAInfo get(const std::string& file, Parse parse)
+    {
+        struct stat st;
+        if (mIndexFile.empty() || stat(file.c_str(), &st) != 0)
+            return parse();
+
+        uint64_t size = st.st_size;
+        uint64_t mtime = uint64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+        mSeen.insert(file);
+
+        auto it = mEntries.find(file);
+        if (it != mEntries.end() && it->second.size == size && it->second.mtime == mtime)
+            return it->second.dsa;
+
+        DSAInfo dsa = parse();
+        if (it != mEntries.end())
+            mEntries.erase(it);
+        mEntries.emplace(file, entry{ size, mtime, dsa });
+        mDirty = true;
+        return dsa;
+    }
+
+    // Write the index back, dropping files which are no longer installed
+    void save()
+    {
+        for (auto it = mEntries.begin(); it != mEntries.end(); ) {
+            if (mSeen.count(it->first) == 0) {
+                it = mEntries.erase(it);
+                mDirty = true;
+            } else {
+                ++it;
+            }
+        }
+        if (mIndexFile.empty() || !mDirty)
+            return;
+
+        boost::property_tree::ptree entries;
+        for (auto& e : mEntries) {
+            const DSAInfo& dsa = e.second.dsa;
+            boost::property_tree::ptree pt;
+            pt.put("file", e.first);
+            pt.put("size", e.second.size);
+            pt.put("mtime", e.second.mtime);
+            pt.put("has_flash_image", dsa.hasFlashImage);
+            pt.put("vendor", dsa.vendor);
+            pt.put("board", dsa.board);
+            pt.put("name", dsa.name);
+            pt.put("timestamp", dsa.timestamp);
+            boost::property_tree::ptree uuids;
+            for (auto& uuid : dsa.uuids) {
+                boost::property_tree::ptree u;
+                u.put("", uuid);
+                uuids.push_back(std::make_pair("", u));
+            }
+            pt.add_child("uuids", uuids);
+            pt.put("bmc_ver", dsa.bmcVer);
+            pt.put("vendor_id", dsa.vendor_id);
+            pt.put("device_id", dsa.device_id);
+            pt.put("subsystem_id", dsa.subsystem_id);
+            pt.put("partition_family_name", dsa.partition_family_name);
+            pt.put("partition_name", dsa.partition_name);
+            pt.put("build_ident", dsa.build_ident);
+            entries.push_back(std::make_pair("", pt));
+        }
+        boost::property_tree::ptree root;
+        root.put("version", FIRMWARE_INDEX_VERSION);
+        root.add_child("entries", entries);
+
+        // Failing to write the index, e.g. when not running as root, only
+        // costs the next scan its speed
+        boost::system::error_code ec;
+        path dir = path(mIndexFile).parent_path();
+        if (!dir.empty())
+            create_directories(dir, ec);
+        std::string tmp = mIndexFile + "." + std::to_string(getpid());
+        try {
+            boost::property_tree::write_json(tmp, root, std::locale(), false);
+        } catch (const std::exception&) {
+            unlink(tmp.c_str());
+            return;
+        }
+        if (rename(tmp.c_str(), mIndexFile.c_str()) != 0)
+            unlink(tmp.c_str());
+    }
+
+private:
+    struct entry
+    {
+        uint64_t size;
+        uint64_t mtime;
+        DSAInfo dsa;
+    };
+
+    void load()
+    {
+        if (mIndexFile.empty())
+            return;
+
+        boost::property_tree::ptree root;
+        try {
+            boost::property_tree::read_json(mIndexFile, root);
+            if (root.get<int>("version") != FIRMWARE_INDEX_VERSION)
+                return;
+            for (auto& e : root.get_child("entries")) {
+                const boost::property_tree::ptree& pt = e.second;
+                DSAInfo dsa("");
+                dsa.file = pt.get<std::string>("file");
+                dsa.hasFlashImage = pt.get<bool>("has_flash_image");
+                dsa.vendor = pt.get<std::string>("vendor");
+                dsa.board = pt.get<std::string>("board");
+                dsa.name = pt.get<std::string>("name");
+                dsa.timestamp = pt.get<uint64_t>("timestamp");
+                for (auto& u : pt.get_child("uuids"))
+                    dsa.uuids.push_back(u.second.get_value<std::string>());
+                dsa.bmcVer = pt.get<std::string>("bmc_ver");
+                dsa.vendor_id = pt.get<uint16_t>("vendor_id");
+                dsa.device_id = pt.get<uint16_t>("device_id");
+                dsa.subsystem_id = pt.get<uint16_t>("subsystem_id");
+                dsa.partition_family_name = pt.get<std::string>("partition_family_name");
+                dsa.partition_name = pt.get<std::string>("partition_name");
+                dsa.build_ident = pt.get<std::string>("build_ident");
+                mEntries.emplace(dsa.file,
+                    entry{ pt.get<uint64_t>("size"), pt.get<uint64_t>("mtime"), dsa });
+            }
+        } catch (const std::exception&) {
+            // Missing or corrupt index, start over
+            mEntries.clear();
+            mDirty = true;
+        }
+    }
+
+    std::string mIndexFile;
+    std::map<std::string, entry> mEntries;
+    std::set<std::string> mSeen;
+    bool mDirty = false;
+};
+
+// Escape characters with special meaning in a regular expression
+static std::string regexEscape(const std::string& str)
+{
+    static const std::string special = "\\^$.|?*+()[]{}";
+    std::string escaped;
+    for (char c : str) {
+        if (special.find(c) != std::string::npos)
+            escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
 std::vector<DSAInfo> firmwareImage::installedDSA;
 
 std::vector<DSAInfo>& firmwareImage::getIntalledDSAs()
 {
-    if (!installedDSA.empty())
-        return installedDSA;
+    if (installedDSA.empty())
+        installedDSA = scanInstalledDSAs(FIRMWARE_DIR, FORMATTED_FW_DIR, FIRMWARE_INDEX_FILE);
+    return installedDSA;
+}
 
+std::vector<DSAInfo> firmwareImage::scanInstalledDSAs(const std::string& fwDir,
+    const std::string& formattedFwDir, const std::string& indexFile)
+{
+    std::vector<DSAInfo> dsas;
+    firmwareIndex index(indexFile);
     struct dirent *entry;
     DIR *dp;
     std::string nm;
 
     // Obtain installed DSA info.
-    dp = opendir(FIRMWARE_DIR);
+    dp = opendir(fwDir.c_str());
     if (dp)
     {
         while ((entry = readdir(dp)))
         {
-            std::string d(FIRMWARE_DIR);
+            std::string d(fwDir);
             std::string e(entry->d_name);
 
             /*
@@ -379,23 +559,26 @@ std::vector<DSAInfo>& firmwareImage::getIntalledDSAs()
                 (e.find(DSABIN_FILE_SUFFIX) == std::string::npos))
                 continue;
 
-            DSAInfo dsa(d + e);
-            installedDSA.push_back(dsa);
+            std::string file = d + e;
+            dsas.push_back(index.get(file, [&file]() { return DSAInfo(file); }));
         }
         closedir(dp);
     }
 
-    dp = opendir(FORMATTED_FW_DIR);
+    dp = opendir(formattedFwDir.c_str());
     if (!dp)
-        return installedDSA;
+    {
+        index.save();
+        return dsas;
+    }
     closedir(dp);
 
-    path formatted_fw_dir(FORMATTED_FW_DIR);
+    path formatted_fw_dir(formattedFwDir);
     std::vector<std::string> suffix = { XSABIN_FILE_SUFFIX, DSABIN_FILE_SUFFIX};
 
     for (std::string t : suffix) {
 
-        std::regex e("^" FORMATTED_FW_DIR "/" hex_digit "-" hex_digit "-" hex_digit "/(.+)/(.+)/(.+)/" hex_digit "\\." + t);
+        std::regex e("^" + regexEscape(formattedFwDir) + "/" hex_digit "-" hex_digit "-" hex_digit "/(.+)/(.+)/(.+)/" hex_digit "\\." + t);
         std::cmatch cm;
 
         for (recursive_directory_iterator iter(formatted_fw_dir, symlink_option::recurse), end;
@@ -415,8 +598,9 @@ std::vector<DSAInfo>& firmwareImage::getIntalledDSAs()
                 std::string pr_family = cm.str(4);
                 std::string pr_name = cm.str(5);
                 std::string build_ident = cm.str(6);
-                DSAInfo dsa(name, vid, did, subsys_id, pr_family, pr_name, build_ident);
-                installedDSA.push_back(dsa);
+                dsas.push_back(index.get(name, [&]() {
+                    return DSAInfo(name, vid, did, subsys_id, pr_family, pr_name, build_ident);
+                }));
                 iter.pop();
             } else if (iter.level() > 4)
                 iter.pop();
@@ -436,7 +620,8 @@ std::vector<DSAInfo>& firmwareImage::getIntalledDSAs()
         }
     }
 
-    return installedDSA;
+    index.save();
+    return dsas;
 }
 
 std::ostream& operator<<(std::ostream& stream, const DSAInfo& dsa)
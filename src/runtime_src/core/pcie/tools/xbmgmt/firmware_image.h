@@ -31,6 +31,8 @@
 // directory where all MCS files are saved
 #define FIRMWARE_DIR        "/lib/firmware/xilinx/"
 #define FORMATTED_FW_DIR    "/opt/xilinx/firmware"
+// index of DSA info parsed from installed firmware files
+#define FIRMWARE_INDEX_FILE "/var/cache/xilinx/xbmgmt_firmware_index.json"
 #define DSA_FILE_SUFFIX     "mcs"
 #define DSABIN_FILE_SUFFIX  "dsabin"
 #define XSABIN_FILE_SUFFIX  "xsabin"
@@ -80,6 +82,15 @@ public:
     firmwareImage(const char *file, imageType type);
     ~firmwareImage();
     static std::vector<DSAInfo>& getIntalledDSAs();
+    /*
+     * Scan @fwDir and @formattedFwDir for installed DSAs.  DSA info of
+     * files unchanged (same size and mtime) since they were recorded in
+     * @indexFile is taken from the index, only new or changed files are
+     * opened and parsed.  The index is rewritten when anything changed,
+     * an empty @indexFile disables indexing.
+     */
+    static std::vector<DSAInfo> scanInstalledDSAs(const std::string& fwDir,
+        const std::string& formattedFwDir, const std::string& indexFile);
 private:
     static std::vector<DSAInfo> installedDSA;
     int mType;
@@ -0,0 +1,245 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+#include <algorithm>
+#include <cstring>
+#include <errno.h>
+#include "mcs_image.h"
+
+// Bytes read from the stream at a time
+#define MCS_CHUNK_SIZE  (1024 * 1024)
+// Characters per data record of a typical 16 byte per record MCS file
+#define MCS_LINE_SIZE   44
+#define MCS_HEX_INVALID 0xff
+
+namespace {
+
+struct hexTable
+{
+    unsigned char value[256];
+
+    hexTable()
+    {
+        std::memset(value, MCS_HEX_INVALID, sizeof(value));
+        for (int i = 0; i < 10; i++)
+            value['0' + i] = i;
+        for (int i = 0; i < 6; i++) {
+            value['A' + i] = 10 + i;
+            value['a' + i] = 10 + i;
+        }
+    }
+};
+
+static const hexTable hex;
+
+// Decode count bytes from 2*count hex characters, returns false on any
+// invalid character
+static bool
+decode(const char *src, unsigned char *dst, unsigned count)
+{
+    unsigned char invalid = 0;
+    const unsigned char *s = reinterpret_cast<const unsigned char *>(src);
+    for (unsigned i = 0; i < count; i++, s += 2) {
+        unsigned char hi = hex.value[s[0]];
+        unsigned char lo = hex.value[s[1]];
+        invalid |= hi | lo;
+        dst[i] = static_cast<unsigned char>((hi << 4) | (lo & 0xf));
+    }
+    return (invalid & 0xf0) == 0;
+}
+
+}
+
+int mcsImage::parseRecord(const char *line, const char *end)
+{
+    mLineNo++;
+
+    // Ignore line endings and blank lines
+    while (end > line && (end[-1] == '\r' || end[-1] == ' ' || end[-1] == '\t'))
+        end--;
+    if (line == end)
+        return 0;
+
+    if (line[0] != ':' || end - line < 11) {
+        std::cout << "ERROR: Invalid MCS record at line " << mLineNo << std::endl;
+        return -EINVAL;
+    }
+
+    // Record header: length, address, type
+    unsigned char header[4];
+    if (!decode(line + 1, header, 4)) {
+        std::cout << "ERROR: Invalid MCS record at line " << mLineNo << std::endl;
+        return -EINVAL;
+    }
+    const unsigned dataLen = header[0];
+    const unsigned address = (header[1] << 8) | header[2];
+    const unsigned recordType = header[3];
+
+    if (static_cast<size_t>(end - line) < 11 + 2 * dataLen) {
+        std::cout << "ERROR: Truncated MCS record at line " << mLineNo << std::endl;
+        return -EINVAL;
+    }
+
+    // Data records are decoded straight into the image
+    unsigned char buf[256];
+    unsigned char *data = buf;
+    if (recordType == 0x00) {
+        size_t offset = mData.size();
+        mData.resize(offset + dataLen);
+        data = mData.data() + offset;
+    }
+
+    unsigned char checksum;
+    if (!decode(line + 9, data, dataLen) || !decode(line + 9 + 2 * dataLen, &checksum, 1)) {
+        std::cout << "ERROR: Invalid MCS record at line " << mLineNo << std::endl;
+        return -EINVAL;
+    }
+
+    unsigned char sum = header[0] + header[1] + header[2] + header[3] + checksum;
+    for (unsigned i = 0; i < dataLen; i++)
+        sum += data[i];
+    if (sum != 0) {
+        std::cout << "ERROR: MCS checksum mismatch at line " << mLineNo << std::endl;
+        return -EINVAL;
+    }
+
+    switch (recordType) {
+    case 0x00:
+    {
+        if (!mStarted) {
+            std::cout << "ERROR: MCS data record before address record at line " << mLineNo << std::endl;
+            return -EINVAL;
+        }
+        if (address != mCurrent.size + (mCurrent.startAddress & 0xFFFF)) {
+            if (mCurrent.size == 0) {
+                // First data record of extent
+                mCurrent.startAddress += address;
+            } else {
+                std::cout << "Address is not contiguous ! " << std::endl;
+                return -EINVAL;
+            }
+        }
+        mCurrent.size += dataLen;
+        break;
+    }
+    case 0x01:
+    {
+        if (!mStarted)
+            break;
+        if (mCurrent.size)
+            mExtents.push_back(mCurrent);
+        mEndFound = true;
+        break;
+    }
+    case 0x04:
+    {
+        if (address != 0x0 || dataLen != 2) {
+            std::cout << "ERROR: Invalid MCS address record at line " << mLineNo << std::endl;
+            return -EINVAL;
+        }
+        // Finish the old extent and start a new one
+        if (mStarted && mCurrent.size)
+            mExtents.push_back(mCurrent);
+        mCurrent.startAddress = ((data[0] << 8) | data[1]) << 16;
+        mCurrent.size = 0;
+        mCurrent.offset = mData.size();
+        mStarted = true;
+        break;
+    }
+    case 0x02:
+    {
+        std::cout << "ERROR: Unsupported MCS segment address record at line " << mLineNo << std::endl;
+        return -EINVAL;
+    }
+    default:
+        // Start address records do not affect the image
+        break;
+    }
+
+    return 0;
+}
+
+int mcsImage::parse(std::istream& mcsStream)
+{
+    mData.clear();
+    mExtents.clear();
+    mCurrent = extent();
+    mStarted = false;
+    mEndFound = false;
+    mLineNo = 0;
+
+    // Size the image up front from the stream length
+    std::streampos pos = mcsStream.tellg();
+    mcsStream.seekg(0, mcsStream.end);
+    std::streampos end = mcsStream.tellg();
+    mcsStream.seekg(pos);
+    if (pos >= 0 && end > pos)
+        mData.reserve((end - pos) / MCS_LINE_SIZE * 16 + 16);
+
+    std::vector<char> chunk(MCS_CHUNK_SIZE);
+    std::string partial;   // line spanning two chunks
+    int ret = 0;
+
+    while (!mEndFound && ret == 0 && mcsStream.good()) {
+        mcsStream.read(chunk.data(), chunk.size());
+        const char *p = chunk.data();
+        const char *e = p + mcsStream.gcount();
+        if (p == e)
+            break;
+
+        while (p < e && !mEndFound && ret == 0) {
+            const char *nl = static_cast<const char *>(std::memchr(p, '\n', e - p));
+            if (nl == nullptr) {
+                partial.append(p, e);
+                break;
+            }
+            if (partial.empty()) {
+                ret = parseRecord(p, nl);
+            } else {
+                partial.append(p, nl);
+                ret = parseRecord(partial.data(), partial.data() + partial.size());
+                partial.clear();
+            }
+            p = nl + 1;
+        }
+    }
+
+    if (ret == 0 && !mEndFound && !partial.empty())
+        ret = parseRecord(partial.data(), partial.data() + partial.size());
+
+    if (ret == 0 && !mEndFound) {
+        std::cout << "ERROR: MCS end of file record not found" << std::endl;
+        ret = -EINVAL;
+    }
+
+    mcsStream.clear();
+    if (ret) {
+        mData.clear();
+        mExtents.clear();
+    }
+    return ret;
+}
+
+std::string mcsImage::flatten(unsigned char fill) const
+{
+    size_t size = 0;
+    for (auto& ext : mExtents)
+        size = std::max<size_t>(size, size_t(ext.startAddress) + ext.size);
+
+    std::string flat(size, static_cast<char>(fill));
+    for (auto& ext : mExtents)
+        std::memcpy(&flat[ext.startAddress], data(ext), ext.size);
+    return flat;
+}
@@ -0,0 +1,86 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef _MCS_IMAGE_H_
+#define _MCS_IMAGE_H_
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/*
+ * Binary flash image decoded from an MCS (Intel HEX) file.
+ *
+ * The stream is decoded in large chunks with a table driven hex decoder,
+ * record checksums are validated.  The data of all records is stored in
+ * one contiguous buffer, with one extent per extended linear address
+ * record describing where its data goes in flash.
+ */
+class mcsImage
+{
+public:
+    struct extent
+    {
+        unsigned startAddress;  // flash address of first byte
+        unsigned size;          // bytes of data
+        size_t offset;          // offset of data in image buffer
+    };
+
+    /*
+     * Decode an MCS stream from its current position up to the end of
+     * file record.  Returns 0 on success, -EINVAL if the stream is not a
+     * well formed MCS file.
+     */
+    int parse(std::istream& mcsStream);
+
+    const std::vector<extent>& extents() const
+    {
+        return mExtents;
+    }
+
+    const unsigned char *data(const extent& ext) const
+    {
+        return mData.data() + ext.offset;
+    }
+
+    /*
+     * Total bytes of data in all extents
+     */
+    size_t size() const
+    {
+        return mData.size();
+    }
+
+    /*
+     * Flat image from address 0 to end of last extent, gaps filled
+     * with @fill
+     */
+    std::string flatten(unsigned char fill = 0xff) const;
+
+private:
+    int parseRecord(const char *line, const char *end);
+
+    std::vector<unsigned char> mData;
+    std::vector<extent> mExtents;
+
+    // Parse state
+    extent mCurrent;
+    bool mStarted = false;
+    bool mEndFound = false;
+    size_t mLineNo = 0;
+};
+
+#endif
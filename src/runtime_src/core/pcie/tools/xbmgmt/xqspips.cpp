@@ -19,7 +19,9 @@
 #include <iostream>
 #include <cassert>
 #include <cstring>
+#include <sstream>
 #include "xqspips.h"
+#include "mcs_image.h"
 #include "core/pcie/driver/linux/include/mgmt-reg.h"
 #include "flasher.h"
 
@@ -338,8 +340,19 @@ bool XQSPIPS_Flasher::waitTxEmpty()
     return false;
 }
 
-int XQSPIPS_Flasher::xclUpgradeFirmware(std::istream& binStream)
+int XQSPIPS_Flasher::xclUpgradeFirmware(std::istream& imageStream)
 {
+    // MCS images are decoded to the flat binary image first
+    std::istringstream mcsFlatStream;
+    bool isMcs = (imageStream.peek() == ':');
+    if (isMcs) {
+        mcsImage mcs;
+        if (mcs.parse(imageStream))
+            return -EINVAL;
+        mcsFlatStream.str(mcs.flatten());
+    }
+    std::istream& binStream = isMcs ? mcsFlatStream : imageStream;
+
     int total_size = 0;
     int remain = 0;
     int pages = 0;
@@ -28,22 +28,10 @@
 
 class XQSPIPS_Flasher
 {
-    struct ELARecord
-    {
-        unsigned mStartAddress;
-        unsigned mEndAddress;
-        unsigned mDataCount;
-        std::streampos mDataPos;
-        ELARecord() : mStartAddress(0), mEndAddress(0), mDataCount(0), mDataPos(0) {}
-    };
-
-    typedef std::list<ELARecord> ELARecordList;
-    ELARecordList mRecordList;
-
 public:
     XQSPIPS_Flasher(std::shared_ptr<pcidev::pci_device> dev);
     ~XQSPIPS_Flasher();
-    int xclUpgradeFirmware(std::istream& binStream);
+    int xclUpgradeFirmware(std::istream& imageStream);
 
 private:
     typedef struct {
@@ -23,6 +23,7 @@
 #include <thread>
 #include <cstring>
 #include <vector>
+#include <algorithm>
 #include <sys/ioctl.h>
 #include <sys/types.h>
 #include <errno.h>
@@ -497,96 +498,27 @@ int XSPI_Flasher::xclUpgradeFirmwareXSpi(std::istream& mcsStream, int index) {
     recordList.clear();
 
     slave_index = index;
-    std::string line;
-    std::string startAddress;
-    ELARecord record;
-    bool endRecordFound = false;
-
-    int lineno = 0;
-    while (!mcsStream.eof() && !endRecordFound) {
-    lineno++;
-        std::string line;
-        std::getline(mcsStream, line);
-        if (line.size() == 0) {
-            continue;
-        }
-        if (line[0] != ':') {
-            return -EINVAL;
-        }
-        const unsigned dataLen = std::stoi(line.substr(1, 2), 0 , 16);
-        const unsigned address = std::stoi(line.substr(3, 4), 0, 16);
-        const unsigned recordType = std::stoi(line.substr(7, 2), 0 , 16);
-        switch (recordType) {
-        case 0x00:
-        {
-            if (dataLen > 16) {
-                // For xilinx mcs files data length should be 16 for all records
-                // except for the last one which can be smaller
-                return -EINVAL;
-            }
-            if (address != (record.mDataCount+(record.mStartAddress & 0xFFFF))) {
-                if(record.mDataCount == 0) {
-                    //First entry only.
-                    assert(record.mStartAddress != 0);
-                    assert(record.mEndAddress != 0);
-                    record.mStartAddress += address;
-                    record.mEndAddress += address;
-                }else {
-                    std::cout << "Address is not contiguous ! " << std::endl;
-                    return -EINVAL;
-                }
-            }
-            //if ( ((record.mEndAddress-record.mStartAddress)& 0xFFFF) != address) {
-              //  return -EINVAL;
-            //}
-            record.mDataCount += dataLen;
-            record.mEndAddress += dataLen;
-            break;
-        }
-        case 0x01:
-        {
-            if (startAddress.size() == 0) {
-                break;
-            }
-            recordList.push_back(record);
-            endRecordFound = true;
-            break;
-        }
-        case 0x02:
-        {
-            assert(0);
-            break;
-        }
-        case 0x04:
-        {
-            if (address != 0x0) {
-                return -EINVAL;
-            }
-            if (dataLen != 2) {
-                return -EINVAL;
-            }
-            std::string newAddress = line.substr(9, dataLen * 2);
-            if (startAddress.size()) {
-                // Finish the old record
-                recordList.push_back(record);
-            }
-            // Start a new record
-            record.mStartAddress = std::stoi(newAddress, 0 , 16);
-            record.mStartAddress <<= 16;
-            record.mDataPos = mcsStream.tellg();
-            record.mEndAddress = record.mStartAddress;
-            record.mDataCount = 0;
-            startAddress = newAddress;
-        }
-        }
+
+    // Decode the whole MCS file up front, one record per ELA extent
+    if (mImage.parse(mcsStream))
+        return -EINVAL;
+
+    for (auto& ext : mImage.extents()) {
+        ELARecord record;
+        record.mStartAddress = ext.startAddress;
+        record.mEndAddress = ext.startAddress + ext.size;
+        record.mDataCount = ext.size;
+        record.mData = mImage.data(ext);
+        recordList.push_back(record);
     }
 
-    mcsStream.seekg(0);
     std::cout << "INFO: ***Found " << recordList.size() << " ELA Records" << std::endl;
+    if (recordList.empty())
+        return -EINVAL;
 
     //Ensure we set bitstream guard to the first location
     BITSTREAM_START_LOC = recordList.front().mStartAddress;
-    return programXSpi(mcsStream);
+    return programXSpi();
 }
 
 unsigned XSPI_Flasher::readReg(unsigned RegOffset) {
@@ -1271,7 +1203,7 @@ bool XSPI_Flasher::prepareXSpi()
     return true;
 }
 
-int XSPI_Flasher::programXSpi(std::istream& mcsStream, const ELARecord& record) {
+int XSPI_Flasher::programXSpi(const ELARecord& record) {
     //TODO: decrease the sleep time.
     const timespec req = {0, 20000};
 
@@ -1279,141 +1211,44 @@ int XSPI_Flasher::programXSpi(std::istream& mcsStream, const ELARecord& record)
     std::cout << "Programming block (" << std::hex << record.mStartAddress << ", " << record.mEndAddress << std::dec << ")" << std::endl;
 #endif
 
-    assert(mcsStream.tellg() < record.mDataPos);
-    mcsStream.seekg(record.mDataPos, std::ios_base::beg);
     unsigned char* buffer = &WriteBuffer[READ_WRITE_EXTRA_BYTES];
-    int bufferIndex = 0;
-    int pageIndex = 0;
-    std::string prevLine("");
-    for (unsigned index = record.mDataCount; index > 0;) {
-        std::string line;
-        std::getline(mcsStream, line);
-        if(TEST_MODE)
-            std::cout << line << std::endl;
-        const unsigned dataLen = std::stoi(line.substr(1, 2), 0 , 16);
-        index -= dataLen;
-        const unsigned recordType = std::stoi(line.substr(7, 2), 0 , 16);
-        if (recordType != 0x00) {
+    unsigned pageIndex = 0;
+    for (unsigned index = 0; index < record.mDataCount; index += WRITE_DATA_SIZE, pageIndex++) {
+        const unsigned count = std::min<unsigned>(WRITE_DATA_SIZE, record.mDataCount - index);
+        std::memcpy(buffer, record.mData + index, count);
+
+        if(TEST_MODE) {
+            std::cout << "writing page " << pageIndex << " (" << count << " bytes)" << std::endl;
             continue;
         }
-        const std::string data = line.substr(9, dataLen * 2);
-        // Write in byte swapped order
-        for (unsigned i = 0; i < data.length(); i += 2) {
-            unsigned value = std::stoi(data.substr(i, 2), 0, 16);
-            buffer[bufferIndex++] = (unsigned char)value;
-            assert(bufferIndex <= WRITE_DATA_SIZE);
-
-#if 0
-            //To enable byte swapping uncomment this.
-            //      if ((bufferIndex % 4) == 0) {
-            //        bufferIndex += 4;
-            //      }
-            //      assert(bufferIndex <= WRITE_DATA_SIZE);
-            //      unsigned value = std::stoi(data.substr(i, 2), 0, 16);
-            //      if(TEST_MODE)
-            //        std::cout << data.substr(i, 2);
-            //      buffer[--bufferIndex] = (unsigned char)value;
-            //      if ((bufferIndex % 4) == 0) {
-            //        bufferIndex += 4;
-            //      }
-#endif
-            if (bufferIndex == WRITE_DATA_SIZE) {
-                break;
-            }
-        }
-
-        if(TEST_MODE)
-            std::cout << std::endl;
-
-#if 0
-        //Uncomment if byte swapping enabled.
 
-        //account for the last line
-        //which can have say 14 bytes instead of 16
-        if((bufferIndex %4)!= 0) {
-            while ((bufferIndex %4)!= 0) {
-                unsigned char fillValue = 0xFF;
-                buffer[--bufferIndex] = fillValue;
-            }
-            bufferIndex += 4;
+        //Fill unused part of last page to FF
+        for(unsigned i = count; i < WRITE_DATA_SIZE; ++i) {
+            buffer[i] = 0xff;
         }
 
-        assert((bufferIndex % 4) == 0);
-#endif
-
-        assert(bufferIndex <= WRITE_DATA_SIZE);
-        if (bufferIndex == WRITE_DATA_SIZE) {
 #if defined(_debug)
-            std::cout << "writing page " << pageIndex << std::endl;
+        std::cout << "writing page " << pageIndex << std::endl;
 #endif
-            const unsigned address = std::stoi(line.substr(3, 4), 0, 16);
-            if(TEST_MODE) {
-                std::cout << (address + dataLen) << " " << (pageIndex +1)*WRITE_DATA_SIZE << std::endl;
-                std::cout << record.mStartAddress << " " << record.mStartAddress + pageIndex*PAGE_SIZE;
-                std::cout << " " << address << std::endl;
-            } else {
-                if(!writePage(record.mStartAddress + pageIndex*WRITE_DATA_SIZE))
-                    return -ENXIO;
-                clearBuffers();
-                {
-                    //debug stuff
-#if defined(_debug)
-                    if(pageIndex == 0) {
-                        if(!readPage(record.mStartAddress + pageIndex*WRITE_DATA_SIZE))
-                            return -ENXIO;
-                        clearBuffers();
-                    }
-#endif
-                }
-            }
-            pageIndex++;
-            nanosleep(&req, 0);
-            bufferIndex = 0;
-        }
-        prevLine = line;
-
-    }
-    if (bufferIndex) {
-        //Write the last page
-        if(TEST_MODE) {
-            std::cout << "writing final page " << pageIndex << std::endl;
-            std::cout << bufferIndex << std::endl;
-            std::cout << prevLine << std::endl;
-        }
-
-        const unsigned address = std::stoi(prevLine.substr(3, 4), 0, 16);
-        const unsigned dataLen = std::stoi(prevLine.substr(1, 2), 0 , 16);
-
-        if(TEST_MODE)
-            std::cout << address % WRITE_DATA_SIZE << " " << dataLen << std::endl;
-
-        //assert( (address % WRITE_DATA_SIZE + dataLen) == bufferIndex);
-
-        if(!TEST_MODE) {
-
-            //Fill unused half page to FF
-            for(unsigned i = bufferIndex; i < WRITE_DATA_SIZE; ++i) {
-                buffer[i] = 0xff;
-            }
-
-            if(!writePage(record.mStartAddress + pageIndex*WRITE_DATA_SIZE))
-                return -ENXIO;
-            nanosleep(&req, 0);
-            clearBuffers();
-            {
-                //debug stuff
+        if(!writePage(record.mStartAddress + pageIndex*WRITE_DATA_SIZE))
+            return -ENXIO;
+        clearBuffers();
+        {
+            //debug stuff
 #if defined(_debug)
+            if(pageIndex == 0) {
                 if(!readPage(record.mStartAddress + pageIndex*WRITE_DATA_SIZE))
                     return -ENXIO;
                 clearBuffers();
-#endif
             }
+#endif
         }
+        nanosleep(&req, 0);
     }
     return 0;
 }
 
-int XSPI_Flasher::programXSpi(std::istream& mcsStream)
+int XSPI_Flasher::programXSpi()
 {
     //  for (ELARecordList::iterator i = mRecordList.begin(), e = mRecordList.end(); i != e; ++i) {
     //    i->mStartAddress <<= 16;
@@ -1496,7 +1331,7 @@ int XSPI_Flasher::programXSpi(std::istream& mcsStream)
 
         clearBuffers();
 
-        if (programXSpi(mcsStream, *i)) {
+        if (programXSpi(*i)) {
             std::cout << "\nERROR: Could not programXSpi the block" << std::endl;
             return -EINVAL;
         }
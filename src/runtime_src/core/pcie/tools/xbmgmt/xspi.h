@@ -23,6 +23,7 @@
 #include <list>
 #include <iostream>
 #include "core/pcie/linux/scan.h"
+#include "mcs_image.h"
 
 class XSPI_Flasher
 {
@@ -31,12 +32,13 @@ class XSPI_Flasher
         unsigned mStartAddress;
         unsigned mEndAddress;
         unsigned mDataCount;
-        std::streampos mDataPos;
-        ELARecord() : mStartAddress(0), mEndAddress(0), mDataCount(0), mDataPos(0) {}
+        const unsigned char *mData;
+        ELARecord() : mStartAddress(0), mEndAddress(0), mDataCount(0), mData(nullptr) {}
     };
 
     typedef std::list<ELARecord> ELARecordList;
     ELARecordList recordList;
+    mcsImage mImage;
 
 public:
     XSPI_Flasher(std::shared_ptr<pcidev::pci_device> dev);
@@ -63,8 +65,8 @@ private:
     bool writePage(unsigned addr, uint8_t writeCmd = 0xff);
     bool readPage(unsigned addr, uint8_t readCmd = 0xff);
     bool prepareXSpi();
-    int programXSpi(std::istream& mcsStream, const ELARecord& record);
-    int programXSpi(std::istream& mcsStream);
+    int programXSpi(const ELARecord& record);
+    int programXSpi();
     bool readRegister(unsigned commandCode, unsigned bytes);
     bool writeRegister(unsigned commandCode, unsigned value, unsigned bytes);
     bool setSector(unsigned address);
@@ -17,6 +17,7 @@
  */
 
 #include <thread>
+#include <future>
 #include <chrono>
 #include <curses.h>
 #include <sstream>
@@ -98,14 +99,18 @@ static void print_pci_info(std::ostream &ostr)
         return;
     }
 
+    // Query all cards concurrently, print in index order
+    std::vector<std::future<std::string>> infos;
     for (unsigned j = 0; j < pcidev::get_dev_total(); j++) {
-        auto dev = pcidev::get_dev(j);
-        if (dev->is_ready)
-            ostr << " ";
-        else
-            ostr << "*";
-        ostr << "[" << j << "] " << dev << std::endl;
+        infos.push_back(std::async(std::launch::async, [j] {
+            auto dev = pcidev::get_dev(j);
+            std::stringstream ss;
+            ss << (dev->is_ready ? " " : "*") << "[" << j << "] " << dev;
+            return ss.str();
+        }));
     }
+    for (auto& info : infos)
+        ostr << info.get() << std::endl;
 
     if (pcidev::get_dev_total() != pcidev::get_dev_ready()) {
         ostr << "WARNING: "
@@ -558,9 +563,16 @@ int main(int argc, char *argv[])
         return 0;
     }
 
+    // Open all cards concurrently, each open reads a good part of sysfs
+    std::vector<std::future<std::unique_ptr<xcldev::device>>> opens;
     for (unsigned i = 0; i < total; i++) {
+        opens.push_back(std::async(std::launch::async, [i] {
+            return std::unique_ptr<xcldev::device>(new xcldev::device(i, nullptr));
+        }));
+    }
+    for (auto& open : opens) {
         try {
-            deviceVec.emplace_back(new xcldev::device(i, nullptr));
+            deviceVec.push_back(open.get());
         } catch (const std::exception& ex) {
             std::cout << ex.what() << std::endl;
         }
@@ -791,6 +803,7 @@ static void topThreadFunc(struct topThreadCtrl *ctrl)
                 ctrl->status = result;
                 return;
             }
+            ctrl->dev->refreshSysfs();
             clear();
             topPrintUsage(ctrl->dev.get(), devstat);
             refresh();
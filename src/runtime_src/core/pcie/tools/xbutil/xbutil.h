@@ -166,6 +166,7 @@ class device {
     xclDeviceHandle m_handle;
     xclDeviceInfo2 m_devinfo;
     xclErrorStatus m_errinfo;
+    std::unique_ptr<pcidev::sysfs_snapshot> m_sysfs;
 
     struct xclbin_lock
     {
@@ -208,7 +209,8 @@ public:
     int userFunc() {
         return pcidev::get_dev(m_idx)->func;
     }
-    device(unsigned int idx, const char* log) : m_idx(idx), m_handle(nullptr), m_devinfo{} {
+    device(unsigned int idx, const char* log) : m_idx(idx), m_handle(nullptr), m_devinfo{},
+        m_sysfs(new pcidev::sysfs_snapshot(pcidev::get_dev(idx))) {
         std::string devstr = "device[" + std::to_string(m_idx) + "]";
         m_handle = xclOpen(m_idx, log, XCL_QUIET);
         if (!m_handle)
@@ -221,7 +223,8 @@ public:
 #endif
     }
 
-    device(device&& rhs) : m_idx(rhs.m_idx), m_handle(rhs.m_handle), m_devinfo(std::move(rhs.m_devinfo)) {
+    device(device&& rhs) : m_idx(rhs.m_idx), m_handle(rhs.m_handle), m_devinfo(std::move(rhs.m_devinfo)),
+        m_sysfs(std::move(rhs.m_sysfs)) {
     }
 
     device(const device &dev) = delete;
@@ -243,6 +246,17 @@ public:
         }
     }
 
+    /*
+     * Re-read all sysfs entries used so far by query, dump and top in one
+     * pass.  Until the next refresh they report values from this pass.
+     */
+    void refreshSysfs() const
+    {
+        if (!std::getenv("XCL_SKIP_CU_READ"))
+            schedulerUpdateStat();
+        m_sysfs->refresh();
+    }
+
     const char *name() const {
         return m_devinfo.mName;
     }
@@ -282,7 +296,7 @@ public:
         std::string errmsg;
         std::vector<char> buf;
 
-        pcidev::get_dev(m_idx)->sysfs_get("icap", "ip_layout", errmsg, buf);
+        m_sysfs->get("icap", "ip_layout", errmsg, buf);
 
         if (!errmsg.empty()) {
             std::cout << errmsg << std::endl;
@@ -324,12 +338,9 @@ public:
 
     int parseComputeUnits(const std::vector<ip_data> &computeUnits) const
     {
-        if (!std::getenv("XCL_SKIP_CU_READ"))
-          schedulerUpdateStat();
-
         std::vector<std::string> custat;
         std::string errmsg;
-        pcidev::get_dev(m_idx)->sysfs_get("mb_scheduler", "kds_custat", errmsg, custat);
+        m_sysfs->get("mb_scheduler", "kds_custat", errmsg, custat);
           
         for (unsigned int i = 0; i < computeUnits.size(); ++i) {
             const auto& ip = computeUnits[i];
@@ -350,7 +361,7 @@ public:
         unsigned long long power = 0;
         std::string errmsg;
 
-        pcidev::get_dev(m_idx)->sysfs_get( "xmc", "xmc_power",  errmsg, power);
+        m_sysfs->get( "xmc", "xmc_power",  errmsg, power);
 
         if (!errmsg.empty()) {
             return -1;
@@ -384,7 +395,7 @@ public:
         std::vector<std::string> mm_buf;
         ss << "Device Memory Usage\n";
 
-        pcidev::get_dev(m_idx)->sysfs_get("icap", "mem_topology", errmsg, buf);
+        m_sysfs->get("icap", "mem_topology", errmsg, buf);
 
         if (!errmsg.empty()) {
             ss << errmsg << std::endl;
@@ -407,7 +418,7 @@ public:
             return;
         }
 
-        pcidev::get_dev(m_idx)->sysfs_get("", "memstat_raw", errmsg, mm_buf);
+        m_sysfs->get("", "memstat_raw", errmsg, mm_buf);
         if (!errmsg.empty()) {
             ss << errmsg << std::endl;
             lines.push_back(ss.str());
@@ -480,11 +491,10 @@ public:
         std::vector<char> buf, temp_buf;
         std::vector<std::string> mm_buf, stream_stat;
         uint64_t memoryUsage, boCount;
-        auto dev = pcidev::get_dev(m_idx);
 
-        dev->sysfs_get("icap", "mem_topology", errmsg, buf);
-        dev->sysfs_get("", "memstat_raw", errmsg, mm_buf);
-        dev->sysfs_get("xmc", "temp_by_mem_topology", errmsg, temp_buf);
+        m_sysfs->get("icap", "mem_topology", errmsg, buf);
+        m_sysfs->get("", "memstat_raw", errmsg, mm_buf);
+        m_sysfs->get("xmc", "temp_by_mem_topology", errmsg, temp_buf);
 
         const mem_topology *map = (mem_topology *)buf.data();
         const uint32_t *temp = (uint32_t *)temp_buf.data();
@@ -495,7 +505,6 @@ public:
         int j = 0; // stream index
         int m = 0; // mem index
 
-        dev->sysfs_put( "", "mig_cache_update", errmsg, "1");
         for(int i = 0; i < map->m_count; i++) {
             if (map->m_mem_data[i].m_type == MEM_STREAMING || map->m_mem_data[i].m_type == MEM_STREAMING_CONNECTION) {
                 std::string lname, status = "Inactive", total = "N/A", pending = "N/A";
@@ -509,7 +518,7 @@ public:
                 else
                     status = "N/A";
 
-                dev->sysfs_get("dma", lname, errmsg, stream_stat);
+                m_sysfs->get("dma", lname, errmsg, stream_stat);
                 if (errmsg.empty()) {
                     status = "Active";
                     for (unsigned k = 0; k < stream_stat.size(); k++) {
@@ -544,16 +553,16 @@ public:
                 unsigned ecc_st;
                 std::string ecc_st_str;
                 std::string tag(reinterpret_cast<const char *>(map->m_mem_data[i].m_tag));
-                dev->sysfs_get(tag, "ecc_status", errmsg, ecc_st);
+                m_sysfs->get(tag, "ecc_status", errmsg, ecc_st);
                 if (errmsg.empty() && eccStatus2Str(ecc_st, ecc_st_str) == 0) {
                     unsigned ce_cnt = 0;
-                    dev->sysfs_get(tag, "ecc_ce_cnt", errmsg, ce_cnt);
+                    m_sysfs->get(tag, "ecc_ce_cnt", errmsg, ce_cnt);
                     unsigned ue_cnt = 0;
-                    dev->sysfs_get(tag, "ecc_ue_cnt", errmsg, ue_cnt);
+                    m_sysfs->get(tag, "ecc_ue_cnt", errmsg, ue_cnt);
                     uint64_t ce_ffa = 0;
-                    dev->sysfs_get(tag, "ecc_ce_ffa", errmsg, ce_ffa);
+                    m_sysfs->get(tag, "ecc_ce_ffa", errmsg, ce_ffa);
                     uint64_t ue_ffa = 0;
-                    dev->sysfs_get(tag, "ecc_ue_ffa", errmsg, ue_ffa);
+                    m_sysfs->get(tag, "ecc_ue_ffa", errmsg, ue_ffa);
 
                     ptMem.put("ecc_status", ecc_st_str);
                     ptMem.put("ecc_ce_cnt", ce_cnt);
@@ -592,14 +601,14 @@ public:
             lines.push_back(ss.str());
             return;
         }
-        pcidev::get_dev(m_idx)->sysfs_get("icap", "mem_topology", errmsg, buf);
+        m_sysfs->get("icap", "mem_topology", errmsg, buf);
         if (!errmsg.empty()) {
             ss << errmsg << std::endl;
             lines.push_back(ss.str());
             return;
         }
 
-        pcidev::get_dev(m_idx)->sysfs_get("xmc", "temp_by_mem_topology", errmsg, temp_buf);
+        m_sysfs->get("xmc", "temp_by_mem_topology", errmsg, temp_buf);
         const uint32_t *temp = (uint32_t *)temp_buf.data();
 
         const mem_topology *map = (mem_topology *)buf.data();
@@ -622,7 +631,7 @@ public:
                 << "\n";
         }
 
-        pcidev::get_dev(m_idx)->sysfs_get("", "memstat_raw", errmsg, mm_buf);
+        m_sysfs->get("", "memstat_raw", errmsg, mm_buf);
         if(mm_buf.empty())
             return;
 
@@ -690,8 +699,7 @@ public:
         std::string errmsg;
         std::vector<std::string> custat;
 
-        schedulerUpdateStat();
-        pcidev::get_dev(m_idx)->sysfs_get("mb_scheduler", "kds_custat", errmsg, custat);
+        m_sysfs->get("mb_scheduler", "kds_custat", errmsg, custat);
 
         if (!errmsg.empty()) {
             ss << errmsg << std::endl;
@@ -721,27 +729,31 @@ public:
         std::vector<std::string> clock_freqs;
         std::vector<std::string> dma_threads;
         bool mig_calibration;
-        
-        pcidev::get_dev(m_idx)->sysfs_get( "rom", "VBNV",               errmsg, name ); 
-        pcidev::get_dev(m_idx)->sysfs_get( "", "vendor",                errmsg, vendor );
-        pcidev::get_dev(m_idx)->sysfs_get( "", "device",                errmsg, device );
-        pcidev::get_dev(m_idx)->sysfs_get( "", "subsystem_device",      errmsg, subsystem );
-        pcidev::get_dev(m_idx)->sysfs_get( "", "subsystem_vendor",      errmsg, subvendor );
-        pcidev::get_dev(m_idx)->sysfs_get( "xmc", "version",            errmsg, xmc_ver );
-        pcidev::get_dev(m_idx)->sysfs_get( "xmc", "serial_num",         errmsg, ser_num );
-        pcidev::get_dev(m_idx)->sysfs_get( "xmc", "max_power",          errmsg, max_power );
-        pcidev::get_dev(m_idx)->sysfs_get( "xmc", "bmc_ver",            errmsg, bmc_ver );
-        pcidev::get_dev(m_idx)->sysfs_get("rom", "ddr_bank_size",       errmsg, ddr_size);
-        pcidev::get_dev(m_idx)->sysfs_get( "rom", "ddr_bank_count_max", errmsg, ddr_count );
-        pcidev::get_dev(m_idx)->sysfs_get( "icap", "clock_freqs",       errmsg, clock_freqs ); 
-        pcidev::get_dev(m_idx)->sysfs_get( "dma", "channel_stat_raw",   errmsg, dma_threads ); 
-        pcidev::get_dev(m_idx)->sysfs_get( "", "link_speed",            errmsg, pcie_speed );
-        pcidev::get_dev(m_idx)->sysfs_get( "", "link_width",            errmsg, pcie_width );
-        pcidev::get_dev(m_idx)->sysfs_get( "", "mig_calibration",       errmsg, mig_calibration );
-        pcidev::get_dev(m_idx)->sysfs_get( "rom", "FPGA",               errmsg, fpga );
-        pcidev::get_dev(m_idx)->sysfs_get( "icap", "idcode",            errmsg, idcode );
-        pcidev::get_dev(m_idx)->sysfs_get( "dna", "dna",                errmsg, dna );
-        pcidev::get_dev(m_idx)->sysfs_get("", "p2p_enable",             errmsg, p2p_enabled);
+
+        // Let ECC status be updated before it is read
+        pcidev::get_dev(m_idx)->sysfs_put( "", "mig_cache_update", errmsg, "1" );
+        refreshSysfs();
+
+        m_sysfs->get( "rom", "VBNV",               errmsg, name ); 
+        m_sysfs->get( "", "vendor",                errmsg, vendor );
+        m_sysfs->get( "", "device",                errmsg, device );
+        m_sysfs->get( "", "subsystem_device",      errmsg, subsystem );
+        m_sysfs->get( "", "subsystem_vendor",      errmsg, subvendor );
+        m_sysfs->get( "xmc", "version",            errmsg, xmc_ver );
+        m_sysfs->get( "xmc", "serial_num",         errmsg, ser_num );
+        m_sysfs->get( "xmc", "max_power",          errmsg, max_power );
+        m_sysfs->get( "xmc", "bmc_ver",            errmsg, bmc_ver );
+        m_sysfs->get("rom", "ddr_bank_size",       errmsg, ddr_size);
+        m_sysfs->get( "rom", "ddr_bank_count_max", errmsg, ddr_count );
+        m_sysfs->get( "icap", "clock_freqs",       errmsg, clock_freqs ); 
+        m_sysfs->get( "dma", "channel_stat_raw",   errmsg, dma_threads ); 
+        m_sysfs->get( "", "link_speed",            errmsg, pcie_speed );
+        m_sysfs->get( "", "link_width",            errmsg, pcie_width );
+        m_sysfs->get( "", "mig_calibration",       errmsg, mig_calibration );
+        m_sysfs->get( "rom", "FPGA",               errmsg, fpga );
+        m_sysfs->get( "icap", "idcode",            errmsg, idcode );
+        m_sysfs->get( "dna", "dna",                errmsg, dna );
+        m_sysfs->get("", "p2p_enable",             errmsg, p2p_enabled);
         sensor_tree::put( "board.info.dsa_name",       name );
         sensor_tree::put( "board.info.vendor",         vendor );
         sensor_tree::put( "board.info.device",         device );
@@ -767,9 +779,9 @@ public:
 
         // physical.thermal.pcb
         unsigned short xmc_se98_temp0 = 0, xmc_se98_temp1 = 0, xmc_se98_temp2 = 0;
-        pcidev::get_dev(m_idx)->sysfs_get( "xmc", "xmc_se98_temp0", errmsg, xmc_se98_temp0 ); 
-        pcidev::get_dev(m_idx)->sysfs_get( "xmc", "xmc_se98_temp1", errmsg, xmc_se98_temp1 );
-        pcidev::get_dev(m_idx)->sysfs_get( "xmc", "xmc_se98_temp2", errmsg, xmc_se98_temp2 );
+        m_sysfs->get( "xmc", "xmc_se98_temp0", errmsg, xmc_se98_temp0 ); 
+        m_sysfs->get( "xmc", "xmc_se98_temp1", errmsg, xmc_se98_temp1 );
+        m_sysfs->get( "xmc", "xmc_se98_temp2", errmsg, xmc_se98_temp2 );
         sensor_tree::put( "board.physical.thermal.pcb.top_front", xmc_se98_temp0 );
         sensor_tree::put( "board.physical.thermal.pcb.top_rear",  xmc_se98_temp1 );
         sensor_tree::put( "board.physical.thermal.pcb.btm_front", xmc_se98_temp2 );
@@ -778,10 +790,10 @@ public:
         unsigned short fan_rpm = 0, xmc_fpga_temp = 0, xmc_fan_temp = 0;
         std::string fan_presence;
         
-        pcidev::get_dev(m_idx)->sysfs_get( "xmc", "xmc_fpga_temp", errmsg, xmc_fpga_temp );
-        pcidev::get_dev(m_idx)->sysfs_get( "xmc", "xmc_fan_temp",  errmsg, xmc_fan_temp );
-        pcidev::get_dev(m_idx)->sysfs_get( "xmc", "fan_presence",  errmsg, fan_presence );
-        pcidev::get_dev(m_idx)->sysfs_get( "xmc", "xmc_fan_rpm",   errmsg, fan_rpm );
+        m_sysfs->get( "xmc", "xmc_fpga_temp", errmsg, xmc_fpga_temp );
+        m_sysfs->get( "xmc", "xmc_fan_temp",  errmsg, xmc_fan_temp );
+        m_sysfs->get( "xmc", "fan_presence",  errmsg, fan_presence );
+        m_sysfs->get( "xmc", "xmc_fan_rpm",   errmsg, fan_rpm );
         sensor_tree::put( "board.physical.thermal.fpga_temp",    xmc_fpga_temp );
         sensor_tree::put( "board.physical.thermal.tcrit_temp",   xmc_fan_temp );
         sensor_tree::put( "board.physical.thermal.fan_presence", fan_presence );
@@ -789,10 +801,10 @@ public:
 
         // physical.thermal.cage
         unsigned short temp0 = 0, temp1 = 0, temp2 = 0, temp3 = 0;
-        pcidev::get_dev(m_idx)->sysfs_get("xmc", "xmc_cage_temp0", errmsg, temp0);
-        pcidev::get_dev(m_idx)->sysfs_get("xmc", "xmc_cage_temp1", errmsg, temp1);
-        pcidev::get_dev(m_idx)->sysfs_get("xmc", "xmc_cage_temp2", errmsg, temp2);
-        pcidev::get_dev(m_idx)->sysfs_get("xmc", "xmc_cage_temp3", errmsg, temp3);
+        m_sysfs->get("xmc", "xmc_cage_temp0", errmsg, temp0);
+        m_sysfs->get("xmc", "xmc_cage_temp1", errmsg, temp1);
+        m_sysfs->get("xmc", "xmc_cage_temp2", errmsg, temp2);
+        m_sysfs->get("xmc", "xmc_cage_temp3", errmsg, temp3);
         sensor_tree::put( "board.physical.thermal.cage.temp0", temp0);
         sensor_tree::put( "board.physical.thermal.cage.temp1", temp1);
         sensor_tree::put( "board.physical.thermal.cage.temp2", temp2);
@@ -805,30 +817,30 @@ public:
                        m12v_sw = 0, mgtavtt = 0, vccint_vol = 0, vccint_curr = 0, m3v3_pex_curr = 0,
                        m0v85_curr = 0, m3v3_vcc_vol = 0, hbm_1v2_vol = 0, vpp2v5_vol = 0,
                        vccint_bram_vol = 0, m12v_pex_vol = 0, m12v_aux_curr = 0;
-        pcidev::get_dev(m_idx)->sysfs_get( "xmc", "xmc_12v_pex_vol",  errmsg, m12v_pex_vol );
-        pcidev::get_dev(m_idx)->sysfs_get( "xmc", "xmc_12v_pex_curr", errmsg, m12v_pex_curr );
-        pcidev::get_dev(m_idx)->sysfs_get( "xmc", "xmc_12v_aux_vol",  errmsg, m12v_aux_vol );
-        pcidev::get_dev(m_idx)->sysfs_get( "xmc", "xmc_12v_aux_curr", errmsg, m12v_aux_curr );
-        pcidev::get_dev(m_idx)->sysfs_get( "xmc", "xmc_3v3_pex_vol", errmsg, m3v3_pex_vol );
-        pcidev::get_dev(m_idx)->sysfs_get( "xmc", "xmc_3v3_aux_vol", errmsg, m3v3_aux_vol ); 
-        pcidev::get_dev(m_idx)->sysfs_get( "xmc", "xmc_ddr_vpp_btm", errmsg, ddr_vpp_btm ); 
-        pcidev::get_dev(m_idx)->sysfs_get( "xmc", "xmc_ddr_vpp_top", errmsg, ddr_vpp_top ); 
-        pcidev::get_dev(m_idx)->sysfs_get( "xmc", "xmc_sys_5v5",     errmsg, sys_5v5 );
-        pcidev::get_dev(m_idx)->sysfs_get( "xmc", "xmc_1v2_top",     errmsg, m1v2_top );
-        pcidev::get_dev(m_idx)->sysfs_get( "xmc", "xmc_vcc1v2_btm",  errmsg, m1v2_btm );
-        pcidev::get_dev(m_idx)->sysfs_get( "xmc", "xmc_1v8",         errmsg, m1v8 );
-        pcidev::get_dev(m_idx)->sysfs_get( "xmc", "xmc_0v85",        errmsg, m0v85 );
-        pcidev::get_dev(m_idx)->sysfs_get( "xmc", "xmc_mgt0v9avcc",  errmsg, mgt0v9avcc );
-        pcidev::get_dev(m_idx)->sysfs_get( "xmc", "xmc_12v_sw",      errmsg, m12v_sw );
-        pcidev::get_dev(m_idx)->sysfs_get( "xmc", "xmc_mgtavtt",     errmsg, mgtavtt );
-        pcidev::get_dev(m_idx)->sysfs_get( "xmc", "xmc_vccint_vol",  errmsg, vccint_vol );
-        pcidev::get_dev(m_idx)->sysfs_get("xmc", "xmc_vccint_curr",  errmsg, vccint_curr);
-        pcidev::get_dev(m_idx)->sysfs_get("xmc", "xmc_3v3_pex_curr", errmsg, m3v3_pex_curr);
-        pcidev::get_dev(m_idx)->sysfs_get("xmc", "xmc_0v85_curr",    errmsg, m0v85_curr);
-        pcidev::get_dev(m_idx)->sysfs_get("xmc", "xmc_3v3_vcc_vol",  errmsg, m3v3_vcc_vol);
-        pcidev::get_dev(m_idx)->sysfs_get("xmc", "xmc_hbm_1v2_vol",  errmsg, hbm_1v2_vol);
-        pcidev::get_dev(m_idx)->sysfs_get("xmc", "xmc_vpp2v5_vol",   errmsg, vpp2v5_vol);
-        pcidev::get_dev(m_idx)->sysfs_get("xmc", "xmc_vccint_bram_vol", errmsg, vccint_bram_vol);
+        m_sysfs->get( "xmc", "xmc_12v_pex_vol",  errmsg, m12v_pex_vol );
+        m_sysfs->get( "xmc", "xmc_12v_pex_curr", errmsg, m12v_pex_curr );
+        m_sysfs->get( "xmc", "xmc_12v_aux_vol",  errmsg, m12v_aux_vol );
+        m_sysfs->get( "xmc", "xmc_12v_aux_curr", errmsg, m12v_aux_curr );
+        m_sysfs->get( "xmc", "xmc_3v3_pex_vol", errmsg, m3v3_pex_vol );
+        m_sysfs->get( "xmc", "xmc_3v3_aux_vol", errmsg, m3v3_aux_vol ); 
+        m_sysfs->get( "xmc", "xmc_ddr_vpp_btm", errmsg, ddr_vpp_btm ); 
+        m_sysfs->get( "xmc", "xmc_ddr_vpp_top", errmsg, ddr_vpp_top ); 
+        m_sysfs->get( "xmc", "xmc_sys_5v5",     errmsg, sys_5v5 );
+        m_sysfs->get( "xmc", "xmc_1v2_top",     errmsg, m1v2_top );
+        m_sysfs->get( "xmc", "xmc_vcc1v2_btm",  errmsg, m1v2_btm );
+        m_sysfs->get( "xmc", "xmc_1v8",         errmsg, m1v8 );
+        m_sysfs->get( "xmc", "xmc_0v85",        errmsg, m0v85 );
+        m_sysfs->get( "xmc", "xmc_mgt0v9avcc",  errmsg, mgt0v9avcc );
+        m_sysfs->get( "xmc", "xmc_12v_sw",      errmsg, m12v_sw );
+        m_sysfs->get( "xmc", "xmc_mgtavtt",     errmsg, mgtavtt );
+        m_sysfs->get( "xmc", "xmc_vccint_vol",  errmsg, vccint_vol );
+        m_sysfs->get("xmc", "xmc_vccint_curr",  errmsg, vccint_curr);
+        m_sysfs->get("xmc", "xmc_3v3_pex_curr", errmsg, m3v3_pex_curr);
+        m_sysfs->get("xmc", "xmc_0v85_curr",    errmsg, m0v85_curr);
+        m_sysfs->get("xmc", "xmc_3v3_vcc_vol",  errmsg, m3v3_vcc_vol);
+        m_sysfs->get("xmc", "xmc_hbm_1v2_vol",  errmsg, hbm_1v2_vol);
+        m_sysfs->get("xmc", "xmc_vpp2v5_vol",   errmsg, vpp2v5_vol);
+        m_sysfs->get("xmc", "xmc_vccint_bram_vol", errmsg, vccint_bram_vol);
         sensor_tree::put( "board.physical.electrical.12v_pex.voltage",        m12v_pex_vol );
         sensor_tree::put( "board.physical.electrical.12v_pex.current",        m12v_pex_curr );
         sensor_tree::put( "board.physical.electrical.12v_aux.voltage",        m12v_aux_vol );
@@ -859,8 +871,8 @@ public:
 
         // firewall
         unsigned short level = 0, status = 0;
-        pcidev::get_dev(m_idx)->sysfs_get( "firewall", "detected_level",  errmsg, level );
-        pcidev::get_dev(m_idx)->sysfs_get( "firewall", "detected_status", errmsg, status ); 
+        m_sysfs->get( "firewall", "detected_level",  errmsg, level );
+        m_sysfs->get( "firewall", "detected_status", errmsg, status ); 
         sensor_tree::put( "board.error.firewall.firewall_level", level );
         sensor_tree::put( "board.error.firewall.status",         parseFirewallStatus(status) );
         
@@ -878,7 +890,7 @@ public:
 
         // xclbin
         std::string xclbinid;
-        pcidev::get_dev(m_idx)->sysfs_get("", "xclbinuuid", errmsg, xclbinid);
+        m_sysfs->get("", "xclbinuuid", errmsg, xclbinid);
         sensor_tree::put( "board.xclbin.uuid", xclbinid );
 
         // compute unit
@@ -969,7 +981,7 @@ public:
 	std::vector<std::string> interface_uuids;
 	std::vector<std::string> logic_uuids;
 	std::string errmsg;
-        pcidev::get_dev(m_idx)->sysfs_get( "", "interface_uuids", errmsg, interface_uuids);
+        m_sysfs->get( "", "interface_uuids", errmsg, interface_uuids);
         if (interface_uuids.size())
         {
             ostr << "Interface UUID" << std::endl;
@@ -980,7 +992,7 @@ public:
             ostr << std::endl;
         }
 
-        pcidev::get_dev(m_idx)->sysfs_get( "", "logic_uuids", errmsg, logic_uuids);
+        m_sysfs->get( "", "logic_uuids", errmsg, logic_uuids);
         if (logic_uuids.size())
         {
             ostr << "Logic UUID" << std::endl;
@@ -0,0 +1,164 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "MappedFile.h"
+
+#include <stdexcept>
+#include <boost/filesystem.hpp>
+
+#include "XclBinUtilities.h"
+namespace XUtil = XclBinUtilities;
+
+#ifndef _WIN32
+  #include <errno.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <sys/sendfile.h>
+#endif
+
+#ifndef _WIN32
+// Copy _size bytes between two files in the kernel.  copy_file_range is
+// used where available, sendfile otherwise (e.g. across file systems on
+// older kernels).
+static bool
+copyFileRange(int _inputFd, off_t _inputOffset, int _outputFd, off_t _outputOffset, uint64_t _size)
+{
+  uint64_t remaining = _size;
+
+#if defined(__GLIBC__) && ((__GLIBC__ > 2) || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 27))
+  while (remaining != 0) {
+    ssize_t copied = ::copy_file_range(_inputFd, &_inputOffset, _outputFd, &_outputOffset, remaining, 0);
+    if (copied <= 0)
+      break;
+    remaining -= (uint64_t) copied;
+  }
+#endif
+
+  if ((remaining != 0) && (::lseek(_outputFd, _outputOffset, SEEK_SET) == _outputOffset)) {
+    while (remaining != 0) {
+      ssize_t copied = ::sendfile(_outputFd, _inputFd, &_inputOffset, remaining);
+      if (copied <= 0)
+        break;
+      remaining -= (uint64_t) copied;
+    }
+  }
+
+  return remaining == 0;
+}
+#endif
+
+MappedFile::MappedFile(const std::string& _sFileName)
+    : m_sFileName(_sFileName)
+    , m_pData(nullptr)
+    , m_size(0)
+    , m_bMapped(false)
+    , m_fd(-1) {
+#ifndef _WIN32
+  m_fd = ::open(m_sFileName.c_str(), O_RDONLY);
+  if (m_fd < 0) {
+    std::string errMsg = "ERROR: Unable to open the file for reading: " + m_sFileName;
+    throw std::runtime_error(errMsg);
+  }
+
+  struct stat st;
+  if (::fstat(m_fd, &st) == 0)
+    m_size = (uint64_t) st.st_size;
+
+  if (m_size != 0) {
+    // Private writable mapping: pages are only read when touched and any
+    // changes are copy-on-write
+    void* pAddr = ::mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, m_fd, 0);
+    if (pAddr != MAP_FAILED) {
+      m_pData = (char*) pAddr;
+      m_bMapped = true;
+      XUtil::TRACE(XUtil::format("Mapped %ld bytes of file: %s", m_size, m_sFileName.c_str()));
+      return;
+    }
+  }
+#endif
+
+  // Fall back to reading the file into memory
+  std::fstream ifFile;
+  ifFile.open(m_sFileName, std::ifstream::in | std::ifstream::binary);
+  if (!ifFile.is_open()) {
+    std::string errMsg = "ERROR: Unable to open the file for reading: " + m_sFileName;
+    throw std::runtime_error(errMsg);
+  }
+
+  ifFile.seekg(0, ifFile.end);
+  m_size = (uint64_t) ifFile.tellg();
+  m_buffer.resize(m_size);
+  ifFile.seekg(0, ifFile.beg);
+  ifFile.read(m_buffer.data(), m_size);
+  if (ifFile.gcount() != (std::streamsize) m_size) {
+    std::string errMsg = "ERROR: Unable to read the file: " + m_sFileName;
+    throw std::runtime_error(errMsg);
+  }
+  m_pData = m_buffer.data();
+}
+
+MappedFile::~MappedFile() {
+#ifndef _WIN32
+  if (m_bMapped)
+    ::munmap(m_pData, m_size);
+
+  if (m_fd >= 0)
+    ::close(m_fd);
+#endif
+}
+
+bool
+MappedFile::isSameFile(const std::string& _sFileName) const
+{
+  boost::system::error_code ec;
+  return boost::filesystem::equivalent(m_sFileName, _sFileName, ec) && !ec;
+}
+
+bool
+MappedFile::copyTo(std::fstream& _ostream,
+                   const std::string& _sOutputFile,
+                   uint64_t _offset,
+                   uint64_t _size) const
+{
+#ifdef _WIN32
+  return false;
+#else
+  if ((m_fd < 0) || (_offset + _size > m_size))
+    return false;
+
+  // Data must land behind what has been written through the stream
+  _ostream.flush();
+  std::streamoff outputOffset = _ostream.tellp();
+  if (!_ostream.good() || (outputOffset < 0))
+    return false;
+
+  int outputFd = ::open(_sOutputFile.c_str(), O_WRONLY);
+  if (outputFd < 0)
+    return false;
+
+  bool bCopied = copyFileRange(m_fd, (off_t) _offset, outputFd, (off_t) outputOffset, _size);
+  ::close(outputFd);
+
+  if (!bCopied)
+    return false;
+
+  _ostream.seekp(outputOffset + (std::streamoff) _size);
+  XUtil::TRACE(XUtil::format("Copied %ld bytes from offset 0x%lx of '%s'", _size, _offset, m_sFileName.c_str()));
+  return true;
+#endif
+}
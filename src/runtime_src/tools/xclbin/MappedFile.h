@@ -0,0 +1,69 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __MappedFile_h_
+#define __MappedFile_h_
+
+// ----------------------- I N C L U D E S -----------------------------------
+
+// #includes here - please keep these to a bare minimum!
+#include <string>
+#include <vector>
+#include <fstream>
+#include <stdint.h>
+
+// ------------------- C L A S S :   M a p p e d F i l e ---------------------
+
+// Read only image of an input file.  Where supported the file is memory
+// mapped copy-on-write, so only the pages an operation looks at are read
+// from disk and changes to the image never reach the file.  Otherwise the
+// file is read into memory.
+class MappedFile {
+ public:
+  MappedFile(const std::string& _sFileName);
+  virtual ~MappedFile();
+
+ public:
+  char* getData() const { return m_pData; }
+  uint64_t getSize() const { return m_size; }
+  const std::string& getFileName() const { return m_sFileName; }
+  bool isMapped() const { return m_bMapped; }
+
+  // True if _sFileName refers to this file
+  bool isSameFile(const std::string& _sFileName) const;
+
+  // Copy a range of the file to the current position of _ostream, which
+  // must be writing _sOutputFile.  The data is copied in the kernel
+  // without reading it into this process.  Returns false, with _ostream
+  // unchanged, if the range could not be copied this way.
+  bool copyTo(std::fstream& _ostream, const std::string& _sOutputFile, uint64_t _offset, uint64_t _size) const;
+
+ private:
+  std::string m_sFileName;
+  char* m_pData;
+  uint64_t m_size;
+  bool m_bMapped;
+  int m_fd;
+  std::vector<char> m_buffer;   // Image if the file is not mapped
+
+ private:
+  // Purposefully private and undefined ctors...
+  MappedFile();
+  MappedFile(const MappedFile& obj);
+  MappedFile& operator=(const MappedFile& obj);
+};
+
+#endif
@@ -21,6 +21,7 @@
 #include <boost/property_tree/json_parser.hpp>
 
 
+#include "MappedFile.h"
 #include "XclBinUtilities.h"
 namespace XUtil = XclBinUtilities;
 
@@ -46,7 +47,9 @@ Section::Section()
     , m_sIndexName("")
     , m_pBuffer(nullptr)
     , m_bufferSize(0)
-    , m_name("") {
+    , m_name("")
+    , m_pMappedFile()
+    , m_mappedOffset(0) {
   // Empty
 }
 
@@ -57,10 +60,14 @@ Section::~Section() {
 void
 Section::purgeBuffers()
 {
-  if (m_pBuffer != nullptr) {
-    delete m_pBuffer;
-    m_pBuffer = nullptr;
+  if (m_pMappedFile) {
+    // View into a mapped file, nothing to free
+    m_pMappedFile.reset();
+    m_mappedOffset = 0;
+  } else if (m_pBuffer != nullptr) {
+    delete[] m_pBuffer;
   }
+  m_pBuffer = nullptr;
   m_bufferSize = 0;
 }
 
@@ -247,6 +254,34 @@ Section::writeXclBinSectionBuffer(std::fstream& _ostream) const
   _ostream.write(m_pBuffer, m_bufferSize);
 }
 
+void
+Section::copyXclBinSectionBuffer(std::fstream& _ostream, const std::string& _sOutputFile) const
+{
+  // Unchanged sections of a mapped file are copied file to file
+  if (m_pMappedFile && 
+      (m_bufferSize != 0) &&
+      m_pMappedFile->copyTo(_ostream, _sOutputFile, m_mappedOffset, m_bufferSize)) {
+    return;
+  }
+
+  writeXclBinSectionBuffer(_ostream);
+}
+
+void
+Section::unmapBuffer(const std::string& _sFileName)
+{
+  if (!m_pMappedFile || !m_pMappedFile->isSameFile(_sFileName)) {
+    return;
+  }
+
+  // The file is about to be overwritten, bring the section into memory
+  char* pBuffer = new char[m_bufferSize];
+  memcpy(pBuffer, m_pBuffer, m_bufferSize);
+  m_pMappedFile.reset();
+  m_mappedOffset = 0;
+  m_pBuffer = pBuffer;
+}
+
 void
 Section::readXclBinBinary(std::fstream& _istream, const axlf_section_header& _sectionHeader) {
   // Some error checking
@@ -285,6 +320,43 @@ Section::readXclBinBinary(std::fstream& _istream, const axlf_section_header& _se
   XUtil::TRACE(XUtil::format("  m_size: %ld", m_bufferSize));
 }
 
+void
+Section::readXclBinBinary(const std::shared_ptr<MappedFile>& _pMappedFile, const axlf_section_header& _sectionHeader) {
+  // Some error checking
+  if ((enum axlf_section_kind)_sectionHeader.m_sectionKind != getSectionKind()) {
+    std::string errMsg = XUtil::format("ERROR: Unexpected section kind.  Expected: %d, Read: %d", getSectionKind(), _sectionHeader.m_sectionKind);
+    throw std::runtime_error(errMsg);
+  }
+
+  if (m_pBuffer != nullptr) {
+    std::string errMsg = "ERROR: Binary buffer already exists.";
+    throw std::runtime_error(errMsg);
+  }
+
+  if (_sectionHeader.m_sectionSize > UINT32_MAX) {
+    std::string errMsg ("FATAL ERROR: Section header size exceeds internal representation size.");
+    throw std::runtime_error(errMsg);
+  }
+
+  if ((_sectionHeader.m_sectionOffset > _pMappedFile->getSize()) ||
+      (_sectionHeader.m_sectionSize > _pMappedFile->getSize() - _sectionHeader.m_sectionOffset)) {
+    std::string errMsg = "ERROR: Input stream for the binary buffer is smaller then the expected size.";
+    throw std::runtime_error(errMsg);
+  }
+
+  m_name = (char*)&_sectionHeader.m_sectionName;
+
+  // Refer to the section in place, its pages are read on first use
+  m_pMappedFile = _pMappedFile;
+  m_mappedOffset = _sectionHeader.m_sectionOffset;
+  m_bufferSize = (unsigned int) _sectionHeader.m_sectionSize;
+  m_pBuffer = _pMappedFile->getData() + m_mappedOffset;
+
+  XUtil::TRACE(XUtil::format("Section: %s (%d)", getSectionKindAsString().c_str(), (unsigned int)getSectionKind()));
+  XUtil::TRACE(XUtil::format("  m_name: %s", m_name.c_str()));
+  XUtil::TRACE(XUtil::format("  m_size: %ld (mapped)", m_bufferSize));
+}
+
 
 void 
 Section::readJSONSectionImage(const boost::property_tree::ptree& _ptSection)
@@ -292,6 +364,9 @@ Section::readJSONSectionImage(const boost::property_tree::ptree& _ptSection)
   std::ostringstream buffer;
   marshalFromJSON(_ptSection, buffer);
 
+  // Release the previous image, including a view into a mapped file
+  purgeBuffers();
+
   // -- Read contents into memory buffer --
   m_bufferSize = (unsigned int) buffer.tellp();
 
@@ -631,11 +706,7 @@ Section::readSubPayload(std::fstream& _istream,
   readSubPayload(m_pBuffer, m_bufferSize, _istream, _sSubSection, _eFormatType, buffer);
 
   // Now for some how cleaning
-  if (m_pBuffer != nullptr) {
-    delete m_pBuffer;
-    m_pBuffer = nullptr;
-    m_bufferSize = 0;
-  }
+  purgeBuffers();
 
   m_bufferSize = (unsigned int) buffer.tellp();
 
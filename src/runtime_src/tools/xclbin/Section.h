@@ -27,11 +27,13 @@
 #include <map>
 #include <functional>
 #include <vector>
+#include <memory>
 
 #include <boost/property_tree/ptree.hpp>
 
 // ------------ F O R W A R D - D E C L A R A T I O N S ----------------------
 // Forward declarations - use these instead whenever possible...
+class MappedFile;
 
 // ------------------- C L A S S :   S e c t i o n ---------------------------
 
@@ -77,6 +79,7 @@ class Section {
   // Xclbin Binary helper methods - child classes can override them if they choose
   virtual void readXclBinBinary(std::fstream& _istream, const struct axlf_section_header& _sectionHeader);
   virtual void readXclBinBinary(std::fstream& _istream, const boost::property_tree::ptree& _ptSection);
+  virtual void readXclBinBinary(const std::shared_ptr<MappedFile>& _pMappedFile, const struct axlf_section_header& _sectionHeader);
   void readXclBinBinary(std::fstream& _istream, enum FormatType _eFormatType);
   void readJSONSectionImage(const boost::property_tree::ptree& _ptSection);
   void readPayload(std::fstream& _istream, enum FormatType _eFormatType);
@@ -85,6 +88,8 @@ class Section {
   void readSubPayload(std::fstream& _istream, const std::string & _sSubSection, enum Section::FormatType _eFormatType);
   virtual void initXclBinSectionHeader(axlf_section_header& _sectionHeader);
   virtual void writeXclBinSectionBuffer(std::fstream& _ostream) const;
+  void copyXclBinSectionBuffer(std::fstream& _ostream, const std::string& _sOutputFile) const;
+  void unmapBuffer(const std::string& _sFileName);
   virtual void appendToSectionMetadata(const boost::property_tree::ptree& _ptAppendData, boost::property_tree::ptree& _ptToAppendTo);
 
   void dumpContents(std::fstream& _ostream, enum FormatType _eFormatType) const;
@@ -118,6 +123,10 @@ class Section {
   unsigned int m_bufferSize;
   std::string m_name;
 
+  // When set, m_pBuffer is an unchanged view into this file at m_mappedOffset
+  std::shared_ptr<MappedFile> m_pMappedFile;
+  uint64_t m_mappedOffset;
+
  private:
   static std::map<enum axlf_section_kind, std::string> m_mapIdToName;
   static std::map<std::string, enum axlf_section_kind> m_mapNameToId;
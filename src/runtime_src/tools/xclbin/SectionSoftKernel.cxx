@@ -472,7 +472,17 @@ SectionSoftKernel::writeSubPayload(const std::string& _sSubSectionName,
 void
 SectionSoftKernel::readXclBinBinary(std::fstream& _istream, const axlf_section_header& _sectionHeader) {
   Section::readXclBinBinary(_istream, _sectionHeader);
+  readIndexName();
+}
 
+void
+SectionSoftKernel::readXclBinBinary(const std::shared_ptr<MappedFile>& _pMappedFile, const axlf_section_header& _sectionHeader) {
+  Section::readXclBinBinary(_pMappedFile, _sectionHeader);
+  readIndexName();
+}
+
+void
+SectionSoftKernel::readIndexName() {
   // Extract the binary data as a JSON string
   std::ostringstream buffer;
   writeMetadata(buffer);
@@ -17,6 +17,7 @@
 // ------ I N C L U D E   F I L E S -------------------------------------------
 #include "XclBinClass.h"
 #include "Section.h"
+#include "MappedFile.h"
 
 #include <stdexcept>
 #include <boost/property_tree/json_parser.hpp>
@@ -113,18 +114,17 @@ XclBin::printSections(std::ostream &_ostream) const {
 }
 
 void
-XclBin::readXclBinBinaryHeader(std::fstream& _istream) {
+XclBin::readXclBinBinaryHeader(const MappedFile& _mappedFile) {
   // Read in the buffer
   const unsigned int expectBufferSize = sizeof(axlf);
 
-  _istream.seekg(0);
-  _istream.read((char*)&m_xclBinHeader, sizeof(axlf));
-
-  if (_istream.gcount() != expectBufferSize) {
+  if (_mappedFile.getSize() < expectBufferSize) {
     std::string errMsg = "ERROR: Input stream is smaller than the expected header size.";
     throw std::runtime_error(errMsg);
   }
 
+  memcpy((char*)&m_xclBinHeader, _mappedFile.getData(), sizeof(axlf));
+
   if (FormattedOutput::getMagicAsString(m_xclBinHeader).c_str() != std::string("xclbin2")) {
     std::string errMsg = "ERROR: The XCLBIN appears to be corrupted (header start key value is not what is expected).";
     throw std::runtime_error(errMsg);
@@ -132,32 +132,32 @@ XclBin::readXclBinBinaryHeader(std::fstream& _istream) {
 }
 
 void
-XclBin::readXclBinBinarySections(std::fstream& _istream) {
+XclBin::readXclBinBinarySections(const std::shared_ptr<MappedFile>& _pMappedFile) {
   // Read in each section
   unsigned int numberOfSections = m_xclBinHeader.m_header.m_numSections;
 
   for (unsigned int index = 0; index < numberOfSections; ++index) {
     XUtil::TRACE(XUtil::format("Examining Section: %d of %d", index + 1, m_xclBinHeader.m_header.m_numSections));
     // Find the section header data
-    long long sectionOffset = sizeof(axlf) + (index * sizeof(axlf_section_header)) - sizeof(axlf_section_header);
-    _istream.seekg(sectionOffset);
+    uint64_t sectionOffset = sizeof(axlf) + (index * sizeof(axlf_section_header)) - sizeof(axlf_section_header);
 
     // Read in the section header
     axlf_section_header sectionHeader = axlf_section_header {0};
     const unsigned int expectBufferSize = sizeof(axlf_section_header);
 
-    _istream.read((char*)&sectionHeader, sizeof(axlf_section_header));
-
-    if (_istream.gcount() != expectBufferSize) {
+    if (_pMappedFile->getSize() < sectionOffset + expectBufferSize) {
       std::string errMsg = "ERROR: Input stream is smaller than the expected section header size.";
       throw std::runtime_error(errMsg);
     }
 
+    memcpy((char*)&sectionHeader, _pMappedFile->getData() + sectionOffset, sizeof(axlf_section_header));
+
     Section* pSection = Section::createSectionObjectOfKind((enum axlf_section_kind)sectionHeader.m_sectionKind);
 
     // Here for testing purposes, when all segments are supported it should be removed
     if (pSection != nullptr) {
-      pSection->readXclBinBinary(_istream, sectionHeader);
+      // The section refers to its data in the mapped file, nothing is read yet
+      pSection->readXclBinBinary(_pMappedFile, sectionHeader);
       addSection(pSection);
     }
   }
@@ -172,8 +172,21 @@ XclBin::readXclBinBinary(const std::string &_binaryFileName,
     throw std::runtime_error(errMsg);
   }
 
-  // Open the file for consumption
   XUtil::TRACE("Reading xclbin binary file: " + _binaryFileName);
+
+  if (!_bMigrate) {
+    // Map the file, section payloads are only read when an operation needs them
+    std::shared_ptr<MappedFile> pMappedFile = std::make_shared<MappedFile>(_binaryFileName);
+
+    // Read in the header
+    readXclBinBinaryHeader(*pMappedFile);
+
+    // Read the sections
+    readXclBinBinarySections(pMappedFile);
+    return;
+  }
+
+  // Open the file for consumption
   std::fstream ifXclBin;
   ifXclBin.open(_binaryFileName, std::ifstream::in | std::ifstream::binary);
   if (!ifXclBin.is_open()) {
@@ -181,19 +194,11 @@ XclBin::readXclBinBinary(const std::string &_binaryFileName,
     throw std::runtime_error(errMsg);
   }
 
-  if (_bMigrate) {
-    boost::property_tree::ptree pt_mirrorData;
-    findAndReadMirrorData(ifXclBin, pt_mirrorData);
+  boost::property_tree::ptree pt_mirrorData;
+  findAndReadMirrorData(ifXclBin, pt_mirrorData);
 
-    // Read in the mirror image
-    readXclBinaryMirrorImage(ifXclBin, pt_mirrorData);
-  } else {
-    // Read in the header
-    readXclBinBinaryHeader(ifXclBin);
-
-    // Read the sections
-    readXclBinBinarySections(ifXclBin);
-  }
+  // Read in the mirror image
+  readXclBinaryMirrorImage(ifXclBin, pt_mirrorData);
 
   ifXclBin.close();
 }
@@ -239,7 +244,7 @@ XclBin::writeXclBinBinaryHeader(std::fstream& _ostream, boost::property_tree::pt
 
 
 void
-XclBin::writeXclBinBinarySections(std::fstream& _ostream, boost::property_tree::ptree& _mirroredData) {
+XclBin::writeXclBinBinarySections(std::fstream& _ostream, const std::string& _sOutputFile, boost::property_tree::ptree& _mirroredData) {
   // Nothing to write
   if (m_sections.empty()) {
     return;
@@ -286,7 +291,7 @@ XclBin::writeXclBinBinarySections(std::fstream& _ostream, boost::property_tree::
     }
 
     // Write buffer
-    m_sections[index]->writeXclBinSectionBuffer(_ostream);
+    m_sections[index]->copyXclBinSectionBuffer(_ostream, _sOutputFile);
 
     // Write mirror data
     {
@@ -355,6 +360,11 @@ XclBin::writeXclBinBinary(const std::string &_binaryFileName,
     throw std::runtime_error(errMsg);
   }
 
+  // Sections mapped from the file about to be overwritten are read in first
+  for (Section* pSection : m_sections) {
+    pSection->unmapBuffer(_binaryFileName);
+  }
+
   // Write the xclbin file image
   XUtil::TRACE("Writing the xclbin binary file: " + _binaryFileName);
   std::fstream ofXclBin;
@@ -380,7 +390,7 @@ XclBin::writeXclBinBinary(const std::string &_binaryFileName,
   writeXclBinBinaryHeader(ofXclBin, mirroredData);
 
   // Write the section array and sections
-  writeXclBinBinarySections(ofXclBin, mirroredData);
+  writeXclBinBinarySections(ofXclBin, _binaryFileName, mirroredData);
 
   // Write out our mirror data
   writeXclBinBinaryMirrorData(ofXclBin, mirroredData);
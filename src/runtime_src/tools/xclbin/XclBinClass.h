@@ -20,12 +20,14 @@
 #include <string>
 #include <fstream>
 #include <vector>
+#include <memory>
 #include <boost/property_tree/ptree.hpp>
 
 #include "xclbin.h"
 #include "ParameterSectionData.h"
 
 class Section;
+class MappedFile;
 
 class XclBin {
  public:
@@ -60,8 +62,8 @@ class XclBin {
 
  private:
   void updateHeaderFromSection(Section *_pSection);
-  void readXclBinBinaryHeader(std::fstream& _istream);
-  void readXclBinBinarySections(std::fstream& _istream);
+  void readXclBinBinaryHeader(const MappedFile& _mappedFile);
+  void readXclBinBinarySections(const std::shared_ptr<MappedFile>& _pMappedFile);
 
   void findAndReadMirrorData(std::fstream& _istream, boost::property_tree::ptree& _mirrorData) const;
   void readXclBinaryMirrorImage(std::fstream& _istream, const boost::property_tree::ptree& _mirrorData);
@@ -85,7 +87,7 @@ class XclBin {
   void readXclBinHeader(const boost::property_tree::ptree& _ptHeader, struct axlf& _axlfHeader);
   void readXclBinSection(std::fstream& _istream, const boost::property_tree::ptree& _ptSection);
   void writeXclBinBinaryHeader(std::fstream& _ostream, boost::property_tree::ptree& _mirroredData);
-  void writeXclBinBinarySections(std::fstream& _ostream, boost::property_tree::ptree& _mirroredData);
+  void writeXclBinBinarySections(std::fstream& _ostream, const std::string& _sOutputFile, boost::property_tree::ptree& _mirroredData);
 
 
  protected:
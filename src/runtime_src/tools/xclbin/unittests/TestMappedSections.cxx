@@ -0,0 +1,227 @@
+#include <gtest/gtest.h>
+#include "ParameterSectionData.h"
+#include "XclBinClass.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+// Create an xclbin with a large BITSTREAM and two small sections
+static void
+createXclBin(const std::string& _sFileName, uint64_t _bitstreamSize)
+{
+  const std::string sDebugData(4096, 'd');
+  const std::string sMetadata = "<?xml version=\"1.0\"?><project name=\"mapped\"></project>";
+  const unsigned int numSections = 3;
+
+  uint64_t offset = sizeof(axlf) + (numSections - 1) * sizeof(axlf_section_header);
+  std::vector<char> header(offset, 0);
+  axlf* pHeader = reinterpret_cast<axlf*>(header.data());
+  std::strcpy(pHeader->m_magic, "xclbin2");
+  pHeader->m_header.m_numSections = numSections;
+  std::memset(&pHeader->m_header.uuid, 0x5a, sizeof(pHeader->m_header.uuid));
+
+  const enum axlf_section_kind kinds[numSections] = { BITSTREAM, DEBUG_DATA, EMBEDDED_METADATA };
+  const uint64_t sizes[numSections] = { _bitstreamSize, sDebugData.size(), sMetadata.size() };
+  for (unsigned int index = 0; index < numSections; ++index) {
+    axlf_section_header& section = pHeader->m_sections[index];
+    section.m_sectionKind = kinds[index];
+    std::strcpy(section.m_sectionName, "mapped");
+    section.m_sectionOffset = offset;
+    section.m_sectionSize = sizes[index];
+    offset += sizes[index];
+  }
+  pHeader->m_header.m_length = offset;
+
+  std::fstream ofXclBin(_sFileName, std::ifstream::out | std::ifstream::binary);
+  ofXclBin.write(header.data(), header.size());
+
+  std::vector<char> chunk(1024 * 1024);
+  for (uint64_t written = 0; written < _bitstreamSize; written += chunk.size()) {
+    for (size_t index = 0; index < chunk.size(); ++index)
+      chunk[index] = (char) ((written + index) * 7);
+    ofXclBin.write(chunk.data(), std::min<uint64_t>(chunk.size(), _bitstreamSize - written));
+  }
+
+  ofXclBin.write(sDebugData.data(), sDebugData.size());
+  ofXclBin.write(sMetadata.data(), sMetadata.size());
+}
+
+static std::vector<char>
+readFile(const std::string& _sFileName)
+{
+  std::fstream ifFile(_sFileName, std::ifstream::in | std::ifstream::binary);
+  ifFile.seekg(0, ifFile.end);
+  std::vector<char> buffer((size_t) ifFile.tellg());
+  ifFile.seekg(0, ifFile.beg);
+  ifFile.read(buffer.data(), buffer.size());
+  return buffer;
+}
+
+static uint64_t
+residentBytes()
+{
+  uint64_t pages = 0, resident = 0;
+  std::ifstream statm("/proc/self/statm");
+  statm >> pages >> resident;
+  return resident * 4096;
+}
+
+static double
+elapsedMs(std::chrono::steady_clock::time_point _start)
+{
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _start).count();
+}
+
+TEST(MappedSections, DumpRemoveWrite) {
+   const std::string sInput = "unittests/MappedSectionsInput.xclbin";
+   const std::string sOutput = "unittests/MappedSectionsOutput.xclbin";
+   const std::string sDump = "unittests/MappedSectionsBitstream.bin";
+   createXclBin(sInput, 1024 * 1024 + 13);
+
+   XclBin xclBin;
+   xclBin.readXclBinBinary(sInput, false /* bMigrateForward */);
+   ASSERT_NE(xclBin.findSection(BITSTREAM), nullptr);
+   ASSERT_EQ(xclBin.findSection(BITSTREAM)->getSize(), 1024 * 1024 + 13);
+
+   // Dumped section matches the input
+   ParameterSectionData psd("BITSTREAM:RAW:" + sDump);
+   xclBin.dumpSection(psd);
+   std::vector<char> input = readFile(sInput);
+   std::vector<char> bitstream = readFile(sDump);
+   ASSERT_EQ(bitstream.size(), 1024 * 1024 + 13);
+   const axlf* pInput = reinterpret_cast<const axlf*>(input.data());
+   ASSERT_EQ(std::memcmp(bitstream.data(), input.data() + pInput->m_sections[0].m_sectionOffset, bitstream.size()), 0);
+
+   // Unchanged sections are copied to the output
+   xclBin.removeSection("DEBUG_DATA");
+   xclBin.writeXclBinBinary(sOutput, true /* Skip UUID insertion */);
+
+   XclBin xclBin2;
+   xclBin2.readXclBinBinary(sOutput, false /* bMigrateForward */);
+   ASSERT_EQ(xclBin2.findSection(DEBUG_DATA), nullptr);
+   ASSERT_NE(xclBin2.findSection(EMBEDDED_METADATA), nullptr);
+   xclBin2.dumpSection(psd);
+   ASSERT_TRUE(readFile(sDump) == bitstream);
+
+   // Overwriting the mapped input file in place
+   xclBin2.writeXclBinBinary(sOutput, true /* Skip UUID insertion */);
+   XclBin xclBin3;
+   xclBin3.readXclBinBinary(sOutput, false /* bMigrateForward */);
+   xclBin3.dumpSection(psd);
+   ASSERT_TRUE(readFile(sDump) == bitstream);
+
+   std::remove(sInput.c_str());
+   std::remove(sOutput.c_str());
+   std::remove(sDump.c_str());
+}
+
+static std::string
+getUserKey(XclBin& _xclBin, const std::string& _sKey)
+{
+  Section* pSection = _xclBin.findSection(KEYVALUE_METADATA);
+  if (pSection == nullptr)
+    return "";
+
+  boost::property_tree::ptree ptKeyValueMetadata;
+  pSection->getPayload(ptKeyValueMetadata);
+  for (auto& keyvalue : ptKeyValueMetadata.get_child("keyvalue_metadata.key_values")) {
+    if (keyvalue.second.get<std::string>("key") == _sKey)
+      return keyvalue.second.get<std::string>("value");
+  }
+  return "";
+}
+
+TEST(MappedSections, KeyValue) {
+   const std::string sInput = "unittests/MappedKeyValueInput.xclbin";
+   const std::string sMapped = "unittests/MappedKeyValueMapped.xclbin";
+   const std::string sOutput = "unittests/MappedKeyValueOutput.xclbin";
+   createXclBin(sInput, 4096);
+
+   // Create the key value section
+   {
+     XclBin xclBin;
+     xclBin.readXclBinBinary(sInput, false /* bMigrateForward */);
+     xclBin.setKeyValue("USER:color:red");
+     xclBin.setKeyValue("USER:shape:round");
+     xclBin.writeXclBinBinary(sMapped, true /* Skip UUID insertion */);
+   }
+
+   // Update and remove keys of the mapped key value section
+   {
+     XclBin xclBin;
+     xclBin.readXclBinBinary(sMapped, false /* bMigrateForward */);
+     ASSERT_EQ(getUserKey(xclBin, "color"), "red");
+     xclBin.setKeyValue("USER:color:a much longer blue");
+     xclBin.removeKey("shape");
+     xclBin.writeXclBinBinary(sOutput, true /* Skip UUID insertion */);
+   }
+
+   XclBin xclBin;
+   xclBin.readXclBinBinary(sOutput, false /* bMigrateForward */);
+   ASSERT_EQ(getUserKey(xclBin, "color"), "a much longer blue");
+   ASSERT_EQ(getUserKey(xclBin, "shape"), "");
+   ASSERT_NE(xclBin.findSection(EMBEDDED_METADATA), nullptr);
+
+   std::remove(sInput.c_str());
+   std::remove(sMapped.c_str());
+   std::remove(sOutput.c_str());
+}
+
+TEST(MappedSections, Benchmark) {
+   const std::string sInput = "unittests/MappedSectionsLarge.xclbin";
+   const std::string sOutput = "unittests/MappedSectionsLargeOutput.xclbin";
+   const std::string sDump = "unittests/MappedSectionsDebugData.bin";
+   const uint64_t bitstreamSize = 256 * 1024 * 1024;
+   createXclBin(sInput, bitstreamSize);
+
+   std::cout << "xclbin with " << (bitstreamSize >> 20) << " MB bitstream" << std::endl;
+
+   {
+     uint64_t rss = residentBytes();
+     auto start = std::chrono::steady_clock::now();
+     std::vector<char> image = readFile(sInput);
+     std::cout << "read all sections: " << elapsedMs(start) << " ms, rss +"
+               << ((residentBytes() - rss) >> 20) << " MB" << std::endl;
+   }
+
+   {
+     uint64_t rss = residentBytes();
+     auto start = std::chrono::steady_clock::now();
+     XclBin xclBin;
+     xclBin.readXclBinBinary(sInput, false /* bMigrateForward */);
+     std::ostringstream info;
+     xclBin.reportInfo(info, "", false /* verbose */);
+     std::cout << "info:              " << elapsedMs(start) << " ms, rss +"
+               << ((residentBytes() - rss) >> 20) << " MB" << std::endl;
+   }
+
+   {
+     auto start = std::chrono::steady_clock::now();
+     XclBin xclBin;
+     xclBin.readXclBinBinary(sInput, false /* bMigrateForward */);
+     ParameterSectionData psd("DEBUG_DATA:RAW:" + sDump);
+     xclBin.dumpSection(psd);
+     std::cout << "dump section:      " << elapsedMs(start) << " ms" << std::endl;
+   }
+
+   {
+     uint64_t rss = residentBytes();
+     auto start = std::chrono::steady_clock::now();
+     XclBin xclBin;
+     xclBin.readXclBinBinary(sInput, false /* bMigrateForward */);
+     ParameterSectionData psd("DEBUG_DATA:RAW:" + sDump);
+     xclBin.replaceSection(psd);
+     xclBin.writeXclBinBinary(sOutput, true /* Skip UUID insertion */);
+     std::cout << "replace + write:   " << elapsedMs(start) << " ms, rss +"
+               << ((residentBytes() - rss) >> 20) << " MB" << std::endl;
+   }
+
+   std::remove(sInput.c_str());
+   std::remove(sOutput.c_str());
+   std::remove(sDump.c_str());
+}
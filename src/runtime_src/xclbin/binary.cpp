@@ -15,32 +15,47 @@
  */
 
 #include "binary.h"
+#include "core/common/xclbin_image.h"
 
 namespace xclbin {
 
 std::unique_ptr<binary::impl>
-create_xclbin0(std::vector<char>&& xb);
+create_xclbin2(std::shared_ptr<const xrt_core::xclbin_image> image);
 
-std::unique_ptr<binary::impl>
-create_xclbin2(std::vector<char>&& xb);
-
-binary::
-binary(std::vector<char>&& xb)
-  : m_content(nullptr)
+// Sanity checks for proper xclbin2 before creating an image
+static void
+check_binary(const char* raw, size_t size)
 {
-  if (xb.size()<8)
+  if (size<8)
     throw error("bad binary");
 
-  const char* raw = &xb[0];
-
   // magic version
   std::string v(raw,raw+7);
-  if (v=="xclbin2")
-    m_content = create_xclbin2(std::move(xb));
-  else 
+  if (v!="xclbin2")
     throw error("bad binary version '" + v + "'");
+
+  if (size < sizeof(axlf))
+    throw error("bad axlf file");
+
+  auto top = reinterpret_cast<const axlf*>(raw);
+  if (size < top->m_header.m_length)
+    throw error ("axlf length mismatch");
 }
 
+binary::
+binary(std::vector<char>&& xb)
+  : m_content(nullptr)
+{
+  check_binary(xb.data(),xb.size());
+  m_content = create_xclbin2(xrt_core::xclbin_image::create(std::move(xb)));
 }
 
+binary::
+binary(std::shared_ptr<const xrt_core::xclbin_image> image)
+  : m_content(nullptr)
+{
+  check_binary(image->data(),image->size());
+  m_content = create_xclbin2(std::move(image));
+}
 
+}
@@ -21,6 +21,10 @@
 #include <vector>
 #include <memory>
 
+namespace xrt_core {
+class xclbin_image;
+}
+
 /**
  * This file contains a class for an xclbin binary.  It captures
  * the binary and exposes an API to access various pieces of the
@@ -54,10 +58,10 @@ public:
  * an xclbin only.  If an invalid function is called, it will throw
  * an xclbin::error exception.
  *
- * Then entire xclbin binary data is copied into this class, any data
- * returned through APIs maybe referencing a range of the data
- * maintained by the class, so the binary object must stay alive while
- * anything is referencing and sharing xclbin data.
+ * The xclbin binary data is held in a shared xrt_core::xclbin_image,
+ * any data returned through APIs maybe referencing a range of the
+ * image, so the binary object must stay alive while anything is
+ * referencing and sharing xclbin data.
  */
 class binary
 {
@@ -65,6 +69,7 @@ public:
   struct impl
   {
     virtual ~impl() {}
+    virtual std::shared_ptr<const xrt_core::xclbin_image> image() const { throw error("not implemented"); }
     virtual size_t size()                  const { throw error("not implemented"); }
     virtual std::string version()          const { throw error("not implemented"); }
     virtual data_range binary_data()       const { throw error("not implemented"); }
@@ -100,6 +105,22 @@ public:
   explicit
   binary(std::vector<char>&& xb);
 
+  /**
+   * Construct from shared xclbin image
+   *
+   * @param image
+   *  xclbin image, possibly shared with other binary objects
+   */
+  explicit
+  binary(std::shared_ptr<const xrt_core::xclbin_image> image);
+
+  /**
+   * @return
+   *   Underlying shared xclbin image
+   */
+  std::shared_ptr<const xrt_core::xclbin_image>
+  image() const { return m_content->image(); }
+
   binary&
   operator=(const binary& rhs)
   {
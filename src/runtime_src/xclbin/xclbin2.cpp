@@ -15,6 +15,7 @@
  */
 
 #include "binary.h"
+#include "core/common/xclbin_image.h"
 
 #include "xclbin.h"
 
@@ -31,24 +32,30 @@ namespace xclbin {
  */
 struct xclbin2 : public binary::impl
 {
-  const std::vector<char> m_xclbin;
+  const std::shared_ptr<const xrt_core::xclbin_image> m_image;
   const char* m_raw = nullptr;
   const axlf* m_axlf = nullptr;
   const axlf_header* m_header = nullptr;
 
   explicit
-  xclbin2(std::vector<char>&& xb)
-    : m_xclbin(std::move(xb)), m_raw(&m_xclbin[0])
-    , m_axlf(reinterpret_cast<const axlf*>(m_raw))
+  xclbin2(std::shared_ptr<const xrt_core::xclbin_image> image)
+    : m_image(std::move(image)), m_raw(m_image->data())
+    , m_axlf(m_image->get_axlf())
     , m_header(&m_axlf->m_header)
   {
-    if (m_xclbin.size() < sizeof(axlf))
+    if (m_image->size() < sizeof(axlf))
       throw error("bad axlf file");
 
-    if (m_xclbin.size() < m_header->m_length)
+    if (m_image->size() < m_header->m_length)
       throw error ("axlf length mismatch");
   }
 
+  std::shared_ptr<const xrt_core::xclbin_image>
+  image() const
+  {
+    return m_image;
+  }
+
   size_t
   size() const
   {
@@ -142,22 +149,9 @@ struct xclbin2 : public binary::impl
 
 // exposed to binary.cpp
 std::unique_ptr<binary::impl>
-create_xclbin2(std::vector<char>&& xb)
+create_xclbin2(std::shared_ptr<const xrt_core::xclbin_image> image)
 {
-  // Before moving do sanity checks for proper xclbin2
-  if (xb.size() < sizeof(axlf))
-    throw error("bad axlf file");
-
-  auto xb2 = reinterpret_cast<const axlf*>(&xb[0]);
-  auto hdr = &xb2->m_header;
-  if (xb.size() < hdr->m_length)
-    throw error ("axlf length mismatch");
-
-  // Ok we are probably good, any throws now breaks
-  // strong exception safety guarantee as xb is being
-  // moved
-  return std::make_unique<xclbin2>(std::move(xb));
+  return std::make_unique<xclbin2>(std::move(image));
 }
 
-
-}
+} // xclbin
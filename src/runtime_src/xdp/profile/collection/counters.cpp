@@ -118,18 +118,8 @@ namespace xdp {
   {
     auto threadId = std::this_thread::get_id() ;
     auto key      = std::make_pair(functionName, threadId) ;
-    auto value    = std::make_pair(timePoint, (double)0.0) ;
 
-    if (CallCount.find(key) == CallCount.end())
-    {
-      std::vector<std::pair<double, double>> newValue ;
-      newValue.push_back(value) ;
-      CallCount[key] = newValue ;
-    }
-    else
-    {
-      CallCount[key].push_back(value);
-    }
+    CallStarts[key].push_back(timePoint) ;
   }
 
   void ProfileCounters::logFunctionCallEnd(const std::string& functionName, double timePoint)
@@ -137,7 +127,16 @@ namespace xdp {
     auto threadId = std::this_thread::get_id() ;
     auto key = std::make_pair(functionName, threadId) ;
 
-    CallCount[key].back().second = timePoint ;
+    auto itr = CallStarts.find(key) ;
+    if (itr == CallStarts.end() || itr->second.empty())
+      return ;
+
+    auto& stats = CallStats[functionName] ;
+    stats.logStart(itr->second.back()) ;
+    stats.logEnd(timePoint) ;
+    itr->second.pop_back() ;
+    if (itr->second.empty())
+      CallStarts.erase(itr) ;
   }
 
   void ProfileCounters::logKernelExecutionStart(const std::string& kernelName, const std::string& deviceName,
@@ -437,27 +436,11 @@ namespace xdp {
     using std::sort;
     using std::string;
     
-    // Go through all of the call values and consolidate all of the
-    //  API calls from different threads into a single TimeStats object
-    std::map<std::string, TimeStats> consolidated ;
-    for (auto iter : CallCount)
-    {
-      auto functionName = iter.first.first ;
-      auto pairVector   = iter.second ;
-
-      for (unsigned int i = 0 ; i < pairVector.size() ; ++i)
-      {
-	auto doublePair = pairVector[i] ;
-	consolidated[functionName].logStart(doublePair.first) ;
-	consolidated[functionName].logEnd(doublePair.second) ;
-      }
-    }
-
     // Print it in sorted order of Total Time. To sort it by duration
     // populate a vector and then using lambda function sort it by duration
 
-    vector<pair<string, TimeStats>> callPairs(consolidated.begin(),
-        consolidated.end());
+    vector<pair<string, TimeStats>> callPairs(CallStats.begin(),
+        CallStats.end());
     sort(callPairs.begin(), callPairs.end(),
         [](const pair<string, TimeStats>& A, const pair<string, TimeStats>& B) {
       return A.second.getTotalTime() > B.second.getTotalTime();
@@ -149,9 +149,11 @@ namespace xdp {
     std::map<std::string, double> DeviceEndTimes;
 
     // For every API function called in every thread, keep track
-    //  of the start and stop time.
+    //  of the start times of calls in progress. Finished calls are
+    //  only accumulated, so memory does not grow with the run time.
     std::map<std::pair<std::string, std::thread::id>,
-             std::vector<std::pair<double, double>>> CallCount;
+             std::vector<double>> CallStarts;
+    std::map<std::string, TimeStats> CallStats;
 
     std::map<std::string, TimeStats> KernelExecutionStats;
     std::map<std::string, TimeStats> ComputeUnitExecutionStats;
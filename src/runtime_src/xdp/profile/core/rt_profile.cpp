@@ -240,6 +240,16 @@ namespace xdp {
     mWriter->writeProfileSummary(this);
   }
 
+  void RTProfile::writeProfileSummary(ProfileWriterI* writer) {
+    if (!isApplicationProfileOn())
+      return;
+
+    std::lock_guard<std::mutex> lock(mLogger->getLogMutex());
+    // Host time of the summary is up to now, endProfiling sets it again
+    setProfileEndTime(std::chrono::steady_clock::now());
+    writer->writeSummary(this);
+  }
+
   // ***************************************************************************
   // Names & Strings
   // ***************************************************************************
@@ -316,6 +326,8 @@ namespace xdp {
   void RTProfile::logDeviceCounters(const std::string& deviceName, const std::string& binaryName, uint32_t programId,
       xclPerfMonType type, xclCounterResults& counterResults, uint64_t timeNsec, bool firstReadAfterProgram)
   {
+    // Counter results are also read by periodic profile summaries
+    std::lock_guard<std::mutex> lock(mLogger->getLogMutex());
     mWriter->logDeviceCounters(deviceName, binaryName, programId, type, counterResults, timeNsec, firstReadAfterProgram);
   }
 
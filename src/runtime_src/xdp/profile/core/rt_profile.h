@@ -87,6 +87,9 @@ namespace xdp {
 
   public:
     void writeProfileSummary();
+    // Write summary of the run so far to writer, logging is held off
+    // meanwhile
+    void writeProfileSummary(ProfileWriterI* writer);
     void addDeviceName(const std::string& deviceName) { mDeviceNames.push_back(deviceName); }
     std::string getDeviceNames(const std::string& sep) const;
     // Intentionally not a reference to the underlying container.
@@ -0,0 +1,109 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "summary_dumper.h"
+#include "rt_profile.h"
+#include "xdp/profile/writer/csv_profile.h"
+#include "xdp/profile/writer/json_profile.h"
+
+#include <boost/property_tree/json_parser.hpp>
+#include <cstdio>
+#include <fstream>
+
+namespace xdp {
+
+  SummaryDumper::SummaryDumper(RTProfile* profile, XDPPluginI* plugin,
+      const std::string& baseName, const std::string& windowName,
+      unsigned int intervalSec, unsigned int maxFiles) :
+    mProfile(profile),
+    mPluginHandle(plugin),
+    mBaseName(baseName),
+    mWindowName(windowName),
+    mInterval(intervalSec),
+    mMaxFiles(maxFiles ? maxFiles : 1),
+    mWindowStart(std::chrono::steady_clock::now())
+  {
+    mThread = std::thread(&SummaryDumper::run, this);
+  }
+
+  SummaryDumper::~SummaryDumper()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mStop = true;
+    }
+    mCondition.notify_one();
+    if (mThread.joinable())
+      mThread.join();
+  }
+
+  void SummaryDumper::run()
+  {
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (!mCondition.wait_for(lock, mInterval, [this] { return mStop; })) {
+      lock.unlock();
+      dump();
+      lock.lock();
+    }
+  }
+
+  void SummaryDumper::dump()
+  {
+    std::string suffix = "." + std::to_string(mSequence);
+
+    {
+      CSVProfileWriter writer(mPluginHandle, "Xilinx", mBaseName + suffix);
+      writer.bufferSummary();
+      mProfile->writeProfileSummary(&writer);
+      writer.flushSummary();
+    }
+
+    {
+      JSONProfileWriter writer(mPluginHandle, "Xilinx", "");
+      mProfile->writeProfileSummary(&writer);
+      std::ofstream ofs(mBaseName + suffix + ".json");
+      if (ofs.is_open())
+        boost::property_tree::write_json(ofs, *writer.getProfileTree(), true /*Pretty print*/);
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    double windowMsec =
+      std::chrono::duration<double, std::milli>(now - mWindowStart).count();
+    mWindowStart = now;
+    {
+      WindowProfileWriter writer(mPluginHandle, "Xilinx", mWindowName + suffix,
+                                 mWindowTotals, windowMsec);
+      writer.bufferSummary();
+      mProfile->writeProfileSummary(&writer);
+      writer.flushSummary();
+    }
+
+    removeOldFiles();
+    mSequence++;
+  }
+
+  void SummaryDumper::removeOldFiles()
+  {
+    if (mSequence < mMaxFiles)
+      return;
+
+    std::string suffix = "." + std::to_string(mSequence - mMaxFiles);
+    std::remove((mBaseName + suffix + ".csv").c_str());
+    std::remove((mBaseName + suffix + ".json").c_str());
+    std::remove((mWindowName + suffix + ".csv").c_str());
+  }
+
+} // xdp
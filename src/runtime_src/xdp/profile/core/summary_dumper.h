@@ -0,0 +1,74 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __XDP_CORE_SUMMARY_DUMPER_H
+#define __XDP_CORE_SUMMARY_DUMPER_H
+
+#include "xdp/profile/writer/window_profile.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace xdp {
+  class RTProfile;
+  class XDPPluginI;
+
+  // **************************************************************************
+  // Periodic profile summaries of long running applications
+  // **************************************************************************
+  // Every interval, a thread of its own writes
+  //   <baseName>.<n>.csv  - cumulative summary of the run so far
+  //   <baseName>.<n>.json - same as JSON
+  //   <windowName>.<n>.csv - API, kernel and CU tables of the last interval
+  // Only the last maxFiles of each are kept. Logging is held off while
+  // the summaries are rendered into memory, the files are written once
+  // logging resumes. Stall, stream and shell tables are left to the
+  // summary at the end.
+  class SummaryDumper {
+  public:
+    SummaryDumper(RTProfile* profile, XDPPluginI* plugin,
+                  const std::string& baseName, const std::string& windowName,
+                  unsigned int intervalSec, unsigned int maxFiles);
+    ~SummaryDumper();
+
+  private:
+    void run();
+    void dump();
+    void removeOldFiles();
+
+  private:
+    RTProfile* mProfile;
+    XDPPluginI* mPluginHandle;
+    std::string mBaseName;
+    std::string mWindowName;
+    std::chrono::seconds mInterval;
+    unsigned int mMaxFiles;
+    unsigned int mSequence = 0;
+    WindowTotals mWindowTotals;
+    std::chrono::steady_clock::time_point mWindowStart;
+
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    bool mStop = false;
+    std::thread mThread;
+  };
+
+} // xdp
+
+#endif
@@ -446,10 +446,12 @@ namespace xdp {
           deviceTimeStamp = 0;
         } else {
           // Find CU Start for this End
-          auto &queue = mCuStartsMap[objId];
-          if (!queue.empty()) {
-            cuId = queue.front();
-            queue.pop();
+          auto itr = mCuStartsMap.find(objId);
+          if (itr != mCuStartsMap.end()) {
+            cuId = itr->second.front();
+            itr->second.pop();
+            if (itr->second.empty())
+              mCuStartsMap.erase(itr);
           }
         }
         mProfileCounters->logComputeUnitExecutionEnd(cuName, deviceTimeStamp);
@@ -108,6 +108,8 @@ namespace xdp {
     int getHostP2PTransfers() const { return mHostP2PTransfers;}
     std::string getCurrentBinaryName() const {return mCurrentBinaryName;}
     const std::set<std::thread::id>& getThreadIds() {return mThreadIdSet;}
+    // Held while logging, take it to read counters while the run goes on
+    std::mutex& getLogMutex() {return mLogMutex;}
 
   private:
     // helpers
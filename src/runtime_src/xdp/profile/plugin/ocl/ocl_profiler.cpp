@@ -33,6 +33,7 @@
 #include "xdp/profile/device/tracedefs.h"
 #include "xdp/profile/writer/json_profile.h"
 #include "xdp/profile/writer/csv_profile.h"
+#include "xdp/profile/writer/csv_stream_trace.h"
 #include "xrt/util/config_reader.h"
 #include "xrt/util/message.h"
 #include "xclperf.h"
@@ -408,13 +409,35 @@ namespace xdp {
     ProfileMgr->attach(jsonWriter);
     ProfileMgr->getRunSummary()->setProfileTree(jsonWriter->getProfileTree());
 
+    // Periodic summaries while the application runs (as requested)
+    auto summaryInterval = xrt::config::get_profile_summary_interval();
+    if (summaryInterval > 0) {
+      mSummaryDumper.reset(new xdp::SummaryDumper(ProfileMgr.get(), Plugin.get(),
+        profileFile, "profile_window", summaryInterval,
+        xrt::config::get_profile_summary_files()));
+    }
+
     // Enable Trace File if profile is on and trace is enabled
     std::string timelineFile("");
     if (xrt::config::get_timeline_trace()) {
       timelineFile = "timeline_trace";
       ProfileMgr->turnOnFile(xdp::RTUtil::FILE_TIMELINE_TRACE);
     }
-    xdp::CSVTraceWriter* csvTraceWriter = new xdp::CSVTraceWriter(timelineFile, "Xilinx", Plugin.get());
+    xdp::CSVTraceWriter* csvTraceWriter = nullptr;
+    if (xrt::config::get_timeline_trace_stream()) {
+      // Buffered, rotated and optionally compressed (as requested)
+      std::string compress = xrt::config::get_timeline_trace_compress();
+      if (compress != "off" && compress != "gzip") {
+        xrt::message::send(xrt::message::severity_level::XRT_WARNING,
+          "Unknown timeline_trace_compress " + compress + ", timeline trace is not compressed");
+      }
+      uint64_t maxFileBytes = uint64_t(xrt::config::get_timeline_trace_file_size()) << 20;
+      csvTraceWriter = new xdp::CSVStreamTraceWriter(timelineFile, "Xilinx", Plugin.get(),
+        maxFileBytes, compress == "gzip");
+    }
+    else {
+      csvTraceWriter = new xdp::CSVTraceWriter(timelineFile, "Xilinx", Plugin.get());
+    }
     TraceWriters.push_back(csvTraceWriter);
     ProfileMgr->attach(csvTraceWriter);
 
@@ -437,6 +460,8 @@ namespace xdp {
   // Wrap up profiling by writing files
   void OCLProfiler::endProfiling()
   {
+    // Stop periodic summaries before the final one
+    mSummaryDumper.reset();
     ProfileMgr->setProfileEndTime(std::chrono::steady_clock::now());
 
     configureWriters();
@@ -25,6 +25,7 @@
 #include "xocl_profile.h"
 #include "xdp/profile/core/rt_util.h"
 #include "xdp/profile/writer/csv_trace.h"
+#include "xdp/profile/core/summary_dumper.h"
 #include "xdp/profile/plugin/ocl/ocl_power_profile.h"
 
 namespace xdp {
@@ -115,6 +116,8 @@ namespace xdp {
     std::shared_ptr<XoclPlugin> Plugin;
     std::unique_ptr<RTProfile> ProfileMgr;
     std::vector<std::unique_ptr<OclPowerProfile>> PowerProfileList;
+    // Periodic summaries, uses ProfileMgr so it goes first
+    std::unique_ptr<SummaryDumper> mSummaryDumper;
 
     // Buffer on Device DDR for Trace
     uint64_t mDDRBufferSz = 0;
@@ -39,6 +39,27 @@ namespace xdp {
     }
   }
 
+  // The file stays open and only the stream buffer is swapped, so the
+  // writers need not know where the summary goes
+  void ProfileWriterI::bufferSummary()
+  {
+    if (mSummaryFileBuf)
+      return;
+    std::ios& ios = Summary_ofs;
+    mSummaryFileBuf = ios.rdbuf(&mSummaryBuffer);
+  }
+
+  void ProfileWriterI::flushSummary()
+  {
+    if (!mSummaryFileBuf)
+      return;
+    std::ios& ios = Summary_ofs;
+    ios.rdbuf(mSummaryFileBuf);
+    mSummaryFileBuf = nullptr;
+    Summary_ofs << mSummaryBuffer.str();
+    mSummaryBuffer.str("");
+  }
+
   void ProfileWriterI::writeSummary(RTProfile* profile)
   {
     auto flowMode = mPluginHandle->getFlowMode();
@@ -27,6 +27,8 @@
 #include <string>
 #include <chrono>
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <map>
 
 
@@ -52,6 +54,11 @@ namespace xdp {
 
       virtual boost::property_tree::ptree* getSummaryTree() { return nullptr; }
 
+      // Render the summary into memory until flushSummary() writes it to
+      // the file, so the profile is locked no longer than it is read
+      void bufferSummary();
+      void flushSummary();
+
     public:
       inline void enableStallTable() { mEnStallTable = true; }
       inline void enableStreamTable() { mEnStreamTable = true; }
@@ -161,6 +168,10 @@ namespace xdp {
     protected:
       std::ofstream Summary_ofs;
 
+    private:
+      std::stringbuf mSummaryBuffer;
+      std::streambuf* mSummaryFileBuf = nullptr;
+
     protected:
       XDPPluginI* mPluginHandle = nullptr;
       std::string mPlatformName;
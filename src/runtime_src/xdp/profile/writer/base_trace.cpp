@@ -39,7 +39,7 @@ namespace xdp {
   void TraceWriterI::writeFunction(double time, const std::string& functionName,
       const std::string& eventName, unsigned int functionID)
   {
-    if (!Trace_ofs.is_open())
+    if (!isOpen())
       return;
 
     std::stringstream timeStr;
@@ -56,7 +56,7 @@ namespace xdp {
             const std::string& stageString, const std::string& eventString,
             const std::string& dependString, uint64_t objId, size_t size)
   {
-    if (!Trace_ofs.is_open())
+    if (!isOpen())
       return;
 
     std::stringstream timeStr;
@@ -77,7 +77,7 @@ namespace xdp {
             const std::string& stageString, const std::string& eventString,
             const std::string& dependString, uint64_t objId, size_t size, uint32_t cuId)
   {
-    if (!Trace_ofs.is_open())
+    if (!isOpen())
       return;
 
     std::stringstream timeStr;
@@ -101,7 +101,7 @@ namespace xdp {
             uint64_t dstAddress, const std::string& dstBank,
   			std::thread::id threadId)
   {
-    if (!Trace_ofs.is_open())
+    if (!isOpen())
       return;
 
     std::stringstream timeStr;
@@ -139,7 +139,7 @@ namespace xdp {
             const std::string& stageString, const std::string& eventString,
             const std::string& dependString)
   {
-    if (!Trace_ofs.is_open())
+    if (!isOpen())
       return;
 
     std::stringstream timeStr;
@@ -155,7 +155,7 @@ namespace xdp {
   void TraceWriterI::writeDeviceCounters(xclPerfMonType type, xclCounterResults& results,
       double timestamp, uint32_t sampleNum, bool firstReadAfterProgram)
   {
-    if (!Trace_ofs.is_open())
+    if (!isOpen())
       return;
     if (firstReadAfterProgram) {
       CountersPrev = results;
@@ -268,7 +268,7 @@ namespace xdp {
   void TraceWriterI::writeDeviceTrace(const TraceParser::TraceResultVector &resultVector,
       std::string deviceName, std::string binaryName)
   {
-    if (!Trace_ofs.is_open())
+    if (!isOpen())
       return;
 
     for (auto it = resultVector.begin(); it != resultVector.end(); it++) {
@@ -47,24 +47,24 @@ namespace xdp {
 
 	    // Functions for timeline trace log
 	    // Write timeline trace of a function call such as cl API call
-	    void writeFunction(double time, const std::string& functionName,
+	    virtual void writeFunction(double time, const std::string& functionName,
 	        const std::string& eventName, unsigned int functionID);
 	    // Write timeline trace of kernel execution
-	    void writeKernel(double traceTime, const std::string& commandString,
+	    virtual void writeKernel(double traceTime, const std::string& commandString,
             const std::string& stageString, const std::string& eventString,
             const std::string& dependString, uint64_t objId, size_t size);
-      void writeCu(double traceTime, const std::string& commandString,
+      virtual void writeCu(double traceTime, const std::string& commandString,
             const std::string& stageString, const std::string& eventString,
             const std::string& dependString, uint64_t objId, size_t size, uint32_t cuId);
 	    // Write timeline trace of read/write/copy data transfer
-	    void writeTransfer(double traceTime, RTUtil::e_profile_command_kind kind,
+	    virtual void writeTransfer(double traceTime, RTUtil::e_profile_command_kind kind,
 	        const std::string& commandString, const std::string& stageString,
             const std::string& eventString, const std::string& dependString, size_t size,
             uint64_t srcAddress, const std::string& srcBank,
             uint64_t dstAddress, const std::string& dstBank,
 			std::thread::id threadId);
 	    // Write timeline trace of dependency
-	    void writeDependency(double traceTime, const std::string& commandString,
+	    virtual void writeDependency(double traceTime, const std::string& commandString,
             const std::string& stageString, const std::string& eventString,
             const std::string& dependString);
 
@@ -80,7 +80,7 @@ namespace xdp {
       // stream it to a file
       // TODO: Windows doesn't support variadic functions till VS 2013.
       template<typename T>
-      void writeTableCells(std::ofstream& ofs, T value)
+      void writeTableCells(std::ostream& ofs, T value)
       {
         ofs << cellStart();
         ofs << value;
@@ -88,7 +88,7 @@ namespace xdp {
       }
 
       template<typename T, typename... Args>
-      void writeTableCells(std::ofstream& ofs, T first, Args... args)
+      void writeTableCells(std::ostream& ofs, T first, Args... args)
       {
         writeTableCells(ofs, first);
         writeTableCells(ofs, args...);
@@ -96,19 +96,21 @@ namespace xdp {
 
 	protected:
 	    void openStream(std::ofstream& ofs, const std::string& fileName);
-	    std::ofstream& getStream(){return Trace_ofs;}
+	    // Stream rows are written to, writers not using Trace_ofs override these
+	    virtual std::ostream& getStream(){return Trace_ofs;}
+	    virtual bool isOpen() {return Trace_ofs.is_open();}
 	    
 	protected:
 	    // Document is assumed to consist of document header and document footer
 	    // A binary writer such as write to Xilinx's WDB format (say WDBWriter class) could be
 	    // derived from TraceWriterI. The writing of such a file can still be organized in following steps.
 	    // Any additional intelligence such as streaming compression can be built in the WDBWriter
-	    virtual void writeDocumentHeader(std::ofstream& ofs, const std::string& docName)  { ofs << docName;}
-	    virtual void writeTableHeader(std::ofstream& ofs, const std::string& caption,
+	    virtual void writeDocumentHeader(std::ostream& ofs, const std::string& docName)  { ofs << docName;}
+	    virtual void writeTableHeader(std::ostream& ofs, const std::string& caption,
 	        const std::vector<std::string>& columnLabels) = 0;
-	    virtual void writeTableRowStart(std::ofstream& ofs) { ofs << rowStart(); }
-	    virtual void writeTableRowEnd(std::ofstream& ofs)   { ofs << rowEnd() << newLine(); }
-	    virtual void writeDocumentFooter(std::ofstream& ofs) {}
+	    virtual void writeTableRowStart(std::ostream& ofs) { ofs << rowStart(); }
+	    virtual void writeTableRowEnd(std::ostream& ofs)   { ofs << rowEnd() << newLine(); }
+	    virtual void writeDocumentFooter(std::ostream& ofs) {}
 
 	    // Cell and Row marking tokens
         virtual const char* cellStart()  { return ""; }
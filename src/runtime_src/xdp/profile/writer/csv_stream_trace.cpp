@@ -0,0 +1,196 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "csv_stream_trace.h"
+
+#include <sstream>
+
+namespace xdp {
+
+  CSVStreamTraceWriter::CSVStreamTraceWriter(const std::string& traceFileName,
+      const std::string& platformName, XDPPluginI* Plugin,
+      uint64_t maxFileBytes, bool compress) :
+    CSVTraceWriter("", platformName, Plugin)
+  {
+    if (traceFileName.empty())
+      return;
+
+    std::ostringstream header;
+    writeTimelineHeader(header);
+    mStream.reset(new TraceStream(traceFileName, ".csv", header.str(),
+                                  maxFileBytes, compress));
+    mFileName = mStream->getFileName();
+  }
+
+  CSVStreamTraceWriter::~CSVStreamTraceWriter()
+  {
+    if (mStream) {
+      writeTimelineFooter(getStream());
+      mStream->close();
+    }
+  }
+
+  void CSVStreamTraceWriter::writeTableRowEnd(std::ostream& ofs)
+  {
+    ofs << "\n";
+    if (mStream)
+      mStream->endRow();
+  }
+
+  void CSVStreamTraceWriter::writeCell(const std::string& value)
+  {
+    mStream->write(value);
+    mStream->put(',');
+  }
+
+  // Time with 10 significant digits, as the other writers do
+  void CSVStreamTraceWriter::writeTimeCell(double time)
+  {
+    mStream->writeDouble(time, 10);
+    mStream->put(',');
+  }
+
+  // Object id as showbase, hex and uppercase format it
+  void CSVStreamTraceWriter::writeObjectCell(uint64_t objId)
+  {
+    if (objId)
+      mStream->writeHex(objId, true);
+    else
+      mStream->put('0');
+    mStream->put(',');
+  }
+
+  void CSVStreamTraceWriter::writeEmptyCells(unsigned int count)
+  {
+    for (unsigned int i = 0; i < count; i++)
+      mStream->put(',');
+  }
+
+  void CSVStreamTraceWriter::writeFunction(double time, const std::string& functionName,
+      const std::string& eventName, unsigned int functionID)
+  {
+    if (!mStream)
+      return;
+
+    writeTimeCell(time);
+    writeCell(functionName);
+    writeCell(eventName);
+    writeEmptyCells(10);
+    mStream->writeUInt(functionID);
+    mStream->write(",\n", 2);
+    mStream->endRow();
+  }
+
+  void CSVStreamTraceWriter::writeKernel(double traceTime, const std::string& commandString,
+      const std::string& stageString, const std::string& eventString,
+      const std::string& dependString, uint64_t objId, size_t size)
+  {
+    if (!mStream)
+      return;
+
+    writeTimeCell(traceTime);
+    writeCell(commandString);
+    writeCell(stageString);
+    writeObjectCell(objId);
+    mStream->writeUInt(size);
+    mStream->put(',');
+    writeEmptyCells(6);
+    writeCell(eventString);
+    writeCell(dependString);
+    mStream->put('\n');
+    mStream->endRow();
+  }
+
+  void CSVStreamTraceWriter::writeCu(double traceTime, const std::string& commandString,
+      const std::string& stageString, const std::string& eventString,
+      const std::string& dependString, uint64_t objId, size_t size, uint32_t cuId)
+  {
+    if (!mStream)
+      return;
+
+    writeTimeCell(traceTime);
+    writeCell(commandString);
+    writeCell(stageString);
+    writeObjectCell(objId);
+    mStream->writeUInt(size);
+    mStream->put(',');
+    mStream->writeUInt(cuId);
+    mStream->put(',');
+    writeEmptyCells(5);
+    writeCell(eventString);
+    writeCell(dependString);
+    mStream->put('\n');
+    mStream->endRow();
+  }
+
+  void CSVStreamTraceWriter::writeTransfer(double traceTime, RTUtil::e_profile_command_kind kind,
+      const std::string& commandString, const std::string& stageString,
+      const std::string& eventString, const std::string& dependString, size_t size,
+      uint64_t srcAddress, const std::string& srcBank,
+      uint64_t dstAddress, const std::string& dstBank,
+      std::thread::id threadId)
+  {
+    if (!mStream)
+      return;
+
+    writeTimeCell(traceTime);
+    writeCell(commandString);
+    writeCell(stageString);
+
+    // Address field as in TraceWriterI::writeTransfer
+    mStream->writeHex(srcAddress, false);
+    mStream->put('|');
+    mStream->write(srcBank);
+    if (stageString == "START" || stageString == "END") {
+      // Thread ids only print through a stream
+      mStream->stream() << "|0X" << std::hex << threadId << std::dec;
+
+      if (kind == RTUtil::COPY_BUFFER || kind == RTUtil::COPY_BUFFER_P2P) {
+        mStream->put('|');
+        mStream->writeHex(dstAddress, false);
+        mStream->put('|');
+        mStream->write(dstBank);
+        mStream->write((kind == RTUtil::COPY_BUFFER_P2P) ? "|1" : "|0", 2);
+      }
+    }
+    mStream->put(',');
+
+    mStream->writeUInt(size);
+    mStream->put(',');
+    writeEmptyCells(6);
+    writeCell(eventString);
+    writeCell(dependString);
+    mStream->put('\n');
+    mStream->endRow();
+  }
+
+  void CSVStreamTraceWriter::writeDependency(double traceTime, const std::string& commandString,
+      const std::string& stageString, const std::string& eventString,
+      const std::string& dependString)
+  {
+    if (!mStream)
+      return;
+
+    writeTimeCell(traceTime);
+    writeCell(commandString);
+    writeCell(stageString);
+    writeCell(eventString);
+    writeCell(dependString);
+    mStream->put('\n');
+    mStream->endRow();
+  }
+
+} // xdp
@@ -0,0 +1,75 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __XDP_CSV_STREAM_TRACE_WRITER_H
+#define __XDP_CSV_STREAM_TRACE_WRITER_H
+
+#include "csv_trace.h"
+#include "trace_stream.h"
+
+#include <memory>
+
+namespace xdp {
+
+  // Same timeline rows as CSVTraceWriter, written through a TraceStream
+  // so the logging thread only encodes rows into a buffer. Host event
+  // rows are encoded by hand, device rows go through the stream.
+  // Rotated files start with the header, the footer is in the last one.
+  class CSVStreamTraceWriter: public CSVTraceWriter {
+
+  public:
+    CSVStreamTraceWriter(const std::string& traceFileName, const std::string& platformName,
+                         XDPPluginI* Plugin, uint64_t maxFileBytes, bool compress);
+    ~CSVStreamTraceWriter();
+
+  public:
+    void writeFunction(double time, const std::string& functionName,
+        const std::string& eventName, unsigned int functionID) override;
+    void writeKernel(double traceTime, const std::string& commandString,
+        const std::string& stageString, const std::string& eventString,
+        const std::string& dependString, uint64_t objId, size_t size) override;
+    void writeCu(double traceTime, const std::string& commandString,
+        const std::string& stageString, const std::string& eventString,
+        const std::string& dependString, uint64_t objId, size_t size, uint32_t cuId) override;
+    void writeTransfer(double traceTime, RTUtil::e_profile_command_kind kind,
+        const std::string& commandString, const std::string& stageString,
+        const std::string& eventString, const std::string& dependString, size_t size,
+        uint64_t srcAddress, const std::string& srcBank,
+        uint64_t dstAddress, const std::string& dstBank,
+        std::thread::id threadId) override;
+    void writeDependency(double traceTime, const std::string& commandString,
+        const std::string& stageString, const std::string& eventString,
+        const std::string& dependString) override;
+
+  protected:
+    std::ostream& getStream() override { return mStream->stream(); }
+    bool isOpen() override { return mStream != nullptr; }
+    // Rows of the base writer end here too
+    void writeTableRowEnd(std::ostream& ofs) override;
+
+  private:
+    void writeCell(const std::string& value);
+    void writeTimeCell(double time);
+    void writeObjectCell(uint64_t objId);
+    void writeEmptyCells(unsigned int count);
+
+  private:
+    std::unique_ptr<TraceStream> mStream;
+  };
+
+} // xdp
+
+#endif
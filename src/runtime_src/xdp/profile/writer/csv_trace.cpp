@@ -31,13 +31,7 @@ namespace xdp {
       assert(!Trace_ofs.is_open());
       mFileName += FileExtension;
       openStream(Trace_ofs, mFileName);
-      writeDocumentHeader(Trace_ofs, "Timeline Trace");
-      std::vector<std::string> TimelineTraceColumnLabels = {
-          "Time_msec", "Name", "Event", "Address_Port", "Size",
-          "Latency_cycles", "Start_cycles", "End_cycles",
-          "Latency_usec", "Start_msec", "End_msec"
-      };
-      writeTableHeader(Trace_ofs, "", TimelineTraceColumnLabels);
+      writeTimelineHeader(Trace_ofs);
     }
   }
 
@@ -49,9 +43,9 @@ namespace xdp {
     }
   }
 
-  void CSVTraceWriter::writeDocumentHeader(std::ofstream& ofs, const std::string& docName)
+  void CSVTraceWriter::writeDocumentHeader(std::ostream& ofs, const std::string& docName)
   {
-    if (!ofs.is_open())
+    if (!ofs.good())
       return;
 
     // Header of document
@@ -69,10 +63,10 @@ namespace xdp {
     ofs << "Build version date: " << xrt_build_version_date << "\n";
   }
 
-  void CSVTraceWriter::writeTableHeader(std::ofstream& ofs, const std::string& caption,
+  void CSVTraceWriter::writeTableHeader(std::ostream& ofs, const std::string& caption,
                                         const std::vector<std::string>& columnLabels)
   {
-    if (!ofs.is_open())
+    if (!ofs.good())
       return;
 
     ofs << "\n" << caption << "\n";
@@ -82,15 +76,26 @@ namespace xdp {
     ofs << "\n";
   }
 
-  void CSVTraceWriter::writeDocumentFooter(std::ofstream& ofs)
+  void CSVTraceWriter::writeDocumentFooter(std::ostream& ofs)
   {
-    if (ofs.is_open())
+    if (ofs.good())
       ofs << "\n";
   }
 
-  void CSVTraceWriter::writeTimelineFooter(std::ofstream& ofs)
+  void CSVTraceWriter::writeTimelineHeader(std::ostream& ofs)
   {
-    if (!ofs.is_open())
+    writeDocumentHeader(ofs, "Timeline Trace");
+    std::vector<std::string> TimelineTraceColumnLabels = {
+        "Time_msec", "Name", "Event", "Address_Port", "Size",
+        "Latency_cycles", "Start_cycles", "End_cycles",
+        "Latency_usec", "Start_msec", "End_msec"
+    };
+    writeTableHeader(ofs, "", TimelineTraceColumnLabels);
+  }
+
+  void CSVTraceWriter::writeTimelineFooter(std::ostream& ofs)
+  {
+    if (!ofs.good())
       return;
 
     std::string trString;
@@ -28,13 +28,15 @@ namespace xdp {
       ~CSVTraceWriter();
 
     protected:
-      void writeDocumentHeader(std::ofstream& ofs, const std::string& docName) override;
-      void writeTableHeader(std::ofstream& ofs, const std::string& caption,
+      void writeDocumentHeader(std::ostream& ofs, const std::string& docName) override;
+      void writeTableHeader(std::ostream& ofs, const std::string& caption,
       const std::vector<std::string>& columnLabels) override;
-      void writeTableRowStart(std::ofstream& ofs) override { ofs << "";}
-      void writeTableRowEnd(std::ofstream& ofs) override { ofs << "\n";}
-      void writeDocumentFooter(std::ofstream& ofs) override;
-      void writeTimelineFooter(std::ofstream& ofs);
+      void writeTableRowStart(std::ostream& ofs) override { ofs << "";}
+      void writeTableRowEnd(std::ostream& ofs) override { ofs << "\n";}
+      void writeDocumentFooter(std::ostream& ofs) override;
+      // Document and table header of the timeline
+      void writeTimelineHeader(std::ostream& ofs);
+      void writeTimelineFooter(std::ostream& ofs);
       // Rest of the cell and row parameters are default in base class
       const char* cellEnd() override { return ","; } 
 
@@ -0,0 +1,340 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "trace_stream.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <zlib.h>
+
+namespace xdp {
+
+  static const uint64_t powersOf10[] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+    10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+    100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+    100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL
+  };
+
+  // Room for the row that overfills a buffer
+  static const size_t rowSlack = 4096;
+
+  TraceStream::TraceStream(const std::string& fileName,
+      const std::string& extension, const std::string& header,
+      uint64_t maxFileBytes, bool compress, size_t bufferSize,
+      size_t numBuffers) :
+    mFileName(fileName),
+    mExtension(compress ? extension + ".gz" : extension),
+    mHeader(header),
+    mMaxFileBytes(maxFileBytes),
+    mCompress(compress),
+    mBufferSize(bufferSize),
+    mRowBuf(*this),
+    mOstream(&mRowBuf)
+  {
+    mFirstFileName = mFileName + mExtension;
+
+    // One buffer is filled while the others are written
+    numBuffers = std::max<size_t>(numBuffers, 2);
+    for (size_t i = 0; i < numBuffers; i++) {
+      Buffer buf(new std::string());
+      buf->reserve(mBufferSize + rowSlack);
+      mFree.push_back(std::move(buf));
+    }
+    mCurrent = std::move(mFree.back());
+    mFree.pop_back();
+
+    if (!openFile())
+      throw std::runtime_error("Unable to open profile report for writing");
+    mThread = std::thread(&TraceStream::run, this);
+  }
+
+  TraceStream::~TraceStream()
+  {
+    close();
+  }
+
+  void TraceStream::writeUInt(uint64_t value)
+  {
+    char buf[32];
+    write(buf, toChars(buf, value));
+  }
+
+  void TraceStream::writeDouble(double value, int precision)
+  {
+    char buf[32];
+    write(buf, toChars(buf, value, precision));
+  }
+
+  void TraceStream::writeHex(uint64_t value, bool upperDigits)
+  {
+    const char* digits = upperDigits ? "0123456789ABCDEF" : "0123456789abcdef";
+    char buf[16];
+    size_t n = 0;
+    do {
+      buf[n++] = digits[value & 0xf];
+      value >>= 4;
+    } while (value);
+
+    write("0X", 2);
+    while (n)
+      put(buf[--n]);
+  }
+
+  void TraceStream::endRow()
+  {
+    if (mCurrent->size() < mBufferSize)
+      return;
+    if (mThread.joinable())
+      handOff(false);
+    else
+      mCurrent->clear();
+  }
+
+  void TraceStream::flush()
+  {
+    if (mThread.joinable())
+      handOff(true);
+  }
+
+  void TraceStream::close()
+  {
+    if (!mThread.joinable())
+      return;
+
+    handOff(false);
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mStop = true;
+    }
+    mCondition.notify_all();
+    mThread.join();
+  }
+
+  unsigned int TraceStream::getNumFiles()
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mNumFiles;
+  }
+
+  bool TraceStream::failed()
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mFailed;
+  }
+
+  size_t TraceStream::toChars(char* buf, uint64_t value)
+  {
+    char digits[20];
+    size_t n = 0;
+    do {
+      digits[n++] = '0' + (value % 10);
+      value /= 10;
+    } while (value);
+
+    for (size_t i = 0; i < n; i++)
+      buf[i] = digits[n - 1 - i];
+    return n;
+  }
+
+  size_t TraceStream::toChars(char* buf, double value, int precision)
+  {
+    double mag = std::fabs(value);
+    if (std::isfinite(value) && precision > 0 && precision <= 15
+        && mag < powersOf10[precision] && (mag >= 1e-4 || mag == 0)) {
+      // Digits after the point to get precision significant digits
+      int fracDigits = precision;
+      if (mag >= 1) {
+        for (uint64_t ip = static_cast<uint64_t>(mag); ip >= 10; ip /= 10)
+          fracDigits--;
+        fracDigits--;
+      }
+      else if (mag > 0) {
+        for (double m = mag * 10; m < 1; m *= 10)
+          fracDigits++;
+      }
+
+      // Round the exact fraction digits, half to even as printf does.
+      // The integer part and the error of the product are exact.
+      uint64_t scale = powersOf10[fracDigits];
+      double intPart = std::floor(mag);
+      double frac = mag - intPart;
+      double product = frac * scale;
+      double error = std::fma(frac, static_cast<double>(scale), -product);
+      double digits = std::floor(product);
+      double rest = (product - digits) + error;
+      uint64_t ip = static_cast<uint64_t>(intPart);
+      uint64_t fp = static_cast<uint64_t>(digits);
+      if (rest > 0.5 || (rest == 0.5 && (fp & 1)))
+        fp++;
+      if (fp >= scale) {
+        fp -= scale;
+        ip++;
+      }
+      // Rounded up to one digit more than printf shows without exponent
+      if (ip < powersOf10[precision]) {
+        size_t n = 0;
+        if (std::signbit(value))
+          buf[n++] = '-';
+        n += toChars(buf + n, ip);
+        if (fp) {
+          while (fp % 10 == 0) {
+            fp /= 10;
+            fracDigits--;
+          }
+          buf[n++] = '.';
+          for (int i = fracDigits - 1; i >= 0; i--) {
+            buf[n + i] = '0' + (fp % 10);
+            fp /= 10;
+          }
+          n += fracDigits;
+        }
+        return n;
+      }
+    }
+
+    int n = snprintf(buf, 32, "%.*g", precision, value);
+    return (n < 0) ? 0 : std::min<size_t>(n, 31);
+  }
+
+  TraceStream::RowBuf::int_type TraceStream::RowBuf::overflow(int_type c)
+  {
+    if (!traits_type::eq_int_type(c, traits_type::eof()))
+      mStream.put(traits_type::to_char_type(c));
+    return traits_type::not_eof(c);
+  }
+
+  std::streamsize TraceStream::RowBuf::xsputn(const char* s, std::streamsize n)
+  {
+    mStream.write(s, n);
+    return n;
+  }
+
+  // Queue the current buffer for writing and take a free one
+  void TraceStream::handOff(bool wait)
+  {
+    std::unique_lock<std::mutex> lock(mMutex);
+    if (!mCurrent->empty()) {
+      mCondition.wait(lock, [this] { return !mFree.empty(); });
+      mFull.push_back(std::move(mCurrent));
+      mCurrent = std::move(mFree.back());
+      mFree.pop_back();
+      mCondition.notify_all();
+    }
+    if (wait)
+      mCondition.wait(lock, [this] { return mFull.empty() && !mWriting; });
+  }
+
+  void TraceStream::run()
+  {
+    std::unique_lock<std::mutex> lock(mMutex);
+    for (;;) {
+      mCondition.wait(lock, [this] { return mStop || !mFull.empty(); });
+      if (mFull.empty())
+        break;
+
+      Buffer buf = std::move(mFull.front());
+      mFull.pop_front();
+      mWriting = true;
+      bool failed = mFailed;
+      lock.unlock();
+
+      if (!failed) {
+        // Start the next file once this one has rows and would grow too big
+        if (mMaxFileBytes && mFileBytes > mHeader.size()
+            && mFileBytes + buf->size() > mMaxFileBytes) {
+          closeFile();
+          failed = !openFile();
+        }
+        if (!failed)
+          failed = !writeFile(*buf);
+      }
+
+      buf->clear();
+      if (buf->capacity() > 4 * (mBufferSize + rowSlack)) {
+        buf->shrink_to_fit();
+        buf->reserve(mBufferSize + rowSlack);
+      }
+
+      lock.lock();
+      mFailed = mFailed || failed;
+      mWriting = false;
+      mFree.push_back(std::move(buf));
+      mCondition.notify_all();
+    }
+    lock.unlock();
+    closeFile();
+  }
+
+  bool TraceStream::openFile()
+  {
+    std::string name = mFirstFileName;
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      if (mNumFiles > 0)
+        name = mFileName + "." + std::to_string(mNumFiles) + mExtension;
+      mNumFiles++;
+    }
+
+    // Fast compression keeps up with the rows better than small files
+    if (mCompress)
+      mFile = gzopen(name.c_str(), "wb1");
+    else
+      mFile = fopen(name.c_str(), "w");
+    if (!mFile)
+      return false;
+
+    mFileBytes = 0;
+    return writeFile(mHeader);
+  }
+
+  void TraceStream::closeFile()
+  {
+    if (!mFile)
+      return;
+
+    if (mCompress)
+      gzclose(static_cast<gzFile>(mFile));
+    else
+      fclose(static_cast<FILE*>(mFile));
+    mFile = nullptr;
+  }
+
+  // Write data and flush it, so the file holds all rows handed off so far
+  bool TraceStream::writeFile(const std::string& data)
+  {
+    if (data.empty())
+      return true;
+
+    bool ok;
+    if (mCompress) {
+      auto file = static_cast<gzFile>(mFile);
+      ok = gzwrite(file, data.data(), data.size()) == static_cast<int>(data.size())
+           && gzflush(file, Z_SYNC_FLUSH) == Z_OK;
+    }
+    else {
+      auto file = static_cast<FILE*>(mFile);
+      ok = fwrite(data.data(), 1, data.size(), file) == data.size()
+           && fflush(file) == 0;
+    }
+    mFileBytes += data.size();
+    return ok;
+  }
+
+} // xdp
@@ -0,0 +1,143 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __XDP_TRACE_STREAM_H
+#define __XDP_TRACE_STREAM_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace xdp {
+
+  // **************************************************************************
+  // Buffered trace file written by an I/O thread
+  // **************************************************************************
+  // Rows are encoded into one of a fixed number of preallocated buffers.
+  // Once a row ends and its buffer is full, the buffer is handed to the
+  // I/O thread, which writes it, gzip compressed if asked for, and
+  // returns it for reuse. When all buffers wait to be written, the row
+  // writer waits for one, so memory stays bounded.
+  //
+  // The first file is <fileName><extension>. With a max file size, the
+  // next ones are <fileName>.1<extension> and so on, each starting with
+  // the header. Files only change between buffers, so rows stay whole.
+  // The size counts bytes before compression.
+  //
+  // Rows are written by one thread at a time.
+  class TraceStream {
+
+  public:
+    TraceStream(const std::string& fileName, const std::string& extension,
+                const std::string& header, uint64_t maxFileBytes = 0,
+                bool compress = false, size_t bufferSize = 1024 * 1024,
+                size_t numBuffers = 8);
+    ~TraceStream();
+
+  public:
+    // Append to the current row
+    void put(char c) { mCurrent->push_back(c); }
+    void write(const char* str, size_t len) { mCurrent->append(str, len); }
+    void write(const std::string& str) { mCurrent->append(str); }
+    void writeUInt(uint64_t value);
+    void writeDouble(double value, int precision);
+    // Hex digits with "0X" prefix, uppercase digits if asked for
+    void writeHex(uint64_t value, bool upperDigits);
+    // End of a row, the buffer goes to the I/O thread once full
+    void endRow();
+
+    // Stream appending to the current row, for rows not worth encoding
+    // by hand. Formatting state is kept between rows.
+    std::ostream& stream() { return mOstream; }
+
+    // Write all rows and wait until they are in the file
+    void flush();
+    // Write all rows and stop the I/O thread, no rows are taken after
+    void close();
+
+    // Name of the first file
+    const std::string& getFileName() const { return mFirstFileName; }
+    unsigned int getNumFiles();
+    // Whether the I/O thread failed to open or write a file. Rows
+    // are dropped after a failure.
+    bool failed();
+
+  public:
+    // Format into buf, return the number of chars. Doubles are written
+    // as printf "%.<precision>g" does for values from 1e-4 up to
+    // 10^precision, others through snprintf. buf holds 32 chars.
+    static size_t toChars(char* buf, uint64_t value);
+    static size_t toChars(char* buf, double value, int precision);
+
+  private:
+    class RowBuf : public std::streambuf {
+    public:
+      RowBuf(TraceStream& stream) : mStream(stream) {}
+    protected:
+      int_type overflow(int_type c) override;
+      std::streamsize xsputn(const char* s, std::streamsize n) override;
+    private:
+      TraceStream& mStream;
+    };
+
+    using Buffer = std::unique_ptr<std::string>;
+
+    void handOff(bool wait);
+    void run();
+    bool openFile();
+    void closeFile();
+    bool writeFile(const std::string& data);
+
+  private:
+    std::string mFileName;
+    std::string mExtension;
+    std::string mFirstFileName;
+    std::string mHeader;
+    uint64_t mMaxFileBytes;
+    bool mCompress;
+    size_t mBufferSize;
+
+    // Row writer side
+    Buffer mCurrent;
+    RowBuf mRowBuf;
+    std::ostream mOstream;
+
+    // Shared with the I/O thread
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::deque<Buffer> mFull;
+    std::vector<Buffer> mFree;
+    bool mWriting = false;
+    bool mStop = false;
+    bool mFailed = false;
+    unsigned int mNumFiles = 0;
+
+    // I/O thread side
+    void* mFile = nullptr;   // FILE* or gzFile
+    uint64_t mFileBytes = 0;
+    std::thread mThread;
+  };
+
+} // xdp
+
+#endif
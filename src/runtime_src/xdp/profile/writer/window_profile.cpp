@@ -0,0 +1,105 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "window_profile.h"
+
+#include "xdp/profile/core/rt_profile.h"
+
+namespace xdp {
+
+  WindowProfileWriter::WindowProfileWriter(XDPPluginI* Plugin,
+      const std::string& platformName, const std::string& summaryFileName,
+      WindowTotals& totals, double windowMsec) :
+    CSVProfileWriter(Plugin, platformName, summaryFileName),
+    mTotals(totals),
+    mWindowMsec(windowMsec)
+  {
+  }
+
+  void WindowProfileWriter::writeSummary(RTProfile* profile)
+  {
+    getStream() << "Window (ms): " << mWindowMsec << "\n";
+
+    std::vector<std::string> TimeStatsColumnLabels = { "Name",
+        "Number Of Calls", "Total Time (ms)", "Average Time (ms)" };
+
+    mCurrentTable = "api";
+    writeTableHeader(getStream(), "OpenCL API Calls", TimeStatsColumnLabels);
+    profile->writeAPISummary(this);
+    writeTableFooter(getStream());
+
+    mCurrentTable = "kernel";
+    writeTableHeader(getStream(), "Kernel Execution", TimeStatsColumnLabels);
+    profile->writeKernelSummary(this);
+    writeTableFooter(getStream());
+
+    std::vector<std::string> ComputeUnitColumnLabels = {
+        "Device", "Compute Unit", "Kernel", "Number Of Calls",
+        "Total Time (ms)", "Average Time (ms)" };
+
+    mCurrentTable = "cu";
+    writeTableHeader(getStream(), "Compute Unit Utilization", ComputeUnitColumnLabels);
+    profile->writeComputeUnitSummary(this);
+    writeTableFooter(getStream());
+  }
+
+  bool WindowProfileWriter::getWindowStats(const std::string& name,
+      const TimeStats& stats, uint32_t& calls, double& totalTime)
+  {
+    auto& last = mTotals[mCurrentTable + "|" + name];
+    // Stats may start over, eg. when a program is loaded again
+    if (stats.getNoOfCalls() < last.first)
+      last = std::make_pair(0, 0.0);
+
+    calls = stats.getNoOfCalls() - last.first;
+    totalTime = stats.getTotalTime() - last.second;
+    last = std::make_pair(stats.getNoOfCalls(), stats.getTotalTime());
+    return calls > 0;
+  }
+
+  void WindowProfileWriter::writeTimeStats(const std::string& name, const TimeStats& stats)
+  {
+    uint32_t calls;
+    double totalTime;
+    if (!getWindowStats(name, stats, calls, totalTime))
+      return;
+
+    writeTableRowStart(getStream());
+    writeTableCells(getStream(), name, calls, totalTime, totalTime / calls);
+    writeTableRowEnd(getStream());
+  }
+
+  void WindowProfileWriter::writeComputeUnitSummary(const std::string& name, const TimeStats& stats)
+  {
+    uint32_t calls;
+    double totalTime;
+    if (!getWindowStats(name, stats, calls, totalTime))
+      return;
+
+    //"name" is of the form "deviceName|kernelName|globalSize|localSize|cuName"
+    size_t first_index = name.find_first_of("|");
+    size_t second_index = name.find('|', first_index+1);
+    size_t fourth_index = name.find_last_of("|");
+
+    writeTableRowStart(getStream());
+    writeTableCells(getStream(), name.substr(0, first_index),
+        name.substr(fourth_index+1), // cuName
+        name.substr(first_index+1, second_index - first_index -1), // kernelName
+        calls, totalTime, totalTime / calls);
+    writeTableRowEnd(getStream());
+  }
+
+} // xdp
@@ -0,0 +1,63 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __XDP_WINDOW_PROFILE_WRITER_H
+#define __XDP_WINDOW_PROFILE_WRITER_H
+
+#include "csv_profile.h"
+
+#include <map>
+#include <string>
+#include <utility>
+
+namespace xdp {
+
+  // Number of calls and total time of a summary row at the end of
+  // the previous window, keyed by table and row name
+  using WindowTotals = std::map<std::string, std::pair<uint32_t, double>>;
+
+  // Writes the API call, kernel and compute unit tables of the profile
+  // summary for the window since the previous summary. Counts and
+  // times are the difference of the cumulative stats to the totals
+  // recorded at the end of the previous window, which are updated.
+  // Min and max times of a window are not known and not written.
+  class WindowProfileWriter: public CSVProfileWriter {
+
+  public:
+    WindowProfileWriter(XDPPluginI* Plugin,
+                        const std::string& platformName,
+                        const std::string& summaryFileName,
+                        WindowTotals& totals, double windowMsec);
+
+    virtual void writeSummary(RTProfile* profile) override;
+
+  protected:
+    void writeTimeStats(const std::string& name, const TimeStats& stats) override;
+    void writeComputeUnitSummary(const std::string& name, const TimeStats& stats) override;
+
+  private:
+    // Calls and time of the row in this window, false if none
+    bool getWindowStats(const std::string& name, const TimeStats& stats,
+                        uint32_t& calls, double& totalTime);
+
+    WindowTotals& mTotals;
+    double mWindowMsec;
+    std::string mCurrentTable;
+  };
+
+} // xdp
+
+#endif
@@ -22,6 +22,7 @@
 #include "xocl/core/device.h"
 #include "xocl/core/memory.h"
 #include "core/common/memalign.h"
+#include "core/common/spsc_ring.h"
 
 #include "detail/context.h"
 #include "detail/memory.h"
@@ -32,11 +33,14 @@
 #include <cstdlib>
 #include <mutex>
 #include <deque>
+#include <new>
 
 // Unused code, but left as reference to be reimplemented in needed
 
 namespace {
 
+// Reservation of a range of packets.  Indices are free running packet
+// indices of the pipe ring.
 struct cpu_pipe_reserve_id_t {
   std::size_t head;
   std::size_t tail;
@@ -45,20 +49,31 @@ struct cpu_pipe_reserve_id_t {
   unsigned int ref;
 };
 
+// Host pipe.  The ring is single producer single consumer, multiple
+// work-items reading or writing the pipe are serialized by the read
+// and write mutexes respectively.
 struct cpu_pipe_t {
   std::mutex rd_mutex;
   std::mutex wr_mutex;
-  std::size_t pkt_size;
-  std::size_t pipe_size;
-  std::size_t head;
-  std::size_t tail;
+  xrt_core::spsc_ring ring;
 
   std::deque<cpu_pipe_reserve_id_t*> rd_rids;
   std::deque<cpu_pipe_reserve_id_t*> wr_rids;
 
-  char buf[0];
+  cpu_pipe_t(std::size_t pkt_size, std::size_t max_packets)
+    : ring(pkt_size,max_packets)
+  {}
 };
 
+// Destroy pipe constructed in place in memory from posix_memalign
+static void
+cpu_destroy_pipe(void *v)
+{
+  cpu_pipe_t *p = (cpu_pipe_t*)v;
+  p->~cpu_pipe_t();
+  free(v);
+}
+
 /*
  * 6.13.16.2 - work-item builtins, non-reservation, non-locking
  */
@@ -73,14 +88,7 @@ cpu_write_pipe_nolock(void *v, void *e)
   printf("cpu_write_pipe_nolock %p %p\n", v, e);
 #endif
 
-  std::size_t head = p->head;
-  std::size_t next = (head + p->pkt_size) % p->pipe_size;
-
-  while (next == p->tail);
-
-  std::memcpy(&p->buf[head], e, p->pkt_size);
-  p->head = next;
-
+  p->ring.write(e,1);
   return 0;
 }
 
@@ -94,16 +102,7 @@ cpu_write_pipe_nb_nolock(void *v, void *e)
   printf("cpu_write_pipe_nb_nolock %p %p\n", v, e);
 #endif
 
-  std::size_t head = p->head;
-  std::size_t next = (head + p->pkt_size) % p->pipe_size;
-
-  if (next == p->tail) {
-    return -1;
-  }
-
-  std::memcpy(&p->buf[head], e, p->pkt_size);
-  p->head = next;
-  return 0;
+  return p->ring.try_write(e,1) ? 0 : -1;
 }
 
 XOCL_UNUSED
@@ -116,12 +115,7 @@ cpu_read_pipe_nolock(void *v, void *e)
   printf("cpu_read_pipe_nolock %p %p\n", v, e);
 #endif
 
-  std::size_t tail = p->tail;
-
-  while (p->head == tail);
-
-  std::memcpy(e, &p->buf[tail], p->pkt_size);
-  p->tail = (tail + p->pkt_size) % p->pipe_size;
+  p->ring.read(e,1);
   return 0;
 }
 
@@ -135,16 +129,7 @@ cpu_read_pipe_nb_nolock(void *v, void *e)
   printf("cpu_read_pipe_nb_nolock %p %p\n", v, e);
 #endif
 
-  std::size_t tail = p->tail;
-
-  if (p->head == tail) {
-    return -1;
-  }
-
-  std::memcpy(e, &p->buf[tail], p->pkt_size);
-  p->tail = (tail + p->pkt_size) % p->pipe_size;
-
-  return 0;
+  return p->ring.try_read(e,1) ? 0 : -1;
 }
 
 
@@ -158,15 +143,48 @@ cpu_peek_pipe_nb_nolock(void *v, void *e)
   printf("cpu_peek_pipe_nb_nolock %p %p\n", v, e);
 #endif
 
-  std::size_t tail = p->tail;
+  return p->ring.try_peek(e) ? 0 : -1;
+}
 
-  if (p->head == tail) {
-    return -1;
-  }
-  std::memcpy(e, &p->buf[tail], p->pkt_size);
+/*
+ * Bulk transfer of n packets, non-locking.  Blocking variants return
+ * when all n packets are transferred, non-blocking variants return the
+ * number of packets transferred.
+ */
+
+XOCL_UNUSED
+static int
+cpu_write_pipe_bulk_nolock(void *v, void *e, unsigned n)
+{
+  cpu_pipe_t *p = (cpu_pipe_t*)v;
+  p->ring.write(e,n);
+  return 0;
+}
+
+XOCL_UNUSED
+static unsigned int
+cpu_write_pipe_bulk_nb_nolock(void *v, void *e, unsigned n)
+{
+  cpu_pipe_t *p = (cpu_pipe_t*)v;
+  return p->ring.try_write(e,n);
+}
+
+XOCL_UNUSED
+static int
+cpu_read_pipe_bulk_nolock(void *v, void *e, unsigned n)
+{
+  cpu_pipe_t *p = (cpu_pipe_t*)v;
+  p->ring.read(e,n);
   return 0;
 }
 
+XOCL_UNUSED
+static unsigned int
+cpu_read_pipe_bulk_nb_nolock(void *v, void *e, unsigned n)
+{
+  cpu_pipe_t *p = (cpu_pipe_t*)v;
+  return p->ring.try_read(e,n);
+}
 
 /*
  * 6.13.16.2 - work-item builtins, non-reservation, locking
@@ -222,6 +240,24 @@ cpu_peek_pipe_nb(void *v, void *e)
   return ret;
 }
 
+XOCL_UNUSED
+static int
+cpu_write_pipe_bulk(void *v, void *e, unsigned n)
+{
+  cpu_pipe_t *p = (cpu_pipe_t*)v;
+  std::lock_guard<std::mutex> lk(p->wr_mutex);
+  return cpu_write_pipe_bulk_nolock(v, e, n);
+}
+
+XOCL_UNUSED
+static int
+cpu_read_pipe_bulk(void *v, void *e, unsigned n)
+{
+  cpu_pipe_t *p = (cpu_pipe_t*)v;
+  std::lock_guard<std::mutex> lk(p->rd_mutex);
+  return cpu_read_pipe_bulk_nolock(v, e, n);
+}
+
 /*
  * 6.13.16.2 - work-item builtins, reservation, locking
  */
@@ -238,24 +274,22 @@ cpu_reserve_read_pipe(void *v, unsigned n)
   std::size_t tail;
   if (p->rd_rids.size()) {
     cpu_pipe_reserve_id_t *id = p->rd_rids.back();
-    tail = id->tail;
+    tail = id->next;
   }
   else {
-    tail = p->tail;
+    tail = p->ring.read_index();
   }
 
-  int space = p->head - tail;
-  if (space < 0)
-    space += p->pipe_size;
+  std::size_t space = p->ring.readable_index() - tail;
 
   cpu_pipe_reserve_id_t *rid = 0;
-  if ((int)n <= space) {
+  if (n <= space) {
     rid = (cpu_pipe_reserve_id_t*)malloc(sizeof(cpu_pipe_reserve_id_t));
     if (rid) {
       // success
       rid->tail = tail;
-      rid->next = (tail + (p->pkt_size*n)) % p->pipe_size;
-      rid->size = n*p->pkt_size;
+      rid->next = tail + n;
+      rid->size = n;
       rid->ref = 1;
       p->rd_rids.push_back(rid);
     }
@@ -277,7 +311,7 @@ cpu_commit_read_pipe(void *v, void *r)
 
   while (p->rd_rids.size() && !p->rd_rids.front()->ref) {
     cpu_pipe_reserve_id_t *front = p->rd_rids.front();
-    p->tail = front->next;
+    p->ring.commit_read(front->next);
     p->rd_rids.pop_front();
     free(front);
   }
@@ -292,12 +326,10 @@ cpu_read_pipe_reserve(void *v, void *r, unsigned idx, void *e)
   if (!p || !rid)
     return -1;
 
-  std::size_t offset = idx*p->pkt_size;
-  if (offset > (rid->size+p->pkt_size))
+  if (idx >= rid->size)
     return -1;
 
-  offset = (rid->tail + offset) % p->pipe_size;
-  std::memcpy(e, &p->buf[offset], p->pkt_size);
+  std::memcpy(e, p->ring.slot(rid->tail + idx), p->ring.packet_size());
 
   return 0;
 }
@@ -314,25 +346,22 @@ cpu_reserve_write_pipe(void *v, unsigned n)
   std::size_t head;
   if (p->wr_rids.size()) {
     cpu_pipe_reserve_id_t *id = p->wr_rids.back();
-    head = id->head;
+    head = id->next;
   }
   else {
-    head = p->head;
+    head = p->ring.write_index();
   }
 
-  int next = (head + p->pkt_size) % p->pipe_size;
-  int space = p->tail - next;
-  if (space < 0)
-    space += p->pipe_size;
+  std::size_t space = p->ring.writable_index() - head;
 
   cpu_pipe_reserve_id_t *rid = 0;
-  if ((int)n <= space) {
+  if (n <= space) {
     rid = (cpu_pipe_reserve_id_t*)malloc(sizeof(cpu_pipe_reserve_id_t));
     if (rid) {
       // success
       rid->head = head;
-      rid->next = (head + (p->pkt_size*n)) % p->pipe_size;
-      rid->size = n*p->pkt_size;
+      rid->next = head + n;
+      rid->size = n;
       rid->ref = 1;
       p->wr_rids.push_back(rid);
     }
@@ -354,7 +383,7 @@ cpu_commit_write_pipe(void *v, void *r)
 
   while (p->wr_rids.size() && !p->wr_rids.front()->ref) {
     cpu_pipe_reserve_id_t *front = p->wr_rids.front();
-    p->head = front->next;
+    p->ring.commit_write(front->next);
     p->wr_rids.pop_front();
     free(front);
   }
@@ -369,12 +398,10 @@ cpu_write_pipe_reserve(void *v, void *r, unsigned idx, void *e)
   if (!p || !rid)
     return -1;
 
-  std::size_t offset = idx*p->pkt_size;
-  if (offset > (rid->size+p->pkt_size))
+  if (idx >= rid->size)
     return -1;
 
-  offset = (rid->head + offset) % p->pipe_size;
-  std::memcpy(&p->buf[offset], e, p->pkt_size);
+  std::memcpy(p->ring.slot(rid->head + idx), e, p->ring.packet_size());
 
   return 0;
 }
@@ -423,21 +450,17 @@ cpu_get_pipe_num_packets(void *v)
   cpu_pipe_t *p = (cpu_pipe_t*)v;
 
   std::lock_guard<std::mutex> lk(p->rd_mutex);
-  std::size_t head = p->head;
+  std::size_t head = p->ring.readable_index();
   std::size_t tail;
   if (p->rd_rids.size()) {
     cpu_pipe_reserve_id_t *id = p->rd_rids.back();
-    tail = id->tail;
+    tail = id->next;
   }
   else {
-    tail = p->tail;
+    tail = p->ring.read_index();
   }
 
-  int space = head - tail;
-  if (space < 0)
-    space += p->pipe_size;
-
-  return (unsigned int)(space / p->pkt_size);
+  return (unsigned int)(head - tail);
 }
 
 XOCL_UNUSED
@@ -445,7 +468,7 @@ static unsigned int
 cpu_get_pipe_max_packets(void *v)
 {
   cpu_pipe_t *p = (cpu_pipe_t*)v;
-  return (p->pipe_size / p->pkt_size) - 8;
+  return (unsigned int)p->ring.capacity();
 }
   
 }
@@ -520,12 +543,19 @@ clCreatePipe(cl_context                context,
 
   // TODO: here we allocate a pipe even if it isn't a memory mapped pipe,
   // it would be nice to not allocate the pipe if it's a hardware pipe.
-  size_t nbytes = upipe->get_pipe_packet_size() * (upipe->get_pipe_max_packets()+8);
+  // The packet storage is owned by the pipe's ring.
   void* user_ptr=nullptr;
-  int status = xrt_core::posix_memalign(&user_ptr, 128, (sizeof(cpu_pipe_t)+nbytes));
+  int status = xrt_core::posix_memalign(&user_ptr, 128, sizeof(cpu_pipe_t));
   if (status)
     throw xocl::error(CL_MEM_OBJECT_ALLOCATION_FAILURE);
-  upipe->set_pipe_host_ptr(user_ptr);
+  try {
+    new (user_ptr) cpu_pipe_t(upipe->get_pipe_packet_size(),upipe->get_pipe_max_packets());
+  }
+  catch (...) {
+    free(user_ptr);
+    throw xocl::error(CL_MEM_OBJECT_ALLOCATION_FAILURE);
+  }
+  upipe->set_pipe_host_ptr(user_ptr,cpu_destroy_pipe);
 
   xocl::assign(errcode_ret,CL_SUCCESS);
   return upipe.release();
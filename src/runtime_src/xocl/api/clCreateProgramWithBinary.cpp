@@ -29,9 +29,13 @@
 #include "detail/context.h"
 #include "detail/device.h"
 
+#include "xrt/util/config_reader.h"
+#include "xrt/util/task.h"
+
 #include <exception>
 #include <string>
 #include <algorithm>
+#include <cstdlib>
 
 #include "plugin/xdp/profile.h"
 
@@ -125,18 +129,26 @@ clCreateProgramWithBinary(cl_context                      context ,
   // Construct program object
   auto program = std::make_unique<xocl::program>(xocl::xocl(context),num_devices,device_list,binaries,lengths);
 
-  // Assign binaries to all devices in the list
-  size_t idx = 0;
-  for (auto device : xocl::get_range(device_list,device_list+num_devices)) {
-    try {
-      loadProgramBinary(program.get(),xocl(device));
-      xocl::assign(&binary_status[idx++],CL_SUCCESS);
-    }
-    catch (const xocl::error& ex) {
-      xocl::assign(&binary_status[idx],CL_INVALID_BINARY);
-      throw;
-    }
-  }
+  // Assign binaries to all devices in the list.  Hardware devices are
+  // loaded concurrently.  Emulation devices are loaded serially, the
+  // emulation shims launch the device process of each load by setting
+  // EMULATION_SOCKETID and friends in the process environment and
+  // forking, which is not safe from concurrent loads.  The first
+  // failing device in list order is reported.
+  static bool emulation = std::getenv("XCL_EMULATION_MODE");
+  auto threads = emulation ? 1 : xrt::config::get_device_load_threads();
+  xrt::task::parallel_for
+    (num_devices,threads,
+     [&program,device_list,binary_status](size_t idx) {
+       try {
+         loadProgramBinary(program.get(),xocl(device_list[idx]));
+         xocl::assign(&binary_status[idx],CL_SUCCESS);
+       }
+       catch (const xocl::error& ex) {
+         xocl::assign(&binary_status[idx],CL_INVALID_BINARY);
+         throw;
+       }
+     });
 
   xocl::profile::start_device_profiling(1);
   // NOTE: We read from the counters to set a baseline for values and
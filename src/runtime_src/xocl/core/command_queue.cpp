@@ -76,28 +76,46 @@ queue(event* ev)
   bool ooo = m_props.test(CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE);
   XOCL_DEBUG(std::cout,"queue(",m_uid,") queues event(",ev->get_uid(),")\n");
 
-  std::lock_guard<std::mutex> lk(m_events_mutex);
-  if (!ooo && m_last_queued_event.get()) {
-    m_last_queued_event->chain(ev);
+  // Only the event set, queue tail and barriers are updated under the
+  // queue lock.  The new event is chained on what it follows after the
+  // lock is released, which is safe because the new event cannot be
+  // submitted before this function returns, and because events it
+  // follows are retained here.
+  ev->retain();
+  ptr<event> last;
+  std::vector<ptr<event>> barriers;
+  {
+    std::lock_guard<std::mutex> lk(m_events_mutex);
+    if (!ooo)
+      last = m_last_queued_event;
+    else {
+      barriers.assign(m_barriers.begin(),m_barriers.end());
+      if (ev->get_command_type()==CL_COMMAND_BARRIER)
+        m_barriers.push_back(ev);
+    }
+
+    m_events.insert(ev);
+    m_last_queued_event = ev;
+  }
+
+  if (last.get()) {
+    last->chain(ev);
 
-    auto tmp_lval = static_cast<cl_event>(m_last_queued_event.get());
+    auto tmp_lval = static_cast<cl_event>(last.get());
     xocl::profile::log_dependencies(ev, 1, &tmp_lval);
   }
 
   if (ooo) {
-    for (auto b: m_barriers)
+    std::vector<cl_event> deps;
+    deps.reserve(barriers.size());
+    for (auto& b : barriers) {
       b->chain(ev);
+      deps.push_back(b.get());
+    }
 
-    xocl::profile::log_dependencies(ev, m_barriers.size(), reinterpret_cast<cl_event*>(m_barriers.data()) );
-
-    if (ev->get_command_type()==CL_COMMAND_BARRIER)
-      m_barriers.push_back(ev);
+    xocl::profile::log_dependencies(ev, deps.size(), deps.data());
   }
 
-  m_events.insert(ev);
-  m_last_queued_event = ev;
-  ev->retain();
-
   return true;
 }
 
@@ -23,6 +23,7 @@
 #include "core/common/xclbin_parser.h"
 
 #include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <limits>
 
@@ -33,7 +34,7 @@ compute_unit(const xclbin::symbol* s, const std::string& n, size_t base, size_t
   : m_symbol(s), m_name(n), m_device(d), m_address(base), m_index(idx)
   , m_control(xrt_core::xclbin::get_cu_control(d->get_axlf(),base))
 {
-  static unsigned int count = 0;
+  static std::atomic<unsigned int> count {0};
   m_uid = count++;
 
   XOCL_DEBUGF("xocl::compute_unit::compute_unit(%d) name(%s) index(%zu) address(0x%x)\n",m_uid,m_name.c_str(),m_index,m_address);
@@ -31,10 +31,17 @@
 #include <fstream>
 #include <sstream>
 #include <cstring>
+#include <atomic>
+#include <mutex>
 
 namespace {
 
-static unsigned int uid_count = 0;
+static std::atomic<unsigned int> uid_count {0};
+
+// Programs may be loaded on several devices concurrently.  Calls into
+// the debug and profile plugins and scheduler initialization operate
+// on process wide state and are serialized.
+static std::mutex s_load_mutex;
 
 static
 std::string
@@ -290,7 +297,10 @@ alloc(memory* mem, memidx_type memidx)
 
   auto domain = get_mem_domain(mem);
 
-  auto boh = m_xdevice->alloc(sz,domain,memidx,nullptr);
+  auto pool = get_bo_pool();
+  auto boh = pool ? pool->alloc(sz,domain,memidx) : nullptr;
+  if (!boh)
+    boh = m_xdevice->alloc(sz,domain,memidx,nullptr);
   track(mem);
 
   // Handle unaligned user ptr or bad alloc host_ptr
@@ -329,7 +339,10 @@ alloc(memory* mem)
     }
   }
 
-  auto boh = m_xdevice->alloc(sz);
+  auto pool = get_bo_pool();
+  auto boh = pool ? pool->alloc(sz,xrt::device::memoryDomain::XRT_DEVICE_RAM,xrt::bo_pool::default_memidx) : nullptr;
+  if (!boh)
+    boh = m_xdevice->alloc(sz);
   // Handle unaligned user ptr or bad alloc host_ptr
   if (host_ptr) {
     if (!aligned_flag)
@@ -347,6 +360,20 @@ alloc(memory* mem)
   return boh;
 }
 
+xrt::bo_pool*
+device::
+get_bo_pool() const
+{
+  if (!xrt::config::get_bo_pool())
+    return nullptr;
+
+  std::lock_guard<std::mutex> lk(m_mutex);
+  if (!m_bo_pool && m_xdevice)
+    m_bo_pool = std::make_unique<xrt::bo_pool>
+      (m_xdevice,xrt::config::get_bo_pool_slab_size(),xrt::config::get_bo_pool_max_size());
+  return m_bo_pool.get();
+}
+
 int
 device::
 get_stream(xrt::device::stream_flags flags, xrt::device::stream_attrs attrs, const cl_mem_ext_ptr_t* ext, xrt::device::stream_handle* stream, int32_t& conn)
@@ -697,6 +724,7 @@ free(const memory* mem)
                              + ") is not allocated on device("
                              + std::to_string(get_uid()) + ")");
   m_memobjs.erase(itr);
+  m_mapped.erase(mem);
 }
 
 bool
@@ -845,18 +873,19 @@ map_buffer(memory* buffer, cl_map_flags map_flags, size_t offset, size_t size, v
   void* result = static_cast<char*>(ubuf) + offset;
   assert(!assert_result || result==assert_result);
 
-  // If this buffer is being mapped for writing, then a following
-  // unmap will have to sync the data to device, so record this.  We
-  // will not enforce that map is followed by unmap, so two maps of
-  // same buffer for write without corresponding unmaps will simply
-  // override previous map value.  We do however keep track of the
-  // map with largest size to subsume small maps into the largest.
-  // That way largest chunk is synced to device if necessary.
-  std::lock_guard<std::mutex> lk(m_mutex);
-  auto& mapinfo = m_mapped[result];
-  mapinfo.flags = map_flags;
-  mapinfo.offset = offset;
-  mapinfo.size = std::max(mapinfo.size,size);
+  // Record the map with the buffer's active map ranges.  If mapped
+  // for writing, a following unmap will have to sync the data to
+  // device, which is tracked per range.
+  std::shared_ptr<mapped_ranges> ranges;
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    auto& entry = m_mapped[buffer];
+    if (!entry)
+      entry = std::make_shared<mapped_ranges>();
+    ranges = entry;
+    ++m_mapped_ptrs[result];
+  }
+  ranges->map(offset,size,map_flags);
   return result;
 }
 
@@ -864,31 +893,56 @@ void
 device::
 unmap_buffer(memory* buffer, void* mapped_ptr)
 {
-  cl_map_flags flags = 0; // flags of mapped_ptr
-  size_t offset = 0;      // offset of mapped_ptr wrt BO
-  size_t size = 0;        // size of mapped_ptr
+  std::shared_ptr<mapped_ranges> ranges;
   {
-    // There is no checking that map/unmap match.  Only one active
-    // map of a mapped_ptr is maintained and is erased on first unmap
     std::lock_guard<std::mutex> lk(m_mutex);
-    auto itr = m_mapped.find(mapped_ptr);
-    if (itr!=m_mapped.end()) {
-      flags = (*itr).second.flags;
-      offset = (*itr).second.offset;
-      size = (*itr).second.size;
-      m_mapped.erase(itr);
-    }
+    auto pitr = m_mapped_ptrs.find(mapped_ptr);
+    if (pitr!=m_mapped_ptrs.end() && --(*pitr).second==0)
+      m_mapped_ptrs.erase(pitr);
+    auto itr = m_mapped.find(buffer);
+    if (itr!=m_mapped.end())
+      ranges = (*itr).second;
   }
 
+  if (!ranges)
+    return;
+
   auto xdevice = get_xrt_device();
   auto boh = buffer->get_buffer_object_or_error(this);
 
-  // Sync data to boh if write flags, and sync to device if resident
-  if (flags & (CL_MAP_WRITE | CL_MAP_WRITE_INVALIDATE_REGION)) {
-    if (auto ubuf = static_cast<char*>(buffer->get_host_ptr()))
-      xdevice->write(boh,ubuf+offset,size,offset,false);
-    if (buffer->is_resident(this) && !buffer->no_host_memory())
-      xdevice->sync(boh,size,offset,xrt::hal::device::direction::HOST2DEVICE,false);
+  // Offset of mapped_ptr wrt BO, see map_buffer
+  auto ubuf = static_cast<char*>(buffer->get_host_ptr());
+  auto base = ubuf;
+  if (!base) {
+    base = static_cast<char*>(xdevice->map(boh));
+    xdevice->unmap(boh);
+  }
+  size_t offset = static_cast<char*>(mapped_ptr) - base;
+
+  // Release one map at mapped_ptr.  Dirty ranges are returned once no
+  // other write map overlaps them, so overlapping write maps are
+  // synced once as their union.
+  cl_map_flags flags = 0;
+  std::vector<mapped_ranges::range> sync;
+  ranges->unmap(offset,flags,sync);
+
+  {
+    // Drop the buffer when this was its last map, unless another
+    // thread is about to map it (holds a reference)
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (ranges.use_count()==2 && ranges->empty())
+      m_mapped.erase(buffer);
+  }
+
+  // Sync data to boh, and sync to device if resident
+  if (sync.empty())
+    return;
+  auto resident = buffer->is_resident(this) && !buffer->no_host_memory();
+  for (auto& rng : sync) {
+    if (ubuf)
+      xdevice->write(boh,ubuf+rng.offset,rng.size,rng.offset,false);
+    if (resident)
+      xdevice->sync(boh,rng.size,rng.offset,xrt::hal::device::direction::HOST2DEVICE,false);
   }
 }
 
@@ -996,11 +1050,7 @@ copy_buffer(memory* src_buffer, memory* dst_buffer, size_t src_offset, size_t ds
     auto cb = [this](memory* sbuf, memory* dbuf, size_t soff, size_t doff, size_t sz,const cmd_type& c) {
       try {
         c->start();
-        char* hbuf_src = static_cast<char*>(map_buffer(sbuf,CL_MAP_READ,soff,sz,nullptr));
-        char* hbuf_dst = static_cast<char*>(map_buffer(dbuf,CL_MAP_WRITE_INVALIDATE_REGION,doff,sz,nullptr));
-        std::memcpy(hbuf_dst,hbuf_src,sz);
-        unmap_buffer(sbuf,hbuf_src);
-        unmap_buffer(dbuf,hbuf_dst);
+        host_copy_buffer(sbuf,dbuf,soff,doff,sz);
         c->done();
       }
       catch (const std::exception& ex) {
@@ -1041,6 +1091,68 @@ copy_buffer(memory* src_buffer, memory* dst_buffer, size_t src_offset, size_t ds
   throw std::runtime_error(err.str());
 }
 
+void
+device::
+host_copy_buffer(memory* src_buffer, memory* dst_buffer, size_t src_offset, size_t dst_offset, size_t size)
+{
+  // Chunks are pipelined only when the host side of each buffer
+  // object is the buffer's host memory, otherwise map and unmap
+  // handle the copy to and from the user's host ptr.
+  auto direct = [this](memory* buffer) {
+    auto ubuf = buffer->get_host_ptr();
+    return !ubuf || is_aligned_ptr(ubuf);
+  };
+
+  auto chunk = xrt::config::get_host_copy_chunk_size();
+  if (!chunk || size<=chunk || !direct(src_buffer) || !direct(dst_buffer)) {
+    char* hbuf_src = static_cast<char*>(map_buffer(src_buffer,CL_MAP_READ,src_offset,size,nullptr));
+    char* hbuf_dst = static_cast<char*>(map_buffer(dst_buffer,CL_MAP_WRITE_INVALIDATE_REGION,dst_offset,size,nullptr));
+    std::memcpy(hbuf_dst,hbuf_src,size);
+    unmap_buffer(src_buffer,hbuf_src);
+    unmap_buffer(dst_buffer,hbuf_dst);
+    return;
+  }
+
+  auto xdevice = get_xrt_device();
+  auto src_boh = src_buffer->get_buffer_object(this);
+  auto dst_boh = dst_buffer->get_buffer_object(this);
+  auto src_host = static_cast<char*>(xdevice->map(src_boh));
+  xdevice->unmap(src_boh);
+  auto dst_host = static_cast<char*>(xdevice->map(dst_boh));
+  xdevice->unmap(dst_boh);
+  bool src_sync = src_buffer->is_resident(this);
+  bool dst_sync = dst_buffer->is_resident(this);
+
+  // All device to host chunk syncs are queued up front and picked up
+  // by the DMA read workers.  Each chunk is copied as soon as it has
+  // arrived and its host to device sync is queued to the DMA write
+  // workers, so reading chunk N+1 overlaps the copy of chunk N and the
+  // write of chunk N-1.
+  auto chunks = (size + chunk - 1) / chunk;
+  std::vector<xrt::event> d2h;
+  std::vector<xrt::event> h2d;
+  d2h.reserve(chunks);
+  h2d.reserve(chunks);
+  for (size_t idx=0; src_sync && idx<chunks; ++idx) {
+    auto offset = idx*chunk;
+    auto sz = std::min(chunk,size-offset);
+    d2h.emplace_back(xdevice->sync(src_boh,sz,src_offset+offset,xrt::hal::device::direction::DEVICE2HOST,true));
+  }
+
+  for (size_t idx=0; idx<chunks; ++idx) {
+    auto offset = idx*chunk;
+    auto sz = std::min(chunk,size-offset);
+    if (src_sync)
+      d2h[idx].wait();
+    std::memcpy(dst_host+dst_offset+offset,src_host+src_offset+offset,sz);
+    if (dst_sync)
+      h2d.emplace_back(xdevice->sync(dst_boh,sz,dst_offset+offset,xrt::hal::device::direction::HOST2DEVICE,true));
+  }
+
+  for (auto& ev : h2d)
+    ev.wait();
+}
+
 void
 device::
 copy_p2p_buffer(memory* src_buffer, memory* dst_buffer, size_t src_offset, size_t dst_offset, size_t size)
@@ -1183,14 +1295,20 @@ load_program(program* program)
   m_xclbin = program->get_xclbin(this);
   auto binary = m_xclbin.binary(); // ::xclbin::binary
 
+  // Slabs of pooled buffers are per memory bank of loaded xclbin
+  m_bo_pool.reset();
+
   // Kernel debug is enabled based on if there is debug_data in the
   // binary it does not have sdaccel.ini attribute. If there is
   // debug_data then make sure xdp is loaded
   if (binary.debug_data().first)
     xrt::hal::load_xdp();
 
-  xocl::debug::reset(get_axlf());
-  xocl::profile::reset(get_axlf());
+  {
+    std::lock_guard<std::mutex> lk(s_load_mutex);
+    xocl::debug::reset(get_axlf());
+    xocl::profile::reset(get_axlf());
+  }
 
   // validatate target binary for target device and set the xrt device
   // according to target binary this is likely temp code that is
@@ -1222,6 +1340,7 @@ load_program(program* program)
       for (auto& clock : kclocks) {
         if (idx == 0) {
           std::string device_name = get_unique_name();
+          std::lock_guard<std::mutex> lk(s_load_mutex);
           profile::set_kernel_clock_freq(device_name, clock.frequency);
         }
         target_freqs[idx++] = clock.frequency;
@@ -1279,11 +1398,12 @@ load_program(program* program)
   }
 
   m_active = program;
-  profile::add_to_active_devices(get_unique_name());
 
   // In order to use virtual CUs (KDMA) we must open a virtual context
   m_xdevice->acquire_cu_context(-1,true);
 
+  std::lock_guard<std::mutex> lk(s_load_mutex);
+  profile::add_to_active_devices(get_unique_name());
   init_scheduler(this);
 }
 
@@ -1295,6 +1415,10 @@ unload_program(const program* program)
     clear_cus();
     m_xdevice->release_cu_context(-1); // release virtual CU context
     m_active = nullptr;
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (m_bo_pool && xrt::config::get_xocl_debug())
+      m_bo_pool->print_stats(std::cout);
+    m_bo_pool.reset();
   }
 }
 
@@ -21,8 +21,10 @@
 #include "xocl/core/refcount.h"
 #include "xocl/core/error.h"
 #include "xocl/core/compute_unit.h"
+#include "xocl/core/mapped_ranges.h"
 #include "xocl/xclbin/xclbin.h"
 #include "xrt/device/device.h"
+#include "xrt/device/bo_pool.h"
 #include "xrt/scheduler/command.h"
 
 #include <unistd.h>
@@ -397,6 +399,15 @@ public:
   void
   unmap_buffer(memory* mem, void* mapped_ptr);
 
+  /**
+   * Copy buffer through host memory
+   *
+   * Copies larger than the host copy chunk size are split in chunks,
+   * and device syncs of the chunks are pipelined on the DMA workers.
+   */
+  void
+  host_copy_buffer(memory* src_buffer, memory* dst_buffer, size_t src_offset, size_t dst_offset, size_t size);
+
   /**
    * Migrate buffer to this device (clEnqueueMigrateMemObjects)
    *
@@ -654,7 +665,7 @@ public:
   is_mapped(const void* mapped_ptr) const
   {
     std::lock_guard<std::mutex> lk(m_mutex);
-    return (m_mapped.find(mapped_ptr)!=m_mapped.end());
+    return (m_mapped_ptrs.find(mapped_ptr)!=m_mapped_ptrs.end());
   }
 
   /**
@@ -769,14 +780,21 @@ private:
   xrt::device::BufferObjectHandle
   alloc(memory* mem);
 
+  /**
+   * Get the small buffer sub-allocation pool of this device
+   *
+   * The pool is created on first use if enabled through
+   * xrt::config::get_bo_pool() and is reset when a program is
+   * loaded or unloaded.
+   *
+   * @return
+   *   Pool or nullptr if pooling is not enabled
+   */
+  xrt::bo_pool*
+  get_bo_pool() const;
+
 
 private:
-  struct mapinfo {
-    cl_map_flags flags = 0; // mapflags
-    size_t offset = 0;      // boh:hbuf offset
-    size_t size = 0;        // max size mapped
-  };
-
   unsigned int m_uid = 0;
   program* m_active = nullptr;   // program loaded on to this device
   xclbin m_xclbin;               // cache xclbin that came from program
@@ -795,10 +813,13 @@ private:
   // Mutual exclusive access to this device
   mutable std::mutex m_mutex;
 
-  // Track how a region of a buffer object is mapped.  There is
-  // no tracking of matching map and unmap.  Last map of a region
-  // is what is stored and first unmap of a region erases the content.
-  std::map<const void*,mapinfo> m_mapped;
+  // Active maps per buffer.  The device mutex guards only this
+  // lookup, map ranges of a buffer are guarded by their own lock.  A
+  // buffer is removed when it has no active maps or pending syncs.
+  std::map<const memory*,std::shared_ptr<mapped_ranges>> m_mapped;
+
+  // Mapped ptrs and their count of active maps, for unmap validation
+  std::map<const void*,unsigned int> m_mapped_ptrs;
 
   // Track memory objects allocated on this device
   std::set<const memory*> m_memobjs;
@@ -806,6 +827,9 @@ private:
   // CUs populated during load_program or by sub device contructor.
   compute_unit_vector_type m_computeunits;
 
+  // Small buffer sub-allocation pool, created on first use
+  mutable std::unique_ptr<xrt::bo_pool> m_bo_pool;
+
   // Caching.  Purely implementation detail (-2 => not initialized)
   mutable memidx_type m_cu_memidx = -2;
 };
@@ -57,7 +57,7 @@ event::
 event(command_queue* cq, context* ctx, cl_command_type cmd)
   : m_context(ctx), m_command_queue(cq), m_command_type(cmd), m_wait_count(1)
 {
-  static unsigned int uid_count = 0;
+  static std::atomic<unsigned int> uid_count {0};
   m_uid = uid_count++;
   debug::add_command_type(this,cmd);
 
@@ -85,6 +85,12 @@ event::
   XOCL_DEBUG(std::cout,"xocl::event::~event(",m_uid,")\n");
   for (auto& cb : sg_destructor_callbacks)
     cb(this);
+
+  for (auto node=chain_head(m_chain.load()); node; ) {
+    auto next = node->next;
+    delete node;
+    node = next;
+  }
 }
 
 cl_int
@@ -135,8 +141,15 @@ set_status(cl_int s)
     // remove the completed event from queue (submitted queue)
     // before event_scheduler attempts to submit next event.
     queue_remove();   // 1 (order matters)
-    for (auto& c : m_chain) // not a race, since m_chain is blocked by CL_COMPLETE
-      c->submit();
+
+    // Close the chain, events chained from here on see this event
+    // as complete.  Submit chained events in the order they chained.
+    std::vector<event*> chained;
+    auto head = m_chain.fetch_or(chain_closed,std::memory_order_acq_rel);
+    for (auto node=chain_head(head); node; node=node->next)
+      chained.push_back(node->ev.get());
+    for (auto itr=chained.rbegin(); itr!=chained.rend(); ++itr)
+      (*itr)->submit();
   }
 
   return s;
@@ -177,13 +190,15 @@ bool
 event::
 submit()
 {
+  // Only the caller that drops the wait count to zero submits
+  auto wait_count = --m_wait_count;
+  if (wait_count) {
+    XOCL_DEBUG(std::cout,"event(",m_uid,") cannot submit wait_count(",wait_count,")\n");
+    return false;
+  }
+
   {
     std::lock_guard<std::mutex> lk(m_mutex);
-    if (--m_wait_count) {
-      XOCL_DEBUG(std::cout,"event(",m_uid,") cannot submit wait_count(",m_wait_count,")\n");
-      return false;
-    }
-
     XOCL_UNUSED auto submitted = queue_submit();
     assert(submitted);
 
@@ -322,18 +337,33 @@ chain(event* ev)
   // assert(ev is locked because it is being enqueued || called from "ev" event ctor);
   assert(ev->m_status == -1); // ev is being enq'ed or ctored
 
-  std::lock_guard<std::mutex> lk(m_mutex);
-  if (m_status == CL_COMPLETE)
+  auto head = m_chain.load(std::memory_order_acquire);
+  if (head & chain_closed)
     return;
-  m_chain.push_back(ev);
+
+  // Count the dependency before it is visible to completion
   ++ev->m_wait_count;
+  auto node = new chain_node{ev,nullptr};
+  do {
+    if (head & chain_closed) {
+      // Completed while chaining
+      delete node;
+      --ev->m_wait_count;
+      return;
+    }
+    node->next = chain_head(head);
+  } while (!m_chain.compare_exchange_weak(head,reinterpret_cast<uintptr_t>(node),
+                                          std::memory_order_acq_rel,std::memory_order_acquire));
 }
 
 bool
 event::
 chains_nolock(const event* ev) const
 {
-  return std::find(m_chain.begin(),m_chain.end(),ev)!=m_chain.end();
+  for (auto node=chain_head(m_chain.load(std::memory_order_acquire)); node; node=node->next)
+    if (node->ev.get()==ev)
+      return true;
+  return false;
 }
 
 bool
@@ -30,6 +30,9 @@
 #include <vector>
 #include <functional>
 #include <iostream>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
 
 namespace xocl {
 
@@ -179,7 +182,12 @@ public:
     std::unique_lock<std::mutex> lk(m_mutex, std::defer_lock);
     if (!lk.try_lock())
       throw xocl::error(DBG_EXCEPT_LOCK_FAILED, "Failed to secure lock on event");
-    return range_lock<event_iterator_type>(m_chain.begin(),m_chain.end(),std::move(lk));
+    // Snapshot of the lock free chain, stable while lock is held
+    m_chain_snapshot.clear();
+    for (auto node=chain_head(m_chain.load(std::memory_order_acquire)); node; node=node->next)
+      m_chain_snapshot.push_back(node->ev);
+    std::reverse(m_chain_snapshot.begin(),m_chain_snapshot.end());
+    return range_lock<event_iterator_type>(m_chain_snapshot.begin(),m_chain_snapshot.end(),std::move(lk));
   }
 
   // for the time being the status is changed all over the place
@@ -396,12 +404,29 @@ protected:
    *
    * It is guaranteed argument event is already locked (called from
    * queue::queue(ev)), or that this function is called from ev's
-   * contructor in which case there is no need to lock
+   * contructor in which case there is no need to lock.  This event
+   * is not locked, the chain is lock free.
    */
   void
   chain(event* ev);
 
 private:
+  // Node of lock free singly linked list of chained events
+  struct chain_node
+  {
+    ptr<event> ev;
+    chain_node* next;
+  };
+
+  // Low bit of chain head marks the chain closed by completion
+  static constexpr uintptr_t chain_closed = 1;
+
+  static chain_node*
+  chain_head(uintptr_t head)
+  {
+    return reinterpret_cast<chain_node*>(head & ~chain_closed);
+  }
+
   /**
    * Submit this event for execution if possible
    *
@@ -516,12 +541,19 @@ private:
   // allocation unless needed.
   std::unique_ptr<callback_list> m_callbacks;
 
-  // List of chained events (events to submit upon completion)
-  event_vector_type m_chain;
+  // List of chained events (events to submit upon completion).
+  // Events are pushed at the head with compare and swap, most recent
+  // first.  Completion closes the list, after which chaining does
+  // nothing and the list is immutable until this event is deleted.
+  std::atomic<uintptr_t> m_chain {0};
+
+  // Chained events copied for debug access, see try_get_chain
+  event_vector_type m_chain_snapshot;
 
   // Number of events this event is waiting on.  This includes
-  // explicit event depedencies and events that chain this
-  unsigned int m_wait_count = 0;
+  // explicit event depedencies and events that chain this.  The
+  // event submits when the count drops to zero.
+  std::atomic<unsigned int> m_wait_count {0};
 };
 
 /**
@@ -297,9 +297,9 @@ cu_control_type() const
   return m_cus.front()->get_control_type();
 }
 
-bool
+void
 execution_context::
-write(const command_type& cmd)
+finalize(const command_type& cmd)
 {
   auto& packet = cmd->get_packet();
   auto data_size = packet.size() - 1; // subtract header
@@ -329,9 +329,6 @@ write(const command_type& cmd)
     for (size_t i=0; i<packet.size(); ++i)
       ostr << "0x" << std::uppercase << std::setfill('0') << std::setw(8) << std::hex << packet[i] << std::dec << "\n";
   }
-
-  xrt::scheduler::schedule(cmd);
-  return true;
 }
 
 void
@@ -391,7 +388,7 @@ update_work()
   m_done = true;
 }
 
-void
+execution_context::command_type
 execution_context::
 start()
 {
@@ -410,7 +407,6 @@ start()
   auto cmd = conformance::on()
     ? std::make_shared<start_kernel_conformance>(xdevice,this,opcode)
     : std::make_shared<start_kernel>(xdevice,this,opcode);
-  ++m_active;
   auto& packet = cmd->get_packet();
 
   // Encode CUs in cu bitmasks with bits in position according to the
@@ -533,8 +529,12 @@ start()
       fill_regmap(regmap,offset,opcode,ctrl,&printf_buffer_addr,sizeof(printf_buffer_addr),arg->get_arginfo_range());
   }
 
-  // send command to mbs
-  write(cmd);
+  finalize(cmd);
+
+  // Count the command only once it is complete, a throw above leaves
+  // no active command behind that would never be done
+  ++m_active;
+  return cmd;
 }
 
 bool
@@ -586,12 +586,21 @@ execute()
   // In order to keep scheduler busy, we need more than just one
   // workgroup at a time, so here we try to ensure that the scheduled
   // commands at any given time is twice the number of available CUs.
+  //
+  // The commands for all workgroups started here are sent to the
+  // scheduler in one batch.  If a workgroup fails to start, those
+  // started before it are still scheduled so that they complete.
   auto limit = m_dataflow ? 20*m_cus.size() : 2*m_cus.size();
-  for (size_t i=m_active; !m_done && i<limit; ++i) {
-    start();
-    update_work();
-    XOCL_DEBUG(std::cout,"active=",m_active,"\n");
-  }
+  size_t i = m_active;
+  xrt::scheduler::schedule_batch
+    ([this,&i,limit]() -> command_type {
+      if (m_done || i++>=limit)
+        return nullptr;
+      auto cmd = start();
+      update_work();
+      XOCL_DEBUG(std::cout,"active=",m_active,"\n");
+      return cmd;
+    });
 
   return m_done;
 }
@@ -656,10 +665,14 @@ conformance_execute()
   // Run
   conformance::active(this);
   // Schedule all workgroups
-  for (size_t i=0; !m_done; ++i) {
-    start();
-    update_work();
-  }
+  xrt::scheduler::schedule_batch
+    ([this]() -> command_type {
+      if (m_done)
+        return nullptr;
+      auto cmd = start();
+      update_work();
+      return cmd;
+    });
 
   return true;
 }
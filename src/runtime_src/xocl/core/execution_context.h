@@ -115,8 +115,11 @@ private:
   void
   add_compute_units(xocl::device* device);
 
-  bool
-  write(const command_type& cmd);
+  /**
+   * Finalize command header prior to scheduling
+   */
+  void
+  finalize(const command_type& cmd);
 
   void
   encode_compute_units(packet_type& pkt);
@@ -133,7 +136,13 @@ private:
   void
   update_work();
 
-  void
+  /**
+   * Construct command for current workgroup.
+   *
+   * The command is not scheduled, caller schedules commands for
+   * multiple workgroups in one batch.
+   */
+  command_type
   start();
 
   /**
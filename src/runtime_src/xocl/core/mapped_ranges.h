@@ -0,0 +1,185 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef xocl_core_mapped_ranges_h_
+#define xocl_core_mapped_ranges_h_
+
+#include <CL/cl.h>
+#include <map>
+#include <vector>
+#include <mutex>
+#include <algorithm>
+#include <cstddef>
+
+namespace xocl {
+
+/**
+ * Track active maps of one buffer object by byte range.
+ *
+ * Every map of the buffer is recorded with its offset, size, and map
+ * flags.  Identical maps share one entry with a reference count, so
+ * repeated maps of the same region need matching unmaps.
+ *
+ * Ranges unmapped after a write map are collected as dirty and merged
+ * into disjoint intervals.  A dirty interval is handed back for sync
+ * once no active write map overlaps it, so overlapping write windows
+ * are synced once, as their union, when the last of them is unmapped.
+ *
+ * All member functions are thread safe; the lock is per buffer.
+ */
+class mapped_ranges
+{
+public:
+  struct range
+  {
+    size_t offset;
+    size_t size;
+  };
+
+  static bool
+  is_write(cl_map_flags flags)
+  {
+    return (flags & (CL_MAP_WRITE | CL_MAP_WRITE_INVALIDATE_REGION)) != 0;
+  }
+
+  /**
+   * Record a map of [offset,offset+size)
+   */
+  void
+  map(size_t offset, size_t size, cl_map_flags flags)
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    auto rng = m_active.equal_range(offset);
+    for (auto itr=rng.first; itr!=rng.second; ++itr) {
+      if (itr->second.size==size && itr->second.flags==flags) {
+        ++itr->second.refs;
+        return;
+      }
+    }
+    m_active.emplace(offset,entry{size,flags,1});
+  }
+
+  /**
+   * Release one map at offset
+   *
+   * When several maps start at offset, write maps are released
+   * before read maps, last mapped first.
+   *
+   * @offset: offset of mapped ptr within the buffer
+   * @flags: [out] flags of the released map
+   * @sync: [out] dirty ranges that can be synced now
+   * @return
+   *   false if there is no active map at offset
+   */
+  bool
+  unmap(size_t offset, cl_map_flags& flags, std::vector<range>& sync)
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    auto rng = m_active.equal_range(offset);
+    if (rng.first==rng.second)
+      return false;
+
+    auto release = std::prev(rng.second);
+    for (auto itr=rng.second; itr!=rng.first; ) {
+      --itr;
+      if (is_write(itr->second.flags)) {
+        release = itr;
+        break;
+      }
+    }
+
+    flags = release->second.flags;
+    auto size = release->second.size;
+    if (--release->second.refs==0)
+      m_active.erase(release);
+
+    if (is_write(flags)) {
+      add_dirty(offset,size);
+      flush_dirty(sync);
+    }
+    return true;
+  }
+
+  /**
+   * @return
+   *   true if no maps are active and nothing is left to sync
+   */
+  bool
+  empty() const
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return m_active.empty() && m_dirty.empty();
+  }
+
+private:
+  struct entry
+  {
+    size_t size;
+    cl_map_flags flags;
+    unsigned int refs;
+  };
+
+  // Merge [offset,offset+size) into disjoint dirty intervals
+  void
+  add_dirty(size_t offset, size_t size)
+  {
+    auto begin = offset;
+    auto end = offset + size;
+    auto itr = m_dirty.upper_bound(begin);
+    if (itr!=m_dirty.begin() && std::prev(itr)->second>=begin)
+      --itr;
+    while (itr!=m_dirty.end() && itr->first<=end) {
+      begin = std::min(begin,itr->first);
+      end = std::max(end,itr->second);
+      itr = m_dirty.erase(itr);
+    }
+    m_dirty.emplace(begin,end);
+  }
+
+  bool
+  overlaps_write_map(size_t begin, size_t end) const
+  {
+    for (auto& active : m_active) {
+      if (active.first>=end)
+        break;
+      if (is_write(active.second.flags) && active.first+active.second.size>begin)
+        return true;
+    }
+    return false;
+  }
+
+  // Move dirty intervals not covered by an active write map to sync
+  void
+  flush_dirty(std::vector<range>& sync)
+  {
+    for (auto itr=m_dirty.begin(); itr!=m_dirty.end(); ) {
+      if (overlaps_write_map(itr->first,itr->second)) {
+        ++itr;
+        continue;
+      }
+      sync.push_back({itr->first,itr->second-itr->first});
+      itr = m_dirty.erase(itr);
+    }
+  }
+
+  mutable std::mutex m_mutex;
+  std::multimap<size_t,entry> m_active;  // offset -> map
+  std::map<size_t,size_t> m_dirty;       // begin -> end
+};
+
+} // xocl
+
+#endif
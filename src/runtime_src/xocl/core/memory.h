@@ -769,14 +769,29 @@ class pipe : public memory
 {
   using pipe_property_type = memory::pipe_property_type;
 public:
+  using host_ptr_deleter = void (*)(void*);
+
   pipe(context* ctx,cl_mem_flags flags, cl_uint packet_size, cl_uint max_packets)
     : memory(ctx,flags), m_packet_size(packet_size), m_max_packets(max_packets)
   {}
 
+  ~pipe()
+  {
+    if (m_host_ptr && m_host_ptr_deleter)
+      m_host_ptr_deleter(m_host_ptr);
+  }
+
+  /**
+   * Set the host side pipe object
+   *
+   * @p: the host pipe
+   * @deleter: called with @p when this pipe is destroyed
+   */
   void
-  set_pipe_host_ptr(void* p)
+  set_pipe_host_ptr(void* p, host_ptr_deleter deleter)
   {
     m_host_ptr = p;
+    m_host_ptr_deleter = deleter;
   }
 
   virtual cl_mem_object_type
@@ -814,6 +829,7 @@ private:
   cl_uint m_packet_size = 0;
   cl_uint m_max_packets = 0;
   void* m_host_ptr = nullptr;
+  host_ptr_deleter m_host_ptr_deleter = nullptr;
 };
 
 inline const void*
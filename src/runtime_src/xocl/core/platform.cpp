@@ -20,12 +20,16 @@
 
 #include "xocl/xclbin/xclbin.h"
 #include "xrt/scheduler/scheduler.h"
+#include "xrt/util/config_reader.h"
+#include "xrt/util/task.h"
 
 #include <boost/filesystem/operations.hpp>
 #include <boost/filesystem/path.hpp>
 #include <fstream>
 #include <iostream>
 #include <cassert>
+#include <vector>
+#include <memory>
 
 namespace {
 
@@ -232,9 +236,20 @@ platform()
   }
 
   //User can target either emulation or board. Not both at the same time.
+  //Hardware devices are opened concurrently, but added in order.
   if (!is_emulation_mode() && m_device_mgr->has_hw_devices()) {
-    while (xrt::device* hw_device = m_device_mgr->get_hw_device()) {
-      auto udev = std::make_unique<xocl::device>(this,hw_device,nullptr,nullptr);
+    std::vector<xrt::device*> hw_devices;
+    while (xrt::device* hw_device = m_device_mgr->get_hw_device())
+      hw_devices.push_back(hw_device);
+
+    std::vector<std::unique_ptr<xocl::device>> udevs(hw_devices.size());
+    xrt::task::parallel_for
+      (hw_devices.size(),xrt::config::get_device_load_threads(),
+       [this,&hw_devices,&udevs](size_t idx) {
+         udevs[idx] = std::make_unique<xocl::device>(this,hw_devices[idx],nullptr,nullptr);
+       });
+
+    for (auto& udev : udevs) {
       auto dev = udev.release();
       add_device(dev);
       dev->release();
@@ -22,6 +22,7 @@
 #include "error.h"
 
 #include "xocl/api/plugin/xdp/profile.h"
+#include "core/common/xclbin_image.h"
 
 #include <boost/filesystem/operations.hpp>
 #include <vector>
@@ -101,9 +102,13 @@ program(context* ctx,cl_uint num_devices, const cl_device_id* devices,
         const unsigned char** binaries, const size_t* lengths)
   : program(ctx,"")
 {
+  // Devices given the same binary share one image, the image is
+  // copied only if not already registered.  Meta data is parsed per
+  // device since the xclbin tracks per device connection state.
   for (cl_uint i=0; i<num_devices; ++i) {
+    auto image = xrt_core::xclbin_image::create(reinterpret_cast<const char*>(binaries[i]),lengths[i]);
     m_devices.push_back(xocl::xocl(devices[i]));
-    m_binaries.emplace(xocl::xocl(devices[i]),std::vector<char>(binaries[i],binaries[i]+lengths[i]));
+    m_binaries.emplace(xocl::xocl(devices[i]),xclbin(std::move(image)));
   }
 
   // Verify that each binary contains the same kernels
@@ -0,0 +1,90 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+////////////////////////////////////////////////////////////////
+// Unit testing and benchmark of xrt/device/bo_pool.h
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+#include "setup.h"
+
+#include "xocl/core/device.h"
+#include "xocl/core/time.h"
+#include "xrt/device/bo_pool.h"
+#include <vector>
+#include <iostream>
+
+BOOST_AUTO_TEST_SUITE ( test_bo_pool )
+
+BOOST_AUTO_TEST_CASE( test_bo_pool1 )
+{
+  ocl_sw_emulation ocl;
+  auto xdevice = xocl::xocl(ocl.device)->get_xrt_device();
+
+  size_t count=10000;
+  size_t sz=128;
+  unsigned long direct_time = 0;
+  unsigned long pooled_time = 0;
+
+  // Direct allocation, one buffer object per buffer
+  {
+    xocl::time_guard tg(direct_time);
+    std::vector<xrt::device::BufferObjectHandle> bos;
+    bos.reserve(count);
+    for (size_t i=0; i<count; ++i)
+      bos.push_back(xdevice->alloc(sz));
+  }
+
+  // Pooled allocation
+  xrt::bo_pool pool(xdevice,0x400000,0x10000);
+  {
+    xocl::time_guard tg(pooled_time);
+    std::vector<xrt::device::BufferObjectHandle> bos;
+    bos.reserve(count);
+    for (size_t i=0; i<count; ++i)
+      bos.push_back(pool.alloc(sz,xrt::device::memoryDomain::XRT_DEVICE_RAM,xrt::bo_pool::default_memidx));
+
+    for (auto& bo : bos)
+      BOOST_REQUIRE(bo);
+
+    // Pooled buffers must not overlap
+    auto align = xdevice->getAlignment();
+    for (size_t i=1; i<count; ++i) {
+      auto a0 = xdevice->getDeviceAddr(bos[i-1]);
+      auto a1 = xdevice->getDeviceAddr(bos[i]);
+      BOOST_CHECK(a0 != a1);
+      BOOST_CHECK_EQUAL(a1 % align,0);
+    }
+
+    auto st = pool.get_stats();
+    BOOST_CHECK_EQUAL(st.buffers_in_use,count);
+  }
+
+  auto st = pool.get_stats();
+  BOOST_CHECK_EQUAL(st.buffers_in_use,0);
+  BOOST_CHECK_EQUAL(st.bytes_in_use,0);
+  BOOST_CHECK_EQUAL(st.allocations,count);
+  BOOST_CHECK_EQUAL(st.releases,count);
+
+  // Oversized buffers are not pooled
+  BOOST_CHECK(!pool.alloc(0x20000,xrt::device::memoryDomain::XRT_DEVICE_RAM,xrt::bo_pool::default_memidx));
+
+  std::cout << "Buffer object create/release for " << count << " buffers of " << sz << " bytes\n";
+  std::cout << "Direct time: " << direct_time*1e-6 << "\n";
+  std::cout << "Pooled time: " << pooled_time*1e-6 << "\n";
+  pool.print_stats(std::cout);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
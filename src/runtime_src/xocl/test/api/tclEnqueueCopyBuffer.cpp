@@ -0,0 +1,79 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include "setup.h"
+
+#include "xocl/core/time.h"
+#include <vector>
+#include <iostream>
+
+// To run all tests in this suite use
+//  % em -env opt txocl --run_test=test_clEnqueueCopyBuffer
+//
+// test_clEnqueueCopyBuffer1
+//   Copy between resident buffers through host memory, verify data
+//   and report bandwidth across sizes.  Copies larger than
+//   Runtime.host_copy_chunk_kb are pipelined in chunks.
+
+BOOST_AUTO_TEST_SUITE ( test_clEnqueueCopyBuffer )
+
+BOOST_AUTO_TEST_CASE( test_clEnqueueCopyBuffer1 )
+{
+  ocl_sw_emulation ocl;
+  cl_int err = CL_SUCCESS;
+
+  auto cq = clCreateCommandQueue(ocl.context,ocl.device,0,&err);
+  BOOST_CHECK_EQUAL(err,CL_SUCCESS);
+
+  for (size_t sz : { size_t(64*1024), size_t(1024*1024), size_t(16*1024*1024), size_t(128*1024*1024) }) {
+    std::vector<char> data(sz);
+    for (size_t i=0; i<sz; ++i)
+      data[i] = static_cast<char>(i*7);
+
+    auto src = clCreateBuffer(ocl.context,CL_MEM_READ_WRITE,sz,nullptr,&err);
+    BOOST_CHECK_EQUAL(err,CL_SUCCESS);
+    auto dst = clCreateBuffer(ocl.context,CL_MEM_READ_WRITE,sz,nullptr,&err);
+    BOOST_CHECK_EQUAL(err,CL_SUCCESS);
+
+    // Make both buffers resident, src with data
+    BOOST_CHECK_EQUAL(clEnqueueWriteBuffer(cq,src,CL_TRUE,0,sz,data.data(),0,nullptr,nullptr),CL_SUCCESS);
+    cl_mem mems[] = { dst };
+    BOOST_CHECK_EQUAL(clEnqueueMigrateMemObjects(cq,1,mems,0,0,nullptr,nullptr),CL_SUCCESS);
+    clFinish(cq);
+
+    unsigned long time = 0;
+    {
+      xocl::time_guard tg(time);
+      BOOST_CHECK_EQUAL(clEnqueueCopyBuffer(cq,src,dst,0,0,sz,0,nullptr,nullptr),CL_SUCCESS);
+      clFinish(cq);
+    }
+
+    std::vector<char> result(sz);
+    BOOST_CHECK_EQUAL(clEnqueueReadBuffer(cq,dst,CL_TRUE,0,sz,result.data(),0,nullptr,nullptr),CL_SUCCESS);
+    BOOST_CHECK(result==data);
+
+    std::cout << "copy " << (sz>>10) << " KB: " << time*1e-6 << " ms, "
+              << (sz/(time*1e-9))/(1024*1024) << " MB/s\n";
+
+    clReleaseMemObject(src);
+    clReleaseMemObject(dst);
+  }
+
+  clReleaseCommandQueue(cq);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -22,6 +22,8 @@
 #include "xocl/core/time.h"
 #include <vector>
 #include <memory>
+#include <thread>
+#include <iostream>
 
 // Terminology
 //   - ubuf is user's buffer in host code
@@ -42,6 +44,9 @@
 // test_clEnqueueMapBuffer3
 //   Test data consistency with map and unmap of resident memory object and
 //   no ubuf.  This creates [hbuf,dbuf], where hbuf is directly used by user.
+// test_clEnqueueMapBuffer4
+//   Benchmark concurrent map and unmap of small overlapping windows of
+//   a large resident memory object from several threads.
 
 
 BOOST_AUTO_TEST_SUITE ( test_clEnqueueMapBuffer )
@@ -222,6 +227,76 @@ BOOST_AUTO_TEST_CASE( test_clEnqueueMapBuffer3 )
   clReleaseMemObject(mem);
 }
 
+// Several threads map small overlapping windows of one large buffer
+// for writing, write a pattern, and unmap.  Each window is synced on
+// unmap, verify that all writes made it to the device buffer.
+BOOST_AUTO_TEST_CASE( test_clEnqueueMapBuffer4 )
+{
+  ocl_sw_emulation ocl;
+  cl_int err = CL_SUCCESS;
+
+  const size_t sz = 16*1024*1024;
+  const size_t window = 4096;
+  const unsigned int nthreads = 8;
+  const unsigned int iterations = 2000;
+
+  auto mem = clCreateBuffer(ocl.context,CL_MEM_READ_WRITE,sz,nullptr,&err);
+  BOOST_CHECK_EQUAL(err,CL_SUCCESS);
+
+  {
+    auto cq = clCreateCommandQueue(ocl.context,ocl.device,0,&err);
+    cl_event migrate_event = nullptr;
+    clEnqueueMigrateMemObjects(cq,1,&mem,0,0,nullptr,&migrate_event);
+    clWaitForEvents(1,&migrate_event);
+    clReleaseEvent(migrate_event);
+    clReleaseCommandQueue(cq);
+  }
+
+  // Thread t owns bytes with (offset/window)%nthreads == t, each map
+  // spans its own window and half of the next thread's window.
+  unsigned long time = 0;
+  {
+    xocl::time_guard tg(time);
+    std::vector<std::thread> threads;
+    for (unsigned int t=0; t<nthreads; ++t)
+      threads.emplace_back([&,t] {
+        cl_int err = CL_SUCCESS;
+        auto cq = clCreateCommandQueue(ocl.context,ocl.device,0,&err);
+        for (unsigned int i=0; i<iterations; ++i) {
+          size_t idx = (i*nthreads + t) % (sz/window - 1);
+          size_t offset = idx*window;
+          auto wptr = static_cast<char*>
+            (clEnqueueMapBuffer(cq,mem,CL_TRUE,CL_MAP_WRITE,offset,window+window/2,0,nullptr,nullptr,&err));
+          BOOST_CHECK_EQUAL(err,CL_SUCCESS);
+          std::memset(wptr,static_cast<char>(idx),window);
+          cl_event unmap_event = nullptr;
+          clEnqueueUnmapMemObject(cq,mem,wptr,0,nullptr,&unmap_event);
+          clWaitForEvents(1,&unmap_event);
+          clReleaseEvent(unmap_event);
+        }
+        clReleaseCommandQueue(cq);
+      });
+    for (auto& t : threads)
+      t.join();
+  }
+
+  auto cq = clCreateCommandQueue(ocl.context,ocl.device,0,&err);
+  auto rptr = static_cast<char*>
+    (clEnqueueMapBuffer(cq,mem,CL_TRUE,CL_MAP_READ,0,sz,0,0,nullptr,&err));
+  BOOST_CHECK_EQUAL(err,CL_SUCCESS);
+  for (size_t idx=0; idx<std::min<size_t>(nthreads*iterations,sz/window-1); ++idx)
+    BOOST_CHECK_EQUAL(rptr[idx*window],static_cast<char>(idx));
+  clEnqueueUnmapMemObject(cq,mem,rptr,0,nullptr,nullptr);
+  clFinish(cq);
+  clReleaseCommandQueue(cq);
+
+  auto ops = nthreads*iterations;
+  std::cout << "map/unmap " << ops << " windows from " << nthreads << " threads: "
+            << time*1e-6 << " ms, " << (time/ops)*1e-3 << " us per map/unmap\n";
+
+  clReleaseMemObject(mem);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 
@@ -0,0 +1,92 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+////////////////////////////////////////////////////////////////
+// Benchmark of xrt::command construction, which recycles exec
+// buffers through the device exec buffer pool
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+#include "setup.h"
+
+#include "xocl/core/device.h"
+#include "xocl/core/time.h"
+#include "xrt/scheduler/command.h"
+#include <atomic>
+#include <functional>
+#include <vector>
+#include <thread>
+#include <iostream>
+
+namespace {
+
+// Boost.Test assertions are not thread safe, the workers count
+// commands that are not in their initial state
+static void
+construct(xrt::device* xdevice, size_t count, std::atomic<size_t>& bad)
+{
+  for (size_t i=0; i<count; ++i) {
+    auto cmd = std::make_shared<xrt::command>(xdevice,ERT_START_CU);
+    if (cmd->get_ert_cmd<ert_packet*>()->state != ERT_CMD_STATE_NEW)
+      ++bad;
+  }
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE ( test_command )
+
+BOOST_AUTO_TEST_CASE( test_command1 )
+{
+  ocl_sw_emulation ocl;
+  auto xdevice = xocl::xocl(ocl.device)->get_xrt_device();
+  xdevice->preallocExecBuffers(16);
+
+  size_t count=100000;
+  unsigned long single_time = 0;
+  unsigned long multi_time = 0;
+  unsigned int threads = 4;
+  std::atomic<size_t> bad(0);
+
+  {
+    xocl::time_guard tg(single_time);
+    construct(xdevice,count,bad);
+  }
+
+  {
+    xocl::time_guard tg(multi_time);
+    std::vector<std::thread> workers;
+    for (unsigned int t=0; t<threads; ++t)
+      workers.emplace_back(construct,xdevice,count,std::ref(bad));
+    for (auto& w : workers)
+      w.join();
+  }
+  BOOST_CHECK_EQUAL(bad,0);
+
+  // All recycled exec buffers are distinct and mapped
+  std::vector<std::shared_ptr<xrt::command>> cmds;
+  for (size_t i=0; i<64; ++i)
+    cmds.push_back(std::make_shared<xrt::command>(xdevice,ERT_START_CU));
+  for (size_t i=1; i<cmds.size(); ++i)
+    BOOST_CHECK(cmds[i]->get_exec_bo() != cmds[i-1]->get_exec_bo());
+
+  std::cout << "Command construction for " << count << " commands\n";
+  std::cout << "Single thread: " << single_time*1e-6 << " ms ("
+            << (single_time/count) << " ns/cmd)\n";
+  std::cout << threads << " threads: " << multi_time*1e-6 << " ms ("
+            << (multi_time/(count*threads)) << " ns/cmd)\n";
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -183,6 +183,110 @@ BOOST_AUTO_TEST_CASE( test_event_submit_wait )
   }
 }
 
+// Throughput of host only events with no enqueue action, which
+// complete as soon as they are submitted.  All events wait on a user
+// event that is completed once everything is queued, so completion
+// propagates through the full dependency graph.
+BOOST_AUTO_TEST_CASE( test_event_throughput )
+{
+  const size_t count = 2000;
+  xocl::context c(nullptr,0,nullptr);
+
+  enum class workload { in_order, out_of_order, fan_in };
+  for (auto wl : { workload::in_order, workload::out_of_order, workload::fan_in }) {
+    bool ooo = (wl != workload::in_order);
+    xocl::command_queue q(&c,nullptr,ooo ? CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE : 0);
+    xocl::event user(nullptr,&c,CL_COMMAND_USER);
+    user.queue();
+    cl_event uev = &user;
+
+    unsigned long time = 0;
+    std::vector<xocl::event*> events;
+    events.reserve(count+1);
+    {
+      xocl::time_guard tg(time);
+      for (size_t i=0; i<count; ++i) {
+        // in order queue chains every event on the previous one
+        auto ev = (wl==workload::in_order && i)
+          ? new xocl::event(&q,&c,0)
+          : new xocl::event(&q,&c,0,1,&uev);
+        ev->queue();
+        events.push_back(ev);
+      }
+      if (wl==workload::fan_in) {
+        std::vector<cl_event> waitlist(events.begin(),events.end());
+        auto ev = new xocl::event(&q,&c,0,waitlist.size(),waitlist.data());
+        ev->queue();
+        events.push_back(ev);
+      }
+      user.set_status(CL_COMPLETE);
+      q.flush();
+    }
+
+    for (auto ev : events) {
+      BOOST_CHECK_EQUAL(ev->get_status(),CL_COMPLETE);
+      if (ev->release())
+        delete ev;
+    }
+
+    const char* name[] = { "in order", "out of order", "fan in" };
+    std::cout << name[static_cast<int>(wl)] << ": " << events.size() << " events in "
+              << time*1e-6 << " ms, " << (events.size()/(time*1e-9))*1e-6 << " M events/s\n";
+  }
+}
+
+// Throughput of host only events enqueued by several threads onto one
+// command queue, which serializes on the queue's event set
+BOOST_AUTO_TEST_CASE( test_event_throughput_threads )
+{
+  const size_t count = 2000;
+  const unsigned int threads = 4;
+  xocl::context c(nullptr,0,nullptr);
+
+  for (bool ooo : { false, true }) {
+    xocl::command_queue q(&c,nullptr,ooo ? CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE : 0);
+    xocl::event user(nullptr,&c,CL_COMMAND_USER);
+    user.queue();
+    cl_event uev = &user;
+
+    unsigned long time = 0;
+    std::vector<std::vector<xocl::event*>> events(threads);
+    {
+      xocl::time_guard tg(time);
+      std::vector<std::thread> workers;
+      for (unsigned int t=0; t<threads; ++t) {
+        workers.emplace_back([&,t] {
+          events[t].reserve(count);
+          for (size_t i=0; i<count; ++i) {
+            auto ev = new xocl::event(&q,&c,0,1,&uev);
+            ev->queue();
+            events[t].push_back(ev);
+          }
+        });
+      }
+      for (auto& w : workers)
+        w.join();
+      user.set_status(CL_COMPLETE);
+      q.flush();
+    }
+
+    size_t complete = 0;
+    for (auto& tevents : events) {
+      for (auto ev : tevents) {
+        if (ev->get_status()==CL_COMPLETE)
+          ++complete;
+        if (ev->release())
+          delete ev;
+      }
+    }
+    BOOST_CHECK_EQUAL(complete,count*threads);
+
+    std::cout << (ooo ? "out of order" : "in order") << ", " << threads << " threads: "
+              << complete << " events in " << time*1e-6 << " ms, "
+              << (complete/(time*1e-9))*1e-6 << " M events/s\n";
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 
@@ -0,0 +1,131 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "xocl/core/mapped_ranges.h"
+
+#include <vector>
+
+namespace {
+
+using range_vector = std::vector<xocl::mapped_ranges::range>;
+
+static bool
+operator==(const range_vector& lhs, const range_vector& rhs)
+{
+  if (lhs.size()!=rhs.size())
+    return false;
+  for (size_t i=0; i<lhs.size(); ++i)
+    if (lhs[i].offset!=rhs[i].offset || lhs[i].size!=rhs[i].size)
+      return false;
+  return true;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE ( test_mapped_ranges )
+
+BOOST_AUTO_TEST_CASE( test_mapped_ranges1 )
+{
+  xocl::mapped_ranges mr;
+  cl_map_flags flags = 0;
+  range_vector sync;
+
+  // Unmap of unknown offset
+  BOOST_CHECK(!mr.unmap(0,flags,sync));
+  BOOST_CHECK(mr.empty());
+
+  // Read map needs no sync
+  mr.map(0,100,CL_MAP_READ);
+  BOOST_CHECK(mr.unmap(0,flags,sync));
+  BOOST_CHECK_EQUAL(flags,CL_MAP_READ);
+  BOOST_CHECK(sync.empty());
+  BOOST_CHECK(mr.empty());
+
+  // Write map syncs exactly its range, not a larger earlier map
+  mr.map(0,4096,CL_MAP_READ);
+  mr.map(0,16,CL_MAP_WRITE);
+  BOOST_CHECK(mr.unmap(0,flags,sync));
+  BOOST_CHECK_EQUAL(flags,CL_MAP_WRITE);
+  BOOST_CHECK(sync==range_vector({{0,16}}));
+  sync.clear();
+  BOOST_CHECK(mr.unmap(0,flags,sync));
+  BOOST_CHECK_EQUAL(flags,CL_MAP_READ);
+  BOOST_CHECK(sync.empty());
+  BOOST_CHECK(mr.empty());
+
+  // Repeated identical maps are reference counted
+  mr.map(64,64,CL_MAP_WRITE);
+  mr.map(64,64,CL_MAP_WRITE);
+  BOOST_CHECK(mr.unmap(64,flags,sync));
+  BOOST_CHECK(sync.empty());
+  BOOST_CHECK(!mr.empty());
+  BOOST_CHECK(mr.unmap(64,flags,sync));
+  BOOST_CHECK(sync==range_vector({{64,64}}));
+  sync.clear();
+  BOOST_CHECK(mr.empty());
+}
+
+BOOST_AUTO_TEST_CASE( test_mapped_ranges2 )
+{
+  xocl::mapped_ranges mr;
+  cl_map_flags flags = 0;
+  range_vector sync;
+
+  // Overlapping write windows are synced once as their union
+  mr.map(0,100,CL_MAP_WRITE);
+  mr.map(50,100,CL_MAP_WRITE_INVALIDATE_REGION);
+  mr.map(120,80,CL_MAP_WRITE);
+  BOOST_CHECK(mr.unmap(50,flags,sync));
+  BOOST_CHECK(sync.empty());
+  BOOST_CHECK(mr.unmap(0,flags,sync));
+  BOOST_CHECK(sync.empty());
+  BOOST_CHECK(mr.unmap(120,flags,sync));
+  BOOST_CHECK(sync==range_vector({{0,200}}));
+  sync.clear();
+  BOOST_CHECK(mr.empty());
+
+  // Disjoint windows sync independently, a read map does not hold back sync
+  mr.map(0,10,CL_MAP_WRITE);
+  mr.map(20,10,CL_MAP_WRITE);
+  mr.map(0,100,CL_MAP_READ);
+  BOOST_CHECK(mr.unmap(20,flags,sync));
+  BOOST_CHECK(sync==range_vector({{20,10}}));
+  sync.clear();
+  BOOST_CHECK(mr.unmap(0,flags,sync));
+  BOOST_CHECK_EQUAL(flags,CL_MAP_WRITE);
+  BOOST_CHECK(sync==range_vector({{0,10}}));
+  sync.clear();
+  BOOST_CHECK(mr.unmap(0,flags,sync));
+  BOOST_CHECK_EQUAL(flags,CL_MAP_READ);
+  BOOST_CHECK(mr.empty());
+
+  // Adjacent dirty ranges merge
+  mr.map(0,10,CL_MAP_WRITE);
+  mr.map(10,10,CL_MAP_WRITE);
+  mr.map(15,1,CL_MAP_WRITE);
+  BOOST_CHECK(mr.unmap(0,flags,sync));
+  BOOST_CHECK(sync==range_vector({{0,10}}));
+  sync.clear();
+  BOOST_CHECK(mr.unmap(10,flags,sync));
+  BOOST_CHECK(sync.empty());
+  BOOST_CHECK(mr.unmap(15,flags,sync));
+  BOOST_CHECK(sync==range_vector({{10,10}}));
+  BOOST_CHECK(mr.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,166 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+////////////////////////////////////////////////////////////////
+// Unit testing and benchmark of xocl::xclbin meta data extraction
+//
+// A synthetic xclbin with many kernels and arguments is constructed
+// repeatedly, once with a new uuid each time which parses the xml,
+// and once with the same uuid which uses the cached meta data index.
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+
+#include "xocl/xclbin/xclbin.h"
+#include "xrt/util/time.h"
+
+#include <vector>
+#include <sstream>
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+
+namespace {
+
+static std::string
+make_xml(unsigned int kernels, unsigned int args)
+{
+  std::stringstream xml;
+  xml << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+      << "<project name=\"tbench\">\n"
+      << " <platform vendor=\"xilinx\" boardid=\"u200\" name=\"xdma\" featureRomTime=\"0\">\n"
+      << "  <version major=\"5\" minor=\"0\"/>\n"
+      << "  <device name=\"fpga0\" fpgaDevice=\"virtexuplus\" addrWidth=\"0\">\n"
+      << "   <systemClocks>\n"
+      << "    <clock port=\"clk_out1_pfm_top_clkwiz_sysclks_0\" frequency=\"50.0MHz\" name=\"clk_out1\"/>\n"
+      << "   </systemClocks>\n"
+      << "   <core name=\"OCL_REGION_0\" target=\"bitstream\" type=\"clc_region\" clockFreq=\"300MHz\" numComputeUnits=\"60\">\n"
+      << "    <kernelClocks>\n"
+      << "     <clock port=\"KERNEL_CLK\" frequency=\"500.0MHz\"/>\n"
+      << "     <clock port=\"DATA_CLK\" frequency=\"300.0MHz\"/>\n"
+      << "    </kernelClocks>\n";
+  for (unsigned int k=0; k<kernels; ++k) {
+    xml << "    <kernel name=\"krnl_" << k << "\" language=\"c\" vlnv=\"xilinx.com:hls:krnl:1.0\""
+        << " attributes=\"\" preferredWorkGroupSizeMultiple=\"0\" workGroupSize=\"1\""
+        << " interrupt=\"true\" hash=\"" << k << "\">\n"
+        << "     <port name=\"M_AXI_GMEM\" mode=\"master\" range=\"0xFFFFFFFF\" dataWidth=\"512\" portType=\"addressable\" base=\"0x0\"/>\n"
+        << "     <port name=\"S_AXI_CONTROL\" mode=\"slave\" range=\"0x1000\" dataWidth=\"32\" portType=\"addressable\" base=\"0x0\"/>\n";
+    for (unsigned int a=0; a<args; ++a)
+      xml << "     <arg name=\"arg" << a << "\" addressQualifier=\"1\" id=\"" << a << "\""
+          << " port=\"M_AXI_GMEM\" size=\"0x8\" offset=\"0x" << std::hex << (0x10+a*0xc) << std::dec << "\""
+          << " hostOffset=\"0x0\" hostSize=\"0x8\" type=\"int*\"/>\n";
+    xml << "     <compileWorkGroupSize x=\"1\" y=\"1\" z=\"1\"/>\n"
+        << "     <maxWorkGroupSize x=\"1\" y=\"1\" z=\"1\"/>\n"
+        << "     <instance name=\"krnl_" << k << "_1\">\n"
+        << "      <addrRemap base=\"0x" << std::hex << (0x1800000+k*0x10000) << std::dec << "\" port=\"S_AXI_CONTROL\"/>\n"
+        << "     </instance>\n"
+        << "    </kernel>\n";
+  }
+  xml << "   </core>\n"
+      << "  </device>\n"
+      << " </platform>\n"
+      << "</project>\n";
+  return xml.str();
+}
+
+// xclbin2 with one EMBEDDED_METADATA section
+static std::vector<char>
+make_xclbin(const std::string& xml, unsigned char tag)
+{
+  std::vector<char> xb(sizeof(axlf) + xml.size(),0);
+  auto top = reinterpret_cast<axlf*>(xb.data());
+  std::strcpy(top->m_magic,"xclbin2");
+  top->m_header.m_length = xb.size();
+  top->m_header.m_timeStamp = tag;
+  std::memset(&top->m_header.uuid,tag,sizeof(xuid_t));
+  top->m_header.m_numSections = 1;
+  top->m_sections[0].m_sectionKind = EMBEDDED_METADATA;
+  top->m_sections[0].m_sectionOffset = sizeof(axlf);
+  top->m_sections[0].m_sectionSize = xml.size();
+  std::memcpy(xb.data()+sizeof(axlf),xml.data(),xml.size());
+  return xb;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE ( test_xclbin )
+
+BOOST_AUTO_TEST_CASE( test_xclbin_metadata1 )
+{
+  auto xml = make_xml(4,3);
+  xocl::xclbin xclbin1(make_xclbin(xml,1));
+  xocl::xclbin xclbin2(make_xclbin(xml,1));
+
+  BOOST_CHECK_EQUAL(xclbin1.num_kernels(),4);
+  BOOST_CHECK_EQUAL(xclbin1.project_name(),"tbench");
+  BOOST_CHECK(xclbin1.target()==xocl::xclbin::target_type::bin);
+  BOOST_CHECK_EQUAL(xclbin1.kernel_clocks().size(),2);
+  BOOST_CHECK_EQUAL(xclbin1.system_clocks().size(),1);
+  BOOST_CHECK_EQUAL(xclbin1.cu_base_address_map().size(),4);
+
+  // Symbols are unique per xclbin even when meta data is cached
+  auto& symbol1 = xclbin1.lookup_kernel("krnl_2");
+  auto& symbol2 = xclbin2.lookup_kernel("krnl_2");
+  BOOST_CHECK(&symbol1 != &symbol2);
+  BOOST_CHECK(symbol1.uid != symbol2.uid);
+  BOOST_CHECK_EQUAL(symbol1.arguments.size(),3);
+  BOOST_CHECK_EQUAL(symbol1.arguments[2].offset,0x28);
+  BOOST_CHECK_EQUAL(symbol1.arguments[0].host,&symbol1);
+  BOOST_CHECK_EQUAL(symbol2.arguments[0].host,&symbol2);
+  BOOST_CHECK_EQUAL(symbol1.instances.at(0).base,0x1820000);
+
+  // Conformance rename is private to the xclbin
+  ::setenv("XCL_CONFORMANCE","1",1);
+  BOOST_CHECK_EQUAL(xclbin2.conformance_rename_kernel("1"),1);
+  BOOST_CHECK_EQUAL(xclbin2.kernel_names()[1],"krnl");
+  xocl::xclbin xclbin3(make_xclbin(xml,1));
+  BOOST_CHECK_EQUAL(xclbin3.conformance_rename_kernel("1"),1);
+  BOOST_CHECK(xclbin3.lookup_kernel("krnl").hash=="1");
+  BOOST_CHECK_EQUAL(xclbin1.lookup_kernel("krnl_1").name,"krnl_1");
+  ::unsetenv("XCL_CONFORMANCE");
+}
+
+BOOST_AUTO_TEST_CASE( test_xclbin_metadata2 )
+{
+  unsigned int kernels = 64;
+  unsigned int args = 16;
+  size_t count = 50;
+  auto xml = make_xml(kernels,args);
+
+  std::vector<std::vector<char>> uncached;
+  for (size_t i=0; i<count; ++i)
+    uncached.emplace_back(make_xclbin(xml,static_cast<unsigned char>(i+2)));
+
+  unsigned long parse_time = 0;
+  {
+    xrt::time_guard tg(parse_time);
+    for (auto& xb : uncached)
+      xocl::xclbin xclbin(std::move(xb));
+  }
+
+  auto xb = make_xclbin(xml,1);
+  unsigned long cached_time = 0;
+  {
+    xrt::time_guard tg(cached_time);
+    for (size_t i=0; i<count; ++i)
+      xocl::xclbin xclbin{std::vector<char>(xb)};
+  }
+
+  std::cout << "xclbin with " << kernels << " kernels, " << args << " args per kernel\n"
+            << "xml parse: " << parse_time*1e-3/count << " us per xclbin\n"
+            << "cached:    " << cached_time*1e-3/count << " us per xclbin\n";
+}
+
+BOOST_AUTO_TEST_SUITE_END()
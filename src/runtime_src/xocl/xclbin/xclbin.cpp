@@ -21,14 +21,20 @@
 #include "xocl/core/error.h"
 
 #include "xclbin/binary.h"
+#include "core/common/xclbin_image.h"
 
 
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/xml_parser.hpp>
 
 #include <map>
+#include <mutex>
+#include <atomic>
+#include <array>
 #include <limits>
 #include <cassert>
+#include <cstring>
+#include <algorithm>
 #include <cstdlib>
 #include <sstream>
 
@@ -550,9 +556,6 @@ private:
     void
     init_symbol()
     {
-      static unsigned int count = 0;
-      m_symbol.uid = count++;
-
       init_args();
       fix_rtinfo();
       fix_progvar();
@@ -579,22 +582,6 @@ private:
       return m_symbol;
     }
 
-    void
-    cu_base_address_map(std::vector<uint64_t>& amap) const
-    {
-      for (auto& instance : m_symbol.instances)
-        amap.push_back(instance.base);
-    }
-
-    std::string
-    conformance_rename()
-    {
-      std::string name = m_name;
-      m_name = name.substr(0,name.find_last_of("_"));
-      m_symbol.name = m_name;
-      return name;
-    }
-
     size_t
     regmap_size() const
     {
@@ -605,18 +592,27 @@ private:
     }
   }; // class kernel_wrapper
 
-private:
-  std::vector<std::unique_ptr<kernel_wrapper>> m_kernels;
-  std::vector<std::unique_ptr<platform_wrapper>> m_platforms;
-  std::vector<std::unique_ptr<device_wrapper>> m_devices;
-  std::vector<std::unique_ptr<core_wrapper>> m_cores;
-
-  pt::ptree xml_project;
+  ////////////////////////////////////////////////////////////////
+  // Compact meta data index.  The index holds everything extracted
+  // from the xml, it is built once per xclbin and shared by all
+  // metadata objects constructed from the same xclbin.
+  ////////////////////////////////////////////////////////////////
+  struct index
+  {
+    std::string project_name;
+    target_type target;
+    xocl::xclbin::system_clocks_type system_clocks;
+    xocl::xclbin::kernel_clocks_type kernel_clocks;
+    xocl::xclbin::profilers_type profilers;
+    std::vector<xocl::xclbin::symbol> kernels;
+  };
 
-public:
-  explicit
-  metadata(const data_range& xml)
+  // Parse the xml and build the index.  The xml wrappers reference
+  // the ptree and are discarded once the index is built.
+  static std::shared_ptr<const index>
+  parse(const data_range& xml)
   {
+    pt::ptree xml_project;
     try {
       std::stringstream xml_stream;
       xml_stream.write(xml.first,xml.second-xml.first);
@@ -627,70 +623,142 @@ public:
     }
 
     // iterate platforms
+    std::vector<std::unique_ptr<platform_wrapper>> platforms;
     int count = 0;
     for (auto& xml_platform : xml_project.get_child("project")) {
       if (xml_platform.first != "platform")
         continue;
       if (++count>1)
         throw xocl::error(CL_INVALID_BINARY,"Only one platform supported");
-      m_platforms.emplace_back(std::make_unique<platform_wrapper>(xml_platform.second));
+      platforms.emplace_back(std::make_unique<platform_wrapper>(xml_platform.second));
     }
-    auto platform = m_platforms.back().get();
+    auto platform = platforms.back().get();
 
     // iterate devices
+    std::vector<std::unique_ptr<device_wrapper>> devices;
     count = 0;
     for (auto& xml_device : xml_project.get_child("project.platform")) {
       if (xml_device.first != "device")
         continue;
       if (++count>1)
         throw xocl::error(CL_INVALID_BINARY,"Only one device supported");
-      m_devices.emplace_back(std::make_unique<device_wrapper>(platform,xml_device.second));
+      devices.emplace_back(std::make_unique<device_wrapper>(platform,xml_device.second));
     }
-    auto device = m_devices.back().get();
-
-    auto nm = device->name();
-    auto c = device->system_clocks();
+    auto device = devices.back().get();
 
     // iterate cores
+    std::vector<std::unique_ptr<core_wrapper>> cores;
     count = 0;
     for (auto& xml_core : xml_project.get_child("project.platform.device")) {
       if (xml_core.first != "core")
         continue;
       if (++count>1)
         throw xocl::error(CL_INVALID_BINARY,"Only one core supported");
-      m_cores.emplace_back(std::make_unique<core_wrapper>(platform,device,xml_core.second));
+      cores.emplace_back(std::make_unique<core_wrapper>(platform,device,xml_core.second));
     }
-    auto core = m_cores.back().get();
+    auto core = cores.back().get();
+
+    auto idx = std::make_shared<index>();
+    idx->project_name = xml_project.get<std::string>("project.<xmlattr>.name","");
+    idx->target = core->target();
+    idx->system_clocks = device->system_clocks();
+    idx->kernel_clocks = core->kernel_clocks();
+    idx->profilers = core->profilers();
 
     // iterate kernels
     for (auto& xml_kernel : xml_project.get_child("project.platform.device.core")) {
       if (xml_kernel.first != "kernel")
         continue;
       XOCL_DEBUG(std::cout,"xclbin found kernel '" + xml_kernel.second.get<std::string>("<xmlattr>.name") + "'\n");
-      m_kernels.emplace_back(std::make_unique<kernel_wrapper>(platform,device,core,xml_kernel.second));
+      kernel_wrapper kernel(platform,device,core,xml_kernel.second);
+      idx->kernels.emplace_back(kernel.symbol());
+      for (auto& arg : idx->kernels.back().arguments)
+        arg.host = nullptr;  // fixed up when index is instantiated
+    }
+
+    return idx;
+  }
+
+  // Index of xml meta data, cached per xclbin uuid and size of xml.
+  // A small number of recently used indices are retained so that
+  // programs created and released repeatedly skip the xml parsing.
+  static std::shared_ptr<const index>
+  get_index(const data_range& xml, const xrt_core::xclbin_image* image)
+  {
+    using key_type = std::pair<std::array<unsigned char,sizeof(xuid_t)>,size_t>;
+    static std::mutex mutex;
+    static std::map<key_type,std::shared_ptr<const index>> cache;
+    static std::vector<key_type> lru;
+    static const size_t cache_size = 16;
+
+    if (!image || !xrt::config::get_xclbin_metadata_cache())
+      return parse(xml);
+
+    key_type key;
+    auto& uuid = image->get_axlf()->m_header.uuid;
+    std::memcpy(key.first.data(),&uuid,key.first.size());
+    key.second = xml.second - xml.first;
+    if (std::all_of(key.first.begin(),key.first.end(),[](unsigned char c) { return c==0; }))
+      return parse(xml);
+
+    {
+      std::lock_guard<std::mutex> lk(mutex);
+      auto itr = cache.find(key);
+      if (itr != cache.end()) {
+        lru.erase(std::find(lru.begin(),lru.end(),key));
+        lru.push_back(key);
+        return itr->second;
+      }
+    }
+
+    // Parse outside the lock, a concurrent parse of same xclbin
+    // is harmless, the last one is cached
+    auto idx = parse(xml);
+
+    std::lock_guard<std::mutex> lk(mutex);
+    if (cache.find(key) == cache.end()) {
+      lru.push_back(key);
+      if (lru.size() > cache_size) {
+        cache.erase(lru.front());
+        lru.erase(lru.begin());
+      }
+    }
+    cache[key] = idx;
+    return idx;
+  }
+
+private:
+  std::shared_ptr<const index> m_index;
+
+  // Per metadata copy of kernel symbols.  Symbols are referenced by
+  // address upstream and must be unique to this object.
+  std::vector<std::unique_ptr<xocl::xclbin::symbol>> m_kernels;
+
+public:
+  explicit
+  metadata(const data_range& xml, const xrt_core::xclbin_image* image)
+    : m_index(get_index(xml,image))
+  {
+    static std::atomic<unsigned int> count {0};
+    for (auto& ksymbol : m_index->kernels) {
+      m_kernels.emplace_back(std::make_unique<xocl::xclbin::symbol>(ksymbol));
+      auto& symbol = *m_kernels.back();
+      symbol.uid = count++;
+      for (auto& arg : symbol.arguments)
+        arg.host = &symbol;
     }
   }
 
   xocl::xclbin::system_clocks_type
   system_clocks() const
   {
-    xocl::xclbin::system_clocks_type clocks;
-    for (auto& device : m_devices) {
-      auto cclocks = device->system_clocks();
-      std::move(cclocks.begin(),cclocks.end(),std::back_inserter(clocks));
-    }
-    return clocks;
+    return m_index->system_clocks;
   }
 
   xocl::xclbin::kernel_clocks_type
   kernel_clocks() const
   {
-    xocl::xclbin::kernel_clocks_type clocks;
-    for (auto& core : m_cores) {
-      auto cclocks = core->kernel_clocks();
-      std::move(cclocks.begin(),cclocks.end(),std::back_inserter(clocks));
-    }
-    return clocks;
+    return m_index->kernel_clocks;
   }
 
   unsigned int
@@ -704,7 +772,7 @@ public:
   {
     std::vector<std::string> names;
     for (auto& kernel : m_kernels)
-      names.emplace_back(kernel->name());
+      names.emplace_back(kernel->name);
     return names;
   }
 
@@ -713,7 +781,7 @@ public:
   {
     std::vector<const xocl::xclbin::symbol*> symbols;
     for (auto& kernel : m_kernels)
-      symbols.push_back(&kernel->symbol());
+      symbols.push_back(kernel.get());
     return symbols;
   }
 
@@ -721,8 +789,8 @@ public:
   lookup_kernel(const std::string& kernel_name) const
   {
     for (auto& kernel : m_kernels) {
-      if (kernel->name()==kernel_name)
-        return kernel->symbol();
+      if (kernel->name==kernel_name)
+        return *kernel;
     }
     throw xocl::error(CL_INVALID_KERNEL_NAME,"No kernel with name '" + kernel_name + "' found in program");
   }
@@ -730,19 +798,19 @@ public:
   std::string
   project_name() const
   {
-    return xml_project.get<std::string>("project.<xmlattr>.name","");
+    return m_index->project_name;
   }
 
   target_type
   target() const
   {
-    return m_cores[0]->target();
+    return m_index->target;
   }
 
   xocl::xclbin::profilers_type
   profilers() const
   {
-    return m_cores[0]->profilers();
+    return m_index->profilers;
   }
 
   std::vector<uint64_t>
@@ -750,7 +818,8 @@ public:
   {
     std::vector<uint64_t> amap;
     for (auto& kernel : m_kernels)
-      kernel->cu_base_address_map(amap);
+      for (auto& instance : kernel->instances)
+        amap.push_back(instance.base);
 
     std::sort(amap.begin(),amap.end());
     return amap;
@@ -761,8 +830,8 @@ public:
   {
     unsigned int retval = 0;
     for (auto& kernel : m_kernels) {
-      if (kernel->hash()==hash)  {
-        kernel->conformance_rename();
+      if (kernel->hash==hash)  {
+        kernel->name = kernel->name.substr(0,kernel->name.find_last_of("_"));
         ++retval;
       }
     }
@@ -774,7 +843,7 @@ public:
   {
     std::vector<std::string> retval;
     for (auto& kernel : m_kernels)
-      retval.push_back(kernel->hash());
+      retval.push_back(kernel->hash);
     return retval;
   }
 }; // metadata
@@ -1013,9 +1082,9 @@ struct xclbin::impl
   metadata m_xml;
   xclbin_data_sections m_sections;
 
-  impl(std::vector<char>&& xb)
-    : m_binary(std::move(xb))
-    , m_xml(m_binary.meta_data())
+  impl(binary_type&& binary)
+    : m_binary(std::move(binary))
+    , m_xml(m_binary.meta_data(),m_binary.image().get())
     , m_sections(m_binary)
   {}
 
@@ -1119,7 +1188,13 @@ xclbin()
 
 xclbin::
 xclbin(std::vector<char>&& xb)
-  : m_impl(std::make_unique<xclbin::impl>(std::move(xb)))
+  : m_impl(std::make_unique<xclbin::impl>(binary_type(std::move(xb))))
+{
+}
+
+xclbin::
+xclbin(std::shared_ptr<const xrt_core::xclbin_image> image)
+  : m_impl(std::make_unique<xclbin::impl>(binary_type(std::move(image))))
 {
 }
 
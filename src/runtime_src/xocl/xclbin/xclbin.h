@@ -147,6 +147,14 @@ public:
    */
   // implicit
   xclbin(std::vector<char>&& xb);
+
+  /**
+   * Construct from a shared xclbin image.  The image is referenced,
+   * not copied.
+   */
+  explicit
+  xclbin(std::shared_ptr<const xrt_core::xclbin_image> image);
+
   xclbin(xclbin&& rhs);
 
   xclbin(const xclbin& rhs);
@@ -0,0 +1,255 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "bo_pool.h"
+#include "xrt/util/debug.h"
+
+#include <map>
+#include <vector>
+#include <mutex>
+#include <algorithm>
+#include <iostream>
+
+namespace {
+
+inline size_t
+align_up(size_t value, size_t alignment)
+{
+  return alignment ? ((value + alignment - 1) / alignment) * alignment : value;
+}
+
+}
+
+namespace xrt {
+
+namespace {
+
+// A slab is one buffer object allocated in a memory bank.  Buffers
+// are carved out of the slab first-fit from a list of free ranges
+// sorted by offset.  Released ranges are coalesced with adjacent free
+// ranges.
+struct slab
+{
+  static constexpr size_t npos = ~size_t(0);
+
+  device::BufferObjectHandle boh;
+  size_t size = 0;
+  size_t in_use = 0;
+  std::map<size_t,size_t> free_ranges; // offset -> size
+
+  slab(device::BufferObjectHandle bo, size_t sz)
+    : boh(std::move(bo)), size(sz)
+  {
+    free_ranges.emplace(0,sz);
+  }
+
+  size_t
+  take(size_t sz)
+  {
+    for (auto itr=free_ranges.begin(); itr!=free_ranges.end(); ++itr) {
+      if (itr->second < sz)
+        continue;
+      auto offset = itr->first;
+      auto remain = itr->second - sz;
+      free_ranges.erase(itr);
+      if (remain)
+        free_ranges.emplace(offset+sz,remain);
+      in_use += sz;
+      return offset;
+    }
+    return npos;
+  }
+
+  void
+  give(size_t offset, size_t sz)
+  {
+    in_use -= sz;
+    auto itr = free_ranges.emplace(offset,sz).first;
+
+    // coalesce with next
+    auto next = std::next(itr);
+    if (next!=free_ranges.end() && itr->first+itr->second==next->first) {
+      itr->second += next->second;
+      free_ranges.erase(next);
+    }
+
+    // coalesce with previous
+    if (itr!=free_ranges.begin()) {
+      auto prev = std::prev(itr);
+      if (prev->first+prev->second==itr->first) {
+        prev->second += itr->second;
+        free_ranges.erase(itr);
+      }
+    }
+  }
+};
+
+} // namespace
+
+struct bo_pool::impl
+{
+  device* m_device;
+  size_t m_slab_size;
+  size_t m_max_size;
+  size_t m_alignment;
+
+  mutable std::mutex m_mutex;
+  std::map<uint64_t,std::vector<std::unique_ptr<slab>>> m_banks;
+  bo_pool::stats m_stats;
+
+  impl(device* xdevice, size_t slab_size, size_t max_size)
+    : m_device(xdevice), m_max_size(max_size)
+    , m_alignment(std::max<size_t>(xdevice->getAlignment(),1))
+  {
+    m_slab_size = align_up(std::max(slab_size,max_size),m_alignment);
+  }
+
+  slab*
+  add_slab(uint64_t memidx)
+  {
+    auto boh = (memidx==bo_pool::default_memidx)
+      ? m_device->alloc(m_slab_size)
+      : m_device->alloc(m_slab_size,memoryDomain::XRT_DEVICE_RAM,memidx,nullptr);
+    auto& slabs = m_banks[memidx];
+    slabs.emplace_back(std::make_unique<slab>(std::move(boh),m_slab_size));
+    m_stats.slabs++;
+    m_stats.slab_bytes += m_slab_size;
+    XRT_DEBUG(std::cout,"bo_pool added slab(",m_slab_size,") in memidx(",memidx,")\n");
+    return slabs.back().get();
+  }
+
+  void
+  release(slab* s, uint64_t memidx, size_t offset, size_t sz)
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    s->give(offset,sz);
+    m_stats.bytes_in_use -= sz;
+    m_stats.buffers_in_use--;
+    m_stats.releases++;
+
+    if (s->in_use)
+      return;
+
+    // Keep one empty slab per bank to avoid slab churn, free any
+    // other empty slab
+    auto& slabs = m_banks[memidx];
+    auto empty = std::count_if(slabs.begin(),slabs.end(),[](const std::unique_ptr<slab>& sl) { return sl->in_use==0; });
+    if (empty < 2)
+      return;
+
+    auto itr = std::find_if(slabs.begin(),slabs.end(),[s](const std::unique_ptr<slab>& sl) { return sl.get()==s; });
+    if (itr==slabs.end())
+      return;
+    m_stats.slabs--;
+    m_stats.slab_bytes -= s->size;
+    slabs.erase(itr);
+  }
+};
+
+bo_pool::
+bo_pool(device* xdevice, size_t slab_size, size_t max_size)
+  : m_impl(std::make_shared<impl>(xdevice,slab_size,max_size))
+{
+}
+
+bo_pool::
+~bo_pool()
+{}
+
+bo_pool::BufferObjectHandle
+bo_pool::
+alloc(size_t sz, memoryDomain domain, uint64_t memidx)
+{
+  auto pool = m_impl.get();
+  std::unique_lock<std::mutex> lk(pool->m_mutex);
+
+  if (!sz || sz > pool->m_max_size || domain!=memoryDomain::XRT_DEVICE_RAM) {
+    pool->m_stats.fallbacks++;
+    return nullptr;
+  }
+
+  auto asz = align_up(sz,pool->m_alignment);
+
+  slab* s = nullptr;
+  size_t offset = slab::npos;
+  for (auto& sl : pool->m_banks[memidx]) {
+    offset = sl->take(asz);
+    if (offset != slab::npos) {
+      s = sl.get();
+      break;
+    }
+  }
+
+  if (!s) {
+    try {
+      s = pool->add_slab(memidx);
+    }
+    catch (const std::bad_alloc&) {
+      // bank cannot fit another slab, let caller allocate directly
+      pool->m_stats.fallbacks++;
+      return nullptr;
+    }
+    offset = s->take(asz);
+  }
+
+  pool->m_stats.bytes_in_use += asz;
+  pool->m_stats.buffers_in_use++;
+  pool->m_stats.allocations++;
+  lk.unlock();
+
+  BufferObjectHandle sub;
+  try {
+    sub = pool->m_device->alloc(s->boh,sz,offset);
+  }
+  catch (...) {
+    pool->release(s,memidx,offset,asz);
+    throw;
+  }
+
+  // Returned handle aliases the offset buffer object.  When the last
+  // reference is dropped the range is returned to the slab, unless the
+  // pool itself has been destroyed.
+  std::weak_ptr<impl> wpool = m_impl;
+  auto raw = sub.get();
+  return BufferObjectHandle
+    (raw,[sub,wpool,s,memidx,offset,asz](BufferObjectHandle::element_type*) mutable {
+      sub.reset();
+      if (auto pool = wpool.lock())
+        pool->release(s,memidx,offset,asz);
+    });
+}
+
+bo_pool::stats
+bo_pool::
+get_stats() const
+{
+  std::lock_guard<std::mutex> lk(m_impl->m_mutex);
+  return m_impl->m_stats;
+}
+
+std::ostream&
+bo_pool::
+print_stats(std::ostream& ostr) const
+{
+  auto st = get_stats();
+  ostr << "bo_pool: slabs(" << st.slabs << ") slab_bytes(" << st.slab_bytes
+       << ") bytes_in_use(" << st.bytes_in_use << ") buffers_in_use(" << st.buffers_in_use
+       << ") allocations(" << st.allocations << ") releases(" << st.releases
+       << ") fallbacks(" << st.fallbacks << ")\n";
+  return ostr;
+}
+
+} // xrt
@@ -0,0 +1,114 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef xrt_device_bo_pool_h_
+#define xrt_device_bo_pool_h_
+
+#include "xrt/device/device.h"
+
+#include <memory>
+#include <iosfwd>
+
+namespace xrt {
+
+/**
+ * Sub-allocating pool of small buffer objects.
+ *
+ * Each buffer object allocation in HAL costs an alloc and a map
+ * ioctl, and each release a munmap and a free ioctl.  The pool
+ * amortizes this by allocating large slab buffer objects per
+ * memory bank and carving small buffers out of the slabs using
+ * offset buffer objects, see xrt::device::alloc(bo,sz,offset).
+ *
+ * Buffers returned from the pool are regular buffer object handles
+ * that can be used with any xrt::device API.  Releasing the last
+ * reference to a pooled buffer returns its range to the slab it
+ * was carved from.  Slabs are kept alive by the outstanding buffers
+ * carved from them, so it is safe to destroy the pool while pooled
+ * buffers are still in use.
+ *
+ * The pool is opt-in, see xrt::config::get_bo_pool().
+ */
+class bo_pool
+{
+public:
+  using BufferObjectHandle = device::BufferObjectHandle;
+  using memoryDomain = device::memoryDomain;
+
+  /**
+   * Memory index used for buffers allocated in default bank
+   */
+  static constexpr uint64_t default_memidx = ~uint64_t(0);
+
+  struct stats
+  {
+    size_t slabs = 0;          // current number of slabs
+    size_t slab_bytes = 0;     // total bytes held by slabs
+    size_t bytes_in_use = 0;   // bytes currently carved out of slabs
+    size_t buffers_in_use = 0; // buffers currently carved out of slabs
+    size_t allocations = 0;    // total number of pooled allocations
+    size_t releases = 0;       // total number of pooled releases
+    size_t fallbacks = 0;      // allocations that could not be pooled
+  };
+
+  /**
+   * @param xdevice
+   *   Device on which slabs are allocated
+   * @param slab_size
+   *   Size in bytes of each slab buffer object
+   * @param max_size
+   *   Max size in bytes of a buffer that is allocated from the pool
+   */
+  bo_pool(device* xdevice, size_t slab_size, size_t max_size);
+
+  ~bo_pool();
+
+  /**
+   * Allocate a buffer object from the pool
+   *
+   * @param sz
+   *   Size of buffer to allocate
+   * @param domain
+   *   Memory domain of buffer, only host accessible device RAM is pooled
+   * @param memidx
+   *   Memory bank index in which to allocate the buffer or default_memidx
+   * @return
+   *   Buffer object handle, or nullptr if the request cannot be served
+   *   from the pool in which case caller should allocate normally.
+   */
+  BufferObjectHandle
+  alloc(size_t sz, memoryDomain domain, uint64_t memidx);
+
+  /**
+   * @return Snapshot of current pool statistics
+   */
+  stats
+  get_stats() const;
+
+  /**
+   * Print pool statistics
+   */
+  std::ostream&
+  print_stats(std::ostream& ostr) const;
+
+private:
+  struct impl;
+  std::shared_ptr<impl> m_impl;
+};
+
+} // xrt
+
+#endif
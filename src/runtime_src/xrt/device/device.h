@@ -19,6 +19,9 @@
 
 #include "xrt/device/hal.h"
 #include "xrt/util/range.h"
+#include "xrt/util/config_reader.h"
+#include "core/common/cmd_bo_pool.h"
+#include "core/common/adaptive_poll.h"
 #include "xclbin.h"
 #include "ert.h"
 
@@ -61,14 +64,36 @@ public:
   using stream_xfer_completions = hal::StreamXferCompletions;
   using device_handle = hal::device_handle;
 
+  /**
+   * Mapped exec buffer object recycled through the exec buffer pool
+   */
+  struct exec_buffer
+  {
+    ExecBufferObjectHandle boh;
+    void* data = nullptr;
+  };
+  using exec_buffer_pool = xrt_core::cmd_bo_pool<exec_buffer>;
+  using exec_buffer_entry = exec_buffer_pool::entry;
+
+  /**
+   * Size of exec buffers managed by the exec buffer pool
+   */
+  static constexpr size_t exec_buffer_size = 4096;
+
   explicit
   device(std::unique_ptr<hal::device>&& hal)
-    : m_hal(std::move(hal)), m_setup_done(false)
+    : m_hal(std::move(hal))
+    , m_exec_pool(std::make_unique<exec_buffer_pool>(config::get_exec_bo_pool_size()))
+    , m_poll(std::make_unique<xrt_core::adaptive_poll>(config::get_poll_window()))
+    , m_setup_done(false)
   {
   }
 
   device(device&& rhs)
-    : m_hal(std::move(rhs.m_hal)), m_setup_done(rhs.m_setup_done)
+    : m_hal(std::move(rhs.m_hal))
+    , m_exec_pool(std::move(rhs.m_exec_pool))
+    , m_poll(std::move(rhs.m_poll))
+    , m_setup_done(rhs.m_setup_done)
   {}
 
   ~device()
@@ -166,6 +191,8 @@ public:
   void
   close()
   {
+    // pooled exec buffers must be freed while device is open
+    m_exec_pool->purge();
     m_hal->close();
   }
 
@@ -197,6 +224,49 @@ public:
     return m_hal->allocExecBuffer(sz);
   }
 
+  /**
+   * Acquire a mapped exec buffer of exec_buffer_size bytes from
+   * the exec buffer pool of this device.
+   *
+   * The exec buffer must be released with releaseExecBuffer.  The
+   * content of a recycled exec buffer is undefined.
+   *
+   * This function is lock free unless a new exec buffer must be
+   * allocated.
+   */
+  exec_buffer_entry
+  acquireExecBuffer()
+  {
+    return m_exec_pool->acquire([this] { return newExecBuffer(); });
+  }
+
+  void
+  releaseExecBuffer(exec_buffer_entry& entry)
+  {
+    m_exec_pool->release(entry);
+  }
+
+  /**
+   * Populate the exec buffer pool with @count mapped exec buffers
+   */
+  void
+  preallocExecBuffers(size_t count)
+  {
+    m_exec_pool->prealloc(count,[this] { return newExecBuffer(); });
+  }
+
+  /**
+   * Completion polling policy of this device.
+   *
+   * The max poll window defaults to Runtime.poll_window_us and can
+   * be changed per device.
+   */
+  xrt_core::adaptive_poll&
+  getCompletionPoll() const
+  {
+    return *m_poll;
+  }
+
   BufferObjectHandle
   alloc(size_t sz, void* userptr)
   {
@@ -396,6 +466,17 @@ public:
   exec_buf(const ExecBufferObjectHandle& bo)
   { return m_hal->exec_buf(bo); }
 
+  /**
+   * Submit a batch of exec buffers to device.
+   *
+   * @returns
+   *   Number of exec buffers submitted, if less than @count then
+   *   errno reflects the failure of first unsubmitted exec buffer.
+   */
+  size_t
+  exec_bufs(const ExecBufferObjectHandle* bos, size_t count)
+  { return m_hal->exec_bufs(bos,count); }
+
   int
   exec_wait(int timeout_ms) const
   { return m_hal->exec_wait(timeout_ms); }
@@ -936,8 +1017,18 @@ public:
   }
 
 private:
+  exec_buffer
+  newExecBuffer()
+  {
+    exec_buffer ebuf;
+    ebuf.boh = m_hal->allocExecBuffer(exec_buffer_size);
+    ebuf.data = m_hal->map(ebuf.boh);
+    return ebuf;
+  }
 
   std::unique_ptr<hal::device> m_hal;
+  std::unique_ptr<exec_buffer_pool> m_exec_pool; // after m_hal, destructed before
+  std::unique_ptr<xrt_core::adaptive_poll> m_poll;
   std::vector<BufferObjectHandle> m_buffers;
   mutable std::mutex m_buffers_mutex;
   xrt::uuid m_uuid;
@@ -277,6 +277,30 @@ public:
     throw std::runtime_error("exec_buf not supported");
   }
 
+  /**
+   * Submit a batch of exec buffers in order
+   *
+   * Default implementation submits one exec buffer at a time.
+   *
+   * @return
+   *   Number of exec buffers submitted.  If less than count, then
+   *   submission of the first unsubmitted exec buffer failed with
+   *   errno set accordingly.
+   */
+  virtual size_t
+  exec_bufs(const ExecBufferObjectHandle* bos, size_t count)
+  {
+    for (size_t i=0; i<count; ++i) {
+      try {
+        exec_buf(bos[i]);
+      }
+      catch (const std::exception&) {
+        return i;
+      }
+    }
+    return count;
+  }
+
   virtual int
   exec_wait(int timeout_ms) const
   {
@@ -72,15 +72,10 @@ printDeviceInfo(std::ostream& ostr) const
 
 void
 device::
-setup()
+start_dma_workers(unsigned int channels)
 {
 #ifndef PMD_OCL
-  if (!m_workers.empty())
-    return;
-
-  openOrError();
-
-  auto threads = config::get_dma_threads(); // number of bidirectional channels
+  auto threads = channels; // number of bidirectional channels
   if (!threads)
     threads = m_devinfo.mDMAThreads;
   else
@@ -88,12 +83,44 @@ setup()
   if (!threads) // Guard against drivers who do not set m_devinfo.mDMAThreads
     threads = 2;
 
-  XRT_DEBUG(std::cout,"Creating ",2*threads," DMA worker threads\n");
-  for (unsigned int i=0; i<threads; ++i) {
+  // Workers are not stopped when dma_channels is lowered
+  if (threads > m_dma_workers)
+    XRT_DEBUG(std::cout,"Creating ",2*(threads-m_dma_workers)," DMA worker threads\n");
+  for (unsigned int i=m_dma_workers; i<threads; ++i) {
     // read and write queue workers
     m_workers.emplace_back(xrt::thread(task::worker2,std::ref(m_queue[static_cast<qtype>(hal::queue_type::read)]),"read"));
     m_workers.emplace_back(xrt::thread(task::worker2,std::ref(m_queue[static_cast<qtype>(hal::queue_type::write)]),"write"));
   }
+  m_dma_workers = std::max(m_dma_workers,threads);
+  m_dma_config = channels;
+#endif
+}
+
+void
+device::
+update_dma_workers()
+{
+  std::lock_guard<std::mutex> lk(m_workers_mutex);
+  if (m_workers.empty()) // not set up, setup() reads dma_channels
+    return;
+  auto channels = config::get_dma_threads();
+  if (channels != m_dma_config)
+    start_dma_workers(channels);
+}
+
+void
+device::
+setup()
+{
+#ifndef PMD_OCL
+  std::lock_guard<std::mutex> lk(m_workers_mutex);
+  if (!m_workers.empty())
+    return;
+
+  openOrError();
+
+  start_dma_workers(config::get_dma_threads());
+
   // single misc queue worker
   m_workers.emplace_back(xrt::thread(task::worker2,std::ref(m_queue[static_cast<qtype>(hal::queue_type::misc)]),"misc"));
 #endif
@@ -369,7 +396,7 @@ device::sync(const BufferObjectHandle& boh, size_t sz, size_t offset, direction
 
   if (async) {
     auto qt = (dir==XCL_BO_SYNC_BO_FROM_DEVICE) ? hal::queue_type::read : hal::queue_type::write;
-    return event(addTaskF(m_ops->mSyncBO,qt,m_handle,bo->handle,dir,sz,offset));
+    return event(addTaskF(m_ops->mSyncBO,qt,m_handle,bo->handle,dir,sz,offset+bo->offset));
   }
   return event(typed_event<int>(m_ops->mSyncBO(m_handle, bo->handle, dir, sz, offset+bo->offset)));
 }
@@ -380,7 +407,7 @@ copy(const BufferObjectHandle& dst_boh, const BufferObjectHandle& src_boh, size_
 {
   BufferObject* dst_bo = getBufferObject(dst_boh);
   BufferObject* src_bo = getBufferObject(src_boh);
-  return event(typed_event<int>(m_ops->mCopyBO(m_handle, dst_bo->handle, src_bo->handle, sz, dst_offset, src_offset)));
+  return event(typed_event<int>(m_ops->mCopyBO(m_handle, dst_bo->handle, src_bo->handle, sz, dst_offset+dst_bo->offset, src_offset+src_bo->offset)));
 }
 
 void
@@ -390,7 +417,7 @@ fill_copy_pkt(const BufferObjectHandle& dst_boh, const BufferObjectHandle& src_b
 {
   BufferObject* dst_bo = getBufferObject(dst_boh);
   BufferObject* src_bo = getBufferObject(src_boh);
-  ert_fill_copybo_cmd(pkt,src_bo->handle,dst_bo->handle,src_offset,dst_offset,sz);
+  ert_fill_copybo_cmd(pkt,src_bo->handle,dst_bo->handle,src_offset+src_bo->offset,dst_offset+dst_bo->offset,sz);
   return;
 }
 
@@ -446,6 +473,21 @@ exec_buf(const ExecBufferObjectHandle& boh)
   return 0;
 }
 
+size_t
+device::
+exec_bufs(const ExecBufferObjectHandle* bos, size_t count)
+{
+  // The driver interface has no batched submission, submit in a tight
+  // loop directly through the driver entry point
+  auto execbuf = m_ops->mExecBuf;
+  for (size_t i=0; i<count; ++i) {
+    auto bo = getExecBufferObject(bos[i]);
+    if (execbuf(m_handle,bo->handle))
+      return i;
+  }
+  return count;
+}
+
 int
 device::
 exec_wait(int timeout_ms) const
@@ -20,6 +20,7 @@
 #include "xrt/device/hal.h"
 #include "xrt/device/halops2.h"
 #include "xrt/device/PMDOperations.h"
+#include "xrt/util/config_reader.h"
 
 #include "ert.h"
 
@@ -30,6 +31,8 @@
 #include <cstring>
 #include <memory>
 #include <map>
+#include <mutex>
+#include <atomic>
 
 namespace xrt { namespace hal2 {
 
@@ -61,6 +64,9 @@ class device : public xrt::hal::device
   using qtype = std::underlying_type<hal::queue_type>::type;
   std::array<task::queue,static_cast<qtype>(hal::queue_type::max)> m_queue;
   std::vector<std::thread> m_workers;
+  std::mutex m_workers_mutex;
+  unsigned int m_dma_workers = 0;          // read and write workers each
+  std::atomic<unsigned int> m_dma_config {0}; // dma_channels of the workers
   svmbomap_type m_svmbomap;
 
   std::shared_ptr<hal2::operations> m_ops;
@@ -115,9 +121,18 @@ class device : public xrt::hal::device
 #endif
   }
 
+  void
+  start_dma_workers(unsigned int channels);
+
+  void
+  update_dma_workers();
+
   task::queue&
   get_queue(hal::queue_type qt)
   {
+    // dma_channels is reloadable, start more workers if raised
+    if (qt != hal::queue_type::misc && m_dma_config != xrt::config::get_dma_threads())
+      update_dma_workers();
     return m_queue[static_cast<qtype>(qt)];
   }
 
@@ -182,6 +197,19 @@ public:
   void
   setup();
 
+  /**
+   * Number of read and of write workers started so far
+   *
+   * Grows when Runtime.dma_channels is raised in a reloaded ini file,
+   * and never shrinks.
+   */
+  unsigned int
+  get_dma_worker_count()
+  {
+    std::lock_guard<std::mutex> lk(m_workers_mutex);
+    return m_dma_workers;
+  }
+
   virtual bool
   open(const char* log, hal::verbosity_level level)
   {
@@ -336,6 +364,9 @@ public:
   virtual int
   exec_buf(const ExecBufferObjectHandle& bo);
 
+  virtual size_t
+  exec_bufs(const ExecBufferObjectHandle* bos, size_t count);
+
   virtual int
   exec_wait(int timeout_ms) const;
 
@@ -17,82 +17,17 @@
 #include "command.h"
 #include "scheduler.h"
 
-#include <map>
-#include <vector>
-
-namespace {
-
-using buffer_type = xrt::device::ExecBufferObjectHandle;
-static std::mutex s_mutex;
-
-// Static destruction logic to prevent double purging.
-
-// Exec buffer objects must be purged before device is closed.  Static
-// destruction calls platform dtor, which in turns calls purge
-// commands, but static destruction could have deleted the static
-// object in this file first.
-static bool s_purged = false;
-
-struct X {
-  std::map<xrt::device*,std::vector<buffer_type>> freelist;
-  X() {}
-  ~X() { s_purged = true; }
-};
-
-static X sx;
-
-static buffer_type
-get_buffer(xrt::device* device,size_t sz)
-{
-  std::lock_guard<std::mutex> lk(s_mutex);
-
-  auto itr = sx.freelist.find(device);
-  if (itr != sx.freelist.end()) {
-    auto& freelist = (*itr).second;
-    if (!freelist.empty()) {
-      auto buffer = freelist.back();
-      freelist.pop_back();
-      return buffer;
-    }
-  }
-
-  return device->allocExecBuffer(sz); // not thread safe
-}
-
-static void
-free_buffer(xrt::device* device,buffer_type bo)
-{
-  std::lock_guard<std::mutex> lk(s_mutex);
-  s_purged=false;
-  sx.freelist[device].emplace_back(std::move(bo));
-}
-
-} // namespace
+#include <atomic>
 
 namespace xrt {
 
-// Purge exec buffer freelist during static destruction.
-// Not safe to call outside of static descruction, can't lock
-// static mutex since it could have been destructed
-void
-purge_command_freelist()
-{
-  if (s_purged)
-    return;
-
-  for (auto& elem : sx.freelist)
-    elem.second.clear();
-
-  s_purged = true;
-}
-
 command::
 command(xrt::device* device, ert_cmd_opcode opcode)
   : m_device(device)
-  , m_exec_bo(get_buffer(m_device,regmap_size*sizeof(value_type)))
-  , m_packet(m_device->map(m_exec_bo))
+  , m_exec_buffer(m_device->acquireExecBuffer())
+  , m_packet(m_exec_buffer.bo.data)
 {
-  static unsigned int uid_count = 0;
+  static std::atomic<unsigned int> uid_count(0);
   m_uid = uid_count++;
 
   // Clear in case packet was recycled
@@ -110,25 +45,24 @@ command(xrt::device* device, ert_cmd_opcode opcode)
 command::
 command(command&& rhs)
   : m_uid(rhs.m_uid), m_device(rhs.m_device)
-  , m_exec_bo(std::move(rhs.m_exec_bo))
+  , m_exec_buffer(std::move(rhs.m_exec_buffer))
   , m_packet(std::move(rhs.m_packet))
 {
-  rhs.m_exec_bo = 0;
+  rhs.m_exec_buffer.bo.boh = nullptr;
 }
 
 command::
 ~command()
 {
-  if (m_exec_bo) {
+  if (m_exec_buffer.bo.boh) {
     XRT_DEBUG(std::cout,"xrt::command::~command(",m_uid,")\n");
-    m_device->unmap(m_exec_bo);
-    free_buffer(m_device,m_exec_bo);
+    m_device->releaseExecBuffer(m_exec_buffer);
   }
 }
 
 void
 command::
-execute()
+reset()
 {
   // command objects can be reused outside constructor
   // reset state
@@ -136,7 +70,23 @@ execute()
   epacket->state = ERT_CMD_STATE_NEW;
 
   m_done=false;
+}
+
+void
+command::
+execute()
+{
+  reset();
   xrt::scheduler::schedule(get_ptr());
 }
 
+void
+command::
+execute(const std::vector<std::shared_ptr<command>>& cmds)
+{
+  for (auto& cmd : cmds)
+    cmd->reset();
+  xrt::scheduler::schedule(cmds);
+}
+
 } // xrt
@@ -24,6 +24,8 @@
 #include <cstddef>
 #include <array>
 #include <memory>
+#include <vector>
+#include <atomic>
 
 namespace xrt {
 
@@ -147,7 +149,7 @@ public:
   buffer_type
   get_exec_bo() const
   {
-    return m_exec_bo;
+    return m_exec_buffer.bo.boh;
   }
 
   /**
@@ -182,6 +184,15 @@ public:
   void
   execute();
 
+  /**
+   * Execute a batch of commands in one call
+   *
+   * Submission of the commands is amortized over the batch, the
+   * commands are submitted in order.
+   */
+  static void
+  execute(const std::vector<std::shared_ptr<command>>& cmds);
+
   /**
    * Wait for command completion
    */
@@ -243,13 +254,16 @@ public:
   }
 
 private:
+  void
+  reset();
+
   unsigned int m_uid;
   xrt::device* m_device;
-  buffer_type m_exec_bo;
+  xrt::device::exec_buffer_entry m_exec_buffer;
   mutable packet_type m_packet;
 
   // synchronization
-  bool m_done = false;
+  std::atomic<bool> m_done {false};
   std::mutex m_mutex;
   std::condition_variable m_cmd_done;
 };
@@ -268,15 +282,6 @@ command_cast(const std::shared_ptr<command>& cmd)
   return cmd->get_ert_cmd<ERT_COMMAND_TYPE>();
 }
 
-  /**
- * Clear free list of exec buffer objects
- *
- * Command exec buffer objects are recycled, the freelist
- * must be cleared prior to global static destruction
- */
-void
-purge_command_freelist();
-
 } // xrt
 
 #endif
@@ -40,11 +40,25 @@
 #include <thread>
 #include <list>
 #include <map>
+#include <vector>
 
 namespace {
 
 using command_type = std::shared_ptr<xrt::command>;
-using command_queue_type = std::list<command_type>;
+
+// Submitted command along with its submission time, which is used
+// to adapt completion polling to observed command durations
+struct submitted_command
+{
+  command_type cmd;
+  unsigned long submit_ns;
+
+  submitted_command(command_type c)
+    : cmd(std::move(c)), submit_ns(xrt::time_ns())
+  {}
+};
+
+using command_queue_type = std::list<submitted_command>;
 
 ////////////////////////////////////////////////////////////////
 // Command notification is threaded through task queue
@@ -138,6 +152,60 @@ launch(command_type cmd)
   }
 }
 
+// Launch a batch of commands targeting the same device.  All commands
+// are tracked under one lock and then submitted together.
+static void
+launch(const command_type* cmds, size_t count)
+{
+  auto device = cmds[0]->get_device();
+  auto& submitted_cmds = s_device_cmds[device]; // safe since inserted in init
+
+  std::vector<xrt::device::ExecBufferObjectHandle> exec_bos;
+  exec_bos.reserve(count);
+  for (size_t i=0; i<count; ++i)
+    exec_bos.push_back(cmds[i]->get_exec_bo());
+
+  std::vector<command_queue_type::const_iterator> pos;
+  pos.reserve(count);
+
+  // Store commands so completion can be tracked.  Make sure this is
+  // done prior to exec_buf as exec_wait can otherwise be missed.
+  {
+    std::lock_guard<std::mutex> lk(s_mutex);
+    for (size_t i=0; i<count; ++i) {
+      XRT_DEBUG(std::cout,"xrt::kds::command(",cmds[i]->get_uid(),") [new->submitted->running]\n");
+      pos.push_back(submitted_cmds.insert(submitted_cmds.end(),cmds[i]));
+    }
+    s_work.notify_all();
+  }
+
+  // Submit the commands
+  auto submitted = device->exec_bufs(exec_bos.data(),count);
+  if (submitted == count)
+    return;
+
+  // Remove the pending commands that were not submitted
+  auto err = errno;
+  {
+    std::lock_guard<std::mutex> lk(s_mutex);
+    for (size_t i=submitted; i<count; ++i) {
+      assert(get_command_state(cmds[i])==ERT_CMD_STATE_NEW);
+      submitted_cmds.erase(pos[i]);
+    }
+  }
+  throw std::runtime_error(std::string("failed to launch exec buffer '") + std::strerror(err) + "'");
+}
+
+// Check if any of the polled commands is done.  The polled commands
+// are a snapshot of the submitted list, so no lock is needed here and
+// polling does not contend with launch.
+static bool
+any_done(const std::vector<command_type>& polled_cmds)
+{
+  return std::any_of(polled_cmds.begin(),polled_cmds.end(),
+                     [](const command_type& cmd) { return is_command_done(cmd); });
+}
+
 static void
 monitor_loop(const xrt::device* device)
 {
@@ -146,6 +214,8 @@ monitor_loop(const xrt::device* device)
 
   // thread safe access, since guaranteed to be inserted in init
   auto& submitted_cmds = s_device_cmds[device];
+  auto& poll = device->getCompletionPoll();
+  std::vector<command_type> polled_cmds;
 
   while (1) {
     ++loops;
@@ -159,19 +229,28 @@ monitor_loop(const xrt::device* device)
           ++sleeps;
           s_work.wait(lk);
         }
+
+        // Commands submitted after the snapshot are caught by
+        // exec_wait if polling times out
+        for (auto& sc : submitted_cmds)
+          polled_cmds.push_back(sc.cmd);
       }
 
       if (s_stop)
         return;
 
-      // Finer wait
-      while (device->exec_wait(1000)==0) ;
+      // Finer wait, poll command state for short commands, otherwise
+      // block for completion interrupt
+      if (!poll.poll([&polled_cmds] { return any_done(polled_cmds); }))
+        while (device->exec_wait(1000)==0) ;
+      polled_cmds.clear();
 
       std::lock_guard<std::mutex> lk(s_mutex);
+      auto now = xrt::time_ns();
       auto end = submitted_cmds.end();
       for (auto itr=submitted_cmds.begin(); itr!=end; ) {
-        auto& cmd = (*itr);
-        if (check(cmd)) {
+        if (check(itr->cmd)) {
+          poll.record(now - itr->submit_ns);
           itr = submitted_cmds.erase(itr);
           end = submitted_cmds.end();
         }
@@ -212,6 +291,20 @@ schedule(const command_type& cmd)
   return launch(cmd);
 }
 
+void
+schedule(const std::vector<command_type>& cmds)
+{
+  // Launch runs of commands that target the same device
+  auto begin = cmds.data();
+  auto end = begin + cmds.size();
+  while (begin != end) {
+    auto device = (*begin)->get_device();
+    auto run = std::find_if(begin,end,[device](const command_type& cmd) { return cmd->get_device()!=device; });
+    launch(begin,run-begin);
+    begin = run;
+  }
+}
+
 void
 start()
 {
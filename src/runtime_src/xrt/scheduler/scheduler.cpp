@@ -94,8 +94,6 @@ stop()
     kds::stop();
   else
     sws::stop();
-
-  purge_command_freelist();
 }
 
 /**
@@ -110,11 +108,29 @@ schedule(const command_type& cmd)
     sws::schedule(cmd);
 }
 
+/**
+ * Schedule a batch of commands for execution on either sws or kds
+ */
+void
+schedule(const std::vector<command_type>& cmds)
+{
+  if (cmds.empty())
+    return;
+
+  if (kds_enabled())
+    kds::schedule(cmds);
+  else
+    sws::schedule(cmds);
+}
+
 void
 init(xrt::device* device, const axlf* top)
 {
   emu_50_disable_kds(device);
 
+  // Warm the exec buffer pool so first commands need not allocate
+  device->preallocExecBuffers(xrt::config::get_exec_bo_pool_prealloc());
+
   if (kds_enabled())
     kds::init(device,top);
   else
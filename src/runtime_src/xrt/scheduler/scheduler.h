@@ -19,6 +19,8 @@
 
 #include "xrt/scheduler/command.h"
 #include <vector>
+#include <utility>
+#include <type_traits>
 
 namespace xrt {
 
@@ -32,6 +34,9 @@ namespace sws {
 void
 schedule(const command_type& cmd);
 
+void
+schedule(const std::vector<command_type>& cmds);
+
 void
 start();
 
@@ -54,6 +59,9 @@ namespace kds {
 void
 schedule(const command_type& cmd);
 
+void
+schedule(const std::vector<command_type>& cmds);
+
 void
 start();
 
@@ -72,6 +80,46 @@ namespace scheduler {
 void
 schedule(const command_type& cmd);
 
+/**
+ * Schedule a batch of commands for execution in one call.  The
+ * commands are submitted in order.
+ */
+void
+schedule(const std::vector<command_type>& cmds);
+
+/**
+ * Schedule the commands returned by @next in one batch, @next is
+ * called until it returns nullptr.  The batch is passed to @sched.
+ *
+ * When @next throws, the commands returned so far are scheduled
+ * before the exception is rethrown.  The caller has accounted for
+ * them already, e.g. counted them as active, and relies on their
+ * completion.
+ */
+template <typename Next, typename Schedule>
+inline void
+schedule_batch(Next&& next, Schedule&& sched)
+{
+  std::vector<typename std::decay<decltype(next())>::type> cmds;
+  try {
+    while (auto cmd = next())
+      cmds.push_back(std::move(cmd));
+  }
+  catch (...) {
+    sched(cmds);
+    throw;
+  }
+  sched(cmds);
+}
+
+template <typename Next>
+inline void
+schedule_batch(Next&& next)
+{
+  schedule_batch(std::forward<Next>(next),
+                 [](const std::vector<command_type>& cmds) { schedule(cmds); });
+}
+
 void
 start();
 
@@ -848,6 +848,25 @@ schedule(const cmd_ptr& cmd)
   scheduler->notify();
 }
 
+void
+schedule(const std::vector<cmd_ptr>& cmds)
+{
+  std::vector<xcmd_ptr> xcmds;
+  xcmds.reserve(cmds.size());
+  for (auto& cmd : cmds) {
+    auto& exec = s_device_exec_core[cmd->get_device()];
+    xcmds.push_back(xocl_cmd::create(exec.get(),cmd));
+  }
+
+  std::lock_guard<std::mutex> lk(s_pending_mutex);
+  for (auto& xcmd : xcmds) {
+    s_pending_cmds.push_back(xcmd);
+    ++s_num_pending;
+  }
+  for (auto& xcmd : xcmds)
+    xcmd->get_exec()->get_scheduler()->notify();
+}
+
 void
 start()
 {
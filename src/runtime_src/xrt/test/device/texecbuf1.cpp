@@ -138,7 +138,6 @@ BOOST_AUTO_TEST_CASE(xbuf1)
     catch (const std::exception& ex) {
       std::cout << ex.what() << "\n";
     }
-    xrt::purge_command_freelist();
     device.close();
   }
 
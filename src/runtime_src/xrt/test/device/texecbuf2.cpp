@@ -0,0 +1,107 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+////////////////////////////////////////////////////////////////
+// Benchmark of per-command vs batched command submission
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+#include "../test_helpers.h"
+
+#include "xrt/device/device.h"
+#include "xrt/scheduler/command.h"
+#include "xrt/scheduler/scheduler.h"
+#include "xrt/util/time.h"
+#include <vector>
+#include <iostream>
+
+using namespace xrt::test;
+
+namespace {
+
+static std::vector<std::shared_ptr<xrt::command>>
+create_commands(xrt::device* device, size_t count)
+{
+  std::vector<std::shared_ptr<xrt::command>> cmds;
+  cmds.reserve(count);
+  while (count--) {
+    cmds.push_back(std::make_shared<xrt::command>(device,ERT_START_CU));
+    auto& packet = cmds.back()->get_packet();
+    packet[0] = 0x13001; // [22:12] = 0x13 = 19 = payload size
+    packet[1] = 0x1;     // cu mask
+  }
+  return cmds;
+}
+
+static void
+wait(const std::vector<std::shared_ptr<xrt::command>>& cmds)
+{
+  for (auto& cmd : cmds)
+    cmd->wait();
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(test_execbuf2)
+
+BOOST_AUTO_TEST_CASE(xbuf2)
+{
+  auto pred = [](const xrt::hal::device& hal) {
+    return (hal.getDriverLibraryName().find("xclgemdrv")!=std::string::npos);
+  };
+  auto devices = xrt::test::loadDevices(pred);
+
+  size_t count = 1000;
+
+  for (auto& device : devices) {
+    device.open();
+    device.setup();
+    xrt::scheduler::start();
+
+    try {
+      unsigned long single_time = 0;
+      unsigned long batch_time = 0;
+
+      auto single = create_commands(&device,count);
+      {
+        xrt::time_guard tg(single_time);
+        for (auto& cmd : single)
+          cmd->execute();
+      }
+      wait(single);
+
+      auto batch = create_commands(&device,count);
+      {
+        xrt::time_guard tg(batch_time);
+        xrt::command::execute(batch);
+      }
+      wait(batch);
+
+      std::cout << "Submission of " << count << " commands\n";
+      std::cout << "Per command: " << single_time*1e-6 << " ms ("
+                << (single_time/count) << " ns/cmd)\n";
+      std::cout << "Batched: " << batch_time*1e-6 << " ms ("
+                << (batch_time/count) << " ns/cmd)\n";
+    }
+    catch (const std::exception& ex) {
+      std::cout << ex.what() << "\n";
+    }
+
+    xrt::scheduler::stop();
+    device.close();
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,137 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+////////////////////////////////////////////////////////////////
+// Unit testing of hal2::device DMA workers following
+// Runtime.dma_channels across ini file reloads
+//
+// The device is opened on a fake shim reporting 4 DMA threads,
+// and read and write tasks are queued after each reload the way
+// the runtime queues buffer transfers.  No hardware is required.
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+
+#include "xrt/device/hal2.h"
+#include "xrt/util/config_reader.h"
+
+#include <dlfcn.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+
+namespace {
+
+static int fake_handle;
+
+static xclDeviceHandle
+fake_open(unsigned int, const char*, xclVerbosityLevel)
+{
+  return &fake_handle;
+}
+
+static void
+fake_close(xclDeviceHandle)
+{
+}
+
+static int
+fake_device_info(xclDeviceHandle, xclDeviceInfo2* info)
+{
+  info->mDMAThreads = 4;
+  return 0;
+}
+
+static std::string
+ini_path()
+{
+  return "/tmp/thal2_dma_workers." + std::to_string(::getpid()) + ".ini";
+}
+
+static void
+reload_ini(const std::string& path, unsigned int channels)
+{
+  auto tmp = path + ".tmp";
+  {
+    std::ofstream ostr(tmp);
+    ostr << "[Runtime]\n"
+         << "dma_channels = " << channels << "\n";
+  }
+  std::rename(tmp.c_str(),path.c_str());
+  xrt::config::reload(path);
+}
+
+static int
+transfer(int value)
+{
+  return value;
+}
+
+// Queue a read and a write task and wait for both
+static bool
+read_write(xrt::hal2::device& hal)
+{
+  auto rd = hal.addTaskF(transfer,xrt::hal::queue_type::read,1);
+  auto wr = hal.addTaskF(transfer,xrt::hal::queue_type::write,2);
+  return rd.get() == 1 && wr.get() == 2;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE ( test_hal2_dma_workers )
+
+BOOST_AUTO_TEST_CASE( test_hal2_dma_workers1 )
+{
+  auto path = ini_path();
+  reload_ini(path,1);
+
+  // No driver symbols are found in the test, the entry points used
+  // to open the device are filled in by hand
+  auto ops = std::make_shared<xrt::hal2::operations>("fake",dlopen(nullptr,RTLD_LAZY),0);
+  ops->mOpen = fake_open;
+  ops->mClose = fake_close;
+  ops->mGetDeviceInfo = fake_device_info;
+
+  xrt::hal2::device hal(ops,0);
+  BOOST_REQUIRE(hal.open("",xrt::hal::verbosity_level::quiet));
+  hal.setup();
+  BOOST_CHECK_EQUAL(hal.get_dma_worker_count(),1);
+  BOOST_CHECK(read_write(hal));
+
+  // Raised, more workers on next transfer
+  reload_ini(path,3);
+  BOOST_CHECK(read_write(hal));
+  BOOST_CHECK_EQUAL(hal.get_dma_worker_count(),3);
+
+  // Lowered, workers are kept
+  reload_ini(path,2);
+  BOOST_CHECK(read_write(hal));
+  BOOST_CHECK_EQUAL(hal.get_dma_worker_count(),3);
+
+  // Capped at what the shim supports, 0 is all of them
+  reload_ini(path,8);
+  BOOST_CHECK(read_write(hal));
+  BOOST_CHECK_EQUAL(hal.get_dma_worker_count(),4);
+  reload_ini(path,0);
+  BOOST_CHECK(read_write(hal));
+  BOOST_CHECK_EQUAL(hal.get_dma_worker_count(),4);
+
+  std::remove(path.c_str());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,195 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+////////////////////////////////////////////////////////////////
+// Unit testing of xrtcpp::exec::wait and wait_any
+//
+// Commands are created on an xrt::device over a fake shim that
+// only hands out exec buffers, and are completed from a test
+// thread the way the scheduler completes them.  No hardware is
+// required.
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+
+// command::impl is private to xrtexec.cpp
+#include "xrt/xrt++/xrtexec.cpp"
+#include "xrt/device/hal2.h"
+
+#include <sys/mman.h>
+#include <dlfcn.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace {
+
+static unsigned int
+fake_alloc_bo(xclDeviceHandle, size_t, int, unsigned int)
+{
+  static std::atomic<unsigned int> handle(1);
+  return handle++;
+}
+
+static void*
+fake_map_bo(xclDeviceHandle, unsigned int, bool)
+{
+  return mmap(nullptr,xrt::device::exec_buffer_size,PROT_READ|PROT_WRITE,
+              MAP_PRIVATE|MAP_ANONYMOUS,-1,0);
+}
+
+static void
+fake_free_bo(xclDeviceHandle, unsigned int)
+{
+}
+
+static std::unique_ptr<xrt::device>
+make_device()
+{
+  // No driver symbols are found in the test, the exec buffer
+  // entry points are filled in by hand
+  auto ops = std::make_shared<xrt::hal2::operations>("fake",dlopen(nullptr,RTLD_LAZY),1);
+  ops->mAllocBO = fake_alloc_bo;
+  ops->mMapBO = fake_map_bo;
+  ops->mFreeBO = fake_free_bo;
+  return std::make_unique<xrt::device>(std::make_unique<xrt::hal2::device>(ops,0));
+}
+
+struct test_command : xrtcpp::exec::exec_cu_command
+{
+  explicit
+  test_command(xrt::device* device)
+    : exec_cu_command(device)
+  {}
+
+  // Complete the command as the scheduler does
+  void
+  complete()
+  {
+    m_impl->notify(ERT_CMD_STATE_COMPLETED);
+  }
+};
+
+static void
+complete_after(test_command cmd, unsigned int ms)
+{
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+  cmd.complete();
+}
+
+static unsigned long
+elapsed_ms(std::chrono::steady_clock::time_point start)
+{
+  auto now = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::milliseconds>(now-start).count();
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE ( test_xrtexec_wait )
+
+BOOST_AUTO_TEST_CASE( test_wait_any_order )
+{
+  auto device = make_device();
+  std::vector<test_command> tcmds;
+  for (int i=0; i<3; ++i)
+    tcmds.emplace_back(device.get());
+  std::vector<xrtcpp::exec::command> cmds(tcmds.begin(),tcmds.end());
+
+  // Woken by the command that completes
+  std::thread t(complete_after,tcmds[2],20);
+  BOOST_CHECK_EQUAL(xrtcpp::exec::wait_any(cmds),2);
+  t.join();
+
+  // Lowest index of completed commands
+  tcmds[1].complete();
+  BOOST_CHECK_EQUAL(xrtcpp::exec::wait_any(cmds),1);
+  tcmds[0].complete();
+  BOOST_CHECK_EQUAL(xrtcpp::exec::wait_any(cmds),0);
+
+  // wait returns once all have completed, in any order
+  std::vector<test_command> more;
+  for (int i=0; i<3; ++i)
+    more.emplace_back(device.get());
+  std::vector<xrtcpp::exec::command> mcmds(more.begin(),more.end());
+  std::vector<std::thread> threads;
+  for (unsigned int i=0; i<more.size(); ++i)
+    threads.emplace_back(complete_after,more[i],30-10*i);
+  xrtcpp::exec::wait(mcmds);
+  for (auto& cmd : mcmds)
+    BOOST_CHECK(cmd.completed());
+  for (auto& th : threads)
+    th.join();
+
+  BOOST_CHECK_THROW(xrtcpp::exec::wait_any({}),std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE( test_wait_any_timeout )
+{
+  auto device = make_device();
+  test_command a(device.get());
+  test_command b(device.get());
+  std::vector<xrtcpp::exec::command> cmds {a,b};
+
+  // Nothing completes
+  auto start = std::chrono::steady_clock::now();
+  BOOST_CHECK_EQUAL(xrtcpp::exec::wait_any(cmds,50),cmds.size());
+  BOOST_CHECK(elapsed_ms(start) >= 50);
+
+  // Completion within timeout
+  std::thread t(complete_after,b,20);
+  start = std::chrono::steady_clock::now();
+  BOOST_CHECK_EQUAL(xrtcpp::exec::wait_any(cmds,5000),1);
+  BOOST_CHECK(elapsed_ms(start) < 5000);
+  t.join();
+
+  // Already completed, no wait
+  BOOST_CHECK_EQUAL(xrtcpp::exec::wait_any(cmds,0),1);
+}
+
+BOOST_AUTO_TEST_CASE( test_wait_any_independent )
+{
+  // A waiter is not satisfied by commands it doesn't wait for
+  auto device = make_device();
+  test_command a(device.get());
+  test_command b(device.get());
+
+  std::atomic<size_t> a_result(0);
+  std::thread ta([&a,&a_result] { a_result = xrtcpp::exec::wait_any({a},100); });
+  std::thread tb(complete_after,b,10);
+  BOOST_CHECK_EQUAL(xrtcpp::exec::wait_any({b},5000),0);
+  tb.join();
+  ta.join();
+  BOOST_CHECK_EQUAL(a_result,1);  // timed out
+
+  // Many waiters on one command are all woken
+  test_command c(device.get());
+  std::atomic<int> woken(0);
+  std::vector<std::thread> waiters;
+  for (int i=0; i<4; ++i)
+    waiters.emplace_back([&c,&woken] {
+      if (xrtcpp::exec::wait_any({c},5000) == 0)
+        ++woken;
+    });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  c.complete();
+  for (auto& w : waiters)
+    w.join();
+  BOOST_CHECK_EQUAL(woken,4);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,121 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+////////////////////////////////////////////////////////////////
+// Unit testing of xrt::scheduler::schedule_batch
+//
+// A stand-in execution context starts workgroups the way
+// xocl::execution_context does: every started command is counted
+// as active and the kernel event completes when the count drops
+// back to zero.  A failure is injected in start to check that the
+// commands started before it are scheduled and complete.
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+
+#include "xrt/scheduler/scheduler.h"
+
+#include <memory>
+#include <vector>
+#include <stdexcept>
+
+namespace {
+
+struct context
+{
+  using command_type = std::shared_ptr<size_t>;
+
+  size_t workgroups;
+  size_t fail_at;
+  size_t started = 0;
+  size_t active = 0;
+  size_t batches = 0;
+  std::vector<size_t> scheduled;
+
+  context(size_t count, size_t fail = -1)
+    : workgroups(count), fail_at(fail)
+  {}
+
+  command_type
+  start()
+  {
+    if (started == fail_at)
+      throw std::runtime_error("start failed");
+    auto cmd = std::make_shared<size_t>(started++);
+    ++active;
+    return cmd;
+  }
+
+  // Scheduled commands complete right away
+  void
+  schedule(const std::vector<command_type>& cmds)
+  {
+    ++batches;
+    for (auto& cmd : cmds) {
+      scheduled.push_back(*cmd);
+      --active;
+    }
+  }
+
+  void
+  execute()
+  {
+    xrt::scheduler::schedule_batch
+      ([this]() -> command_type {
+        return started < workgroups ? start() : nullptr;
+      },
+       [this](const std::vector<command_type>& cmds) { schedule(cmds); });
+  }
+};
+
+}
+
+BOOST_AUTO_TEST_SUITE ( test_schedule_batch )
+
+BOOST_AUTO_TEST_CASE( test_schedule_batch1 )
+{
+  // all commands in one batch, in order
+  context ctx(8);
+  ctx.execute();
+  BOOST_CHECK_EQUAL(ctx.batches,1);
+  BOOST_CHECK_EQUAL(ctx.active,0);
+  BOOST_REQUIRE_EQUAL(ctx.scheduled.size(),8);
+  for (size_t i=0; i<ctx.scheduled.size(); ++i)
+    BOOST_CHECK_EQUAL(ctx.scheduled[i],i);
+
+  // nothing to start
+  context empty(0);
+  empty.execute();
+  BOOST_CHECK_EQUAL(empty.batches,1);
+  BOOST_CHECK(empty.scheduled.empty());
+}
+
+BOOST_AUTO_TEST_CASE( test_schedule_batch2 )
+{
+  // failure in start, commands started before it still complete
+  context ctx(8,5);
+  BOOST_CHECK_THROW(ctx.execute(),std::runtime_error);
+  BOOST_CHECK_EQUAL(ctx.batches,1);
+  BOOST_CHECK_EQUAL(ctx.scheduled.size(),5);
+  BOOST_CHECK_EQUAL(ctx.active,0);
+
+  // failure in first start schedules an empty batch
+  context first(8,0);
+  BOOST_CHECK_THROW(first.execute(),std::runtime_error);
+  BOOST_CHECK(first.scheduled.empty());
+  BOOST_CHECK_EQUAL(first.active,0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,349 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef xrt_test_util_fake_pcie_tree_h_
+#define xrt_test_util_fake_pcie_tree_h_
+
+#include "core/include/xclbin.h"
+#include "core/pcie/linux/scan.h"
+
+#include <boost/filesystem.hpp>
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+#include <cstdlib>
+
+namespace xrt { namespace test {
+
+/**
+ * Fake PCIE sysfs and devfs tree of Xilinx boards
+ *
+ * Builds, in a temporary directory, the sysfs entries and device nodes
+ * that pcidev scan and the xbutil/xbmgmt queries read for a number of
+ * boards, each with a mgmt PF (function 0) and a user PF (function 1):
+ * ids, PF markers, instance and render node, ready, BAR resources, rom
+ * and xmc subdevices with sensors, icap mem_topology and ip_layout,
+ * memstat_raw, and kds_custat.
+ *
+ * Point pcidev at the tree with pcidev::set_roots(sysfs_root(),
+ * devfs_root()), or with XRT_SYSFS_ROOT and XRT_DEVFS_ROOT for tools run
+ * as separate processes.  The tree is removed on destruction.
+ */
+class fake_pcie_tree
+{
+public:
+  /**
+   * @boards: number of boards
+   * @banks: number of DDR banks in mem_topology of each board
+   * @cus: number of compute units in ip_layout of each board
+   */
+  explicit
+  fake_pcie_tree(unsigned int boards, unsigned int banks=4, unsigned int cus=8)
+    : m_banks(banks), m_cus(cus)
+  {
+    char tmpl[] = "/tmp/fake_pcie_tree.XXXXXX";
+    m_root = mkdtemp(tmpl);
+    m_sysfs = m_root + "/sys/bus/pci/devices";
+    m_devfs = m_root + "/dev";
+    boost::filesystem::create_directories(m_sysfs);
+    boost::filesystem::create_directories(m_devfs + "/dri");
+    boost::filesystem::create_directories(m_devfs + "/xfpga");
+
+    // Non Xilinx function, skipped by scan
+    auto other = m_sysfs + "/0000:00:1f.0";
+    boost::filesystem::create_directories(other);
+    write(other + "/vendor","0x8086");
+
+    for (unsigned int b=0; b<boards; ++b)
+      add_board(b);
+  }
+
+  ~fake_pcie_tree()
+  {
+    boost::filesystem::remove_all(m_root);
+  }
+
+  fake_pcie_tree(const fake_pcie_tree&) = delete;
+  fake_pcie_tree& operator=(const fake_pcie_tree&) = delete;
+
+  const std::string&
+  sysfs_root() const
+  {
+    return m_sysfs;
+  }
+
+  const std::string&
+  devfs_root() const
+  {
+    return m_devfs;
+  }
+
+  static std::string
+  bdf(unsigned int board, bool mgmt)
+  {
+    char buf[16];
+    std::snprintf(buf,sizeof(buf),"0000:%02x:00.%u",bus(board),mgmt ? 0 : 1);
+    return buf;
+  }
+
+  // Directory of a PF
+  std::string
+  pf_dir(unsigned int board, bool mgmt) const
+  {
+    return m_sysfs + "/" + bdf(board,mgmt);
+  }
+
+  // Mark both PFs of board ready or not ready
+  void
+  set_ready(unsigned int board, bool ready)
+  {
+    write(pf_dir(board,true) + "/ready",ready ? "0x1" : "0x0");
+    write(pf_dir(board,false) + "/ready",ready ? "0x1" : "0x0");
+  }
+
+  // Write a text entry, newline terminated as sysfs shows it
+  static void
+  write(const std::string& file, const std::string& value)
+  {
+    std::ofstream ostr(file);
+    ostr << value;
+    if (value.empty() || value.back() != '\n')
+      ostr << "\n";
+  }
+
+  static void
+  write(const std::string& file, const std::vector<char>& buf)
+  {
+    std::ofstream ostr(file,std::ios::binary);
+    ostr.write(buf.data(),buf.size());
+  }
+
+private:
+  static unsigned int
+  bus(unsigned int board)
+  {
+    return 0x17 + board;
+  }
+
+  static std::string
+  hex(uint64_t value)
+  {
+    char buf[32];
+    std::snprintf(buf,sizeof(buf),"0x%llx",static_cast<unsigned long long>(value));
+    return buf;
+  }
+
+  static std::string
+  subdev(const std::string& dir, const std::string& name, bool mgmt, unsigned int id)
+  {
+    auto path = dir + "/" + name + (mgmt ? ".m." : ".u.") + std::to_string(id);
+    boost::filesystem::create_directories(path);
+    return path;
+  }
+
+  std::vector<char>
+  make_mem_topology(unsigned int board) const
+  {
+    std::vector<char> buf(offsetof(mem_topology,m_mem_data) + m_banks*sizeof(mem_data),0);
+    auto topo = reinterpret_cast<mem_topology*>(buf.data());
+    topo->m_count = m_banks;
+    for (unsigned int i=0; i<m_banks; ++i) {
+      auto& mem = topo->m_mem_data[i];
+      mem.m_type = MEM_DDR4;
+      mem.m_used = (i+board)%4 != 3;  // some banks unused
+      mem.m_size = 16*1024*1024;      // KB
+      mem.m_base_address = uint64_t(i) << 34;
+      std::snprintf(reinterpret_cast<char*>(mem.m_tag),sizeof(mem.m_tag),"bank%u",i);
+    }
+    return buf;
+  }
+
+  std::vector<char>
+  make_ip_layout() const
+  {
+    std::vector<char> buf(offsetof(ip_layout,m_ip_data) + m_cus*sizeof(ip_data),0);
+    auto layout = reinterpret_cast<ip_layout*>(buf.data());
+    layout->m_count = m_cus;
+    for (unsigned int i=0; i<m_cus; ++i) {
+      auto& ip = layout->m_ip_data[i];
+      ip.m_type = IP_KERNEL;
+      ip.m_base_address = cu_addr(i);
+      std::snprintf(reinterpret_cast<char*>(ip.m_name),sizeof(ip.m_name),"vadd:vadd_%u",i);
+    }
+    return buf;
+  }
+
+  static uint64_t
+  cu_addr(unsigned int cu)
+  {
+    return 0x1800000 + cu*0x10000;
+  }
+
+  // Subdevices and entries common to mgmt and user PFs
+  void
+  add_common(const std::string& dir, unsigned int board, bool mgmt, unsigned int id) const
+  {
+    write(dir + "/vendor","0x10ee");
+    write(dir + "/device",mgmt ? "0x5000" : "0x5001");
+    write(dir + "/subsystem_vendor","0x10ee");
+    write(dir + "/subsystem_device","0x000e");
+    write(dir + "/userbar","0");
+    write(dir + "/ready","0x1");
+    write(dir + "/mfg","0");
+    write(dir + "/link_speed","3");
+    write(dir + "/link_width","16");
+    write(dir + "/resource",
+          "0x0000003800000000 0x0000003801ffffff 0x000000000014220c\n"
+          "0x0000000000000000 0x0000000000000000 0x0000000000000000\n"
+          "0x0000003802000000 0x000000380201ffff 0x000000000014220c");
+
+    auto rom = subdev(dir,"rom",mgmt,id);
+    write(rom + "/VBNV","xilinx_u200_xdma_201830_2");
+    write(rom + "/FPGA","xcu200-fsgd2104-2-e");
+    write(rom + "/timestamp",hex(0x5d1211e8));
+    write(rom + "/ddr_bank_count_max",std::to_string(m_banks));
+    write(rom + "/ddr_bank_size","16");
+
+    static const char* sensors[][2] = {
+      { "xmc_12v_pex_vol", "12125" }, { "xmc_12v_pex_curr", "2304" },
+      { "xmc_12v_aux_vol", "12110" }, { "xmc_12v_aux_curr", "1540" },
+      { "xmc_3v3_pex_vol", "3294" },  { "xmc_3v3_pex_curr", "312" },
+      { "xmc_3v3_aux_vol", "3302" },  { "xmc_3v3_vcc_vol", "3300" },
+      { "xmc_vccint_vol", "850" },    { "xmc_vccint_curr", "9730" },
+      { "xmc_vccint_bram_vol", "851" }, { "xmc_0v85", "852" },
+      { "xmc_0v85_curr", "0" },       { "xmc_mgt0v9avcc", "901" },
+      { "xmc_mgtavtt", "1202" },      { "xmc_1v2_top", "1200" },
+      { "xmc_vcc1v2_btm", "1201" },   { "xmc_1v8", "1802" },
+      { "xmc_12v_sw", "12090" },      { "xmc_sys_5v5", "5502" },
+      { "xmc_vpp2v5_vol", "2503" },   { "xmc_hbm_1v2_vol", "0" },
+      { "xmc_ddr_vpp_btm", "2498" },  { "xmc_ddr_vpp_top", "2501" },
+      { "xmc_fpga_temp", "47" },      { "xmc_fan_temp", "38" },
+      { "xmc_fan_rpm", "2431" },      { "xmc_se98_temp0", "36" },
+      { "xmc_se98_temp1", "35" },     { "xmc_se98_temp2", "0" },
+      { "xmc_dimm_temp0", "41" },     { "xmc_dimm_temp1", "42" },
+      { "xmc_dimm_temp2", "40" },     { "xmc_dimm_temp3", "43" },
+      { "xmc_cage_temp0", "32" },     { "xmc_cage_temp1", "33" },
+      { "xmc_cage_temp2", "0" },      { "xmc_cage_temp3", "0" },
+    };
+    auto xmc = subdev(dir,"xmc",mgmt,id);
+    for (auto& sensor : sensors)
+      write(xmc + "/" + sensor[0],sensor[1]);
+    std::vector<char> temps(m_banks*sizeof(uint32_t));
+    for (unsigned int i=0; i<m_banks; ++i) {
+      uint32_t temp = 40 + i;
+      std::memcpy(temps.data() + i*sizeof(temp),&temp,sizeof(temp));
+    }
+    write(xmc + "/temp_by_mem_topology",temps);
+
+    auto icap = subdev(dir,"icap",mgmt,id);
+    write(icap + "/mem_topology",make_mem_topology(board));
+    write(icap + "/ip_layout",make_ip_layout());
+    write(icap + "/debug_ip_layout",std::vector<char>());
+    write(icap + "/clock_freqs","300\n500\n0");
+    write(icap + "/idcode","0x14b37093");
+
+    auto fw = subdev(dir,"firewall",mgmt,id);
+    write(fw + "/detected_status","0");
+    write(fw + "/detected_level","0");
+    write(fw + "/detected_time","0");
+  }
+
+  void
+  add_board(unsigned int board)
+  {
+    auto b = bus(board);
+
+    // mgmt PF, instance number encodes bus/device/function
+    auto mgmt = pf_dir(board,true);
+    boost::filesystem::create_directories(mgmt);
+    auto mgmt_inst = b << 8;
+    add_common(mgmt,board,true,mgmt_inst);
+    write(mgmt + "/mgmt_pf","");
+    write(mgmt + "/instance",std::to_string(mgmt_inst));
+    write(m_devfs + "/xclmgmt" + std::to_string(mgmt_inst),"");
+
+    // user PF, instance is its DRM render node
+    auto user = pf_dir(board,false);
+    auto render = 128 + board;
+    boost::filesystem::create_directories(user + "/drm/renderD" + std::to_string(render));
+    auto user_inst = (b << 8) + 1;
+    add_common(user,board,false,user_inst);
+    write(user + "/user_pf","");
+    write(user + "/xclbinuuid","7b0b8bfa-a2bc-45ab-9b41-4fbc51b2ab31");
+    write(user + "/p2p_enable","0");
+    write(user + "/mig_calibration","1");
+    write(user + "/logic_uuids","2c3e1a4b5f6d7e8f9a0b1c2d3e4f5a6b");
+    write(m_devfs + "/dri/renderD" + std::to_string(render),"");
+    write(m_devfs + "/xfpga/xvc_pub.u" + std::to_string(user_inst),"");
+
+    std::string memstat;
+    for (unsigned int i=0; i<m_banks; ++i)
+      memstat += std::to_string((i+1)*4096*1024) + " " + std::to_string(i+board+1) + "\n";
+    write(user + "/memstat_raw",memstat);
+
+    auto sched = subdev(user,"mb_scheduler",false,user_inst);
+    std::string custat;
+    for (unsigned int i=0; i<m_cus; ++i)
+      custat += "CU[@" + hex(cu_addr(i)) + "] : " + std::to_string(i*100) + " status : 4\n";
+    write(sched + "/kds_custat",custat);
+    write(sched + "/kds_numcdmas","0");
+  }
+
+  unsigned int m_banks;
+  unsigned int m_cus;
+  std::string m_root;
+  std::string m_sysfs;
+  std::string m_devfs;
+};
+
+/**
+ * Point pcidev at a fake tree for the lifetime of the guard
+ *
+ * The devices are rescanned from the tree, and rescanned from the
+ * previous roots on destruction.
+ */
+class roots_guard
+{
+public:
+  explicit
+  roots_guard(const fake_pcie_tree& tree)
+    : m_sysfs(pcidev::get_sysfs_root()), m_devfs(pcidev::get_devfs_root())
+  {
+    pcidev::set_roots(tree.sysfs_root(),tree.devfs_root());
+    pcidev::rescan();
+  }
+
+  ~roots_guard()
+  {
+    pcidev::set_roots(m_sysfs,m_devfs);
+    pcidev::rescan();
+  }
+
+  roots_guard(const roots_guard&) = delete;
+  roots_guard& operator=(const roots_guard&) = delete;
+
+private:
+  std::string m_sysfs;
+  std::string m_devfs;
+};
+
+}} // test,xrt
+
+#endif
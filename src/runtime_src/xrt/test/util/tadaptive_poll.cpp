@@ -0,0 +1,166 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+////////////////////////////////////////////////////////////////
+// Unit testing and latency benchmark of core/common/adaptive_poll.h
+//
+// A device thread emulates command execution, it completes a
+// command by writing its state and signalling a condition variable
+// standing in for the completion interrupt.  Launch-to-notify latency
+// is compared between always blocking and hybrid polling.
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+
+#include "core/common/adaptive_poll.h"
+#include "xrt/util/time.h"
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+
+namespace {
+
+// Device thread runs one command at a time, it spins waiting for a
+// launch so that launch cost is not part of the measured latency
+struct emulated_device
+{
+  std::mutex mutex;
+  std::condition_variable interrupt;
+  std::atomic<unsigned long> launched {0};
+  std::atomic<bool> done {false};
+  std::atomic<bool> stop {false};
+  std::thread thread;
+
+  emulated_device()
+    : thread(&emulated_device::run,this)
+  {}
+
+  ~emulated_device()
+  {
+    stop = true;
+    thread.join();
+  }
+
+  void
+  run()
+  {
+    while (!stop) {
+      auto duration = launched.exchange(0);
+      if (!duration)
+        continue;
+      auto start = xrt::time_ns();
+      while (xrt::time_ns() - start < duration)
+        ;
+      std::lock_guard<std::mutex> lk(mutex);
+      done = true;
+      interrupt.notify_all();
+    }
+  }
+
+  void
+  launch(unsigned long duration_ns)
+  {
+    done = false;
+    launched = duration_ns;
+  }
+
+  void
+  wait()
+  {
+    std::unique_lock<std::mutex> lk(mutex);
+    while (!done)
+      interrupt.wait(lk);
+  }
+};
+
+static std::vector<unsigned long>
+measure(xrt_core::adaptive_poll* poll, unsigned long duration_ns, size_t count)
+{
+  emulated_device device;
+  std::vector<unsigned long> latency;
+  latency.reserve(count);
+  for (size_t i=0; i<count; ++i) {
+    auto launch = xrt::time_ns();
+    device.launch(duration_ns);
+    if (!poll || !poll->poll([&device] { return device.done.load(); }))
+      device.wait();
+    auto now = xrt::time_ns();
+    if (poll)
+      poll->record(now - launch);
+    latency.push_back(now - launch - duration_ns);
+  }
+  std::sort(latency.begin(),latency.end());
+  return latency;
+}
+
+static void
+report(const char* label, const std::vector<unsigned long>& latency)
+{
+  auto p50 = latency[latency.size()/2];
+  auto p99 = latency[latency.size()*99/100];
+  std::cout << label << " p50: " << p50/1000.0 << " us, p99: " << p99/1000.0 << " us\n";
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE ( test_adaptive_poll )
+
+BOOST_AUTO_TEST_CASE( test_adaptive_poll1 )
+{
+  xrt_core::adaptive_poll poll(50);
+
+  // Optimistic full window before any samples
+  BOOST_CHECK_EQUAL(poll.window(),50000);
+
+  // Short commands shrink the window to cover them
+  for (int i=0; i<32; ++i)
+    poll.record(10000);
+  BOOST_CHECK_EQUAL(poll.window(),20000);
+
+  // Long commands disable polling
+  for (int i=0; i<64; ++i)
+    poll.record(2000000);
+  BOOST_CHECK_EQUAL(poll.window(),0);
+
+  // Zero max window disables polling
+  poll.set_max_window(0);
+  BOOST_CHECK_EQUAL(poll.window(),0);
+  BOOST_CHECK_EQUAL(poll.poll([] { return false; }),false);
+}
+
+BOOST_AUTO_TEST_CASE( test_adaptive_poll2 )
+{
+  size_t count = 1000;
+  unsigned long short_ns = 20000;    // 20us
+  unsigned long long_ns = 2000000;   // 2ms
+
+  std::cout << "Launch-to-notify latency over " << count << " commands\n";
+
+  report("short blocking",measure(nullptr,short_ns,count));
+  xrt_core::adaptive_poll short_poll(50);
+  report("short hybrid  ",measure(&short_poll,short_ns,count));
+
+  report("long blocking ",measure(nullptr,long_ns,count/10));
+  xrt_core::adaptive_poll long_poll(50);
+  report("long hybrid   ",measure(&long_poll,long_ns,count/10));
+  BOOST_CHECK_EQUAL(long_poll.window(),0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,277 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+////////////////////////////////////////////////////////////////
+// Unit testing and benchmark of xrt_core::mpsc_queue and
+// xrt_core::async_log
+//
+// The benchmark logs from several threads into a file, once with a
+// mutex protected stream flushed per record as the synchronous file
+// logger does, and once through async_log.
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+
+#include "core/common/async_log.h"
+#include "xrt/util/time.h"
+
+#include <vector>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <cstdio>
+#include <unistd.h>
+
+namespace {
+
+static std::string
+record(unsigned int thread, unsigned int idx)
+{
+  return "[XRT] Tid: " + std::to_string(thread) + ", DEBUG: message " + std::to_string(idx) + "\n";
+}
+
+// Check that each thread's records appear complete and in order
+static void
+check_log(const std::string& log, unsigned int threads, unsigned int count)
+{
+  std::vector<unsigned int> next(threads,0);
+  std::istringstream istr(log);
+  std::string line;
+  while (std::getline(istr,line)) {
+    if (line.find("log records dropped") != std::string::npos)
+      continue;
+    unsigned int thread = 0, idx = 0;
+    BOOST_REQUIRE_EQUAL(std::sscanf(line.c_str(),"[XRT] Tid: %u, DEBUG: message %u",&thread,&idx),2);
+    BOOST_REQUIRE(thread < threads);
+    BOOST_CHECK(idx >= next[thread]);
+    next[thread] = idx + 1;
+  }
+  for (auto n : next)
+    BOOST_CHECK(n <= count);
+}
+
+static std::string
+read_file(const std::string& file)
+{
+  std::ifstream istr(file);
+  std::stringstream sstr;
+  sstr << istr.rdbuf();
+  return sstr.str();
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE ( test_async_log )
+
+BOOST_AUTO_TEST_CASE( test_mpsc_queue )
+{
+  xrt_core::mpsc_queue<std::string> queue(3);
+  BOOST_CHECK_EQUAL(queue.capacity(),4);
+  BOOST_CHECK(queue.empty());
+
+  for (int i=0; i<4; ++i) {
+    std::string value = std::to_string(i);
+    BOOST_CHECK(queue.push(std::move(value)));
+  }
+  std::string full = "full";
+  BOOST_CHECK(!queue.push(std::move(full)));
+  BOOST_CHECK_EQUAL(full,"full");
+
+  std::string value;
+  for (int i=0; i<4; ++i) {
+    BOOST_CHECK(queue.pop(value));
+    BOOST_CHECK_EQUAL(value,std::to_string(i));
+  }
+  BOOST_CHECK(!queue.pop(value));
+  BOOST_CHECK(queue.empty());
+
+  // Many producers, every value arrives once and in per producer order
+  const unsigned int producers = 4;
+  const unsigned int count = 100000;
+  xrt_core::mpsc_queue<unsigned int> mq(64);
+  std::vector<std::thread> threads;
+  for (unsigned int p=0; p<producers; ++p)
+    threads.emplace_back([&mq,p] {
+      for (unsigned int i=0; i<count; ++i) {
+        unsigned int v = (p<<24) | i;
+        while (!mq.push(std::move(v)))
+          std::this_thread::yield();
+      }
+    });
+
+  std::vector<unsigned int> next(producers,0);
+  for (unsigned int received=0; received<producers*count; ) {
+    unsigned int v;
+    if (!mq.pop(v))
+      continue;
+    ++received;
+    auto p = v >> 24;
+    BOOST_REQUIRE(p < producers);
+    BOOST_REQUIRE_EQUAL(v & 0xffffff,next[p]);
+    ++next[p];
+  }
+  for (auto& t : threads)
+    t.join();
+  BOOST_CHECK(mq.empty());
+}
+
+BOOST_AUTO_TEST_CASE( test_async_log1 )
+{
+  // All records are written when the queue keeps up
+  {
+    std::ostringstream ostr;
+    {
+      xrt_core::async_log log(ostr,1024,10);
+      for (unsigned int i=0; i<1000; ++i)
+        BOOST_CHECK(log.write(record(0,i)));
+    }
+    std::string expect;
+    for (unsigned int i=0; i<1000; ++i)
+      expect += record(0,i);
+    BOOST_CHECK(ostr.str() == expect);
+  }
+
+  // Urgent records are flushed without waiting for the flush interval
+  {
+    char name[] = "/tmp/tasync_log.XXXXXX";
+    int fd = mkstemp(name);
+    close(fd);
+    std::ofstream ostr(name);
+    xrt_core::async_log log(ostr,1024,60000);
+    log.write(record(0,0));
+    log.write(record(0,1),true);
+    std::string content;
+    for (int i=0; i<1000 && content.size()<2*record(0,0).size(); ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      content = read_file(name);
+    }
+    BOOST_CHECK_EQUAL(content,record(0,0)+record(0,1));
+
+    // After stop records are written synchronously
+    log.stop();
+    log.write(record(0,2));
+    BOOST_CHECK_EQUAL(read_file(name),record(0,0)+record(0,1)+record(0,2));
+    std::remove(name);
+  }
+
+  // A full queue drops and counts records, the count is logged
+  {
+    std::ostringstream ostr;
+    uint64_t dropped = 0;
+    {
+      xrt_core::async_log log(ostr,16,10);
+      std::vector<std::thread> threads;
+      for (unsigned int t=0; t<4; ++t)
+        threads.emplace_back([&log,t] {
+          for (unsigned int i=0; i<20000; ++i)
+            log.write(record(t,i));
+        });
+      for (auto& t : threads)
+        t.join();
+      log.stop();
+      dropped = log.dropped();
+    }
+    check_log(ostr.str(),4,20000);
+    uint64_t reported = 0;
+    size_t lines = 0;
+    std::istringstream istr(ostr.str());
+    std::string line;
+    while (std::getline(istr,line)) {
+      unsigned long n = 0;
+      if (std::sscanf(line.c_str(),"[XRT] %lu log records dropped",&n) == 1)
+        reported += n;
+      else
+        ++lines;
+    }
+    BOOST_CHECK_EQUAL(reported,dropped);
+    BOOST_CHECK_EQUAL(lines + dropped,4*20000);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_async_log2 )
+{
+  const unsigned int nthreads = 4;
+  const unsigned int count = 100000;
+  char name[] = "/tmp/tasync_log.XXXXXX";
+  int fd = mkstemp(name);
+  close(fd);
+
+  std::cout << "Logging " << count << " records from each of "
+            << nthreads << " threads\n";
+
+  // Synchronous, as file_dispatch: mutex and flush per record
+  unsigned long sync_time = 0;
+  {
+    std::ofstream ostr(name);
+    std::mutex mutex;
+    xrt::time_guard tg(sync_time);
+    std::vector<std::thread> threads;
+    for (unsigned int t=0; t<nthreads; ++t)
+      threads.emplace_back([&,t] {
+        for (unsigned int i=0; i<count; ++i) {
+          auto r = record(t,i);
+          std::lock_guard<std::mutex> lk(mutex);
+          ostr << r << std::flush;
+        }
+      });
+    for (auto& t : threads)
+      t.join();
+  }
+  check_log(read_file(name),nthreads,count);
+
+  auto total = nthreads*count;
+  std::cout << "sync flush per record: " << sync_time*1e-6 << " ms, "
+            << (total/(sync_time*1e-9))*1e-6 << " M records/s\n";
+
+  // Default queue size, which drops under this flood, and a queue
+  // large enough to hold all records
+  for (size_t queue_size : { size_t(8192), size_t(total) }) {
+    unsigned long async_time = 0;     // caller side
+    unsigned long drain_time = 0;     // until all records are written
+    uint64_t dropped = 0;
+    {
+      std::ofstream ostr(name);
+      xrt_core::async_log log(ostr,queue_size,100);
+      {
+        xrt::time_guard dg(drain_time);
+        {
+          xrt::time_guard tg(async_time);
+          std::vector<std::thread> threads;
+          for (unsigned int t=0; t<nthreads; ++t)
+            threads.emplace_back([&,t] {
+              for (unsigned int i=0; i<count; ++i)
+                log.write(record(t,i));
+            });
+          for (auto& t : threads)
+            t.join();
+        }
+        log.stop();
+      }
+      dropped = log.dropped();
+    }
+    check_log(read_file(name),nthreads,count);
+
+    std::cout << "async_log queue " << queue_size << ": callers "
+              << async_time*1e-6 << " ms, "
+              << (total/(async_time*1e-9))*1e-6 << " M records/s, drained "
+              << drain_time*1e-6 << " ms, " << dropped << " dropped\n";
+  }
+  std::remove(name);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,324 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+////////////////////////////////////////////////////////////////
+// Unit testing and benchmark of the xbmgmt installed firmware index
+//
+// Synthetic xsabin files are installed in a temporary firmware
+// directory and a temporary formatted firmware directory, then
+// scanned without index, with an empty index and with an up to
+// date index.
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+
+#include "core/pcie/tools/xbmgmt/firmware_image.h"
+#include "core/include/xclbin.h"
+#include "xrt/util/time.h"
+
+#include <boost/filesystem.hpp>
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <endian.h>
+#include <utime.h>
+
+namespace {
+
+static void
+push_cell(std::vector<char>& buf, uint32_t value)
+{
+  value = htobe32(value);
+  buf.insert(buf.end(),reinterpret_cast<char*>(&value),reinterpret_cast<char*>(&value)+4);
+}
+
+// Device tree blob with logic_uuid and interface_uuid properties
+static std::vector<char>
+make_dtb(const std::string& logic_uuid, const std::string& interface_uuid)
+{
+  const char strings[] = "logic_uuid\0interface_uuid";
+  std::vector<char> dt;
+  push_cell(dt,FDT_BEGIN_NODE);
+  push_cell(dt,0);  // root node, empty name
+  const std::string* values[] = { &logic_uuid, &interface_uuid };
+  uint32_t nameoff[] = { 0, 11 };
+  for (int i=0; i<2; ++i) {
+    push_cell(dt,FDT_PROP);
+    push_cell(dt,values[i]->size()+1);
+    push_cell(dt,nameoff[i]);
+    dt.insert(dt.end(),values[i]->begin(),values[i]->end());
+    dt.resize(ALIGN(dt.size()+1,4),0);
+  }
+  push_cell(dt,FDT_END_NODE);
+  push_cell(dt,FDT_END);
+
+  std::vector<char> blob(sizeof(fdt_header));
+  auto hdr = reinterpret_cast<fdt_header*>(blob.data());
+  hdr->magic = htobe32(0xd00dfeed);
+  hdr->version = htobe32(17);
+  hdr->off_dt_struct = htobe32(blob.size());
+  hdr->size_dt_struct = htobe32(dt.size());
+  hdr->off_dt_strings = htobe32(blob.size()+dt.size());
+  hdr->size_dt_strings = htobe32(sizeof(strings));
+  blob.insert(blob.end(),dt.begin(),dt.end());
+  blob.insert(blob.end(),strings,strings+sizeof(strings));
+  hdr = reinterpret_cast<fdt_header*>(blob.data());
+  hdr->totalsize = htobe32(blob.size());
+  return blob;
+}
+
+// xsabin with MCS and BMC sections, and a PARTITION_METADATA section if
+// dtb is not empty
+static void
+make_xsabin(const std::string& file, const std::string& vbnv, const std::string& bmc_version,
+            const std::vector<char>& dtb = std::vector<char>())
+{
+  const size_t mcs_size = 64*1024;
+  std::vector<axlf_section_kind> kinds = { MCS, BMC };
+  if (!dtb.empty())
+    kinds.push_back(PARTITION_METADATA);
+
+  size_t offset = sizeof(axlf) + (kinds.size()-1) * sizeof(axlf_section_header);
+  std::vector<char> header(offset,0);
+  auto top = reinterpret_cast<axlf*>(header.data());
+  std::strcpy(top->m_magic,"xclbin2");
+  std::strncpy(reinterpret_cast<char*>(top->m_header.m_platformVBNV),vbnv.c_str(),sizeof(top->m_header.m_platformVBNV)-1);
+  top->m_header.m_numSections = kinds.size();
+
+  struct bmc bmc = {};
+  std::strcpy(bmc.m_version,bmc_version.c_str());
+
+  std::vector<char> body;
+  for (size_t i=0; i<kinds.size(); ++i) {
+    auto& section = top->m_sections[i];
+    section.m_sectionKind = kinds[i];
+    section.m_sectionOffset = offset + body.size();
+    if (kinds[i] == MCS)
+      body.resize(body.size() + mcs_size,'m');
+    else if (kinds[i] == BMC)
+      body.insert(body.end(),reinterpret_cast<char*>(&bmc),reinterpret_cast<char*>(&bmc)+sizeof(bmc));
+    else
+      body.insert(body.end(),dtb.begin(),dtb.end());
+    section.m_sectionSize = offset + body.size() - section.m_sectionOffset;
+  }
+  top->m_header.m_length = offset + body.size();
+
+  std::ofstream ostr(file,std::ios::binary);
+  ostr.write(header.data(),header.size());
+  ostr.write(body.data(),body.size());
+}
+
+static std::string
+hex(unsigned value, int width)
+{
+  char buf[32];
+  std::snprintf(buf,sizeof(buf),"%0*x",width,value);
+  return buf;
+}
+
+struct firmware_dirs
+{
+  std::string root;
+  std::string fw;
+  std::string formatted;
+  std::string index;
+
+  firmware_dirs()
+  {
+    char tmpl[] = "/tmp/tfirmware_index.XXXXXX";
+    root = mkdtemp(tmpl);
+    fw = root + "/xilinx/";
+    formatted = root + "/firmware";
+    index = root + "/cache/firmware_index.json";
+    boost::filesystem::create_directories(fw);
+    boost::filesystem::create_directories(formatted);
+  }
+
+  ~firmware_dirs()
+  {
+    boost::filesystem::remove_all(root);
+  }
+
+  // Legacy shell in flat firmware directory, identified by timestamp
+  std::string
+  install_flat(unsigned i, const std::string& bmc_version = "4.2.0")
+  {
+    auto file = fw + "10ee-5000-000e-" + hex(0x5c000000+i,16) + ".xsabin";
+    make_xsabin(file,"xilinx:u200:xdma:201830." + std::to_string(i),bmc_version);
+    return file;
+  }
+
+  // Shell in formatted firmware directory, identified by uuids in dtb
+  std::string
+  install_formatted(unsigned i)
+  {
+    auto dir = formatted + "/10ee-5005-000e/xilinx_u250_gen3x16/base_" + std::to_string(i) + "/" + hex(i,8);
+    boost::filesystem::create_directories(dir);
+    auto file = dir + "/" + hex(0xabcd0000+i,8) + ".xsabin";
+    auto uuid = hex(i,8) + "0123456789abcdef0123456789abcdef";
+    make_xsabin(file,"xilinx:u250:gen3x16:base." + std::to_string(i),"",make_dtb(uuid,uuid.substr(8)));
+    return file;
+  }
+};
+
+static void
+check_equal(std::vector<DSAInfo> lhs, std::vector<DSAInfo> rhs)
+{
+  auto by_file = [](const DSAInfo& a, const DSAInfo& b) { return a.file < b.file; };
+  std::sort(lhs.begin(),lhs.end(),by_file);
+  std::sort(rhs.begin(),rhs.end(),by_file);
+  BOOST_REQUIRE_EQUAL(lhs.size(),rhs.size());
+  for (size_t i=0; i<lhs.size(); ++i) {
+    auto& a = lhs[i];
+    auto& b = rhs[i];
+    BOOST_CHECK_EQUAL(a.file,b.file);
+    BOOST_CHECK_EQUAL(a.hasFlashImage,b.hasFlashImage);
+    BOOST_CHECK_EQUAL(a.vendor,b.vendor);
+    BOOST_CHECK_EQUAL(a.board,b.board);
+    BOOST_CHECK_EQUAL(a.name,b.name);
+    BOOST_CHECK_EQUAL(a.timestamp,b.timestamp);
+    BOOST_CHECK(a.uuids==b.uuids);
+    BOOST_CHECK_EQUAL(a.bmcVer,b.bmcVer);
+    BOOST_CHECK_EQUAL(a.vendor_id,b.vendor_id);
+    BOOST_CHECK_EQUAL(a.device_id,b.device_id);
+    BOOST_CHECK_EQUAL(a.subsystem_id,b.subsystem_id);
+    BOOST_CHECK_EQUAL(a.partition_family_name,b.partition_family_name);
+    BOOST_CHECK_EQUAL(a.partition_name,b.partition_name);
+    BOOST_CHECK_EQUAL(a.build_ident,b.build_ident);
+  }
+}
+
+static const DSAInfo*
+find_file(const std::vector<DSAInfo>& dsas, const std::string& file)
+{
+  for (auto& dsa : dsas)
+    if (dsa.file == file)
+      return &dsa;
+  return nullptr;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE ( test_firmware_index )
+
+BOOST_AUTO_TEST_CASE( test_firmware_index1 )
+{
+  firmware_dirs dirs;
+  std::vector<std::string> flat;
+  for (unsigned i=0; i<4; ++i) {
+    flat.push_back(dirs.install_flat(i));
+    dirs.install_formatted(i);
+  }
+
+  auto scanned = firmwareImage::scanInstalledDSAs(dirs.fw,dirs.formatted,"");
+  BOOST_REQUIRE_EQUAL(scanned.size(),8);
+  auto dsa = find_file(scanned,flat[1]);
+  BOOST_REQUIRE(dsa);
+  BOOST_CHECK_EQUAL(dsa->timestamp,0x5c000001);
+  BOOST_CHECK_EQUAL(dsa->bmcVer,"4.2.0");
+  BOOST_CHECK(dsa->hasFlashImage);
+
+  // Building the index and reading it back gives the same DSA info
+  BOOST_CHECK(!boost::filesystem::exists(dirs.index));
+  check_equal(firmwareImage::scanInstalledDSAs(dirs.fw,dirs.formatted,dirs.index),scanned);
+  BOOST_CHECK(boost::filesystem::exists(dirs.index));
+  auto indexed = firmwareImage::scanInstalledDSAs(dirs.fw,dirs.formatted,dirs.index);
+  check_equal(indexed,scanned);
+  bool found_uuid = false;
+  for (auto& d : indexed)
+    found_uuid |= (d.uuids.size()==2 && d.partition_name=="base_2" && d.timestamp==0x0000000201234567);
+  BOOST_CHECK(found_uuid);
+
+  // Unchanged index is not rewritten
+  auto mtime = boost::filesystem::last_write_time(dirs.index);
+  auto size = boost::filesystem::file_size(dirs.index);
+  boost::filesystem::last_write_time(dirs.index,mtime-10);
+  firmwareImage::scanInstalledDSAs(dirs.fw,dirs.formatted,dirs.index);
+  BOOST_CHECK_EQUAL(boost::filesystem::last_write_time(dirs.index),mtime-10);
+
+  // Changed file is parsed again, even with the same size
+  dirs.install_flat(1,"4.2.1");
+  struct utimbuf times = { 1000, 1000 };
+  utime(flat[1].c_str(),&times);
+  indexed = firmwareImage::scanInstalledDSAs(dirs.fw,dirs.formatted,dirs.index);
+  dsa = find_file(indexed,flat[1]);
+  BOOST_REQUIRE(dsa);
+  BOOST_CHECK_EQUAL(dsa->bmcVer,"4.2.1");
+
+  // Removed and added files
+  boost::filesystem::remove(flat[2]);
+  auto added = dirs.install_formatted(9);
+  indexed = firmwareImage::scanInstalledDSAs(dirs.fw,dirs.formatted,dirs.index);
+  check_equal(indexed,firmwareImage::scanInstalledDSAs(dirs.fw,dirs.formatted,""));
+  BOOST_CHECK(find_file(indexed,flat[2])==nullptr);
+  BOOST_CHECK(find_file(indexed,added)!=nullptr);
+  BOOST_CHECK(boost::filesystem::file_size(dirs.index) != size);
+
+  // Corrupt index is rebuilt
+  std::ofstream(dirs.index) << "{ not json";
+  check_equal(firmwareImage::scanInstalledDSAs(dirs.fw,dirs.formatted,dirs.index),indexed);
+  check_equal(firmwareImage::scanInstalledDSAs(dirs.fw,dirs.formatted,dirs.index),indexed);
+}
+
+BOOST_AUTO_TEST_CASE( test_firmware_index2 )
+{
+  firmware_dirs dirs;
+  const unsigned count = 50;
+  for (unsigned i=0; i<count; ++i) {
+    dirs.install_flat(i);
+    dirs.install_formatted(i);
+  }
+  std::cout << "Scanning " << 2*count << " installed shells\n";
+
+  unsigned long scan_time = 0;
+  {
+    xrt::time_guard tg(scan_time);
+    BOOST_CHECK_EQUAL(firmwareImage::scanInstalledDSAs(dirs.fw,dirs.formatted,"").size(),2*count);
+  }
+
+  unsigned long build_time = 0;
+  {
+    xrt::time_guard tg(build_time);
+    BOOST_CHECK_EQUAL(firmwareImage::scanInstalledDSAs(dirs.fw,dirs.formatted,dirs.index).size(),2*count);
+  }
+
+  // Drop page cache of the shells is not possible without privileges,
+  // so this compares warm scans; the index saves one open and several
+  // reads per shell
+  const int iterations = 10;
+  unsigned long no_index_time = 0;
+  unsigned long index_time = 0;
+  for (int i=0; i<iterations; ++i) {
+    {
+      xrt::time_guard tg(no_index_time);
+      firmwareImage::scanInstalledDSAs(dirs.fw,dirs.formatted,"");
+    }
+    {
+      xrt::time_guard tg(index_time);
+      firmwareImage::scanInstalledDSAs(dirs.fw,dirs.formatted,dirs.index);
+    }
+  }
+
+  std::cout << "first scan without index: " << scan_time*1e-6 << " ms\n"
+            << "scan building index:      " << build_time*1e-6 << " ms\n"
+            << "scan without index:       " << no_index_time*1e-6/iterations << " ms\n"
+            << "scan with index:          " << index_time*1e-6/iterations << " ms\n";
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,171 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+////////////////////////////////////////////////////////////////
+// Unit testing and benchmark of xbmgmt MCS flash image decoding
+//
+// A synthetic MCS file is generated and decoded, once with the
+// getline/stoi per record and per byte parsing previously used by
+// the flashers, and once with mcsImage.
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+
+#include "core/pcie/tools/xbmgmt/mcs_image.h"
+#include "xrt/util/time.h"
+
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+
+namespace {
+
+static void
+add_record(std::ostream& ostr, unsigned type, unsigned address, const unsigned char* data, unsigned len)
+{
+  unsigned char sum = len + (address >> 8) + address + type;
+  ostr << ':' << std::hex << std::uppercase << std::setfill('0')
+       << std::setw(2) << len << std::setw(4) << (address & 0xffff) << std::setw(2) << type;
+  for (unsigned i=0; i<len; ++i) {
+    ostr << std::setw(2) << unsigned(data[i]);
+    sum += data[i];
+  }
+  ostr << std::setw(2) << unsigned(static_cast<unsigned char>(-sum)) << "\r\n";
+}
+
+// MCS with size bytes of data starting at flash address start
+static std::string
+make_mcs(unsigned start, size_t size)
+{
+  std::ostringstream ostr;
+  for (size_t offset=0; offset<size; ) {
+    unsigned address = start + offset;
+    unsigned char ela[2] = { static_cast<unsigned char>(address >> 24), static_cast<unsigned char>(address >> 16) };
+    add_record(ostr,0x04,0,ela,2);
+    do {
+      unsigned char data[16];
+      unsigned len = std::min<size_t>(16,size-offset);
+      for (unsigned i=0; i<len; ++i)
+        data[i] = static_cast<unsigned char>((offset+i) * 13);
+      add_record(ostr,0x00,start+offset,data,len);
+      offset += len;
+    } while (offset<size && ((start+offset) & 0xffff));
+  }
+  add_record(ostr,0x01,0,nullptr,0);
+  return ostr.str();
+}
+
+// Previous parsing, getline and stoi per record and per data byte
+static size_t
+legacy_parse(std::istream& mcsStream, std::vector<unsigned char>& image)
+{
+  size_t records = 0;
+  std::string line;
+  while (std::getline(mcsStream,line)) {
+    if (line.empty())
+      continue;
+    const unsigned dataLen = std::stoi(line.substr(1, 2), 0 , 16);
+    const unsigned recordType = std::stoi(line.substr(7, 2), 0 , 16);
+    if (recordType == 0x04)
+      ++records;
+    if (recordType == 0x01)
+      break;
+    if (recordType != 0x00)
+      continue;
+    const std::string data = line.substr(9, dataLen * 2);
+    for (unsigned i = 0; i < data.length(); i += 2)
+      image.push_back(std::stoi(data.substr(i, 2), 0, 16));
+  }
+  return records;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE ( test_mcs_image )
+
+BOOST_AUTO_TEST_CASE( test_mcs_image1 )
+{
+  // two extents, the first one starting mid 64K segment
+  std::string mcs = make_mcs(0x01000100, 0x10000) + "\n";
+  std::istringstream istr(mcs);
+  mcsImage image;
+  BOOST_CHECK_EQUAL(image.parse(istr),0);
+  BOOST_REQUIRE_EQUAL(image.extents().size(),2);
+  BOOST_CHECK_EQUAL(image.size(),0x10000);
+  auto& ext0 = image.extents()[0];
+  auto& ext1 = image.extents()[1];
+  BOOST_CHECK_EQUAL(ext0.startAddress,0x01000100);
+  BOOST_CHECK_EQUAL(ext0.size,0xff00);
+  BOOST_CHECK_EQUAL(ext1.startAddress,0x01010000);
+  BOOST_CHECK_EQUAL(ext1.size,0x100);
+  BOOST_CHECK_EQUAL(image.data(ext0)[3],static_cast<unsigned char>(3*13));
+  BOOST_CHECK_EQUAL(image.data(ext1)[0],static_cast<unsigned char>(0xff00*13));
+
+  // flat image
+  std::istringstream istr2(make_mcs(0x20, 40));
+  BOOST_CHECK_EQUAL(image.parse(istr2),0);
+  auto flat = image.flatten();
+  BOOST_CHECK_EQUAL(flat.size(),0x20+40);
+  BOOST_CHECK_EQUAL(static_cast<unsigned char>(flat[0]),0xff);
+  BOOST_CHECK_EQUAL(static_cast<unsigned char>(flat[0x21]),13);
+
+  // bad checksum
+  std::string bad = make_mcs(0, 64);
+  bad[bad.find("\r\n:10")+14] ^= 1;
+  std::istringstream istr3(bad);
+  BOOST_CHECK_EQUAL(image.parse(istr3),-EINVAL);
+  BOOST_CHECK_EQUAL(image.extents().size(),0);
+
+  // missing end of file record
+  std::string truncated = make_mcs(0, 64);
+  truncated.resize(truncated.rfind(':'));
+  std::istringstream istr4(truncated);
+  BOOST_CHECK_EQUAL(image.parse(istr4),-EINVAL);
+}
+
+BOOST_AUTO_TEST_CASE( test_mcs_image2 )
+{
+  size_t size = 32*1024*1024;
+  auto mcs = make_mcs(0x01002000, size);
+  std::cout << "Decoding " << (size>>20) << " MB flash image from "
+            << (mcs.size()>>20) << " MB MCS\n";
+
+  unsigned long legacy_time = 0;
+  std::vector<unsigned char> legacy;
+  {
+    std::istringstream istr(mcs);
+    xrt::time_guard tg(legacy_time);
+    legacy_parse(istr,legacy);
+  }
+
+  unsigned long time = 0;
+  mcsImage image;
+  {
+    std::istringstream istr(mcs);
+    xrt::time_guard tg(time);
+    BOOST_CHECK_EQUAL(image.parse(istr),0);
+  }
+
+  BOOST_CHECK_EQUAL(image.size(),legacy.size());
+  BOOST_CHECK_EQUAL(image.extents().size(),(size>>16)+1);
+  BOOST_CHECK(std::equal(legacy.begin(),legacy.end(),image.data(image.extents().front())));
+
+  std::cout << "getline/stoi: " << legacy_time*1e-6 << " ms\n"
+            << "mcsImage:     " << time*1e-6 << " ms\n";
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,203 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+////////////////////////////////////////////////////////////////
+// Unit testing of mpd serving a board through plugin hooks
+//
+// The in-tree plugins (aws, azure, container) hand out no msd
+// socket, get_remote_msd_fd returns 0 with fd -1, and handle the
+// mailbox msgs themselves.  mpd is built in with a stub plugin and
+// run against a fake pcie tree, where the mailbox node of the board
+// is a raw pty.  The test plays the mailbox driver on the master end.
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+
+#include "fake_pcie_tree.h"
+
+// mpd keeps its plugin hooks and quit flag in statics
+#define main mpd_main
+#include "core/pcie/tools/cloud-daemon/mpd.cpp"
+#undef main
+
+#include <termios.h>
+#include <poll.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace {
+
+static std::atomic<int> loads(0);
+
+static int
+no_msd_fd(size_t, int& fd)
+{
+  fd = -1;
+  return 0;
+}
+
+static int
+failed_msd_fd(size_t, int& fd)
+{
+  fd = -1;
+  return -ENODEV;
+}
+
+static int
+load_xclbin(size_t, const axlf*&)
+{
+  ++loads;
+  return 0;
+}
+
+// Raw pty standing in for the mailbox node of board 0
+struct fake_mailbox
+{
+  int master = -1;
+  int slave_fd = -1;
+
+  explicit
+  fake_mailbox(const xrt::test::fake_pcie_tree& tree)
+  {
+    master = posix_openpt(O_RDWR | O_NOCTTY);
+    BOOST_REQUIRE(master >= 0);
+    BOOST_REQUIRE(grantpt(master) == 0 && unlockpt(master) == 0);
+    std::string slave = ptsname(master);
+
+    // Keep the slave open, master hangs up while no one has it open
+    slave_fd = open(slave.c_str(), O_RDWR | O_NOCTTY);
+    BOOST_REQUIRE(slave_fd >= 0);
+    termios tio;
+    tcgetattr(slave_fd, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(slave_fd, TCSANOW, &tio);
+
+    // User PF of board 0 is 0000:17:00.1
+    auto node = tree.devfs_root() + "/xfpga/mailbox.u" + std::to_string((0x17 << 8) + 1);
+    BOOST_REQUIRE(symlink(slave.c_str(), node.c_str()) == 0);
+  }
+
+  ~fake_mailbox()
+  {
+    close(slave_fd);
+    close(master);
+  }
+
+  // Next msg written by mpd, null if none within secs
+  std::unique_ptr<sw_msg>
+  receive(int secs)
+  {
+    pollfd pfd = { master, POLLIN, 0 };
+    if (poll(&pfd, 1, secs * 1000) != 1)
+      return nullptr;
+    auto buf = std::make_unique<std::vector<char>>(64 * 1024);
+    ssize_t ret = read(master, buf->data(), buf->size());
+    if (ret <= 0)
+      return nullptr;
+    buf->resize(ret);
+    auto msg = std::make_unique<sw_msg>(std::move(buf));
+    return msg->valid() ? std::move(msg) : nullptr;
+  }
+
+  void
+  send(sw_msg& msg)
+  {
+    BOOST_REQUIRE(write(master, msg.data(), msg.size()) == ssize_t(msg.size()));
+  }
+};
+
+static bool
+is_state(sw_msg& msg, uint64_t flag)
+{
+  auto req = reinterpret_cast<mailbox_req*>(msg.payloadData());
+  auto state = reinterpret_cast<mailbox_peer_state*>(req->data);
+  return msg.payloadSize() == sizeof(mailbox_req) + sizeof(mailbox_peer_state) &&
+    req->req == MAILBOX_REQ_MGMT_STATE && (state->state_flags & flag);
+}
+
+struct mpd_fixture
+{
+  xrt::test::fake_pcie_tree tree;
+  xrt::test::roots_guard guard;
+  fake_mailbox mailbox;
+
+  mpd_fixture()
+    : tree(1), guard(tree), mailbox(tree)
+  {
+    plugin_cbs = mpd_plugin_callbacks();
+    quit = false;
+    loads = 0;
+  }
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE ( test_mpd_plugin )
+
+BOOST_AUTO_TEST_CASE( test_plugin_no_msd_fd )
+{
+  mpd_fixture fx;
+  plugin_cbs.get_remote_msd_fd = no_msd_fd;
+  plugin_cbs.load_xclbin = load_xclbin;
+
+  Mpd mpd("mpd", plugin_path);
+  std::thread daemon([&mpd] { mpd.run(); });
+
+  // Board comes online with no msd socket
+  auto online = fx.mailbox.receive(5);
+  BOOST_REQUIRE(online);
+  BOOST_CHECK(is_state(*online, MB_STATE_ONLINE));
+
+  // Download is served by the plugin hook
+  std::vector<char> buf(sizeof(mailbox_req) + sizeof(axlf), 0);
+  auto req = reinterpret_cast<mailbox_req*>(buf.data());
+  req->req = MAILBOX_REQ_LOAD_XCLBIN;
+  sw_msg request(buf.data(), buf.size(), 0x42, MB_REQ_FLAG_REQUEST);
+  fx.mailbox.send(request);
+
+  auto resp = fx.mailbox.receive(5);
+  BOOST_REQUIRE(resp);
+  BOOST_CHECK_EQUAL(resp->id(), 0x42);
+  BOOST_REQUIRE_EQUAL(resp->payloadSize(), sizeof(int));
+  BOOST_CHECK_EQUAL(*reinterpret_cast<int*>(resp->payloadData()), 0);
+  BOOST_CHECK_EQUAL(loads, 1);
+
+  // Board goes offline on quit
+  quit = true;
+  daemon.join();
+  mpd.stop();
+  auto offline = fx.mailbox.receive(5);
+  BOOST_REQUIRE(offline);
+  BOOST_CHECK(is_state(*offline, MB_STATE_OFFLINE));
+}
+
+BOOST_AUTO_TEST_CASE( test_plugin_failed )
+{
+  mpd_fixture fx;
+  plugin_cbs.get_remote_msd_fd = failed_msd_fd;
+  plugin_cbs.load_xclbin = load_xclbin;
+
+  // Quits with the board never brought online
+  Mpd mpd("mpd", plugin_path);
+  mpd.run();
+  mpd.stop();
+  BOOST_CHECK(quit);
+  BOOST_CHECK(!fx.mailbox.receive(1));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
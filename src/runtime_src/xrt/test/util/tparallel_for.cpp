@@ -0,0 +1,129 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+////////////////////////////////////////////////////////////////
+// Unit testing of xrt::task::parallel_for and startup benchmark
+//
+// Stand-in cards only sleep for a fixed time when opened and when a
+// program is loaded, in place of device open and xclbin download.
+// Startup time is compared between loading the cards serially and
+// concurrently, which measures the scheduling of parallel_for and
+// the serialized part of load, not real or emulation devices.
+// Emulation devices are always loaded serially, see
+// clCreateProgramWithBinary.
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+
+#include "xrt/util/task.h"
+#include "xrt/util/time.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <stdexcept>
+#include <iostream>
+
+namespace {
+
+struct standin_card
+{
+  static std::mutex global_mutex;  // process wide state, e.g. plugins
+  bool open = false;
+  bool loaded = false;
+
+  void
+  do_open()
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    open = true;
+  }
+
+  void
+  do_load()
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    std::lock_guard<std::mutex> lk(global_mutex);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    loaded = true;
+  }
+};
+
+std::mutex standin_card::global_mutex;
+
+static unsigned long
+startup(size_t cards, unsigned int threads)
+{
+  std::vector<standin_card> devices(cards);
+  unsigned long time = 0;
+  {
+    xrt::time_guard tg(time);
+    xrt::task::parallel_for(cards,threads,[&devices](size_t idx) { devices[idx].do_open(); });
+    xrt::task::parallel_for(cards,threads,[&devices](size_t idx) { devices[idx].do_load(); });
+  }
+  for (auto& device : devices)
+    BOOST_CHECK(device.open && device.loaded);
+  return time;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE ( test_parallel_for )
+
+BOOST_AUTO_TEST_CASE( test_parallel_for1 )
+{
+  // every index visited exactly once
+  std::vector<std::atomic<int>> visits(100);
+  for (auto& v : visits)
+    v = 0;
+  xrt::task::parallel_for(visits.size(),4,[&visits](size_t idx) { ++visits[idx]; });
+  for (auto& v : visits)
+    BOOST_CHECK_EQUAL(v.load(),1);
+
+  // zero threads and zero count are fine
+  int calls = 0;
+  xrt::task::parallel_for(3,0,[&calls](size_t) { ++calls; });
+  BOOST_CHECK_EQUAL(calls,3);
+  xrt::task::parallel_for(0,4,[&calls](size_t) { ++calls; });
+  BOOST_CHECK_EQUAL(calls,3);
+
+  // all calls complete and lowest failing index is reported
+  std::atomic<int> completed {0};
+  try {
+    xrt::task::parallel_for(8,4,[&completed](size_t idx) {
+        ++completed;
+        if (idx==5 || idx==2)
+          throw std::runtime_error(std::to_string(idx));
+      });
+    BOOST_CHECK(false);
+  }
+  catch (const std::runtime_error& ex) {
+    BOOST_CHECK_EQUAL(ex.what(),std::string("2"));
+  }
+  BOOST_CHECK_EQUAL(completed.load(),8);
+}
+
+BOOST_AUTO_TEST_CASE( test_parallel_for2 )
+{
+  size_t cards = 8;
+  std::cout << "Startup of " << cards << " stand-in cards\n";
+  for (unsigned int threads : {1,2,8}) {
+    auto time = startup(cards,threads);
+    std::cout << "threads(" << threads << "): " << time*1e-6 << " ms\n";
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,349 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+////////////////////////////////////////////////////////////////
+// Unit testing and benchmark of the cloud daemon msg reactor
+//
+// Socketpairs stand in for the mailbox and the peer daemon of each
+// board.  A SOCK_SEQPACKET pair hands out one whole msg per read as
+// the mailbox driver does, a SOCK_STREAM pair is the socket to the
+// peer.  The reactor forwards msgs between them as mpd does, while
+// round trip latency and one way throughput are measured for
+// increasing numbers of boards.
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+
+#include "fake_pcie_tree.h"
+#include "core/pcie/linux/scan.h"
+#include "core/pcie/tools/cloud-daemon/reactor.h"
+#include "xrt/util/time.h"
+
+#include <sys/socket.h>
+#include <syslog.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <numeric>
+#include <iostream>
+#include <thread>
+#include <memory>
+
+namespace {
+
+// Fds of one board, [0] is served by the reactor, [1] by the test
+struct board
+{
+  int mbx[2];
+  int sock[2];
+  pcieFunc dev;
+
+  board(size_t index)
+    : dev(index)
+  {
+    BOOST_REQUIRE(socketpair(AF_UNIX,SOCK_SEQPACKET,0,mbx)==0);
+    BOOST_REQUIRE(socketpair(AF_UNIX,SOCK_STREAM,0,sock)==0);
+    fcntl(sock[0],F_SETFL,fcntl(sock[0],F_GETFL) | O_NONBLOCK);
+  }
+
+  ~board()
+  {
+    for (int fd : { mbx[0], mbx[1], sock[0], sock[1] })
+      if (fd>=0)
+        close(fd);
+  }
+};
+
+static std::vector<char>
+make_payload(size_t size, char seed)
+{
+  std::vector<char> payload(size);
+  for (size_t i=0; i<size; ++i)
+    payload[i] = static_cast<char>(seed + i*13);
+  return payload;
+}
+
+// Mailbox driver side, one msg per write
+static void
+mbx_send(int fd, const std::vector<char>& payload, uint64_t id)
+{
+  sw_msg msg(payload.data(),payload.size(),id,0);
+  BOOST_REQUIRE_EQUAL(write(fd,msg.data(),msg.size()),static_cast<ssize_t>(msg.size()));
+}
+
+static std::vector<char>
+mbx_recv(int fd, uint64_t& id)
+{
+  std::vector<char> buf(256*1024);
+  auto ret = read(fd,buf.data(),buf.size());
+  BOOST_REQUIRE(ret>=static_cast<ssize_t>(sizeof(sw_chan)));
+  auto sc = reinterpret_cast<sw_chan*>(buf.data());
+  BOOST_REQUIRE_EQUAL(sizeof(sw_chan)+sc->sz,static_cast<size_t>(ret));
+  id = sc->id;
+  return std::vector<char>(sc->data,sc->data+sc->sz);
+}
+
+// Peer side, a stream of framed msgs
+static void
+sock_send(int fd, const std::vector<char>& payload, uint64_t id)
+{
+  sw_msg msg(payload.data(),payload.size(),id,0);
+  size_t cur = 0;
+  while (cur<msg.size()) {
+    auto ret = write(fd,msg.data()+cur,msg.size()-cur);
+    BOOST_REQUIRE(ret>0);
+    cur += ret;
+  }
+}
+
+static void
+read_all(int fd, char* buf, size_t size)
+{
+  size_t cur = 0;
+  while (cur<size) {
+    auto ret = read(fd,buf+cur,size-cur);
+    BOOST_REQUIRE(ret>0);
+    cur += ret;
+  }
+}
+
+static std::vector<char>
+sock_recv(int fd, uint64_t& id)
+{
+  std::vector<char> hdr(sizeof(sw_chan));
+  read_all(fd,hdr.data(),hdr.size());
+  auto sc = reinterpret_cast<sw_chan*>(hdr.data());
+  id = sc->id;
+  std::vector<char> buf(sizeof(sw_chan)+sc->sz);
+  std::memcpy(buf.data(),hdr.data(),hdr.size());
+  read_all(fd,buf.data()+hdr.size(),sc->sz);
+  auto data = reinterpret_cast<sw_chan*>(buf.data())->data;
+  return std::vector<char>(data,data+sc->sz);
+}
+
+// Reply to a peer request with the sum of its payload
+static int
+sum_handler(const pcieFunc&, std::unique_ptr<sw_msg>& orig, std::unique_ptr<sw_msg>& processed)
+{
+  auto data = orig->payloadData();
+  uint64_t sum = std::accumulate(data,data+orig->payloadSize(),uint64_t(0),
+                                 [](uint64_t s, char c) { return s + static_cast<unsigned char>(c); });
+  processed = std::make_unique<sw_msg>(&sum,sizeof(sum),orig->id(),0);
+  return FOR_REMOTE;
+}
+
+// Serve boards as mpd, with callback for peer msgs if any
+struct reactor_thread
+{
+  msgReactor reactor;
+  bool quit = false;
+  std::vector<int> errors;
+  std::thread thread;
+
+  reactor_thread(std::vector<std::unique_ptr<board>>& boards, msgHandler cb = nullptr)
+    : reactor(std::min<size_t>(boards.size(),4))
+  {
+    for (size_t i=0; i<boards.size(); ++i) {
+      auto& b = *boards[i];
+      msgRoute local = { LOCAL_MSG, b.mbx[0], b.sock[0], nullptr };
+      msgRoute remote = { REMOTE_MSG, b.mbx[0], b.sock[0], cb };
+      auto down = [this,&b](int err) {
+        errors.push_back(err);
+        reactor.removeFd(b.mbx[0]);
+        reactor.removeFd(b.sock[0]);
+      };
+      BOOST_REQUIRE_EQUAL(reactor.addMsgFd(i,b.dev,b.mbx[0],true,local,down),0);
+      BOOST_REQUIRE_EQUAL(reactor.addMsgFd(i,b.dev,b.sock[0],false,remote,down),0);
+    }
+    thread = std::thread([this] { reactor.run(quit,1); });
+  }
+
+  void
+  join()
+  {
+    if (!thread.joinable())
+      return;
+    reactor.defer([this] { reactor.stop(); });
+    thread.join();
+  }
+
+  ~reactor_thread()
+  {
+    join();
+  }
+};
+
+}
+
+BOOST_AUTO_TEST_SUITE ( test_reactor )
+
+BOOST_AUTO_TEST_CASE( test_reactor1 )
+{
+  setlogmask(LOG_UPTO(LOG_WARNING));
+  xrt::test::fake_pcie_tree tree(2);
+  xrt::test::roots_guard roots(tree);
+
+  std::vector<std::unique_ptr<board>> boards;
+  boards.emplace_back(std::make_unique<board>(0));
+  boards.emplace_back(std::make_unique<board>(1));
+
+  {
+    reactor_thread rt(boards);
+
+    // Mailbox msgs are passed on to peer in order, and back
+    uint64_t id = 0;
+    for (size_t sz : { 0, 1, 24, 4096, 60000 }) {
+      for (auto& b : boards) {
+        auto payload = make_payload(sz,static_cast<char>(sz));
+        mbx_send(b->mbx[1],payload,sz+1);
+        BOOST_CHECK(sock_recv(b->sock[1],id)==payload);
+        BOOST_CHECK_EQUAL(id,sz+1);
+
+        sock_send(b->sock[1],payload,sz+2);
+        BOOST_CHECK(mbx_recv(b->mbx[1],id)==payload);
+        BOOST_CHECK_EQUAL(id,sz+2);
+      }
+    }
+
+    // Peer msgs of any size make it to the mailbox
+    auto large = make_payload(200000,5);
+    sock_send(boards[0]->sock[1],large,3);
+    BOOST_CHECK(mbx_recv(boards[0]->mbx[1],id)==large);
+
+    // Several msgs queued at once keep their order
+    for (uint64_t i=0; i<100; ++i)
+      mbx_send(boards[0]->mbx[1],make_payload(i,0),i);
+    for (uint64_t i=0; i<100; ++i) {
+      BOOST_CHECK(sock_recv(boards[0]->sock[1],id)==make_payload(i,0));
+      BOOST_CHECK_EQUAL(id,i);
+    }
+
+    // Closed peer is reported once, other board keeps going
+    close(boards[1]->sock[1]);
+    boards[1]->sock[1] = -1;
+    mbx_send(boards[0]->mbx[1],make_payload(10,1),7);
+    BOOST_CHECK(sock_recv(boards[0]->sock[1],id)==make_payload(10,1));
+
+    rt.join();
+    BOOST_REQUIRE_EQUAL(rt.errors.size(),1);
+    BOOST_CHECK_EQUAL(rt.errors[0],-EPIPE);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_reactor2 )
+{
+  setlogmask(LOG_UPTO(LOG_WARNING));
+  xrt::test::fake_pcie_tree tree(1);
+  xrt::test::roots_guard roots(tree);
+
+  std::vector<std::unique_ptr<board>> boards;
+  boards.emplace_back(std::make_unique<board>(0));
+
+  reactor_thread rt(boards,sum_handler);
+
+  // Large peer msgs arrive over many reads and are handled by callback
+  for (size_t sz : { size_t(0), size_t(1000), size_t(4*1024*1024), size_t(64*1024*1024) }) {
+    auto payload = make_payload(sz,3);
+    uint64_t expect = 0;
+    for (auto c : payload)
+      expect += static_cast<unsigned char>(c);
+
+    std::thread sender([&] { sock_send(boards[0]->sock[1],payload,sz); });
+    uint64_t id = 0;
+    auto reply = sock_recv(boards[0]->sock[1],id);
+    sender.join();
+    BOOST_REQUIRE_EQUAL(reply.size(),sizeof(uint64_t));
+    uint64_t sum = 0;
+    std::memcpy(&sum,reply.data(),sizeof(sum));
+    BOOST_CHECK_EQUAL(sum,expect);
+    BOOST_CHECK_EQUAL(id,sz);
+  }
+
+}
+
+BOOST_AUTO_TEST_CASE( test_reactor3 )
+{
+  setlogmask(LOG_UPTO(LOG_WARNING));
+
+  for (size_t nboards : { 1, 8, 32 }) {
+    xrt::test::fake_pcie_tree tree(nboards);
+    xrt::test::roots_guard roots(tree);
+
+    std::vector<std::unique_ptr<board>> boards;
+    for (size_t i=0; i<nboards; ++i)
+      boards.emplace_back(std::make_unique<board>(i));
+
+    reactor_thread rt(boards);
+
+    // Round trip mailbox -> peer -> mailbox, all boards at once
+    const size_t loops = 2000;
+    auto request = make_payload(64,1);
+    unsigned long rtt_time = 0;
+    {
+      xrt::time_guard tg(rtt_time);
+      std::vector<std::thread> threads;
+      for (auto& b : boards) {
+        threads.emplace_back([&request,loops](board* b) {
+          uint64_t id = 0;
+          for (size_t i=0; i<loops; ++i) {
+            mbx_send(b->mbx[1],request,i);
+            auto req = sock_recv(b->sock[1],id);
+            sock_send(b->sock[1],req,id);
+            mbx_recv(b->mbx[1],id);
+          }
+        },b.get());
+      }
+      for (auto& t : threads)
+        t.join();
+    }
+
+    // One way mailbox -> peer stream of 4KB msgs
+    const size_t msgs = 5000;
+    auto data = make_payload(4096,2);
+    unsigned long stream_time = 0;
+    {
+      xrt::time_guard tg(stream_time);
+      std::vector<std::thread> threads;
+      for (auto& b : boards) {
+        threads.emplace_back([&data,msgs](board* b) {
+          std::thread reader([b,msgs] {
+            uint64_t id = 0;
+            for (size_t i=0; i<msgs; ++i)
+              sock_recv(b->sock[1],id);
+          });
+          for (size_t i=0; i<msgs; ++i)
+            mbx_send(b->mbx[1],data,i);
+          reader.join();
+        },b.get());
+      }
+      for (auto& t : threads)
+        t.join();
+    }
+
+    auto total_rtt = nboards*loops;
+    auto total_msgs = nboards*msgs;
+    std::cout << nboards << " boards: round trip " << rtt_time*1e-3/loops << " us, "
+              << total_rtt/(rtt_time*1e-9) << " round trips/s, "
+              << "stream " << total_msgs/(stream_time*1e-9) << " msgs/s, "
+              << (total_msgs*data.size())/(stream_time*1e-9)/(1024*1024) << " MB/s\n";
+
+    BOOST_CHECK(rt.errors.empty());
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
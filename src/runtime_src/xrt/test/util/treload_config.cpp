@@ -0,0 +1,259 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+////////////////////////////////////////////////////////////////
+// Unit testing of reloading xrt.ini at run time
+//
+// Settings are flipped by reload, file watching and SIGHUP while
+// worker threads keep reading them as the runtime does per
+// command and per log message.
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include "xrt/util/config_reader.h"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+// % sdaccel -exec truntime --run_test=test_reload_config
+
+namespace {
+
+std::string
+ini_path()
+{
+  return "/tmp/treload_config." + std::to_string(::getpid()) + ".ini";
+}
+
+// Replace the ini file in one step so a watcher never sees half of it
+void
+write_ini(const std::string& path, unsigned int verbosity, unsigned int throttle,
+          bool polling, unsigned int channels)
+{
+  auto tmp = path + ".tmp";
+  {
+    std::ofstream ostr(tmp);
+    ostr << "[Runtime]\n"
+         << "verbosity = " << verbosity << "\n"
+         << "polling_throttle = " << throttle << "\n"
+         << "ert_polling = " << (polling ? "true" : "false") << "\n"
+         << "dma_channels = " << channels << "\n"
+         << "[Emulation]\n"
+         << "launch_waveform = " << (polling ? "gui" : "batch") << "\n";
+  }
+  std::rename(tmp.c_str(),path.c_str());
+}
+
+template <typename Pred>
+bool
+wait_for(Pred pred, std::chrono::milliseconds timeout = std::chrono::milliseconds(5000))
+{
+  auto end = std::chrono::steady_clock::now() + timeout;
+  while (!pred()) {
+    if (std::chrono::steady_clock::now() > end)
+      return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  return true;
+}
+
+// Readers running while settings change.  Every read must be one of
+// the two settings written, and the new one is eventually seen.
+struct workload
+{
+  std::atomic<bool> stop {false};
+  std::atomic<unsigned int> bad {0};
+  std::atomic<unsigned int> seen_new {0};
+  std::vector<std::thread> threads;
+
+  workload(unsigned int nthreads, unsigned int old_verbosity, unsigned int new_verbosity,
+           unsigned int old_throttle, unsigned int new_throttle)
+  {
+    for (unsigned int t=0; t<nthreads; ++t) {
+      threads.emplace_back([=] {
+        bool noted = false;
+        while (!stop) {
+          auto verbosity = xrt::config::get_verbosity();
+          auto throttle = xrt::config::get_polling_throttle();
+          xrt::config::get_ert_polling();
+          xrt::config::get_dma_threads();
+          if ((verbosity != old_verbosity && verbosity != new_verbosity)
+              || (throttle != old_throttle && throttle != new_throttle))
+            ++bad;
+          if (!noted && verbosity == new_verbosity && throttle == new_throttle) {
+            noted = true;
+            ++seen_new;
+          }
+        }
+      });
+    }
+  }
+
+  ~workload()
+  {
+    stop = true;
+    for (auto& t : threads)
+      t.join();
+  }
+};
+
+}
+
+BOOST_AUTO_TEST_SUITE ( test_reload_config )
+
+BOOST_AUTO_TEST_CASE( test_reload )
+{
+  auto path = ini_path();
+  write_ini(path,2,10,false,1);
+  xrt::config::reload(path);
+  BOOST_CHECK_EQUAL(xrt::config::get_verbosity(),2);
+  BOOST_CHECK_EQUAL(xrt::config::get_polling_throttle(),10);
+  BOOST_CHECK_EQUAL(xrt::config::get_ert_polling(),false);
+  BOOST_CHECK_EQUAL(xrt::config::get_dma_threads(),1);
+
+  // Same content is not a reload
+  auto count = xrt::config::detail::get_reload_count();
+  BOOST_CHECK(!xrt::config::reload(path));
+  BOOST_CHECK_EQUAL(xrt::config::detail::get_reload_count(),count);
+
+  const unsigned int nthreads = 4;
+  {
+    workload load(nthreads,2,6,10,0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    write_ini(path,6,0,true,3);
+    BOOST_CHECK(xrt::config::reload());
+    BOOST_CHECK(wait_for([&] { return load.seen_new == nthreads; }));
+    BOOST_CHECK_EQUAL(load.bad,0);
+  }
+  BOOST_CHECK_EQUAL(xrt::config::get_verbosity(),6);
+  BOOST_CHECK_EQUAL(xrt::config::get_polling_throttle(),0);
+  BOOST_CHECK_EQUAL(xrt::config::get_ert_polling(),true);
+  BOOST_CHECK_EQUAL(xrt::config::get_dma_threads(),3);
+
+  std::remove(path.c_str());
+}
+
+BOOST_AUTO_TEST_CASE( test_reload_ptree )
+{
+  // References to the tree stay valid across reloads
+  auto path = ini_path();
+  write_ini(path,2,10,false,1);
+  xrt::config::reload(path);
+  auto& emu = xrt::config::detail::get_ptree_value("Emulation");
+  BOOST_CHECK_EQUAL(emu.get<std::string>("launch_waveform"),"batch");
+
+  write_ini(path,2,10,true,1);
+  BOOST_CHECK(xrt::config::reload());
+  BOOST_CHECK_EQUAL(emu.get<std::string>("launch_waveform"),"batch");
+  auto& emu2 = xrt::config::detail::get_ptree_value("Emulation");
+  BOOST_CHECK_EQUAL(emu2.get<std::string>("launch_waveform"),"gui");
+
+  std::remove(path.c_str());
+}
+
+BOOST_AUTO_TEST_CASE( test_reload_watch )
+{
+  auto path = ini_path();
+  write_ini(path,2,10,false,1);
+  xrt::config::reload(path);
+  xrt::config::detail::watch("watch",10);
+
+  const unsigned int nthreads = 4;
+  {
+    workload load(nthreads,2,5,10,20);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    write_ini(path,5,20,true,2);
+    BOOST_CHECK(wait_for([&] { return load.seen_new == nthreads; }));
+    BOOST_CHECK_EQUAL(load.bad,0);
+  }
+  BOOST_CHECK_EQUAL(xrt::config::get_ert_polling(),true);
+
+  xrt::config::detail::watch("off",0);
+  std::remove(path.c_str());
+}
+
+BOOST_AUTO_TEST_CASE( test_reload_signal )
+{
+  auto path = ini_path();
+  write_ini(path,2,10,false,1);
+  xrt::config::reload(path);
+  xrt::config::detail::watch("signal",10);
+
+  // File changes alone are not picked up
+  auto count = xrt::config::detail::get_reload_count();
+  write_ini(path,3,30,true,2);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  BOOST_CHECK_EQUAL(xrt::config::detail::get_reload_count(),count);
+  BOOST_CHECK_EQUAL(xrt::config::get_verbosity(),2);
+
+  std::raise(SIGHUP);
+  BOOST_CHECK(wait_for([] { return xrt::config::get_verbosity() == 3; }));
+  BOOST_CHECK_EQUAL(xrt::config::get_polling_throttle(),30);
+
+  // Handler is removed when watching stops
+  xrt::config::detail::watch("off",0);
+  struct sigaction action;
+  ::sigaction(SIGHUP,nullptr,&action);
+  BOOST_CHECK(action.sa_handler == SIG_DFL);
+
+  std::remove(path.c_str());
+}
+
+BOOST_AUTO_TEST_CASE( test_reload_race )
+{
+  // Refreshes racing with back to back reloads never leave an old
+  // value cached once reloads stop
+  auto path = ini_path();
+  write_ini(path,1,10,false,1);
+  xrt::config::reload(path);
+
+  xrt::config::detail::reloadable<unsigned int> value;
+  auto read = [] {
+    auto verbosity = xrt::config::detail::get_uint_value("Runtime.verbosity",0);
+    // Widen the window between reading the value and caching it
+    std::this_thread::yield();
+    return verbosity;
+  };
+
+  const unsigned int nthreads = 8;
+  std::atomic<bool> stop {false};
+  std::vector<std::thread> threads;
+  for (unsigned int t=0; t<nthreads; ++t)
+    threads.emplace_back([&] { while (!stop) value.get(read); });
+
+  unsigned int verbosity = 1;
+  for (int i=0; i<200; ++i) {
+    verbosity = verbosity % 7 + 1;
+    write_ini(path,verbosity,10,false,1);
+    xrt::config::reload();
+  }
+  stop = true;
+  for (auto& t : threads)
+    t.join();
+  BOOST_CHECK_EQUAL(value.get(read),verbosity);
+
+  std::remove(path.c_str());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
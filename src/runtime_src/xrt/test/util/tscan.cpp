@@ -0,0 +1,304 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+////////////////////////////////////////////////////////////////
+// Unit testing and benchmark of pcidev scan and sysfs queries
+//
+// Scans a generated fake sysfs/devfs tree instead of the hardware
+// tree, then times rescan and a round of typical xbutil queries for
+// increasing numbers of boards, read directly and through
+// pcidev::sysfs_snapshot, one board after another and concurrently.
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+
+#include "fake_pcie_tree.h"
+#include "core/pcie/linux/scan.h"
+#include "xrt/util/time.h"
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <thread>
+#include <memory>
+
+namespace {
+
+// Reads straight from sysfs, as pcidev::sysfs_snapshot::get
+struct direct
+{
+  std::shared_ptr<pcidev::pci_device> dev;
+
+  template <typename T>
+  void
+  get(const std::string& subdev, const std::string& entry, std::string& err, T& value)
+  {
+    dev->sysfs_get(subdev,entry,err,value);
+  }
+};
+
+static const char* sensors[] = {
+  "xmc_12v_pex_vol", "xmc_12v_pex_curr", "xmc_12v_aux_vol", "xmc_12v_aux_curr",
+  "xmc_3v3_pex_vol", "xmc_3v3_aux_vol", "xmc_ddr_vpp_btm", "xmc_ddr_vpp_top",
+  "xmc_sys_5v5", "xmc_1v2_top", "xmc_vcc1v2_btm", "xmc_1v8", "xmc_0v85",
+  "xmc_mgt0v9avcc", "xmc_12v_sw", "xmc_mgtavtt", "xmc_vccint_vol",
+  "xmc_vccint_curr", "xmc_fpga_temp", "xmc_fan_temp", "xmc_fan_rpm",
+  "xmc_se98_temp0", "xmc_se98_temp1", "xmc_cage_temp0", "xmc_cage_temp1",
+};
+
+// Queries made by xbutil query for one board
+template <typename Source>
+static void
+query(Source& src)
+{
+  std::string err, vbnv;
+  std::vector<char> topo, layout, temps;
+  std::vector<std::string> memstat, custat, clocks;
+  unsigned int value = 0;
+  src.get("rom","VBNV",err,vbnv);
+  src.get("rom","FPGA",err,vbnv);
+  src.get("","vendor",err,value);
+  src.get("","device",err,value);
+  src.get("","link_speed",err,value);
+  src.get("","link_width",err,value);
+  src.get("icap","clock_freqs",err,clocks);
+  src.get("icap","mem_topology",err,topo);
+  src.get("icap","ip_layout",err,layout);
+  src.get("","memstat_raw",err,memstat);
+  src.get("mb_scheduler","kds_custat",err,custat);
+  src.get("xmc","temp_by_mem_topology",err,temps);
+  for (auto sensor : sensors)
+    src.get("xmc",sensor,err,value);
+  src.get("firewall","detected_level",err,value);
+  src.get("firewall","detected_status",err,value);
+  src.get("","xclbinuuid",err,vbnv);
+}
+
+static void
+query(const std::shared_ptr<pcidev::pci_device>& dev)
+{
+  direct src{dev};
+  query(src);
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE ( test_scan )
+
+BOOST_AUTO_TEST_CASE( test_scan1 )
+{
+  xrt::test::fake_pcie_tree tree(4);
+  tree.set_ready(2,false);
+  xrt::test::roots_guard roots(tree);
+
+  BOOST_CHECK_EQUAL(pcidev::get_sysfs_root(),tree.sysfs_root() + "/");
+  BOOST_CHECK_EQUAL(pcidev::get_dev_total(true),4);
+  BOOST_CHECK_EQUAL(pcidev::get_dev_total(false),4);
+  BOOST_CHECK_EQUAL(pcidev::get_dev_ready(true),3);
+  BOOST_CHECK_EQUAL(pcidev::get_dev_ready(false),3);
+
+  // Ready boards first
+  for (unsigned int i=0; i<3; ++i)
+    BOOST_CHECK(pcidev::get_dev(i)->is_ready);
+  auto notready = pcidev::get_dev(3);
+  BOOST_CHECK(!notready->is_ready);
+  BOOST_CHECK_EQUAL(notready->sysfs_name,tree.bdf(2,false));
+
+  for (unsigned int i=0; i<4; ++i) {
+    auto user = pcidev::get_dev(i,true);
+    BOOST_CHECK(!user->is_mgmt);
+    BOOST_CHECK_EQUAL(user->func,1);
+    BOOST_CHECK(user->instance >= 128 && user->instance < 132);
+    BOOST_CHECK_EQUAL(user->user_bar_size,0x2000000);
+
+    auto mgmt = pcidev::get_dev(i,false);
+    BOOST_CHECK(mgmt->is_mgmt);
+    BOOST_CHECK_EQUAL(mgmt->func,0);
+    BOOST_CHECK_EQUAL(mgmt->instance,mgmt->bus << 8);
+  }
+
+  auto dev = pcidev::get_dev(0);
+  std::string err, vbnv;
+  dev->sysfs_get("rom","VBNV",err,vbnv);
+  BOOST_CHECK(err.empty());
+  BOOST_CHECK_EQUAL(vbnv,"xilinx_u200_xdma_201830_2");
+
+  std::vector<char> buf;
+  dev->sysfs_get("icap","mem_topology",err,buf);
+  BOOST_CHECK(err.empty());
+  auto topo = reinterpret_cast<const mem_topology*>(buf.data());
+  BOOST_REQUIRE(buf.size() >= sizeof(mem_topology));
+  BOOST_CHECK_EQUAL(topo->m_count,4);
+  BOOST_CHECK_EQUAL(std::string(reinterpret_cast<const char*>(topo->m_mem_data[1].m_tag)),"bank1");
+
+  std::vector<std::string> memstat;
+  dev->sysfs_get("","memstat_raw",err,memstat);
+  BOOST_CHECK_EQUAL(memstat.size(),4);
+
+  std::vector<std::string> custat;
+  dev->sysfs_get("mb_scheduler","kds_custat",err,custat);
+  BOOST_CHECK_EQUAL(custat.size(),8);
+  BOOST_CHECK_EQUAL(custat[0],"CU[@0x1800000] : 0 status : 4");
+
+  unsigned int temp = 0;
+  dev->sysfs_get("xmc","xmc_fpga_temp",err,temp);
+  BOOST_CHECK(err.empty());
+  BOOST_CHECK_EQUAL(temp,47);
+
+  // Device nodes resolve under devfs root
+  int fd = dev->open("",O_RDWR);
+  BOOST_CHECK(fd >= 0);
+  dev->close(fd);
+  fd = dev->open("xvc_pub",O_RDWR);
+  BOOST_CHECK(fd >= 0);
+  dev->close(fd);
+}
+
+BOOST_AUTO_TEST_CASE( test_scan2 )
+{
+  for (unsigned int boards : { 1, 8, 32 }) {
+    xrt::test::fake_pcie_tree tree(boards);
+    xrt::test::roots_guard roots(tree);
+    BOOST_CHECK_EQUAL(pcidev::get_dev_total(),boards);
+
+    const unsigned int loops = 100;
+    unsigned long scan_time = 0;
+    {
+      xrt::time_guard tg(scan_time);
+      for (unsigned int i=0; i<loops; ++i)
+        pcidev::rescan();
+    }
+
+    unsigned long query_time = 0;
+    {
+      xrt::time_guard tg(query_time);
+      for (unsigned int i=0; i<loops; ++i)
+        for (unsigned int b=0; b<boards; ++b)
+          query(pcidev::get_dev(b));
+    }
+
+    std::cout << boards << " boards: rescan " << scan_time*1e-3/loops << " us, "
+              << "query all boards " << query_time*1e-3/loops << " us\n";
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_scan3 )
+{
+  xrt::test::fake_pcie_tree tree(2);
+  xrt::test::roots_guard roots(tree);
+
+  {
+    pcidev::sysfs_snapshot snap(pcidev::get_dev(0));
+    std::string err, vbnv;
+    snap.get("rom","VBNV",err,vbnv);
+    BOOST_CHECK(err.empty());
+    BOOST_CHECK_EQUAL(vbnv,"xilinx_u200_xdma_201830_2");
+
+    unsigned int temp = 0;
+    snap.get("xmc","xmc_fpga_temp",err,temp);
+    BOOST_CHECK_EQUAL(temp,47);
+
+    std::vector<std::string> custat;
+    snap.get("mb_scheduler","kds_custat",err,custat);
+    BOOST_CHECK_EQUAL(custat.size(),8);
+
+    std::vector<char> buf, direct_buf;
+    snap.get("icap","mem_topology",err,buf);
+    pcidev::get_dev(0)->sysfs_get("icap","mem_topology",err,direct_buf);
+    BOOST_CHECK(buf==direct_buf);
+
+    // Missing entries report errors as sysfs_get does
+    snap.get("xmc","no_such_entry",err,temp);
+    BOOST_CHECK(!err.empty());
+    snap.get("no_such_subdev","entry",err,temp);
+    BOOST_CHECK(!err.empty());
+
+    // Values change only on refresh
+    auto xmc = pcidev::get_dev(0)->get_sysfs_path("xmc","xmc_fpga_temp");
+    tree.write(xmc,"52");
+    snap.get("xmc","xmc_fpga_temp",err,temp);
+    BOOST_CHECK_EQUAL(temp,47);
+    snap.refresh();
+    snap.get("xmc","xmc_fpga_temp",err,temp);
+    BOOST_CHECK(err.empty());
+    BOOST_CHECK_EQUAL(temp,52);
+
+    // Subdevice recreated with another instance is found again
+    auto dir = tree.pf_dir(0,false);
+    std::string old_dir = boost::filesystem::path(xmc).parent_path().string();
+    boost::filesystem::rename(old_dir,dir + "/xmc.u.99");
+    tree.write(dir + "/xmc.u.99/xmc_fpga_temp","53");
+    snap.refresh();
+    snap.get("xmc","xmc_fpga_temp",err,temp);
+    BOOST_CHECK(err.empty());
+    BOOST_CHECK_EQUAL(temp,53);
+    pcidev::get_dev(0)->sysfs_get("xmc","xmc_fan_rpm",err,temp);
+    BOOST_CHECK(err.empty());
+    BOOST_CHECK_EQUAL(temp,2431);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_scan4 )
+{
+  const unsigned int boards = 8;
+  const unsigned int loops = 50;
+  xrt::test::fake_pcie_tree tree(boards);
+  xrt::test::roots_guard roots(tree);
+
+  std::cout << boards << " boards, " << loops << " rounds of query:\n";
+
+  std::vector<std::unique_ptr<pcidev::sysfs_snapshot>> snaps;
+  for (unsigned int b=0; b<boards; ++b) {
+    snaps.emplace_back(new pcidev::sysfs_snapshot(pcidev::get_dev(b)));
+    query(*snaps.back());
+  }
+
+  auto run = [&](bool snapshot, bool concurrent) {
+    auto one = [&](unsigned int b) {
+      if (snapshot) {
+        snaps[b]->refresh();
+        query(*snaps[b]);
+      }
+      else
+        query(pcidev::get_dev(b));
+    };
+    unsigned long time = 0;
+    {
+      xrt::time_guard tg(time);
+      for (unsigned int i=0; i<loops; ++i) {
+        if (!concurrent) {
+          for (unsigned int b=0; b<boards; ++b)
+            one(b);
+          continue;
+        }
+        std::vector<std::thread> threads;
+        for (unsigned int b=0; b<boards; ++b)
+          threads.emplace_back(one,b);
+        for (auto& t : threads)
+          t.join();
+      }
+    }
+    std::cout << (snapshot ? "snapshot" : "sysfs_get") << ", "
+              << (concurrent ? "concurrent" : "serial") << ": "
+              << time*1e-3/loops << " us per round\n";
+  };
+
+  run(false,false);
+  run(false,true);
+  run(true,false);
+  run(true,true);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,157 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+////////////////////////////////////////////////////////////////
+// Unit testing and benchmark of core/common/spsc_ring.h
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+
+#include "core/common/spsc_ring.h"
+#include "xrt/util/time.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include <iostream>
+
+namespace {
+
+// Stream count packets of pkt_size bytes through the ring in batches,
+// packets carry their sequence number which the consumer verifies
+static unsigned long
+stream(size_t pkt_size, size_t count, size_t batch)
+{
+  xrt_core::spsc_ring ring(pkt_size,1024);
+  unsigned long time = 0;
+  bool ok = true;
+
+  {
+    xrt::time_guard tg(time);
+    std::thread producer([&] {
+        std::vector<char> data(pkt_size*batch);
+        for (size_t seq=0; seq<count; seq+=batch) {
+          auto n = std::min(batch,count-seq);
+          for (size_t i=0; i<n; ++i)
+            *reinterpret_cast<uint32_t*>(&data[i*pkt_size]) = seq+i;
+          ring.write(data.data(),n);
+        }
+      });
+
+    std::vector<char> data(pkt_size*batch);
+    for (size_t seq=0; seq<count; seq+=batch) {
+      auto n = std::min(batch,count-seq);
+      ring.read(data.data(),n);
+      for (size_t i=0; i<n; ++i)
+        ok = ok && (*reinterpret_cast<uint32_t*>(&data[i*pkt_size]) == seq+i);
+    }
+    producer.join();
+  }
+
+  BOOST_CHECK(ok);
+  return time;
+}
+
+// Round trip of one packet through a pair of rings
+static unsigned long
+ping_pong(size_t pkt_size, size_t count)
+{
+  xrt_core::spsc_ring ping(pkt_size,16);
+  xrt_core::spsc_ring pong(pkt_size,16);
+  unsigned long time = 0;
+
+  std::thread echo([&] {
+      std::vector<char> data(pkt_size);
+      for (size_t i=0; i<count; ++i) {
+        ping.read(data.data(),1);
+        pong.write(data.data(),1);
+      }
+    });
+
+  {
+    xrt::time_guard tg(time);
+    std::vector<char> data(pkt_size);
+    for (size_t i=0; i<count; ++i) {
+      ping.write(data.data(),1);
+      pong.read(data.data(),1);
+    }
+  }
+  echo.join();
+  return time/count;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE ( test_spsc_ring )
+
+BOOST_AUTO_TEST_CASE( test_spsc_ring1 )
+{
+  xrt_core::spsc_ring ring(sizeof(int),5);
+  BOOST_CHECK_EQUAL(ring.capacity(),5);
+
+  // fill, wrapping around the end of the buffer
+  int in[8] = {0,1,2,3,4,5,6,7};
+  int out[8] = {0};
+  BOOST_CHECK_EQUAL(ring.try_write(in,6),5);
+  BOOST_CHECK_EQUAL(ring.try_read(out,4),4);
+  BOOST_CHECK_EQUAL(ring.try_write(in,8),4);
+  BOOST_CHECK_EQUAL(ring.size(),5);
+  BOOST_CHECK_EQUAL(ring.try_write(in,1),0);
+  BOOST_CHECK_EQUAL(ring.writable_index()-ring.write_index(),0);
+
+  BOOST_CHECK(ring.try_peek(out));
+  BOOST_CHECK_EQUAL(out[0],4);
+  BOOST_CHECK_EQUAL(ring.try_read(out,8),5);
+  int expect[5] = {4,0,1,2,3};
+  for (int i=0; i<5; ++i)
+    BOOST_CHECK_EQUAL(out[i],expect[i]);
+  BOOST_CHECK_EQUAL(ring.try_read(out,1),0);
+  BOOST_CHECK(!ring.try_peek(out));
+  BOOST_CHECK_EQUAL(ring.writable_index()-ring.write_index(),5);
+
+  // blocking writer never gets more than capacity ahead of the reader
+  std::thread writer([&ring] {
+    for (int i=0; i<100; ++i)
+      ring.write(&i,1);
+  });
+  bool ordered = true;
+  size_t max_size = 0;
+  for (int i=0; i<100; ++i) {
+    max_size = std::max(max_size,ring.size());
+    int value = -1;
+    ring.read(&value,1);
+    ordered = ordered && value==i;
+  }
+  writer.join();
+  BOOST_CHECK(ordered);
+  BOOST_CHECK(max_size<=5);
+}
+
+BOOST_AUTO_TEST_CASE( test_spsc_ring2 )
+{
+  size_t count = 1000000;
+  std::cout << "SPSC ring streaming " << count << " packets\n";
+  for (size_t pkt_size : {4,64,512}) {
+    for (size_t batch : {1,32}) {
+      auto time = stream(pkt_size,count,batch);
+      std::cout << "packet(" << pkt_size << ") batch(" << batch << "): "
+                << time*1e-6 << " ms (" << static_cast<double>(time)/count << " ns/pkt, "
+                << (pkt_size*count*1e3)/time << " MB/s)\n";
+    }
+    std::cout << "packet(" << pkt_size << ") round trip: " << ping_pong(pkt_size,10000) << " ns\n";
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,237 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+////////////////////////////////////////////////////////////////
+// Unit testing of xdp::SummaryDumper and xdp::WindowProfileWriter
+//
+// API calls are logged to an RTProfile with application profiling
+// on, while a dumper writes summaries every second.  The calls of
+// each window are logged right after the previous window file is
+// written, so each window is expected to hold exactly those calls
+// while the cumulative summary holds all calls so far.
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+
+#include "xdp/profile/core/summary_dumper.h"
+#include "xdp/profile/core/rt_profile.h"
+#include "xdp/profile/core/rt_util.h"
+#include "xdp/profile/plugin/base_plugin.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+// Host side only, there is no device to ask for metadata
+struct host_plugin : xdp::XDPPluginI
+{
+  void getProfileKernelName(const std::string&, const std::string& cuName,
+                            std::string& kernelName) override
+  { kernelName = cuName; }
+  void getTraceStringFromComputeUnit(const std::string&, const std::string&,
+                                     std::string&) override {}
+  size_t getDeviceTimestamp(const std::string&) override { return 0; }
+  double getReadMaxBandwidthMBps() override { return 0; }
+  double getWriteMaxBandwidthMBps() override { return 0; }
+  unsigned int getProfileNumberSlots(xclPerfMonType, const std::string&) override
+  { return 0; }
+  void getProfileSlotName(xclPerfMonType, const std::string&, unsigned int,
+                          std::string&) override {}
+  unsigned int getProfileSlotProperties(xclPerfMonType, const std::string&,
+                                        unsigned int) override { return 0; }
+  bool isAPCtrlChain(const std::string&, const std::string&) override { return false; }
+};
+
+static std::string
+read_file(const std::string& file)
+{
+  std::ifstream istr(file);
+  std::stringstream sstr;
+  sstr << istr.rdbuf();
+  return sstr.str();
+}
+
+static bool
+exists(const std::string& file)
+{
+  return access(file.c_str(),F_OK) == 0;
+}
+
+// Content of a window file once it has been written in full, the
+// compute unit table is last and the file is no longer growing
+static std::string
+wait_for_window(const std::string& file)
+{
+  std::string last;
+  for (int i=0; i<100; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    auto data = read_file(file);
+    if (data.find("Compute Unit Utilization") != std::string::npos && data == last)
+      return data;
+    last = data;
+  }
+  return "";
+}
+
+static void
+log_calls(xdp::RTProfile& profile, const char* name, int count)
+{
+  for (int i=0; i<count; ++i) {
+    profile.logFunctionCallStart(name,0,i);
+    profile.logFunctionCallEnd(name,0,i);
+  }
+}
+
+// Number of calls in the row of the named API call, 0 if no row
+static unsigned int
+calls(const std::string& data, const std::string& name)
+{
+  auto pos = data.find("\n" + name + ",");
+  if (pos == std::string::npos)
+    return 0;
+  return std::strtoul(data.c_str() + pos + name.size() + 2,nullptr,10);
+}
+
+static double
+window_msec(const std::string& data)
+{
+  auto pos = data.find("Window (ms): ");
+  if (pos == std::string::npos)
+    return 0;
+  return std::strtod(data.c_str() + pos + 13,nullptr);
+}
+
+static std::string
+tmp_dir()
+{
+  char name[] = "/tmp/tsummary_dumper.XXXXXX";
+  return mkdtemp(name);
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE ( test_summary_dumper )
+
+BOOST_AUTO_TEST_CASE( test_summary_dumper1 )
+{
+  auto dir = tmp_dir();
+  auto base = dir + "/profile_summary";
+  auto window = dir + "/profile_window";
+
+  auto plugin = std::make_shared<host_plugin>();
+  int flags = xdp::RTUtil::PROFILE_APPLICATION;
+  xdp::RTProfile profile(flags,plugin);
+
+  {
+    xdp::SummaryDumper dumper(&profile,plugin.get(),base,window,1,2);
+
+    // window 0: clFoo only
+    log_calls(profile,"clFoo",3);
+    auto w0 = wait_for_window(window + ".0.csv");
+    BOOST_REQUIRE(!w0.empty());
+
+    // window 1: clBar only
+    log_calls(profile,"clBar",2);
+    auto w1 = wait_for_window(window + ".1.csv");
+    BOOST_REQUIRE(!w1.empty());
+
+    // window 2: no calls
+    auto w2 = wait_for_window(window + ".2.csv");
+    BOOST_REQUIRE(!w2.empty());
+
+    BOOST_CHECK_EQUAL(calls(w0,"clFoo"),3);
+    BOOST_CHECK_EQUAL(calls(w0,"clBar"),0);
+    BOOST_CHECK_EQUAL(calls(w1,"clFoo"),0);
+    BOOST_CHECK_EQUAL(calls(w1,"clBar"),2);
+    BOOST_CHECK_EQUAL(calls(w2,"clFoo"),0);
+    BOOST_CHECK_EQUAL(calls(w2,"clBar"),0);
+
+    // windows are back to back, each about one interval long
+    for (auto& w : {w0,w1,w2}) {
+      BOOST_CHECK(window_msec(w) > 900);
+      BOOST_CHECK(window_msec(w) < 2000);
+    }
+
+    // summary is cumulative
+    auto s1 = read_file(base + ".1.csv");
+    BOOST_CHECK_EQUAL(calls(s1,"clFoo"),3);
+    BOOST_CHECK_EQUAL(calls(s1,"clBar"),2);
+    auto s2 = read_file(base + ".2.csv");
+    BOOST_CHECK_EQUAL(calls(s2,"clFoo"),3);
+    BOOST_CHECK_EQUAL(calls(s2,"clBar"),2);
+    BOOST_CHECK(exists(base + ".2.json"));
+  }
+
+  // only the last 2 of each are kept
+  BOOST_CHECK(!exists(base + ".0.csv"));
+  BOOST_CHECK(!exists(base + ".0.json"));
+  BOOST_CHECK(!exists(window + ".0.csv"));
+  BOOST_CHECK(exists(base + ".2.csv"));
+  BOOST_CHECK(exists(window + ".2.csv"));
+
+  // no summary at the end of the test
+  flags = 0;
+  std::string cmd = "rm -rf " + dir;
+  BOOST_CHECK_EQUAL(std::system(cmd.c_str()),0);
+}
+
+BOOST_AUTO_TEST_CASE( test_window_profile_writer )
+{
+  // window stats restart when the cumulative stats start over
+  auto dir = tmp_dir();
+  auto plugin = std::make_shared<host_plugin>();
+  int flags = xdp::RTUtil::PROFILE_APPLICATION;
+  auto profile = std::make_unique<xdp::RTProfile>(flags,plugin);
+  xdp::WindowTotals totals;
+
+  auto write = [&](xdp::RTProfile& prof, const std::string& name) {
+    {
+      xdp::WindowProfileWriter writer(plugin.get(),"Xilinx",dir + "/" + name,totals,10.0);
+      prof.writeProfileSummary(&writer);
+    }
+    return read_file(dir + "/" + name + ".csv");
+  };
+
+  log_calls(*profile,"clFoo",4);
+  auto w0 = write(*profile,"w0");
+  BOOST_CHECK_EQUAL(window_msec(w0),10.0);
+  BOOST_CHECK_EQUAL(calls(w0,"clFoo"),4);
+
+  log_calls(*profile,"clFoo",1);
+  auto w1 = write(*profile,"w1");
+  BOOST_CHECK_EQUAL(calls(w1,"clFoo"),1);
+
+  // fewer calls than recorded, stats started over
+  flags = 0;
+  profile = std::make_unique<xdp::RTProfile>(flags,plugin);
+  flags = xdp::RTUtil::PROFILE_APPLICATION;
+  log_calls(*profile,"clFoo",2);
+  auto w2 = write(*profile,"w2");
+  BOOST_CHECK_EQUAL(calls(w2,"clFoo"),2);
+
+  flags = 0;
+  std::string cmd = "rm -rf " + dir;
+  BOOST_CHECK_EQUAL(std::system(cmd.c_str()),0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,279 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+////////////////////////////////////////////////////////////////
+// Unit testing and benchmark of xdp::TraceStream
+//
+// The benchmark writes synthetic API call rows of the timeline
+// trace, once formatted through stringstreams and an ofstream as
+// TraceWriterI does, and once encoded into a TraceStream, plain
+// and gzip compressed.
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+
+#include "xdp/profile/writer/trace_stream.h"
+#include "xrt/util/time.h"
+
+#include <zlib.h>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+
+static std::string
+read_file(const std::string& file)
+{
+  std::ifstream istr(file);
+  std::stringstream sstr;
+  sstr << istr.rdbuf();
+  return sstr.str();
+}
+
+static std::string
+read_gz_file(const std::string& file)
+{
+  std::string data;
+  gzFile f = gzopen(file.c_str(),"rb");
+  if (!f)
+    return data;
+  char buf[4096];
+  int n;
+  while ((n = gzread(f,buf,sizeof(buf))) > 0)
+    data.append(buf,n);
+  gzclose(f);
+  return data;
+}
+
+static std::string
+tmp_name()
+{
+  char name[] = "/tmp/ttrace_stream.XXXXXX";
+  int fd = mkstemp(name);
+  close(fd);
+  std::remove(name);
+  return name;
+}
+
+static std::string
+printf_g(double value, int precision)
+{
+  char buf[64];
+  snprintf(buf,sizeof(buf),"%.*g",precision,value);
+  return buf;
+}
+
+static std::string
+to_chars(double value, int precision)
+{
+  char buf[32];
+  return std::string(buf,xdp::TraceStream::toChars(buf,value,precision));
+}
+
+// An API call row as TraceWriterI::writeFunction writes it
+static std::string
+row(double time, unsigned int id)
+{
+  std::stringstream timeStr;
+  timeStr << std::setprecision(10) << time;
+  return timeStr.str() + ",clEnqueueNDRangeKernel,START,,,,,,,,,,," + std::to_string(id) + ",\n";
+}
+
+static void
+write_row(xdp::TraceStream& stream, double time, unsigned int id)
+{
+  static const std::string cells = ",clEnqueueNDRangeKernel,START,,,,,,,,,,,";
+  stream.writeDouble(time,10);
+  stream.write(cells);
+  stream.writeUInt(id);
+  stream.write(",\n",2);
+  stream.endRow();
+}
+
+static double
+row_time(unsigned int i)
+{
+  return 1000.0 + i*0.001234;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE ( test_trace_stream )
+
+BOOST_AUTO_TEST_CASE( test_to_chars )
+{
+  char buf[32];
+  for (uint64_t v : { 0ULL, 7ULL, 10ULL, 4294967295ULL, 18446744073709551615ULL })
+    BOOST_CHECK_EQUAL(std::string(buf,xdp::TraceStream::toChars(buf,v)),std::to_string(v));
+
+  // Values as trace times are, with fewer digits than the precision,
+  // come out as printf writes them
+  for (double v : { 0.0, -0.0, 1.0, 0.5, 0.05, 0.000123, 12.25, 1234.567891,
+                    -42.125, 9999999999.0, 99999.999999, 123456789.1 })
+    BOOST_CHECK_EQUAL(to_chars(v,10),printf_g(v,10));
+  for (unsigned int i=0; i<100000; ++i) {
+    double v = i*0.000001 + i;
+    BOOST_CHECK_EQUAL(to_chars(v,10),printf_g(v,10));
+  }
+
+  // Out of the fixed point range, printf is used
+  for (double v : { 1e-5, 12345678901.0, 1e300, -1e-300 })
+    BOOST_CHECK_EQUAL(to_chars(v,10),printf_g(v,10));
+
+  // Random values read back the same as printf's, up to the last digit
+  std::mt19937_64 rng(42);
+  std::uniform_real_distribution<double> dist(1e-4,1e9);
+  for (unsigned int i=0; i<100000; ++i) {
+    double v = dist(rng);
+    double ours = std::strtod(to_chars(v,10).c_str(),nullptr);
+    double theirs = std::strtod(printf_g(v,10).c_str(),nullptr);
+    BOOST_REQUIRE_CLOSE(ours,theirs,1e-7);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_trace_stream1 )
+{
+  // Rows and stream output arrive in order after the header
+  auto name = tmp_name();
+  std::string expect = "header\n";
+  {
+    xdp::TraceStream stream(name,".csv","header\n",0,false,256,2);
+    BOOST_CHECK_EQUAL(stream.getFileName(),name + ".csv");
+    for (unsigned int i=0; i<10000; ++i) {
+      write_row(stream,row_time(i),i);
+      expect += row(row_time(i),i);
+      if (i % 100 == 0) {
+        stream.stream() << "device," << 1.5 << "," << 42 << "\n";
+        stream.endRow();
+        expect += "device,1.5,42\n";
+      }
+    }
+
+    // Flushed rows are in the file while the stream is open
+    stream.flush();
+    BOOST_CHECK(read_file(name + ".csv") == expect);
+
+    stream.write("footer\n");
+    expect += "footer\n";
+  }
+  BOOST_CHECK(read_file(name + ".csv") == expect);
+  std::remove((name + ".csv").c_str());
+}
+
+BOOST_AUTO_TEST_CASE( test_trace_stream2 )
+{
+  // Files are rotated by size, each starts with the header and holds
+  // whole rows, together they hold all rows in order
+  for (bool compress : { false, true }) {
+    auto name = tmp_name();
+    const uint64_t maxFileBytes = 16*1024;
+    const std::string ext = compress ? ".csv.gz" : ".csv";
+    unsigned int files = 0;
+    std::string expect;
+    {
+      xdp::TraceStream stream(name,".csv","header\n",maxFileBytes,compress,1024,4);
+      for (unsigned int i=0; i<20000; ++i) {
+        write_row(stream,row_time(i),i);
+        expect += row(row_time(i),i);
+      }
+      stream.close();
+      files = stream.getNumFiles();
+      BOOST_CHECK(!stream.failed());
+    }
+    BOOST_CHECK(files > 1);
+
+    std::string rows;
+    for (unsigned int f=0; f<files; ++f) {
+      auto file = f ? name + "." + std::to_string(f) + ext : name + ext;
+      auto data = compress ? read_gz_file(file) : read_file(file);
+      BOOST_REQUIRE(data.compare(0,7,"header\n") == 0);
+      BOOST_CHECK(data.size() <= maxFileBytes + 1024 + 4096);
+      BOOST_CHECK(data.back() == '\n');
+      rows += data.substr(7);
+      std::remove(file.c_str());
+    }
+    BOOST_CHECK(rows == expect);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_trace_stream3 )
+{
+  // A file which can't be opened throws as other writers do
+  BOOST_CHECK_THROW(xdp::TraceStream("/nonexistent/dir/trace",".csv",""),std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE( test_trace_stream4 )
+{
+  const unsigned int count = 2000000;
+  auto name = tmp_name();
+
+  std::cout << "Writing " << count << " timeline rows\n";
+
+  // As TraceWriterI::writeFunction: stringstream per time and ofstream cells
+  unsigned long ofs_time = 0;
+  {
+    std::ofstream ofs(name + ".csv");
+    xrt::time_guard tg(ofs_time);
+    for (unsigned int i=0; i<count; ++i) {
+      std::stringstream timeStr;
+      timeStr << std::setprecision(10) << row_time(i);
+      ofs << timeStr.str() << "," << "clEnqueueNDRangeKernel" << "," << "START" << ",";
+      for (int c=0; c<10; ++c)
+        ofs << "" << ",";
+      ofs << std::to_string(i) << ",";
+      ofs << "\n";
+    }
+  }
+  auto size = read_file(name + ".csv").size();
+  std::cout << "ofstream: " << ofs_time*1e-6 << " ms, "
+            << (count/(ofs_time*1e-9))*1e-6 << " M rows/s\n";
+
+  for (bool compress : { false, true }) {
+    unsigned long row_time_ns = 0;    // logging thread
+    unsigned long total_time = 0;     // until all rows are written
+    {
+      xrt::time_guard dg(total_time);
+      xdp::TraceStream stream(name,".csv","",0,compress);
+      {
+        xrt::time_guard tg(row_time_ns);
+        for (unsigned int i=0; i<count; ++i)
+          write_row(stream,row_time(i),i);
+      }
+      stream.close();
+    }
+    auto file = name + (compress ? ".csv.gz" : ".csv");
+    auto data = compress ? read_gz_file(file) : read_file(file);
+    BOOST_CHECK_EQUAL(data.size(),size);
+
+    std::ifstream istr(file,std::ios::binary | std::ios::ate);
+    std::cout << "TraceStream" << (compress ? " gzip: " : ": ")
+              << row_time_ns*1e-6 << " ms, "
+              << (count/(row_time_ns*1e-9))*1e-6 << " M rows/s, written "
+              << total_time*1e-6 << " ms, "
+              << istr.tellg() << " of " << size << " bytes\n";
+    std::remove(file.c_str());
+  }
+  std::remove((name + ".csv").c_str());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,201 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+////////////////////////////////////////////////////////////////
+// Unit testing and startup benchmark of core/common/xclbin_image.h
+//
+// A synthetic xclbin is loaded for a number of emulated devices,
+// either copied per device as before or shared through xclbin_image.
+// Time and resident memory growth are compared.
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+
+#include "core/common/xclbin_image.h"
+#include "xrt/util/time.h"
+
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <iostream>
+#include <cstring>
+#include <cstdio>
+#include <unistd.h>
+
+namespace {
+
+// Build an xclbin of size bytes with one BITSTREAM section
+static std::vector<char>
+make_xclbin(size_t size, unsigned char tag)
+{
+  std::vector<char> xb(size,0);
+  auto top = reinterpret_cast<axlf*>(xb.data());
+  std::strcpy(top->m_magic,"xclbin2");
+  top->m_header.m_length = size;
+  top->m_header.m_timeStamp = 1;
+  std::memset(&top->m_header.uuid,tag,sizeof(xuid_t));
+  top->m_header.m_numSections = 1;
+  top->m_sections[0].m_sectionKind = BITSTREAM;
+  top->m_sections[0].m_sectionOffset = sizeof(axlf);
+  top->m_sections[0].m_sectionSize = size - sizeof(axlf);
+  for (size_t i=sizeof(axlf); i<size; ++i)
+    xb[i] = static_cast<char>(i);
+  return xb;
+}
+
+static size_t
+resident_bytes()
+{
+  size_t pages = 0, resident = 0;
+  std::ifstream statm("/proc/self/statm");
+  statm >> pages >> resident;
+  return resident * ::sysconf(_SC_PAGESIZE);
+}
+
+// Copy the image for each device, touching the copy as a load would
+static size_t
+load_copies(const std::vector<char>& xb, size_t devices, std::vector<std::vector<char>>& loaded)
+{
+  size_t sum = 0;
+  for (size_t d=0; d<devices; ++d) {
+    loaded.emplace_back(xb);
+    for (size_t i=0; i<loaded.back().size(); i+=4096)
+      sum += loaded.back()[i];
+  }
+  return sum;
+}
+
+static size_t
+load_shared(const std::vector<char>& xb, size_t devices,
+            std::vector<std::shared_ptr<const xrt_core::xclbin_image>>& loaded)
+{
+  size_t sum = 0;
+  for (size_t d=0; d<devices; ++d) {
+    loaded.emplace_back(xrt_core::xclbin_image::create(xb.data(),xb.size()));
+    for (size_t i=0; i<loaded.back()->size(); i+=4096)
+      sum += loaded.back()->data()[i];
+  }
+  return sum;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE ( test_xclbin_image )
+
+BOOST_AUTO_TEST_CASE( test_xclbin_image1 )
+{
+  auto xb = make_xclbin(64*1024,0xa5);
+  auto registered = xrt_core::xclbin_image::registered();
+
+  {
+    auto image1 = xrt_core::xclbin_image::create(xb.data(),xb.size());
+    auto image2 = xrt_core::xclbin_image::create(std::vector<char>(xb));
+    BOOST_CHECK_EQUAL(image1.get(),image2.get());
+    BOOST_CHECK(image1->data() != xb.data());
+    BOOST_CHECK_EQUAL(xrt_core::xclbin_image::registered(),registered+1);
+
+    // section is a view into the image
+    auto section = image1->section(BITSTREAM);
+    BOOST_CHECK_EQUAL(section.first,image1->data()+sizeof(axlf));
+    BOOST_CHECK_EQUAL(section.second,image1->data()+xb.size());
+    BOOST_CHECK(image1->section(IP_LAYOUT).first==nullptr);
+
+    // mapped file with same uuid resolves to the registered image
+    char path[] = "/tmp/txclbin_imageXXXXXX";
+    auto fd = ::mkstemp(path);
+    BOOST_REQUIRE(fd >= 0);
+    BOOST_CHECK_EQUAL(::write(fd,xb.data(),xb.size()),static_cast<ssize_t>(xb.size()));
+    ::close(fd);
+    auto image3 = xrt_core::xclbin_image::open(path);
+    BOOST_CHECK_EQUAL(image3.get(),image1.get());
+    std::remove(path);
+
+    // different uuid is a different image
+    auto other = make_xclbin(64*1024,0x5a);
+    auto image4 = xrt_core::xclbin_image::create(other.data(),other.size());
+    BOOST_CHECK(image4.get()!=image1.get());
+    BOOST_CHECK_EQUAL(xrt_core::xclbin_image::registered(),registered+2);
+  }
+
+  // released images are unregistered
+  BOOST_CHECK_EQUAL(xrt_core::xclbin_image::registered(),registered);
+
+  // not an xclbin
+  std::vector<char> bad(xb.begin(),xb.begin()+sizeof(axlf)-1);
+  BOOST_CHECK_THROW(xrt_core::xclbin_image::create(bad.data(),bad.size()),std::runtime_error);
+
+  // section header pointing past the end of the image
+  auto edge = make_xclbin(4096,0x3c);
+  auto top = reinterpret_cast<axlf*>(edge.data());
+  top->m_sections[0].m_sectionSize += 1;
+  BOOST_CHECK_THROW(xrt_core::xclbin_image::create(edge.data(),edge.size())->section(BITSTREAM),
+                    std::runtime_error);
+
+  auto past = make_xclbin(4096,0x3d);
+  top = reinterpret_cast<axlf*>(past.data());
+  top->m_sections[0].m_sectionOffset = past.size() + 1;
+  top->m_sections[0].m_sectionSize = 0;
+  BOOST_CHECK_THROW(xrt_core::xclbin_image::create(past.data(),past.size())->section(BITSTREAM),
+                    std::runtime_error);
+
+  // offset plus size wraps around
+  auto wrap = make_xclbin(4096,0x3e);
+  top = reinterpret_cast<axlf*>(wrap.data());
+  top->m_sections[0].m_sectionSize = ~uint64_t(0) - sizeof(axlf) + 1;
+  BOOST_CHECK_THROW(xrt_core::xclbin_image::create(wrap.data(),wrap.size())->section(BITSTREAM),
+                    std::runtime_error);
+
+  // section ending exactly at the end of the image is fine
+  auto exact = make_xclbin(4096,0x3f);
+  auto image = xrt_core::xclbin_image::create(exact.data(),exact.size());
+  BOOST_CHECK_EQUAL(image->section(BITSTREAM).second,image->data()+exact.size());
+}
+
+BOOST_AUTO_TEST_CASE( test_xclbin_image2 )
+{
+  size_t size = 32*1024*1024;
+  size_t devices = 8;
+  auto xb = make_xclbin(size,0x11);
+
+  std::cout << "Loading " << (size>>20) << " MB xclbin for " << devices << " devices\n";
+
+  {
+    std::vector<std::vector<char>> loaded;
+    unsigned long time = 0;
+    auto rss = resident_bytes();
+    {
+      xrt::time_guard tg(time);
+      load_copies(xb,devices,loaded);
+    }
+    std::cout << "copied: " << time*1e-6 << " ms, rss +"
+              << ((resident_bytes()-rss)>>20) << " MB\n";
+  }
+
+  {
+    std::vector<std::shared_ptr<const xrt_core::xclbin_image>> loaded;
+    unsigned long time = 0;
+    auto rss = resident_bytes();
+    {
+      xrt::time_guard tg(time);
+      load_shared(xb,devices,loaded);
+    }
+    std::cout << "shared: " << time*1e-6 << " ms, rss +"
+              << ((resident_bytes()-rss)>>20) << " MB\n";
+    for (auto& image : loaded)
+      BOOST_CHECK_EQUAL(image.get(),loaded.front().get());
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
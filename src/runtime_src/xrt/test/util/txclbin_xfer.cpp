@@ -0,0 +1,508 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+////////////////////////////////////////////////////////////////
+// Unit testing of streamed xclbin transfer between mpd and msd
+//
+// A local mpd/msd pair, each served by a msg reactor, talks over a
+// unix stream socketpair.  The mpd side queues requests on an
+// xferSender, driven by the mpd reactor as in mpd, and passes
+// responses on to a SOCK_SEQPACKET pair in place of the mailbox.
+// The msd side stages chunks with an xferReceiver and, in place of
+// the download ioctl, checks the staged request against what was
+// sent.
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+
+#include "fake_pcie_tree.h"
+#include "core/pcie/linux/scan.h"
+#include "core/pcie/tools/cloud-daemon/reactor.h"
+#include "core/pcie/tools/cloud-daemon/xclbin_xfer.h"
+#include "xrt/util/time.h"
+
+#include <sys/socket.h>
+#include <syslog.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <map>
+
+namespace {
+
+// Handlers are plain functions, so the pair under test is global
+static std::unique_ptr<xferSender> sender;
+static std::unique_ptr<xferReceiver> receiver;
+// Requests sent by mpd, by id
+static std::mutex requests_mutex;
+static std::map<uint64_t,const std::vector<char>*> requests;
+// msd doesn't answer BEGIN, as if stuck
+static std::atomic<bool> no_ack(false);
+static std::atomic<uint64_t> max_ack_offset(0);
+static std::atomic<uint64_t> received(0);
+// Socket end of mpd to cut off once cut_at bytes are received by msd
+static std::atomic<int> cut_fd(-1);
+static uint64_t cut_at = 0;
+
+// A xclbin download request with size bytes of payload
+static std::vector<char>
+make_request(size_t size, char seed)
+{
+  std::vector<char> req(size);
+  for (size_t i=0; i<size; ++i)
+    req[i] = static_cast<char>(seed + i*7);
+  auto mreq = reinterpret_cast<mailbox_req*>(req.data());
+  mreq->req = MAILBOX_REQ_LOAD_XCLBIN;
+  return req;
+}
+
+static void
+make_nonblock(int fd)
+{
+  fcntl(fd,F_SETFL,fcntl(fd,F_GETFL) | O_NONBLOCK);
+}
+
+static int
+check_request(uint64_t id, const char* data, size_t size)
+{
+  std::lock_guard<std::mutex> lk(requests_mutex);
+  auto expected = requests[id];
+  return (data && expected && size==expected->size() &&
+          std::memcmp(data,expected->data(),size)==0) ? 0 : -EIO;
+}
+
+// msd: stage chunks, compare the whole request in place of download
+static int
+msd_handler(const pcieFunc& dev, std::unique_ptr<sw_msg>& orig, std::unique_ptr<sw_msg>& processed)
+{
+  // Small request is passed on as is
+  if (!isXferMsg(*orig)) {
+    int ret = check_request(orig->id(),orig->payloadData(),orig->payloadSize());
+    processed = std::make_unique<sw_msg>(&ret,sizeof(ret),orig->id(),MB_REQ_FLAG_RESPONSE);
+    return FOR_REMOTE;
+  }
+
+  auto hdr = reinterpret_cast<xfer_hdr*>(orig->payloadData());
+  if (hdr->op == XFER_BEGIN && no_ack)
+    return FOR_NONE;
+  if (hdr->op == XFER_DATA) {
+    uint64_t r = received += orig->payloadSize() - sizeof(xfer_hdr);
+    if (cut_at && r >= cut_at) {
+      cut_at = 0;
+      shutdown(cut_fd,SHUT_RDWR);
+    }
+  }
+
+  std::unique_ptr<xferStage> done;
+  int pass = receiver->recv(dev,*orig,processed,done);
+  if (processed && isXferMsg(*processed)) {
+    auto ack = reinterpret_cast<xfer_hdr*>(processed->payloadData());
+    if (ack->offset > max_ack_offset)
+      max_ack_offset = ack->offset;
+  }
+  if (!done)
+    return pass;
+
+  int ret = check_request(done->xid,done->map(),done->size);
+  processed = std::make_unique<sw_msg>(&ret,sizeof(ret),done->xid,MB_REQ_FLAG_RESPONSE);
+  return FOR_REMOTE;
+}
+
+// mpd: ACKs are for the sender, responses go to the mailbox
+static int
+mpd_handler(const pcieFunc&, std::unique_ptr<sw_msg>& orig, std::unique_ptr<sw_msg>& processed)
+{
+  if (isXferMsg(*orig)) {
+    auto hdr = reinterpret_cast<xfer_hdr*>(orig->payloadData());
+    if (hdr->op == XFER_ACK)
+      sender->ack(*hdr);
+    return FOR_NONE;
+  }
+  processed = std::move(orig);
+  return FOR_LOCAL;
+}
+
+struct reactor_thread
+{
+  msgReactor reactor;
+  bool quit = false;
+  std::thread thread;
+
+  reactor_thread()
+    : reactor(2)
+  {
+    thread = std::thread([this] { reactor.run(quit,1); });
+  }
+
+  // Run fn on the reactor thread and wait for it
+  void
+  call(std::function<void()> fn)
+  {
+    std::atomic<bool> done(false);
+    reactor.defer([&] { fn(); done = true; });
+    while (!done)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  void
+  stop()
+  {
+    if (!thread.joinable())
+      return;
+    reactor.defer([this] { reactor.stop(); });
+    thread.join();
+    reactor.drain();
+  }
+
+  ~reactor_thread()
+  {
+    stop();
+  }
+};
+
+// A local mpd/msd pair serving one board
+struct daemon_pair
+{
+  pcieFunc mpd_dev;
+  pcieFunc msd_dev;
+  int mbx[2];
+  std::vector<int> fds;
+  reactor_thread mpd;
+  reactor_thread msd;
+  std::atomic<int> resets;
+
+  daemon_pair(size_t chunk, int timeout = 5)
+    : mpd_dev(0), msd_dev(0,false), resets(0)
+  {
+    sender = std::make_unique<xferSender>(mpd_dev,hooks(),chunk,timeout);
+    receiver = std::make_unique<xferReceiver>();
+    max_ack_offset = 0;
+    received = 0;
+
+    BOOST_REQUIRE(socketpair(AF_UNIX,SOCK_SEQPACKET,0,mbx)==0);
+    mpd.call([this] { connect(); });
+  }
+
+  // Sender is driven on the socket strand of mpd, a dropped request
+  // is failed to the mailbox
+  xferSender::hooks
+  hooks()
+  {
+    xferSender::hooks cbs;
+    cbs.waitWritable = [this](int fd) {
+      mpd.reactor.defer([this,fd] {
+        mpd.reactor.watchWritable(fd,[this] {
+          mpd.reactor.post(1,[] { sender->writable(); });
+        });
+      });
+    };
+    cbs.wakeAfter = [this](int secs) {
+      mpd.reactor.deferAfter(secs,[this] {
+        mpd.reactor.post(1,[] { sender->expire(); });
+      });
+    };
+    cbs.failed = [this](sw_msg& msg, int err) {
+      sw_msg resp(&err,sizeof(err),msg.id(),MB_REQ_FLAG_RESPONSE);
+      auto ret = write(mbx[0],resp.data(),resp.size());
+      (void)ret;
+    };
+    return cbs;
+  }
+
+  // Runs on mpd reactor thread, as mpd reconnecting to msd
+  void
+  connect()
+  {
+    int sock[2];
+    BOOST_REQUIRE(socketpair(AF_UNIX,SOCK_STREAM,0,sock)==0);
+    make_nonblock(sock[0]);
+    make_nonblock(sock[1]);
+    fds.push_back(sock[0]);
+    fds.push_back(sock[1]);
+    cut_fd = sock[0];
+
+    int mpdfd = sock[0], msdfd = sock[1];
+    msd.reactor.defer([this,msdfd] {
+      msgRoute remote = { REMOTE_MSG, -1, msdfd, msd_handler };
+      msd.reactor.addMsgFd(0,msd_dev,msdfd,false,remote,
+                           [this,msdfd](int) { msd.reactor.removeFd(msdfd); });
+    });
+
+    msgRoute remote = { REMOTE_MSG, mbx[0], mpdfd, mpd_handler };
+    mpd.reactor.addMsgFd(1,mpd_dev,mpdfd,false,remote,[this,mpdfd](int) {
+      mpd.reactor.removeFd(mpdfd);
+      sender->connected(-1);
+      resets++;
+      connect();
+    });
+    sender->connected(mpdfd);
+  }
+
+  // Queue req on the sender as mpd does
+  void
+  submit(const std::vector<char>& req, uint64_t id)
+  {
+    {
+      std::lock_guard<std::mutex> lk(requests_mutex);
+      requests[id] = &req;
+    }
+    auto msg = std::make_unique<sw_msg>(req.data(),req.size(),id,MB_REQ_FLAG_REQUEST);
+    BOOST_REQUIRE(isXclbinReq(*msg));
+    sender->send(std::move(msg));
+  }
+
+  // Next response from msd, which is to request id
+  int
+  response(uint64_t id)
+  {
+    std::vector<char> buf(1024);
+    auto ret = read(mbx[1],buf.data(),buf.size());
+    BOOST_REQUIRE_EQUAL(ret,static_cast<ssize_t>(sizeof(sw_chan)+sizeof(int)));
+    auto sc = reinterpret_cast<sw_chan*>(buf.data());
+    BOOST_CHECK_EQUAL(sc->id,id);
+    BOOST_CHECK(sc->flags & MB_REQ_FLAG_RESPONSE);
+    int resp = 0;
+    std::memcpy(&resp,sc->data,sizeof(resp));
+    return resp;
+  }
+
+  int
+  download(const std::vector<char>& req, uint64_t id)
+  {
+    submit(req,id);
+    return response(id);
+  }
+
+  ~daemon_pair()
+  {
+    mpd.stop();
+    msd.stop();
+    for (int fd : fds)
+      close(fd);
+    close(mbx[0]);
+    close(mbx[1]);
+    sender.reset();
+    receiver.reset();
+    std::lock_guard<std::mutex> lk(requests_mutex);
+    requests.clear();
+  }
+};
+
+}
+
+BOOST_AUTO_TEST_SUITE ( test_xclbin_xfer )
+
+BOOST_AUTO_TEST_CASE( test_xclbin_xfer1 )
+{
+  // Hash is the same however the data is split up, on word boundaries
+  auto data = make_request(1000,1);
+  uint64_t whole = xferHash(data.data(),data.size());
+  uint64_t split = xferHash(data.data()+512,data.size()-512,xferHash(data.data(),512));
+  BOOST_CHECK_EQUAL(whole,split);
+  data[999] ^= 1;
+  BOOST_CHECK(xferHash(data.data(),data.size())!=whole);
+  data[999] ^= 1;
+  data[3] ^= 1;
+  BOOST_CHECK(xferHash(data.data(),data.size())!=whole);
+
+  xferStage stage(1,data.size(),whole);
+  BOOST_REQUIRE(stage.valid());
+  BOOST_REQUIRE_EQUAL(stage.write(data.data(),600),0);
+  BOOST_REQUIRE_EQUAL(stage.write(data.data()+600,400),0);
+  BOOST_CHECK_EQUAL(stage.received,data.size());
+  char* mapped = stage.map();
+  BOOST_REQUIRE(mapped!=nullptr);
+  BOOST_CHECK(std::memcmp(mapped,data.data(),data.size())==0);
+}
+
+BOOST_AUTO_TEST_CASE( test_xclbin_xfer2 )
+{
+  setlogmask(LOG_UPTO(LOG_WARNING));
+  xrt::test::fake_pcie_tree tree(1);
+  xrt::test::roots_guard roots(tree);
+
+  daemon_pair pair(xferChunkSize);
+
+  // Requests of any size, chunks split at any point
+  uint64_t id = 1;
+  for (size_t sz : { size_t(100), xferChunkSize, xferChunkSize+1, size_t(5*xferChunkSize+12345) }) {
+    auto req = make_request(sz,static_cast<char>(sz));
+    BOOST_CHECK_EQUAL(pair.download(req,id),0);
+    ++id;
+  }
+  BOOST_CHECK_EQUAL(pair.resets,0);
+
+  // Throughput of a large xclbin
+  auto req = make_request(256*1024*1024,3);
+  unsigned long time = 0;
+  {
+    xrt::time_guard tg(time);
+    BOOST_CHECK_EQUAL(pair.download(req,id),0);
+  }
+  std::cout << "xclbin transfer of " << req.size()/(1024*1024) << " MB: "
+            << time*1e-6 << " ms, "
+            << req.size()/(time*1e-9)/(1024*1024) << " MB/s\n";
+}
+
+BOOST_AUTO_TEST_CASE( test_xclbin_xfer3 )
+{
+  setlogmask(LOG_UPTO(LOG_CRIT));
+  xrt::test::fake_pcie_tree tree(1);
+  xrt::test::roots_guard roots(tree);
+
+  // Socket reset half way, transfer resumes where msd is
+  const size_t chunk = 64*1024;
+  daemon_pair pair(chunk);
+  auto req = make_request(64*1024*1024,5);
+  cut_at = req.size()/2;
+  BOOST_CHECK_EQUAL(pair.download(req,7),0);
+  BOOST_CHECK_EQUAL(pair.resets,1);
+  BOOST_CHECK(max_ack_offset>=req.size()/4);
+  BOOST_CHECK_EQUAL(max_ack_offset%chunk,0);
+  // Nothing much is sent twice
+  BOOST_CHECK(received<req.size()+req.size()/4);
+
+  // Next transfer starts over
+  max_ack_offset = 0;
+  auto req2 = make_request(3*chunk,6);
+  BOOST_CHECK_EQUAL(pair.download(req2,8),0);
+  BOOST_CHECK_EQUAL(max_ack_offset,0);
+}
+
+BOOST_AUTO_TEST_CASE( test_xclbin_xfer4 )
+{
+  setlogmask(LOG_UPTO(LOG_CRIT));
+  xrt::test::fake_pcie_tree tree(1);
+  xrt::test::roots_guard roots(tree);
+
+  pcieFunc dev(0,false);
+  xferReceiver rcv;
+  const size_t chunk = 4096;
+  auto req = make_request(4*chunk,9);
+  uint64_t hash = xferHash(req.data(),req.size());
+  std::unique_ptr<sw_msg> reply;
+  std::unique_ptr<xferStage> done;
+  uint64_t size = req.size();
+
+  // Transfer msg from mpd straight to the receiver
+  auto recv = [&](uint32_t op, uint32_t session, uint64_t offset, const char* data, size_t len) {
+    xfer_hdr hdr = { op, session, 11, offset, size, hash };
+    std::vector<char> payload(sizeof(hdr)+len);
+    std::memcpy(payload.data(),&hdr,sizeof(hdr));
+    if (len)
+      std::memcpy(payload.data()+sizeof(hdr),data,len);
+    sw_msg msg(payload.data(),payload.size(),11,XFER_MSG_FLAG);
+    reply.reset();
+    done.reset();
+    return rcv.recv(dev,msg,reply,done);
+  };
+  auto response = [&] {
+    BOOST_REQUIRE(reply);
+    BOOST_REQUIRE_EQUAL(reply->payloadSize(),sizeof(int));
+    int ret = 0;
+    std::memcpy(&ret,reply->payloadData(),sizeof(ret));
+    return ret;
+  };
+
+  // Chunk corrupted on the way fails the request at END
+  std::vector<char> bad(req);
+  bad[chunk+100] ^= 1;
+  BOOST_CHECK_EQUAL(recv(XFER_BEGIN,1,0,nullptr,0),FOR_REMOTE);
+  BOOST_REQUIRE(reply && isXferMsg(*reply));
+  for (size_t off=0; off<bad.size(); off+=chunk)
+    BOOST_CHECK_EQUAL(recv(XFER_DATA,1,off,bad.data()+off,chunk),FOR_NONE);
+  BOOST_CHECK_EQUAL(recv(XFER_END,1,req.size(),nullptr,0),FOR_REMOTE);
+  BOOST_CHECK(!done);
+  BOOST_CHECK_EQUAL(response(),-EIO);
+
+  // Chunks out of sequence or of an older session are dropped
+  BOOST_CHECK_EQUAL(recv(XFER_BEGIN,2,0,nullptr,0),FOR_REMOTE);
+  BOOST_CHECK_EQUAL(recv(XFER_DATA,2,0,req.data(),chunk),FOR_NONE);
+  BOOST_CHECK_EQUAL(recv(XFER_DATA,2,2*chunk,req.data()+2*chunk,chunk),FOR_NONE);
+  BOOST_CHECK_EQUAL(recv(XFER_BEGIN,3,0,nullptr,0),FOR_REMOTE);
+  BOOST_REQUIRE(reply && isXferMsg(*reply));
+  BOOST_CHECK_EQUAL(reinterpret_cast<xfer_hdr*>(reply->payloadData())->offset,chunk);
+  BOOST_CHECK_EQUAL(recv(XFER_DATA,2,chunk,req.data()+chunk,chunk),FOR_NONE);
+  BOOST_CHECK_EQUAL(recv(XFER_END,2,req.size(),nullptr,0),FOR_NONE);
+  BOOST_CHECK(!reply && !done);
+
+  // Rest of the chunks in the current session completes the request
+  for (size_t off=chunk; off<req.size(); off+=chunk)
+    BOOST_CHECK_EQUAL(recv(XFER_DATA,3,off,req.data()+off,chunk),FOR_NONE);
+  BOOST_CHECK_EQUAL(recv(XFER_END,3,req.size(),nullptr,0),FOR_NONE);
+  BOOST_REQUIRE(done);
+  BOOST_CHECK_EQUAL(done->xid,11);
+  char* data = done->map();
+  BOOST_REQUIRE(data!=nullptr);
+  BOOST_CHECK(std::memcmp(data,req.data(),req.size())==0);
+
+  // END without transfer
+  BOOST_CHECK_EQUAL(recv(XFER_END,3,req.size(),nullptr,0),FOR_REMOTE);
+  BOOST_CHECK_EQUAL(response(),-EIO);
+
+  // Empty or oversized transfer is refused at BEGIN, nothing is staged
+  for (uint64_t sz : { uint64_t(0), uint64_t(maxMsgSize)+1, ~uint64_t(0) }) {
+    size = sz;
+    BOOST_CHECK_EQUAL(recv(XFER_BEGIN,4,0,nullptr,0),FOR_REMOTE);
+    BOOST_CHECK_EQUAL(response(),-EINVAL);
+    BOOST_CHECK_EQUAL(recv(XFER_DATA,4,0,req.data(),chunk),FOR_NONE);
+    BOOST_CHECK_EQUAL(recv(XFER_END,4,sz,nullptr,0),FOR_REMOTE);
+    BOOST_CHECK_EQUAL(response(),-EIO);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_xclbin_xfer5 )
+{
+  setlogmask(LOG_UPTO(LOG_CRIT));
+  xrt::test::fake_pcie_tree tree(1);
+  xrt::test::roots_guard roots(tree);
+
+  const size_t chunk = 64*1024;
+  daemon_pair pair(chunk,1);
+
+  // Stuck msd fails the request once the sender times out
+  auto req = make_request(3*chunk,12);
+  no_ack = true;
+  unsigned long time = 0;
+  {
+    xrt::time_guard tg(time);
+    BOOST_CHECK_EQUAL(pair.download(req,30),-ETIMEDOUT);
+  }
+  no_ack = false;
+  BOOST_CHECK(time>=1000000000UL);
+  BOOST_CHECK(time<5000000000UL);
+  BOOST_CHECK(sender->idle());
+
+  // Msgs queued during a transfer follow it, nothing gets in between
+  auto big = make_request(64*chunk+100,13);
+  auto small = make_request(chunk/2,14);
+  pair.submit(big,31);
+  pair.submit(small,32);
+  pair.submit(req,33);
+  BOOST_CHECK_EQUAL(pair.response(31),0);
+  BOOST_CHECK_EQUAL(pair.response(32),0);
+  BOOST_CHECK_EQUAL(pair.response(33),0);
+  BOOST_CHECK_EQUAL(pair.resets,0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,286 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+////////////////////////////////////////////////////////////////
+// Unit testing and benchmark of the XMA per device completion thread
+//
+// An emulated device runs submitted exec BOs one at a time, marks
+// them completed and raises an interrupt that wakes xclExecWait.
+// Sessions submit one frame at a time and wait for the completion
+// thread to retire it and notify them, as xma_plg_is_work_item_done
+// does.  Frames/sec and submit-to-notify latency are reported for
+// increasing numbers of sessions.
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+
+#include "lib/xmaapi.h"
+#include "lib/xmahw_lib.h"
+#include "lib/xma_utils.hpp"
+#include "ert.h"
+#include "xrt/util/time.h"
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <deque>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+extern XmaSingleton *g_xma_singleton;
+
+namespace {
+
+// Runs one command at a time for a fixed duration
+struct emulated_device
+{
+  unsigned long duration_ns;
+  std::mutex mutex;
+  std::condition_variable submitted;
+  std::deque<ert_start_kernel_cmd*> queue;
+  std::condition_variable interrupt;
+  unsigned int interrupts = 0;
+  bool stop = false;
+  std::thread thread;
+
+  explicit
+  emulated_device(unsigned long ns)
+    : duration_ns(ns), thread(&emulated_device::run,this)
+  {}
+
+  ~emulated_device()
+  {
+    {
+      std::lock_guard<std::mutex> lk(mutex);
+      stop = true;
+    }
+    submitted.notify_all();
+    thread.join();
+  }
+
+  void
+  run()
+  {
+    while (1) {
+      ert_start_kernel_cmd* cmd = nullptr;
+      {
+        std::unique_lock<std::mutex> lk(mutex);
+        while (!stop && queue.empty())
+          submitted.wait(lk);
+        if (stop)
+          return;
+        cmd = queue.front();
+        queue.pop_front();
+      }
+      auto start = xrt::time_ns();
+      while (xrt::time_ns() - start < duration_ns)
+        ;
+      std::lock_guard<std::mutex> lk(mutex);
+      cmd->state = ERT_CMD_STATE_COMPLETED;
+      ++interrupts;
+      interrupt.notify_all();
+    }
+  }
+
+  void
+  submit(ert_start_kernel_cmd* cmd)
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    queue.push_back(cmd);
+    submitted.notify_one();
+  }
+
+  int
+  exec_wait(int timeout_ms)
+  {
+    std::unique_lock<std::mutex> lk(mutex);
+    interrupt.wait_for(lk,std::chrono::milliseconds(timeout_ms),[this] { return interrupts>0; });
+    auto count = interrupts;
+    interrupts = 0;
+    return count;
+  }
+};
+
+// XMA device with execbos backed by host memory, the device handle
+// is the emulated device
+struct xma_device
+{
+  emulated_device emulated;
+  XmaHwDevice device;
+  std::vector<std::vector<char>> data;
+  std::thread completion;
+
+  xma_device(unsigned long duration_ns, int32_t num_execbo)
+    : emulated(duration_ns), data(num_execbo,std::vector<char>(MAX_EXECBO_BUFF_SIZE))
+  {
+    device.handle = &emulated;
+    device.kernel_execbos.resize(num_execbo);
+    for (int32_t d = num_execbo - 1; d >= 0; d--) {
+      device.kernel_execbos[d].data = data[d].data();
+      device.execbo_free.emplace_back(d);
+    }
+    device.num_execbo_allocated = num_execbo;
+    device.execbo_inflight.reserve(num_execbo);
+    completion = std::thread(xma_core::utils::execbo_completion,&device);
+  }
+
+  ~xma_device()
+  {
+    g_xma_singleton->xma_exit = true;
+    completion.join();
+    g_xma_singleton->xma_exit = false;
+  }
+
+  // Acquire an execbo and submit it on behalf of session
+  void
+  submit(XmaHwSessionPrivate* priv, int32_t session_id)
+  {
+    ert_start_kernel_cmd* cmd = nullptr;
+    {
+      std::lock_guard<std::mutex> lk(*device.execbo_mutex);
+      if (device.execbo_free.empty())
+        throw std::runtime_error("no free execbo");
+      int32_t bo_idx = device.execbo_free.back();
+      device.execbo_free.pop_back();
+
+      XmaHwExecBO& execbo = device.kernel_execbos[bo_idx];
+      execbo.in_use = true;
+      execbo.session_id = session_id;
+      execbo.cu_cmd_id1 = device.cu_cmd_id++;
+      cmd = (ert_start_kernel_cmd*)execbo.data;
+      cmd->state = ERT_CMD_STATE_NEW;
+
+      XmaCUCmdObjPrivate cmd_obj;
+      cmd_obj.execbo_id = bo_idx;
+      priv->CU_cmds.emplace(execbo.cu_cmd_id1,cmd_obj);
+      xma_core::utils::track_execbo(&device,bo_idx,priv,true);
+    }
+    emulated.submit(cmd);
+  }
+
+  // Wait for completion thread to retire a work item of session
+  void
+  wait(XmaHwSessionPrivate* priv)
+  {
+    std::unique_lock<std::mutex> lk(*device.execbo_mutex);
+    while (priv->kernel_complete_count == 0)
+      priv->work_item_cond.wait(lk);
+    priv->kernel_complete_count--;
+  }
+
+  size_t
+  num_free()
+  {
+    std::lock_guard<std::mutex> lk(*device.execbo_mutex);
+    return device.execbo_free.size();
+  }
+};
+
+// Each session submits frames one at a time, returns sorted latencies
+// of all frames.  Sessions left with commands in flight are counted
+// in leftover.
+static std::vector<unsigned long>
+run_sessions(xma_device& dev, int32_t sessions, size_t frames, std::atomic<int>& leftover)
+{
+  std::vector<std::vector<unsigned long>> latencies(sessions);
+  std::vector<std::thread> threads;
+  for (int32_t s = 0; s < sessions; s++) {
+    threads.emplace_back([&dev,&latencies,&leftover,s,frames] {
+      XmaHwSessionPrivate priv;
+      priv.device = &dev.device;
+      latencies[s].reserve(frames);
+      for (size_t f = 0; f < frames; f++) {
+        auto start = xrt::time_ns();
+        dev.submit(&priv,s);
+        dev.wait(&priv);
+        latencies[s].push_back(xrt::time_ns() - start);
+      }
+      std::lock_guard<std::mutex> lk(*dev.device.execbo_mutex);
+      if (!priv.CU_cmds.empty())
+        ++leftover;
+    });
+  }
+  for (auto& t : threads)
+    t.join();
+
+  std::vector<unsigned long> all;
+  for (auto& l : latencies)
+    all.insert(all.end(),l.begin(),l.end());
+  std::sort(all.begin(),all.end());
+  return all;
+}
+
+}
+
+// xclExecWait is resolved from the XRT driver library that XMA loads
+// at run time, here it waits on the emulated device
+int
+xclExecWait(xclDeviceHandle handle, int timeoutMilliSec)
+{
+  return static_cast<emulated_device*>(handle)->exec_wait(timeoutMilliSec);
+}
+
+BOOST_AUTO_TEST_SUITE ( test_xma_completion )
+
+BOOST_AUTO_TEST_CASE( test_xma_completion1 )
+{
+  int32_t sessions = 32;
+  size_t frames = 200;
+  xma_device dev(1000,64);
+
+  std::atomic<int> leftover {0};
+  auto latency = run_sessions(dev,sessions,frames,leftover);
+  BOOST_CHECK_EQUAL(latency.size(),sessions*frames);
+  BOOST_CHECK_EQUAL(leftover,0);
+  BOOST_CHECK_EQUAL(dev.num_free(),64);
+
+  // A session destroyed with a command in flight is detached, the
+  // command still retires and its execbo is released
+  {
+    XmaHwSessionPrivate priv;
+    priv.device = &dev.device;
+    dev.submit(&priv,sessions);
+  }
+  for (int i = 0; i < 1000 && dev.num_free() != 64; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  BOOST_CHECK_EQUAL(dev.num_free(),64);
+  std::lock_guard<std::mutex> lk(*dev.device.execbo_mutex);
+  BOOST_CHECK(dev.device.execbo_inflight.empty());
+}
+
+BOOST_AUTO_TEST_CASE( test_xma_completion2 )
+{
+  unsigned long duration_ns = 20000;   // 20us per frame
+  size_t frames = 2000;
+
+  std::cout << "XMA frames with " << duration_ns/1000 << " us device time\n";
+  for (int32_t sessions : {1, 8, 32}) {
+    xma_device dev(duration_ns,64);
+    std::atomic<int> leftover {0};
+    auto start = xrt::time_ns();
+    auto latency = run_sessions(dev,sessions,frames/sessions,leftover);
+    auto elapsed = xrt::time_ns() - start;
+    std::cout << "sessions: " << sessions
+              << " frames/sec: " << latency.size()*1e9/elapsed
+              << " p50: " << latency[latency.size()/2]/1000.0 << " us"
+              << " p99: " << latency[latency.size()*99/100]/1000.0 << " us\n";
+    BOOST_CHECK_EQUAL(leftover,0);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
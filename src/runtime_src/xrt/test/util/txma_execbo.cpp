@@ -0,0 +1,243 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+////////////////////////////////////////////////////////////////
+// Unit testing and microbenchmark of XMA exec BO allocation
+//
+// Session threads acquire an exec BO, track it as in flight, and
+// retire it as the completion thread does, all under the device
+// execbo mutex as the XMA plugin layer does.  Each session keeps a number
+// of commands in flight so that most exec BOs are in use.  The free
+// list and in-flight position are compared against the scan based
+// allocation and in-flight search they replaced.
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+
+#include "lib/xmaapi.h"
+#include "lib/xmahw_lib.h"
+#include "lib/xma_utils.hpp"
+#include "ert.h"
+#include "xrt/util/time.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <deque>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <cstring>
+
+namespace {
+
+struct xma_device
+{
+  XmaHwDevice device;
+  std::vector<std::vector<char>> data;
+
+  explicit
+  xma_device(int32_t num_execbo)
+    : data(num_execbo,std::vector<char>(MAX_EXECBO_BUFF_SIZE))
+  {
+    device.kernel_execbos.resize(num_execbo);
+    for (int32_t d = num_execbo - 1; d >= 0; d--) {
+      device.kernel_execbos[d].data = data[d].data();
+      device.execbo_free.emplace_back(d);
+    }
+    device.num_execbo_allocated = num_execbo;
+    device.execbo_inflight.reserve(num_execbo);
+  }
+};
+
+// Free list allocation, as xma_plg_execbo_avail_get
+static int32_t
+free_list_acquire(XmaHwDevice* dev)
+{
+  if (dev->execbo_free.empty())
+    return -1;
+  int32_t bo_idx = dev->execbo_free.back();
+  dev->execbo_free.pop_back();
+  dev->kernel_execbos[bo_idx].in_use = true;
+  return bo_idx;
+}
+
+// Scan for first unused exec BO, as before the free list
+static int32_t
+scan_acquire(XmaHwDevice* dev)
+{
+  for (int32_t d = 0; d < dev->num_execbo_allocated; d++) {
+    if (!dev->kernel_execbos[d].in_use) {
+      dev->kernel_execbos[d].in_use = true;
+      return d;
+    }
+  }
+  return -1;
+}
+
+// Search and erase from in-flight list, as before inflight_pos
+static void
+scan_retire(XmaHwDevice* dev, XmaHwSessionPrivate* priv, int32_t bo_idx)
+{
+  XmaHwExecBO& execbo = dev->kernel_execbos[bo_idx];
+  priv->CU_cmds.erase(execbo.cu_cmd_id1);
+  auto& inflight = dev->execbo_inflight;
+  inflight.erase(std::find(inflight.begin(),inflight.end(),bo_idx));
+  execbo.in_use = false;
+}
+
+// Each session keeps depth commands in flight, retiring the oldest
+// before submitting the next.  Returns ns per submit+retire.
+static double
+run_sessions(xma_device& xdev, int32_t sessions, int32_t depth, size_t cmds, bool free_list)
+{
+  auto dev = &xdev.device;
+  std::atomic<int> errors {0};
+  std::vector<std::thread> threads;
+  auto start = xrt::time_ns();
+  for (int32_t s = 0; s < sessions; s++) {
+    threads.emplace_back([dev,s,depth,cmds,free_list,&errors] {
+      XmaHwSessionPrivate priv;
+      priv.device = dev;
+
+      std::deque<int32_t> inflight;
+      for (size_t c = 0; c < cmds + depth; c++) {
+        std::lock_guard<std::mutex> lk(*dev->execbo_mutex);
+        if (!inflight.empty() && (inflight.size() == (size_t)depth || c >= cmds)) {
+          // Oldest command completes and is retired
+          int32_t bo_idx = inflight.front();
+          inflight.pop_front();
+          ((ert_start_kernel_cmd*)dev->kernel_execbos[bo_idx].data)->state = ERT_CMD_STATE_COMPLETED;
+          if (free_list)
+            xma_core::utils::retire_execbo(dev,bo_idx);
+          else
+            scan_retire(dev,&priv,bo_idx);
+        }
+        if (c >= cmds)
+          continue;
+
+        int32_t bo_idx = free_list ? free_list_acquire(dev) : scan_acquire(dev);
+        if (bo_idx < 0) {
+          ++errors;
+          continue;
+        }
+        XmaHwExecBO& execbo = dev->kernel_execbos[bo_idx];
+        execbo.session_id = s;
+        execbo.cu_cmd_id1 = dev->cu_cmd_id++;
+        ((ert_start_kernel_cmd*)execbo.data)->state = ERT_CMD_STATE_NEW;
+        XmaCUCmdObjPrivate cmd_obj;
+        cmd_obj.execbo_id = bo_idx;
+        priv.CU_cmds.emplace(execbo.cu_cmd_id1,cmd_obj);
+        if (free_list)
+          xma_core::utils::track_execbo(dev,bo_idx,&priv,true);
+        else
+          dev->execbo_inflight.emplace_back(bo_idx);
+        inflight.push_back(bo_idx);
+      }
+      if (!priv.CU_cmds.empty())
+        ++errors;
+    });
+  }
+  for (auto& t : threads)
+    t.join();
+  auto elapsed = xrt::time_ns() - start;
+
+  BOOST_CHECK_EQUAL(errors,0);
+  BOOST_CHECK(dev->execbo_inflight.empty());
+  return static_cast<double>(elapsed)/(sessions*cmds);
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE ( test_xma_execbo )
+
+BOOST_AUTO_TEST_CASE( test_xma_execbo1 )
+{
+  int32_t num_execbo = 64;
+  xma_device xdev(num_execbo);
+  auto dev = &xdev.device;
+
+  // Exec BOs retired out of order keep in-flight positions consistent
+  run_sessions(xdev,8,num_execbo/8,1000,true);
+  BOOST_CHECK_EQUAL(dev->execbo_free.size(),num_execbo);
+  for (auto& execbo : dev->kernel_execbos) {
+    BOOST_CHECK(!execbo.in_use);
+    BOOST_CHECK_EQUAL(execbo.inflight_pos,-1);
+    BOOST_CHECK(execbo.session_priv == NULL);
+  }
+
+  // Session retires its completed commands out of submission order
+  XmaHwSessionPrivate priv;
+  priv.device = dev;
+  XmaSession session;
+  std::memset(&session,0,sizeof(session));
+  session.session_id = 0;
+  session.hw_session.private_do_not_use = &priv;
+  std::vector<int32_t> submitted;
+  for (int32_t c = 0; c < 8; c++) {
+    int32_t bo_idx = free_list_acquire(dev);
+    XmaHwExecBO& execbo = dev->kernel_execbos[bo_idx];
+    execbo.session_id = 0;
+    execbo.cu_cmd_id1 = dev->cu_cmd_id++;
+    ((ert_start_kernel_cmd*)execbo.data)->state = (c % 3) ? ERT_CMD_STATE_NEW : ERT_CMD_STATE_COMPLETED;
+    XmaCUCmdObjPrivate cmd_obj;
+    cmd_obj.execbo_id = bo_idx;
+    priv.CU_cmds.emplace(execbo.cu_cmd_id1,cmd_obj);
+    xma_core::utils::track_execbo(dev,bo_idx,&priv,true);
+    submitted.push_back(bo_idx);
+  }
+  BOOST_CHECK_EQUAL(xma_core::utils::check_all_execbo(session),XMA_SUCCESS);
+  BOOST_CHECK_EQUAL(priv.kernel_complete_count,3);
+  BOOST_CHECK_EQUAL(priv.CU_cmds.size(),5);
+  BOOST_CHECK_EQUAL(dev->execbo_inflight.size(),5);
+  for (size_t pos = 0; pos < dev->execbo_inflight.size(); pos++)
+    BOOST_CHECK_EQUAL(dev->kernel_execbos[dev->execbo_inflight[pos]].inflight_pos,pos);
+  for (auto bo_idx : submitted)
+    ((ert_start_kernel_cmd*)dev->kernel_execbos[bo_idx].data)->state = ERT_CMD_STATE_COMPLETED;
+  BOOST_CHECK_EQUAL(xma_core::utils::check_all_execbo(session),XMA_SUCCESS);
+  BOOST_CHECK(dev->execbo_inflight.empty());
+  BOOST_CHECK_EQUAL(dev->execbo_free.size(),num_execbo);
+
+  // Free list hands out every exec BO exactly once
+  std::vector<int32_t> acquired;
+  for (int32_t bo_idx; (bo_idx = free_list_acquire(dev)) >= 0; )
+    acquired.push_back(bo_idx);
+  std::sort(acquired.begin(),acquired.end());
+  BOOST_CHECK_EQUAL(acquired.size(),num_execbo);
+  BOOST_CHECK(std::adjacent_find(acquired.begin(),acquired.end())==acquired.end());
+  for (auto bo_idx : acquired)
+    xma_core::utils::release_execbo(dev,bo_idx);
+  BOOST_CHECK_EQUAL(dev->execbo_free.size(),num_execbo);
+}
+
+BOOST_AUTO_TEST_CASE( test_xma_execbo2 )
+{
+  int32_t sessions = 16;
+  size_t cmds = 20000;
+
+  std::cout << "XMA exec BO submit+retire, " << sessions << " sessions (ns/cmd)\n";
+  std::cout << "execbos   scan   free list\n";
+  for (int32_t num_execbo : {32, 128, 512}) {
+    // Keep all but one exec BO per session in flight
+    int32_t depth = num_execbo/sessions - 1;
+    xma_device scan_dev(num_execbo);
+    auto scan = run_sessions(scan_dev,sessions,depth,cmds,false);
+    xma_device free_dev(num_execbo);
+    auto free_list = run_sessions(free_dev,sessions,depth,cmds,true);
+    std::cout << num_execbo << "\t" << scan << "\t" << free_list << "\n";
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
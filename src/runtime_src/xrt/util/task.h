@@ -28,6 +28,11 @@
 #include <mutex>
 #include <condition_variable>
 #include <iostream>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <exception>
+#include <algorithm>
 
 namespace xrt { namespace task {
 
@@ -385,6 +390,45 @@ worker(queue& q)
 {
   return worker2(q,"");
 }
+
+/**
+ * Call f(idx) for each idx in [0,count) on at most max_threads
+ * threads and wait for all calls to complete.
+ *
+ * The calling thread is one of the threads.  Indices are handed out
+ * in order as threads become available.  If any call throws, then
+ * all remaining calls still complete, after which the exception of
+ * the lowest failing index is rethrown.
+ */
+template <typename F>
+void
+parallel_for(size_t count, unsigned int max_threads, F&& f)
+{
+  std::vector<std::exception_ptr> errors(count);
+  std::atomic<size_t> next {0};
+  auto run = [&] {
+    for (size_t idx=next++; idx<count; idx=next++) {
+      try {
+        f(idx);
+      }
+      catch (...) {
+        errors[idx] = std::current_exception();
+      }
+    }
+  };
+
+  auto threads = std::min<size_t>(count,std::max(max_threads,1u));
+  std::vector<std::thread> workers;
+  for (size_t t=1; t<threads; ++t)
+    workers.emplace_back(run);
+  run();
+  for (auto& w : workers)
+    w.join();
+
+  for (auto& e : errors)
+    if (e)
+      std::rethrow_exception(e);
+}
 }} // task,xrt
 
 #endif
@@ -17,6 +17,11 @@
 #include "xrt/device/device.h"
 #include "xrt/scheduler/command.h"
 
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <algorithm>
+
 namespace xrtcpp {
 
 inline index_type
@@ -77,6 +82,57 @@ get_device_handle(const xrt_device* device)
 
 namespace exec {
 
+/**
+ * A wait_any call
+ *
+ * The waiter is registered with each command it waits for, and is
+ * woken only when one of those commands completes.
+ */
+class waiter
+{
+  const std::vector<command>& m_cmds;
+  std::mutex m_mutex;
+  std::condition_variable m_cond;
+  bool m_notified = false;
+
+public:
+  explicit
+  waiter(const std::vector<command>& cmds);
+
+  ~waiter();
+
+  void
+  notify()
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_notified = true;
+    m_cond.notify_one();
+  }
+
+  /**
+   * Wait for any command to complete
+   *
+   * @deadline: time to give up, or nullptr to wait forever
+   * Return: index of first completed command, or size of commands
+   *   if none completed before @deadline
+   */
+  size_t
+  wait(const std::chrono::steady_clock::time_point* deadline)
+  {
+    std::unique_lock<std::mutex> lk(m_mutex);
+    while (1) {
+      m_notified = false;
+      for (size_t i=0; i<m_cmds.size(); ++i)
+        if (m_cmds[i].completed())
+          return i;
+      if (!deadline)
+        m_cond.wait(lk,[this] { return m_notified; });
+      else if (!m_cond.wait_until(lk,*deadline,[this] { return m_notified; }))
+        return m_cmds.size();
+    }
+  }
+};
+
 struct command::impl : xrt::command
 {
   impl(xrt::device* device, ert_cmd_opcode opcode)
@@ -86,12 +142,53 @@ struct command::impl : xrt::command
     ert_pkt = get_ert_cmd<ert_packet*>();
   }
 
+  virtual void
+  done() const
+  {
+    std::lock_guard<std::mutex> lk(m_waiters_mutex);
+    for (auto w : m_waiters)
+      w->notify();
+  }
+
+  void
+  add_waiter(waiter* w)
+  {
+    std::lock_guard<std::mutex> lk(m_waiters_mutex);
+    m_waiters.push_back(w);
+  }
+
+  void
+  remove_waiter(waiter* w)
+  {
+    std::lock_guard<std::mutex> lk(m_waiters_mutex);
+    m_waiters.erase(std::find(m_waiters.begin(),m_waiters.end(),w));
+  }
+
   union {
     ert_packet* ert_pkt;
     ert_start_kernel_cmd* ert_cu;
   };
+
+  // wait_any calls waiting for this command
+  mutable std::mutex m_waiters_mutex;
+  std::vector<waiter*> m_waiters;
 };
 
+waiter::
+waiter(const std::vector<command>& cmds)
+  : m_cmds(cmds)
+{
+  for (auto& cmd : m_cmds)
+    cmd.m_impl->add_waiter(this);
+}
+
+waiter::
+~waiter()
+{
+  for (auto& cmd : m_cmds)
+    cmd.m_impl->remove_waiter(this);
+}
+
 command::
 command(xrt_device* device, ert_cmd_opcode opcode)
   : m_impl(std::make_shared<impl>(static_cast<xrt::device*>(device),opcode))
@@ -214,4 +311,148 @@ clear()
   m_impl->ert_pkt->count = 1 + 4 + 2; 
 }
 
+struct exec_cu_launch::impl
+{
+  std::vector<exec_cu_command> m_cmds;
+  std::vector<bool> m_submitted;
+  unsigned int m_next = 0;
+
+  // Current register map values, and for each command in the ring the
+  // indices that have changed since that command was last submitted
+  std::vector<value_type> m_regmap;
+  std::vector<std::vector<index_type>> m_dirty;
+  std::vector<std::vector<bool>> m_is_dirty;
+
+  impl(xrt_device* device, const std::vector<value_type>& cus, index_type regmap_size, unsigned int depth)
+    : m_submitted(depth,false)
+    , m_regmap(regmap_size,0)
+    , m_dirty(depth)
+    , m_is_dirty(depth,std::vector<bool>(regmap_size,false))
+  {
+    if (!depth)
+      throw std::runtime_error("exec_cu_launch depth must be at least 1");
+
+    // Layout of each command is fixed here, all CUs are added before
+    // any payload so the payload is never shifted
+    m_cmds.reserve(depth);
+    for (unsigned int i=0; i<depth; ++i) {
+      m_cmds.emplace_back(device);
+      auto& cmd = m_cmds.back();
+      for (auto cuidx : cus)
+        cmd.add_cu(cuidx);
+      if (regmap_size)
+        cmd.add(regmap_size-1,0);
+    }
+  }
+
+  void
+  set_arg(index_type idx, value_type value)
+  {
+    if (idx >= m_regmap.size())
+      throw std::runtime_error("Bad register map index : " + std::to_string(idx));
+    if (m_regmap[idx] == value)
+      return;
+    m_regmap[idx] = value;
+    for (size_t i=0; i<m_cmds.size(); ++i) {
+      if (m_is_dirty[i][idx])
+        continue;
+      m_is_dirty[i][idx] = true;
+      m_dirty[i].push_back(idx);
+    }
+  }
+
+  command
+  submit()
+  {
+    auto i = m_next;
+    m_next = (m_next + 1) % m_cmds.size();
+
+    auto& cmd = m_cmds[i];
+    if (m_submitted[i])
+      cmd.wait();
+
+    for (auto idx : m_dirty[i]) {
+      cmd.add(idx,m_regmap[idx]);
+      m_is_dirty[i][idx] = false;
+    }
+    m_dirty[i].clear();
+
+    cmd.execute();
+    m_submitted[i] = true;
+    return cmd;
+  }
+
+  void
+  wait()
+  {
+    for (size_t i=0; i<m_cmds.size(); ++i)
+      if (m_submitted[i])
+        m_cmds[i].wait();
+  }
+};
+
+exec_cu_launch::
+exec_cu_launch(xrt_device* device, const std::vector<value_type>& cus, index_type regmap_size, unsigned int depth)
+  : m_impl(std::make_shared<impl>(device,cus,regmap_size,depth))
+{}
+
+void
+exec_cu_launch::
+set_arg(index_type idx, value_type value)
+{
+  m_impl->set_arg(idx,value);
+}
+
+command
+exec_cu_launch::
+submit()
+{
+  return m_impl->submit();
+}
+
+void
+exec_cu_launch::
+wait()
+{
+  m_impl->wait();
+}
+
+void
+execute(const std::vector<command>& cmds)
+{
+  std::vector<std::shared_ptr<xrt::command>> xcmds;
+  xcmds.reserve(cmds.size());
+  for (auto& cmd : cmds)
+    xcmds.push_back(cmd.m_impl);
+  xrt::command::execute(xcmds);
+}
+
+void
+wait(const std::vector<command>& cmds)
+{
+  for (auto cmd : cmds)
+    cmd.wait();
+}
+
+size_t
+wait_any(const std::vector<command>& cmds)
+{
+  if (cmds.empty())
+    throw std::runtime_error("wait_any requires at least one command");
+
+  waiter w(cmds);
+  return w.wait(nullptr);
+}
+
+size_t
+wait_any(const std::vector<command>& cmds, unsigned int timeout_ms)
+{
+  if (cmds.empty())
+    throw std::runtime_error("wait_any requires at least one command");
+
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+  waiter w(cmds);
+  return w.wait(&deadline);
+}
+
 }} // exec,xrt
@@ -21,6 +21,7 @@
 #ifndef _XRT_XRTEXEC_H_
 #define _XRT_XRTEXEC_H_
 #include <memory>
+#include <vector>
 #include "ert.h"
 #include "xrt.h"
 
@@ -94,6 +95,8 @@ public:
   ert_cmd_state
   state() const;
 
+  friend void execute(const std::vector<command>& cmds);
+  friend class waiter;
 };
 
 /**
@@ -191,5 +194,104 @@ public:
   clear();
 };
 
+/**
+ * class exec_cu_launch : reusable ERT_START_CU launch
+ *
+ * A launch object is built once for a set of CUs and a register map
+ * size.  Individual register map entries (kernel arguments) can then
+ * be patched in place between submissions without rebuilding the
+ * command.
+ *
+ * The launch object owns @depth exec_cu_commands that are used in
+ * round robin order, so a new submission can be prepared and submitted
+ * while up to @depth-1 previous submissions are still running.  If
+ * the next command in the ring is still running, submit waits for it
+ * to complete before reusing it.
+ */
+class exec_cu_launch
+{
+  struct impl;
+  std::shared_ptr<impl> m_impl;
+
+public:
+  /**
+   * @dev: device on which to launch
+   * @cus: indices of cus to execute, max 128 CUs indexed [0..127]
+   * @regmap_size: number of register map entries including the 4
+   *   control registers
+   * @depth: number of commands that can be in flight concurrently
+   */
+  exec_cu_launch(xrt_device* dev, const std::vector<value_type>& cus,
+                 index_type regmap_size, unsigned int depth=2);
+
+  /**
+   * Set register map entry for subsequent submissions
+   *
+   * @index: register map index, see exec_cu_command::add.
+   * @value: value to write
+   *
+   * The value is written to each command in the ring when that command
+   * is next submitted.  Only changed entries are written.
+   */
+  void
+  set_arg(index_type idx, value_type value);
+
+  /**
+   * Submit the launch with current register map values
+   *
+   * Return: the submitted command, which can be waited on.  The
+   *   command object is reused by the launch after @depth more
+   *   submissions.
+   *
+   * Throws on error
+   */
+  command
+  submit();
+
+  /**
+   * Wait for all submitted commands of this launch to complete
+   */
+  void
+  wait();
+};
+
+/**
+ * Execute a batch of commands in one call
+ *
+ * @cmds: commands to execute, submitted in order
+ *
+ * Submission overhead is amortized over the batch.  Throws on error.
+ */
+void
+execute(const std::vector<command>& cmds);
+
+/**
+ * Wait for all commands to complete
+ *
+ * @cmds: commands to wait for
+ */
+void
+wait(const std::vector<command>& cmds);
+
+/**
+ * Wait for any of a number of commands to complete
+ *
+ * @cmds: commands to wait for
+ * Return: index in @cmds of first completed command found
+ */
+size_t
+wait_any(const std::vector<command>& cmds);
+
+/**
+ * Wait for any of a number of commands to complete, with timeout
+ *
+ * @cmds: commands to wait for
+ * @timeout_ms: max time to wait in milliseconds
+ * Return: index in @cmds of first completed command found, or
+ *   cmds.size() if none completed within @timeout_ms
+ */
+size_t
+wait_any(const std::vector<command>& cmds, unsigned int timeout_ms);
+
 }} //exec, xrtcpp
 #endif
@@ -23,6 +23,18 @@ int32_t load_libxrt();
 
 int32_t check_all_execbo(XmaSession s_handle);
 
+//Record submitted execbo as in flight on device. execbo lock must be held
+void track_execbo(XmaHwDevice* dev, int32_t execbo_id, XmaHwSessionPrivate* priv, bool count_completion);
+
+//Return execbo to device free list. execbo lock must be held
+void release_execbo(XmaHwDevice* dev, int32_t execbo_id);
+
+//Retire completed execbo and notify its session. execbo lock must be held
+void retire_execbo(XmaHwDevice* dev, int32_t execbo_id);
+
+//Per device completion thread. Waits for ERT completions and notifies sessions
+void execbo_completion(XmaHwDevice* dev);
+
 } // namespace utils
 } // namespace xma_core
 
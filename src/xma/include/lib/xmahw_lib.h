@@ -26,7 +26,11 @@
 #include "app/xmaparam.h"
 #include "plg/xmasess.h"
 #include "xrt.h"
+#include "core/common/config_reader.h"
+#include "core/common/adaptive_poll.h"
 #include <atomic>
+#include <mutex>
+#include <condition_variable>
 #include <vector>
 #include <memory>
 #include <unordered_map>
@@ -79,7 +83,8 @@ typedef struct XmaHwSessionPrivate
     //For execbo:
     uint32_t        kernel_complete_count;
     XmaHwDevice     *device;
-    std::unordered_map<uint32_t, XmaCUCmdObjPrivate> CU_cmds;//Use execbo lock when accessing this map
+    std::unordered_map<uint32_t, XmaCUCmdObjPrivate> CU_cmds;//Use execbo mutex when accessing this map
+    std::condition_variable work_item_cond;//Notified with execbo mutex held when a command of this session completes
     std::atomic<uint32_t> cmd_load;
     bool     using_work_item_done;
     bool     using_cu_cmd_status;
@@ -95,6 +100,7 @@ typedef struct XmaHwSessionPrivate
    using_work_item_done = false;
    using_cu_cmd_status = false;
   }
+  ~XmaHwSessionPrivate();
 } XmaHwSessionPrivate;
 
 typedef struct XmaBufferObjPrivate
@@ -195,6 +201,9 @@ typedef struct XmaHwExecBO
     int32_t     session_id;
     uint32_t    cu_cmd_id1;//Counter
     int32_t     cu_cmd_id2;//Random num
+    XmaHwSessionPrivate* session_priv;//Owner of in-flight command; NULL once owner is destroyed
+    bool        count_completion;//Completion counts as finished work item of owner
+    int32_t     inflight_pos;//Position in device execbo_inflight; -1 if not in flight
 
     uint32_t    reserved[16];
 
@@ -206,6 +215,9 @@ typedef struct XmaHwExecBO
     cu_cmd_id1 = 0;
     cu_cmd_id2 = 0;
     session_id = -1;
+    session_priv = NULL;
+    count_completion = false;
+    inflight_pos = -1;
   }
 } XmaHwExecBO;
 
@@ -224,8 +236,12 @@ typedef struct XmaHwDevice
     std::vector<XmaHwKernel> kernels;
     std::vector<XmaHwMem> ddrs;
 
-    std::unique_ptr<std::atomic<bool>> execbo_locked;
+    std::unique_ptr<std::mutex> execbo_mutex;//Guards execbos and CU_cmds of all sessions on this device
+    std::unique_ptr<std::condition_variable> execbo_submitted;//Wakes idle completion thread
+    std::unique_ptr<xrt_core::adaptive_poll> completion_poll;//Poll window for work item completion
     std::vector<XmaHwExecBO> kernel_execbos;
+    std::vector<int32_t> execbo_free;//Indices of execbos not in use
+    std::vector<int32_t> execbo_inflight;//Indices of submitted execbos, scanned by completion thread
     int32_t    num_execbo_allocated;
 
     uint32_t    cu_cmd_id;//Counter
@@ -235,11 +251,10 @@ typedef struct XmaHwDevice
     uint32_t    reserved[16];
 
 //  XmaHwDevice(): execbo_locked(new std::atomic<bool>), mt_gen(std::mt19937(std::seed_seq(static_cast<long unsigned int>(time(0)), std::random_device()))), rnd_dis(-97986387, 97986387) {
-  XmaHwDevice(): execbo_locked(new std::atomic<bool>), rnd_dis(-97986387, 97986387) {
+  XmaHwDevice(): execbo_mutex(new std::mutex), execbo_submitted(new std::condition_variable), completion_poll(new xrt_core::adaptive_poll(xrt_core::config::get_poll_window())), rnd_dis(-97986387, 97986387) {
     //in_use = false;
     dev_index = -1;
     number_of_cus = 0;
-    *execbo_locked = false;
     number_of_mem_banks = 0;
     num_execbo_allocated = -1;
     handle = NULL;
@@ -253,6 +268,16 @@ typedef struct XmaHwDevice
   }
 } XmaHwDevice;
 
+//Commands still in flight complete without their owner
+inline XmaHwSessionPrivate::~XmaHwSessionPrivate() {
+  if (device == NULL)
+    return;
+  std::lock_guard<std::mutex> lk(*device->execbo_mutex);
+  for (auto& itr1: CU_cmds) {
+    device->kernel_execbos[itr1.second.execbo_id].session_priv = NULL;
+  }
+}
+
 typedef struct XmaHwCfg
 {
     int32_t     num_devices;
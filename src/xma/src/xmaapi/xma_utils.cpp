@@ -25,6 +25,7 @@
 #include <boost/filesystem/operations.hpp>
 #include <boost/filesystem/path.hpp>
 #include <iostream>
+#include <chrono>
 
 #define XMAUTILS_MOD "xmautils"
 
@@ -214,54 +215,131 @@ void get_session_cmd_load() {
    }
 }
 
+void release_execbo(XmaHwDevice* dev, int32_t execbo_id) {
+    //NOTE: execbo lock must be already obtained
+    XmaHwExecBO& execbo = dev->kernel_execbos[execbo_id];
+    if (!execbo.in_use) {
+        return;
+    }
+    execbo.in_use = false;
+    dev->execbo_free.emplace_back(execbo_id);
+}
+
+//Release a completed execbo and wake up session waiting on it
+//NOTE: execbo lock must be already obtained
+void retire_execbo(XmaHwDevice* dev, int32_t execbo_id) {
+    XmaHwExecBO& execbo = dev->kernel_execbos[execbo_id];
+    XmaHwSessionPrivate *priv1 = execbo.session_priv;
+    if (priv1 != NULL) {
+        priv1->CU_cmds.erase(execbo.cu_cmd_id1);
+        if (execbo.count_completion) {
+            priv1->kernel_complete_count++;
+        }
+        priv1->work_item_cond.notify_all();
+    }
+    execbo.session_priv = NULL;
+    execbo.count_completion = false;
+
+    //Swap with last in flight execbo
+    auto& inflight = dev->execbo_inflight;
+    if (execbo.inflight_pos >= 0) {
+        int32_t last = inflight.back();
+        inflight[execbo.inflight_pos] = last;
+        dev->kernel_execbos[last].inflight_pos = execbo.inflight_pos;
+        inflight.pop_back();
+        execbo.inflight_pos = -1;
+    }
+    release_execbo(dev, execbo_id);
+}
+
+void track_execbo(XmaHwDevice* dev, int32_t execbo_id, XmaHwSessionPrivate* priv, bool count_completion) {
+    //NOTE: execbo lock must be already obtained
+    XmaHwExecBO& execbo = dev->kernel_execbos[execbo_id];
+    execbo.session_priv = priv;
+    execbo.count_completion = count_completion;
+    execbo.inflight_pos = dev->execbo_inflight.size();
+    dev->execbo_inflight.emplace_back(execbo_id);
+    if (dev->execbo_inflight.size() == 1) {
+        //Wake up idle completion thread
+        dev->execbo_submitted->notify_one();
+    }
+}
+
 int32_t check_all_execbo(XmaSession s_handle) {
     //NOTE: execbo lock must be already obtained
     //Check only for commands in this sessions else too much checking will waste CPU cycles
 
     XmaHwSessionPrivate *priv1 = (XmaHwSessionPrivate*) s_handle.hw_session.private_do_not_use;
     XmaHwDevice *dev_tmp1 = priv1->device;
+    std::vector<int32_t> completed;
 
-    if (!priv1->CU_cmds.empty()) {
-        for (auto itr_tmp1 = priv1->CU_cmds.begin(); itr_tmp1 != priv1->CU_cmds.end(); /* NOTHING */) {
-            XmaHwExecBO* execbo_tmp1 = &dev_tmp1->kernel_execbos[itr_tmp1->second.execbo_id];
+    for (auto& itr_tmp1: priv1->CU_cmds) {
+        XmaHwExecBO* execbo_tmp1 = &dev_tmp1->kernel_execbos[itr_tmp1.second.execbo_id];
+
+        if (execbo_tmp1->session_id != s_handle.session_id)
+        {
+            xma_logmsg(XMA_ERROR_LOG, XMAUTILS_MOD, "xma_plg_check_all_execbo: Unexpected error-1. Please report this to sarabjee@xilinx.com\n");
+            return XMA_ERROR;
+        }
+        if (itr_tmp1.first != execbo_tmp1->cu_cmd_id1) {
+            xma_logmsg(XMA_ERROR_LOG, XMAUTILS_MOD, "xma_plg_check_all_execbo: Unexpected error-2. Please report this to sarabjee@xilinx.com\n");
+            return XMA_ERROR;
+        }
+        if (itr_tmp1.second.cmd_id2 != execbo_tmp1->cu_cmd_id2) {
+            xma_logmsg(XMA_ERROR_LOG, XMAUTILS_MOD, "xma_plg_check_all_execbo: Unexpected error-2. Please report this to sarabjee@xilinx.com\n");
+            return XMA_ERROR;
+        }
+        if (itr_tmp1.second.cu_id != execbo_tmp1->cu_index) {
+            xma_logmsg(XMA_ERROR_LOG, XMAUTILS_MOD, "xma_plg_check_all_execbo: Unexpected error-3. Please report this to sarabjee@xilinx.com\n");
+            return XMA_ERROR;
+        }
 
-            if (execbo_tmp1->session_id != s_handle.session_id)
+        if (execbo_tmp1->in_use) {
+            ert_start_kernel_cmd *cu_cmd = 
+                (ert_start_kernel_cmd*)execbo_tmp1->data;
+            if (cu_cmd->state == ERT_CMD_STATE_COMPLETED)
             {
-                xma_logmsg(XMA_ERROR_LOG, XMAUTILS_MOD, "xma_plg_check_all_execbo: Unexpected error-1. Please report this to sarabjee@xilinx.com\n");
-                return XMA_ERROR;
-            }
-            if (itr_tmp1->first != execbo_tmp1->cu_cmd_id1) {
-                xma_logmsg(XMA_ERROR_LOG, XMAUTILS_MOD, "xma_plg_check_all_execbo: Unexpected error-2. Please report this to sarabjee@xilinx.com\n");
-                return XMA_ERROR;
+                completed.emplace_back(itr_tmp1.second.execbo_id);
             }
-            if (itr_tmp1->second.cmd_id2 != execbo_tmp1->cu_cmd_id2) {
-                xma_logmsg(XMA_ERROR_LOG, XMAUTILS_MOD, "xma_plg_check_all_execbo: Unexpected error-2. Please report this to sarabjee@xilinx.com\n");
-                return XMA_ERROR;
-            }
-            if (itr_tmp1->second.cu_id != execbo_tmp1->cu_index) {
-                xma_logmsg(XMA_ERROR_LOG, XMAUTILS_MOD, "xma_plg_check_all_execbo: Unexpected error-3. Please report this to sarabjee@xilinx.com\n");
-                return XMA_ERROR;
+        }
+    }
+
+    for (auto execbo_id: completed) {
+        retire_execbo(dev_tmp1, execbo_id);
+    }
+
+    return XMA_SUCCESS;
+}
+
+void execbo_completion(XmaHwDevice* dev) {
+    std::vector<int32_t> completed;
+    while (!g_xma_singleton->xma_exit) {
+        {
+            std::unique_lock<std::mutex> lk(*dev->execbo_mutex);
+            if (dev->execbo_inflight.empty()) {
+                //Nothing submitted; sleep until a session schedules a command
+                dev->execbo_submitted->wait_for(lk, std::chrono::milliseconds(50));
+                continue;
             }
+        }
 
-            if (execbo_tmp1->in_use) {
-                ert_start_kernel_cmd *cu_cmd = 
-                    (ert_start_kernel_cmd*)execbo_tmp1->data;
-                if (cu_cmd->state == ERT_CMD_STATE_COMPLETED)
-                {
-                    if (s_handle.session_type < XMA_ADMIN) {
-                        priv1->kernel_complete_count++;
-                    }
-                    execbo_tmp1->in_use = false;
-
-                  itr_tmp1 = priv1->CU_cmds.erase(itr_tmp1);
-                }
-            } else {
-              ++itr_tmp1;
+        //Block in the driver until some command on this device changes state
+        xclExecWait(dev->handle, 50);
+
+        std::lock_guard<std::mutex> lk(*dev->execbo_mutex);
+        //Scan only execbos in flight, not every execbo of every session
+        completed.clear();
+        for (auto execbo_id: dev->execbo_inflight) {
+            ert_start_kernel_cmd *cu_cmd =
+                (ert_start_kernel_cmd*)dev->kernel_execbos[execbo_id].data;
+            if (cu_cmd->state == ERT_CMD_STATE_COMPLETED) {
+                completed.emplace_back(execbo_id);
             }
         }
+        for (auto execbo_id: completed) {
+            retire_execbo(dev, execbo_id);
+        }
     }
-
-    return XMA_SUCCESS;
 }
 
 } // namespace utils
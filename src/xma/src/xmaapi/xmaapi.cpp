@@ -69,8 +69,6 @@ void xma_thread1() {
         if (!g_xma_singleton->xma_exit) {
             //Check Session loading
             uint32_t max_load = 0;
-            bool expected = false;
-            bool desired = true;
             for (auto& itr1: g_xma_singleton->all_sessions) {
                 if (g_xma_singleton->xma_exit) {
                     break;
@@ -90,21 +88,11 @@ void xma_thread1() {
                     xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "XMA thread1 failed-3. Session XMA private pointer is NULL\n");
                     continue;
                 }
-                while (!(*(dev_tmp1->execbo_locked)).compare_exchange_weak(expected, desired)) {
-                    expected = false;
+                {
+                    //Completed commands are retired by device completion thread
+                    std::lock_guard<std::mutex> lk(*dev_tmp1->execbo_mutex);
+                    priv1->cmd_load += priv1->CU_cmds.size();
                 }
-                //execbo lock acquired
-
-                if (xma_core::utils::check_all_execbo(itr1.second) != XMA_SUCCESS) {
-                    xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "XMA thread1 failed-4. Unexpected error\n");
-                    //Release execbo lock
-                    *(dev_tmp1->execbo_locked) = false;
-                    continue;
-                }
-                priv1->cmd_load += priv1->CU_cmds.size();
-
-                //Release execbo lock
-                *(dev_tmp1->execbo_locked) = false;
 
                 max_load = std::max({max_load, (uint32_t)priv1->cmd_load});
             }
@@ -327,6 +315,13 @@ int32_t xma_initialize(XmaXclbinParameter *devXclbins, int32_t num_parms)
     //threadObjSystem.detach();
     g_xma_singleton->xma_thread1.detach();
 
+    //Completion threads wait at most 50 ms at a time so they exit within xma_exit
+    for (XmaHwDevice& hw_device: g_xma_singleton->hwcfg.devices) {
+        if (hw_device.num_execbo_allocated > 0) {
+            std::thread(xma_core::utils::execbo_completion, &hw_device).detach();
+        }
+    }
+
     xma_init_sighandlers();
     //xma_res_mark_xma_ready(g_xma_singleton->shm_res_cfg);
 
@@ -32,7 +32,9 @@
 #include <dlfcn.h>
 #include <iostream>
 #include <bitset>
+#include <map>
 #include "ert.h"
+#include "core/common/xclbin_image.h"
 
 //#define xma_logmsg(f_, ...) printf((f_), ##__VA_ARGS__)
 #define XMAAPI_MOD "xmahw_hal"
@@ -180,6 +182,9 @@ bool hal_configure(XmaHwCfg *hwcfg, XmaXclbinParameter *devXclbins, int32_t num_
         return false;
     }
 
+    /* Memory mapped xclbins by file name, devices loaded with the same xclbin share the image */
+    std::map<std::string, std::shared_ptr<const xrt_core::xclbin_image>> images;
+
     /* Download the requested image to the associated device */
     for (int32_t i = 0; i < num_parms; i++) {
         std::string xclbin = std::string(devXclbins[i].xclbin_name);
@@ -189,19 +194,21 @@ bool hal_configure(XmaHwCfg *hwcfg, XmaXclbinParameter *devXclbins, int32_t num_
                        dev_index);
             return false;
         }
-        char *buffer = xma_xclbin_file_open(xclbin.c_str());
-        if (!buffer)
-        {
-            xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "Could not open xclbin file %s\n",
-                       xclbin.c_str());
+        auto& image = images[xclbin];
+        try {
+            if (!image)
+                image = xrt_core::xclbin_image::open(xclbin);
+        } catch (const std::exception& ex) {
+            xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "Could not open xclbin file %s: %s\n",
+                       xclbin.c_str(), ex.what());
             return false;
         }
+        char *buffer = const_cast<char*>(image->data());
         int32_t rc = xma_xclbin_info_get(buffer, &info);
         if (rc != XMA_SUCCESS)
         {
             xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "Could not get info for xclbin file %s\n",
                        xclbin.c_str());
-            free(buffer);
             return false;
         }
 
@@ -213,7 +220,6 @@ bool hal_configure(XmaHwCfg *hwcfg, XmaXclbinParameter *devXclbins, int32_t num_
         dev_tmp1.handle = xclOpen(dev_index, NULL, XCL_QUIET);
         if (dev_tmp1.handle == NULL){
             xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "Unable to open device  id: %d\n", dev_index);
-            free(buffer);
             return false;
         }
         dev_tmp1.dev_index = dev_index;
@@ -223,14 +229,12 @@ bool hal_configure(XmaHwCfg *hwcfg, XmaXclbinParameter *devXclbins, int32_t num_
         if (rc != 0)
         {
             xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "xclGetDeviceInfo2 failed for device id: %d, rc=%d\n", dev_index, rc);
-            free(buffer);
             return false;
         }
 
         /* Always attempt download xclbin */
         rc = load_xclbin_to_device(dev_tmp1.handle, buffer);
         if (rc != 0) {
-            free(buffer);
             xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "Could not download xclbin file %s to device %d\n",
                         xclbin.c_str(), dev_index);
             return false;
@@ -239,14 +243,12 @@ bool hal_configure(XmaHwCfg *hwcfg, XmaXclbinParameter *devXclbins, int32_t num_
         dev_tmp1.number_of_cus = info.number_of_kernels;
         dev_tmp1.number_of_mem_banks = info.number_of_mem_banks;
         if (dev_tmp1.number_of_cus > MAX_XILINX_KERNELS + MAX_XILINX_SOFT_KERNELS) {
-            free(buffer);
             xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "Could not download xclbin file %s to device %d\n",
                         xclbin.c_str(), dev_index);
             xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "XMA & XRT supports max of %d CUs but xclbin has %d number of CUs\n", MAX_XILINX_KERNELS + MAX_XILINX_SOFT_KERNELS, dev_tmp1.number_of_cus);
             return false;
         }
         if (dev_tmp1.number_of_mem_banks > MAX_DDR_MAP) {
-            free(buffer);
             xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "XMA supports max of only %d mem banks\n", MAX_DDR_MAP);
             return false;
         }
@@ -325,7 +327,6 @@ bool hal_configure(XmaHwCfg *hwcfg, XmaXclbinParameter *devXclbins, int32_t num_
                     xma_logmsg(XMA_DEBUG_LOG, XMAAPI_MOD,"\tCU# %d - %s - default DDR bank:%d", d, (char*)tmp1.name, tmp1.default_ddr_bank);
                 }
                 if (xclOpenContext(dev_tmp1.handle, info.uuid, d, true) != 0) {
-                    free(buffer);
                     xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "Failed to open context to this CU\n");
                     return false;
                 }
@@ -385,6 +386,8 @@ bool hal_configure(XmaHwCfg *hwcfg, XmaXclbinParameter *devXclbins, int32_t num_
             num_execbo = MIN_EXECBO_POOL_SIZE;
         }
         dev_tmp1.kernel_execbos.reserve(num_execbo);
+        dev_tmp1.execbo_free.reserve(num_execbo);
+        dev_tmp1.execbo_inflight.reserve(num_execbo);
         dev_tmp1.num_execbo_allocated = num_execbo;
         for (int32_t d = 0; d < num_execbo; d++) {
             uint32_t  bo_handle;
@@ -397,7 +400,6 @@ bool hal_configure(XmaHwCfg *hwcfg, XmaXclbinParameter *devXclbins, int32_t num_
                                     XCL_BO_FLAGS_EXECBUF);
             if (!bo_handle || bo_handle == mNullBO) 
             {
-                free(buffer);
                 xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "Unable to create bo for cu start\n");
                 return false;
             }
@@ -409,8 +411,10 @@ bool hal_configure(XmaHwCfg *hwcfg, XmaXclbinParameter *devXclbins, int32_t num_
             dev_execbo.handle = bo_handle;
             dev_execbo.data = bo_data;
         }
-
-        free(buffer);
+        //Lowest index on top of free list
+        for (int32_t d = num_execbo - 1; d >= 0; d--) {
+            dev_tmp1.execbo_free.emplace_back(d);
+        }
     }
 
     return true;
@@ -18,6 +18,7 @@
 #include "xrt.h"
 #include "ert.h"
 #include "lib/xmahw_lib.h"
+#include "lib/xma_utils.hpp"
 //#include "lib/xmares.h"
 
 #include <cstdio>
@@ -483,25 +484,18 @@ int32_t xma_plg_execbo_avail_get(XmaSession s_handle)
         xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "Session XMA private: No execbo allocated\n");
         return -1;
     }
-    int32_t i;
-    int32_t rc = -1;
-    bool    found = false;
     //NOTE: execbo lock must be already acquired
 
-    for (i = 0; i < num_execbo; i++) {
-        XmaHwExecBO* execbo_tmp1 = &dev_tmp1->kernel_execbos[i];
-        if (!execbo_tmp1->in_use) {
-            found = true;
-        }
-
-        if (found) {
-            execbo_tmp1->in_use = true;
-            execbo_tmp1->cu_index = kernel_tmp1->cu_index;
-            execbo_tmp1->session_id = s_handle.session_id;
-            rc = i;
-            break;
-        }
+    if (dev_tmp1->execbo_free.empty()) {
+        return -1;
     }
+    int32_t rc = dev_tmp1->execbo_free.back();
+    dev_tmp1->execbo_free.pop_back();
+
+    XmaHwExecBO* execbo_tmp1 = &dev_tmp1->kernel_execbos[rc];
+    execbo_tmp1->in_use = true;
+    execbo_tmp1->cu_index = kernel_tmp1->cu_index;
+    execbo_tmp1->session_id = s_handle.session_id;
     //std::cout << "Sarab: Debug - " << __func__ << "; " << __LINE__ << std::endl;
 
     return rc;
@@ -577,11 +571,7 @@ XmaCUCmdObj xma_plg_schedule_work_item(XmaSession s_handle,
     uint8_t *src = (uint8_t*)regmap;
     int32_t bo_idx;
     
-    bool expected = false;
-    bool desired = true;
-    while (!(*(dev_tmp1->execbo_locked)).compare_exchange_weak(expected, desired)) {
-        expected = false;
-    }
+    std::lock_guard<std::mutex> lk(*dev_tmp1->execbo_mutex);
     //kernel completion lock acquired
     xma_logmsg(XMA_DEBUG_LOG, XMAPLUGIN_MOD, "1. Num of cmds in-progress = %lu\n", priv1->CU_cmds.size());
 
@@ -589,7 +579,6 @@ XmaCUCmdObj xma_plg_schedule_work_item(XmaSession s_handle,
     bo_idx = xma_plg_execbo_avail_get(s_handle);
     if (bo_idx == -1) {
         xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "Unable to find free execbo to use\n");
-        *(dev_tmp1->execbo_locked) = false;
         if (return_code) *return_code = XMA_ERROR;
         return cmd_obj_error;
     }
@@ -634,7 +623,7 @@ XmaCUCmdObj xma_plg_schedule_work_item(XmaSession s_handle,
     {
         xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD,
                     "Failed to submit kernel start with xclExecBuf\n");
-        *(dev_tmp1->execbo_locked) = false;
+        xma_core::utils::release_execbo(dev_tmp1, bo_idx);
         if (return_code) *return_code = XMA_ERROR;
         return cmd_obj_error;
     }
@@ -673,8 +662,9 @@ XmaCUCmdObj xma_plg_schedule_work_item(XmaSession s_handle,
         }
     }
 
+    xma_core::utils::track_execbo(dev_tmp1, bo_idx, priv1, s_handle.session_type < XMA_ADMIN);
+
     xma_logmsg(XMA_DEBUG_LOG, XMAPLUGIN_MOD, "2. Num of cmds in-progress = %lu\n", priv1->CU_cmds.size());
-    *(dev_tmp1->execbo_locked) = false;
     if (return_code) *return_code = XMA_SUCCESS;
     return cmd_obj;
 }
@@ -756,11 +746,7 @@ XmaCUCmdObj xma_plg_schedule_cu_cmd(XmaSession s_handle,
     uint8_t *src = (uint8_t*)regmap;
     int32_t bo_idx;
     
-    bool expected = false;
-    bool desired = true;
-    while (!(*(dev_tmp1->execbo_locked)).compare_exchange_weak(expected, desired)) {
-        expected = false;
-    }
+    std::lock_guard<std::mutex> lk(*dev_tmp1->execbo_mutex);
     //kernel completion lock acquired
 
     
@@ -770,7 +756,6 @@ XmaCUCmdObj xma_plg_schedule_cu_cmd(XmaSession s_handle,
     bo_idx = xma_plg_execbo_avail_get(s_handle);
     if (bo_idx == -1) {
         xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "Unable to find free execbo to use\n");
-        *(dev_tmp1->execbo_locked) = false;
         if (return_code) *return_code = XMA_ERROR;
         return cmd_obj_error;
     }
@@ -815,7 +800,7 @@ XmaCUCmdObj xma_plg_schedule_cu_cmd(XmaSession s_handle,
     {
         xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD,
                     "Failed to submit kernel start with xclExecBuf\n");
-        *(dev_tmp1->execbo_locked) = false;
+        xma_core::utils::release_execbo(dev_tmp1, bo_idx);
         if (return_code) *return_code = XMA_ERROR;
         return cmd_obj_error;
     }
@@ -854,8 +839,9 @@ XmaCUCmdObj xma_plg_schedule_cu_cmd(XmaSession s_handle,
         }
     }
 
+    xma_core::utils::track_execbo(dev_tmp1, bo_idx, priv1, s_handle.session_type < XMA_ADMIN);
+
     xma_logmsg(XMA_DEBUG_LOG, XMAPLUGIN_MOD, "2. Num of cmds in-progress = %lu\n", priv1->CU_cmds.size());
-    *(dev_tmp1->execbo_locked) = false;
     if (return_code) *return_code = XMA_SUCCESS;
     return cmd_obj;
 }
@@ -902,28 +888,19 @@ int32_t xma_plg_cu_cmd_status(XmaSession s_handle, XmaCUCmdObj* cmd_obj_array, i
         return XMA_ERROR;
     }
 
-    bool expected = false;
-    bool desired = true;
     bool all_done = true;
     std::vector<XmaCUCmdObj> cmd_vector(cmd_obj_array, cmd_obj_array+num_cu_objs);
+    std::unique_lock<std::mutex> lk(*dev_tmp1->execbo_mutex);
+    //kernel completion lock acquired
     do {
-        while (!(*(dev_tmp1->execbo_locked)).compare_exchange_weak(expected, desired)) {
-            expected = false;
-        }
-        //kernel completion lock acquired
-
         all_done = true;
         for (auto& cmd: cmd_vector) {
             if (s_handle.session_type < XMA_ADMIN && cmd.cu_index != kernel_tmp1->cu_index) {
                 xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "cmd_obj_array is corrupted-1\n");
-                //Release completion lock
-                *(dev_tmp1->execbo_locked) = false;
                 return XMA_ERROR;
             }
             if (cmd.cmd_id1 == 0 || cmd.cu_index == -1) {
                 xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "cmd_obj is invalid. Schedule_command may have  failed\n");
-                //Release completion lock
-                *(dev_tmp1->execbo_locked) = false;
                 return XMA_ERROR;
             }
             auto itr_tmp1 = priv1->CU_cmds.find(cmd.cmd_id1);
@@ -934,36 +911,29 @@ int32_t xma_plg_cu_cmd_status(XmaSession s_handle, XmaCUCmdObj* cmd_obj_array, i
 
                 if (itr_tmp1->second.cmd_id2 != cmd.cmd_id2) {
                     xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "cmd_obj_array is corrupted-2\n");
-                    //Release completion lock
-                    *(dev_tmp1->execbo_locked) = false;
                     return XMA_ERROR;
                 }
                 if (itr_tmp1->second.cu_id != cmd.cu_index) {
                     xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "cmd_obj_array is corrupted-3\n");
-                    //Release completion lock
-                    *(dev_tmp1->execbo_locked) = false;
                     return XMA_ERROR;
                 }
             }
 
             if (cmd.do_not_use1 != s_handle.session_signature) {
                 xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "cmd_obj_array is corrupted-5\n");
-                //Release completion lock
-                *(dev_tmp1->execbo_locked) = false;
                 return XMA_ERROR;
             }
         }
 
-        //Release completion lock
-        *(dev_tmp1->execbo_locked) = false;
-
         if (!wait_for_cu_cmds) {
             //Don't wait for all cu_cmds to finsh
             all_done = true;
         } else if (!all_done) {
-            xclExecWait(priv1->dev_handle, 10000);
+            //Device completion thread retires commands of this session and notifies
+            priv1->work_item_cond.wait_for(lk, std::chrono::milliseconds(10000));
         }
     } while(!all_done);
+    lk.unlock();
 
     for(int32_t i = 0; i < num_cu_objs; i++) {
         cmd_obj_array[i].cmd_finished = cmd_vector[i].cmd_finished;
@@ -1006,34 +976,54 @@ int32_t xma_plg_is_work_item_done(XmaSession s_handle, int32_t timeout_ms)
 
     int32_t count = 0;
     int32_t give_up = 0;
-    bool expected = false;
-    bool desired = true;
+    bool waited = false;
+    auto& poll = *dev_tmp1->completion_poll;
+    auto start = std::chrono::steady_clock::now();
+
+    //Check for completed work items, updating completion count from execbo state
+    auto work_item_done = [&]() {
+        std::lock_guard<std::mutex> lk(*dev_tmp1->execbo_mutex);
+        xma_core::utils::check_all_execbo(s_handle);
+        return priv1->kernel_complete_count > 0;
+    };
+
     while (count == 0)
     {
-        while (!(*(dev_tmp1->execbo_locked)).compare_exchange_weak(expected, desired)) {
-            expected = false;
-        }
+        std::unique_lock<std::mutex> lk(*dev_tmp1->execbo_mutex);
         //kernel completion lock acquired
 
         count = priv1->kernel_complete_count;
 
         if (count) {
             priv1->kernel_complete_count--;
+            lk.unlock();
             if (count > 255) {
                 xma_logmsg(XMA_WARNING_LOG, XMAPLUGIN_MOD, "CU completion count is more than 256. Application maybe slow to process CU output\n");
             }
-            //Release completion lock
-            *(dev_tmp1->execbo_locked) = false;
+            //Time spent waiting adapts the poll window to work item duration
+            if (waited) {
+                auto elapsed = std::chrono::steady_clock::now() - start;
+                poll.record(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+            }
             return XMA_SUCCESS;
-        } else {
-            //Release completion lock
-            *(dev_tmp1->execbo_locked) = false;
         }
+        lk.unlock();
 
-        // Wait for a notification
+        //Poll execbo state for short work items before blocking
+        waited = true;
+        if (poll.poll(work_item_done))
+            continue;
+
+        //Wait for the device completion thread to retire a work item of this session
         give_up++;
-        xclExecWait(priv1->dev_handle, timeout_ms);
-        if (give_up >= 3)
+        lk.lock();
+        if (priv1->kernel_complete_count == 0) {
+            if (timeout_ms < 0)
+                priv1->work_item_cond.wait(lk);
+            else
+                priv1->work_item_cond.wait_for(lk, std::chrono::milliseconds(timeout_ms));
+        }
+        if (give_up >= 3 && priv1->kernel_complete_count == 0)
             break;
     }
 